@@ -0,0 +1,636 @@
+#include "ipc_bench.hpp"
+
+#include "synthetic_log.hpp"
+
+#include "ipc/log_ring.hpp"
+#include "ipc/message_queue.hpp"
+#include "ipc/semaphore.hpp"
+#include "ipc/shared_memory.hpp"
+#include "logging/logger.hpp"
+#include "model/events.hpp"
+#include "model/shared_state.hpp"
+#include "visualization/log_parser.hpp"
+
+#include <sys/ipc.h>
+#include <sys/msg.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+/** @brief Default System V queue capacity (msgmnb); bounds the backlog of the priority-receive case. */
+constexpr size_t kQueueBytes = 16384;
+/** @brief Largest System V message (msgmax), mtype included. */
+constexpr size_t kMaxMessageBytes = 8192 + sizeof(long);
+constexpr size_t kMaxPriorityDepth = 64;
+constexpr int kPriorityLevels = 3;  // triage colours travel as mtypes 1..3
+constexpr long kDataType = 1;
+constexpr long kStopType = 2;
+/** @brief Lines parsed per clock read, so the timer does not dominate a ~100 ns parse. */
+constexpr size_t kParseBatch = 64;
+
+uint64_t nowNs() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+struct CaseResult {
+    std::string name;
+    size_t bytes{0};
+    int producers{1};
+    int consumers{1};
+    uint64_t ops{0};
+    double seconds{0.0};
+    uint64_t meanNs{0};
+    uint64_t p50Ns{0};
+    uint64_t p90Ns{0};
+    uint64_t p99Ns{0};
+    uint64_t p999Ns{0};
+    uint64_t maxNs{0};
+    std::vector<std::pair<std::string, long long>> extra;  // case-specific figures (queue depth, drops)
+
+    explicit CaseResult(std::string caseName, size_t messageBytes = 0, int producerCount = 1, int consumerCount = 1)
+        : name(std::move(caseName)), bytes(messageBytes), producers(producerCount), consumers(consumerCount) {}
+};
+
+/** @brief Fill the latency fields of a result from raw per-operation samples (sorted in place). */
+void fillLatency(std::vector<uint64_t>& samples, CaseResult& result) {
+    if (samples.empty()) return;
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double quantile) {
+        return samples[static_cast<size_t>(quantile * static_cast<double>(samples.size() - 1))];
+    };
+    uint64_t sum = 0;
+    for (uint64_t ns : samples) sum += ns;
+    result.meanNs = sum / samples.size();
+    result.p50Ns = at(0.50);
+    result.p90Ns = at(0.90);
+    result.p99Ns = at(0.99);
+    result.p999Ns = at(0.999);
+    result.maxNs = samples.back();
+}
+
+/** @brief Message of a given total size; the send stamp follows the mtype. */
+class MessageBuffer {
+public:
+    explicit MessageBuffer(size_t bytes) : words_((bytes + sizeof(long) - 1) / sizeof(long), 0), bytes_(bytes) {}
+
+    void* data() { return words_.data(); }
+    size_t size() const { return bytes_; }
+    long type() const { return words_[0]; }
+
+    void setStamp(uint64_t ns) { std::memcpy(&words_[1], &ns, sizeof(ns)); }
+    uint64_t stamp() const {
+        uint64_t ns = 0;
+        std::memcpy(&ns, &words_[1], sizeof(ns));
+        return ns;
+    }
+
+private:
+    std::vector<long> words_;
+    size_t bytes_;
+};
+
+/** @brief Collects results, printing each one as it arrives. */
+class Report {
+public:
+    explicit Report(const IpcBenchOptions& options)
+        : options_(options), text_(options.jsonPath == "-" ? stderr : stdout) {}
+
+    bool wants(const std::string& name) const {
+        return options_.only.empty() || name.compare(0, options_.only.size(), options_.only) == 0;
+    }
+
+    void add(CaseResult result) {
+        double opsPerSec = result.seconds > 0.0 ? static_cast<double>(result.ops) / result.seconds : 0.0;
+        char threads[32];
+        std::snprintf(threads, sizeof(threads), "%dp/%dc", result.producers, result.consumers);
+        std::fprintf(text_, "  %-26s %6zu B %-7s %11.0f ops/s  mean %7llu  p50 %7llu  p99 %8llu  p99.9 %8llu  max %9llu ns",
+                     result.name.c_str(), result.bytes, threads, opsPerSec,
+                     static_cast<unsigned long long>(result.meanNs), static_cast<unsigned long long>(result.p50Ns),
+                     static_cast<unsigned long long>(result.p99Ns), static_cast<unsigned long long>(result.p999Ns),
+                     static_cast<unsigned long long>(result.maxNs));
+        for (const auto& kv : result.extra) {
+            std::fprintf(text_, "  %s=%lld", kv.first.c_str(), kv.second);
+        }
+        std::fprintf(text_, "\n");
+        std::fflush(text_);
+        results_.push_back(std::move(result));
+    }
+
+    void fail(const std::string& name) {
+        std::fprintf(stderr, "case %s failed to set up\n", name.c_str());
+        ok_ = false;
+    }
+
+    bool ok() const { return ok_; }
+    std::FILE* text() const { return text_; }
+
+    // Names and keys are fixed identifiers, so the JSON needs no escaping.
+    bool writeJson() const {
+        std::ofstream file;
+        std::ostream* out = &std::cout;
+        if (options_.jsonPath != "-") {
+            file.open(options_.jsonPath, std::ios::out | std::ios::trunc);
+            if (!file) {
+                std::cerr << "Cannot write " << options_.jsonPath << std::endl;
+                return false;
+            }
+            out = &file;
+        }
+        *out << "{\n  \"suite\": \"ipc\",\n  \"opsPerCase\": " << options_.ops << ",\n  \"results\": [";
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const CaseResult& r = results_[i];
+            char rate[64];
+            std::snprintf(rate, sizeof(rate), "%.6f, \"opsPerSec\": %.0f", r.seconds,
+                          r.seconds > 0.0 ? static_cast<double>(r.ops) / r.seconds : 0.0);
+            *out << (i > 0 ? "," : "") << "\n    {\"name\": \"" << r.name << "\", \"bytes\": " << r.bytes
+                 << ", \"producers\": " << r.producers << ", \"consumers\": " << r.consumers << ", \"ops\": " << r.ops
+                 << ", \"seconds\": " << rate << ", \"latencyNs\": {\"mean\": " << r.meanNs << ", \"p50\": " << r.p50Ns
+                 << ", \"p90\": " << r.p90Ns << ", \"p99\": " << r.p99Ns << ", \"p999\": " << r.p999Ns
+                 << ", \"max\": " << r.maxNs << "}";
+            for (const auto& kv : r.extra) {
+                *out << ", \"" << kv.first << "\": " << kv.second;
+            }
+            *out << "}";
+        }
+        *out << "\n  ]\n}\n";
+        return static_cast<bool>(*out);
+    }
+
+private:
+    const IpcBenchOptions& options_;
+    std::FILE* text_;
+    std::vector<CaseResult> results_;
+    bool ok_{true};
+};
+
+/** @brief Start threads together so the first ones do not finish before the last ones exist. */
+class StartGate {
+public:
+    void wait() const {
+        while (!open_.load(std::memory_order_acquire)) std::this_thread::yield();
+    }
+    void open() { open_.store(true, std::memory_order_release); }
+
+private:
+    std::atomic<bool> open_{false};
+};
+
+// One thread, queue never holds more than one message: the bare msgsnd/msgrcv cost.
+void benchQueueSendReceive(const IpcBenchOptions& options, size_t size, Report& report) {
+    MessageQueue queue;
+    if (!queue.create(IPC_PRIVATE)) return report.fail("mq_send");
+    MessageBuffer out(size);
+    MessageBuffer in(size);
+    std::vector<uint64_t> sendNs;
+    std::vector<uint64_t> receiveNs;
+    sendNs.reserve(options.ops);
+    receiveNs.reserve(options.ops);
+    uint64_t start = nowNs();
+    for (size_t i = 0; i < options.ops; ++i) {
+        uint64_t t0 = nowNs();
+        if (!queue.send(out.data(), size, kDataType)) break;
+        uint64_t t1 = nowNs();
+        if (!queue.receive(in.data(), size, 0)) break;
+        uint64_t t2 = nowNs();
+        sendNs.push_back(t1 - t0);
+        receiveNs.push_back(t2 - t1);
+    }
+    double seconds = static_cast<double>(nowNs() - start) / 1e9;
+    queue.destroy();
+
+    CaseResult send{"mq_send", size};
+    send.ops = sendNs.size();
+    send.seconds = seconds;
+    fillLatency(sendNs, send);
+    report.add(send);
+    CaseResult receive{"mq_receive", size};
+    receive.ops = receiveNs.size();
+    receive.seconds = seconds;
+    fillLatency(receiveNs, receive);
+    report.add(receive);
+}
+
+// A backlog of mixed mtypes 1..3 drained either in arrival order (msgtyp 0) or lowest type first
+// (msgtyp -3, as the specialists receive by colour); only the receives are timed.
+void benchQueuePriority(const IpcBenchOptions& options, size_t size, bool priority, Report& report) {
+    const char* name = priority ? "mq_receive_priority" : "mq_receive_fifo";
+    MessageQueue queue;
+    if (!queue.create(IPC_PRIVATE)) return report.fail(name);
+    size_t depth = std::min(kMaxPriorityDepth, kQueueBytes / (size - sizeof(long)));
+    if (depth == 0) depth = 1;
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> type(1, kPriorityLevels);
+    MessageBuffer out(size);
+    MessageBuffer in(size);
+    std::vector<uint64_t> samples;
+    samples.reserve(options.ops + depth);
+    uint64_t timedNs = 0;
+    bool failed = false;
+    while (samples.size() < options.ops && !failed) {
+        for (size_t i = 0; i < depth && !failed; ++i) {
+            failed = !queue.send(out.data(), size, type(rng));
+        }
+        for (size_t i = 0; i < depth && !failed; ++i) {
+            uint64_t t0 = nowNs();
+            failed = !queue.receive(in.data(), size, priority ? -kPriorityLevels : 0);
+            uint64_t ns = nowNs() - t0;
+            samples.push_back(ns);
+            timedNs += ns;
+        }
+    }
+    queue.destroy();
+
+    CaseResult result{name, size};
+    result.ops = samples.size();
+    result.seconds = static_cast<double>(timedNs) / 1e9;
+    result.extra.emplace_back("depth", static_cast<long long>(depth));
+    fillLatency(samples, result);
+    report.add(result);
+}
+
+// N producers and N consumers on one queue; latency is send stamp to receive (end to end).
+void benchQueuePipeline(const IpcBenchOptions& options, size_t size, int pairs, Report& report) {
+    MessageQueue queue;
+    if (!queue.create(IPC_PRIVATE)) return report.fail("mq_pipeline");
+    StartGate gate;
+    std::vector<std::vector<uint64_t>> latencies(static_cast<size_t>(pairs));
+    std::vector<std::thread> consumers;
+    std::vector<std::thread> producers;
+    for (int c = 0; c < pairs; ++c) {
+        consumers.emplace_back([&, c]() {
+            MessageBuffer in(size);
+            std::vector<uint64_t>& samples = latencies[static_cast<size_t>(c)];
+            samples.reserve(options.ops);
+            while (queue.receive(in.data(), size, 0) && in.type() != kStopType) {
+                samples.push_back(nowNs() - in.stamp());
+            }
+        });
+    }
+    for (int p = 0; p < pairs; ++p) {
+        producers.emplace_back([&]() {
+            MessageBuffer out(size);
+            gate.wait();
+            for (size_t i = 0; i < options.ops; ++i) {
+                out.setStamp(nowNs());
+                if (!queue.send(out.data(), size, kDataType)) break;
+            }
+        });
+    }
+    uint64_t start = nowNs();
+    gate.open();
+    for (std::thread& t : producers) t.join();
+    // Stop markers queue up behind every data message, so each consumer drains its share first.
+    MessageBuffer stop(size);
+    for (int c = 0; c < pairs; ++c) queue.send(stop.data(), size, kStopType);
+    for (std::thread& t : consumers) t.join();
+    double seconds = static_cast<double>(nowNs() - start) / 1e9;
+    queue.destroy();
+
+    std::vector<uint64_t> samples;
+    for (const std::vector<uint64_t>& part : latencies) samples.insert(samples.end(), part.begin(), part.end());
+    CaseResult result{"mq_pipeline", size, pairs, pairs};
+    result.ops = samples.size();
+    result.seconds = seconds;
+    fillLatency(samples, result);
+    report.add(result);
+}
+
+void benchSemaphore(const IpcBenchOptions& options, Report& report) {
+    Semaphore sem;
+    if (report.wants("sem_post_wait")) {
+        if (!sem.create(IPC_PRIVATE, 0)) return report.fail("sem_post_wait");
+        std::vector<uint64_t> samples;
+        samples.reserve(options.ops);
+        uint64_t start = nowNs();
+        for (size_t i = 0; i < options.ops; ++i) {
+            uint64_t t0 = nowNs();
+            if (!sem.post() || !sem.wait()) break;
+            samples.push_back(nowNs() - t0);
+        }
+        CaseResult result{"sem_post_wait"};
+        result.ops = samples.size();
+        result.seconds = static_cast<double>(nowNs() - start) / 1e9;
+        fillLatency(samples, result);
+        sem.destroy();
+        report.add(result);
+    }
+
+    // Two threads hand a token back and forth: a post that wakes a blocked waiter, twice per sample.
+    if (report.wants("sem_pingpong_rtt")) {
+        Semaphore ping;
+        Semaphore pong;
+        if (!ping.create(IPC_PRIVATE, 0) || !pong.create(IPC_PRIVATE, 0)) return report.fail("sem_pingpong_rtt");
+        std::thread partner([&]() {
+            for (size_t i = 0; i < options.ops; ++i) {
+                if (!ping.wait() || !pong.post()) break;
+            }
+        });
+        std::vector<uint64_t> samples;
+        samples.reserve(options.ops);
+        uint64_t start = nowNs();
+        for (size_t i = 0; i < options.ops; ++i) {
+            uint64_t t0 = nowNs();
+            if (!ping.post() || !pong.wait()) break;
+            samples.push_back(nowNs() - t0);
+        }
+        double seconds = static_cast<double>(nowNs() - start) / 1e9;
+        partner.join();
+        ping.destroy();
+        pong.destroy();
+        CaseResult result{"sem_pingpong_rtt", 0, 1, 1};
+        result.ops = samples.size();
+        result.seconds = seconds;
+        fillLatency(samples, result);
+        report.add(result);
+    }
+}
+
+// Every role attaches the SharedState segment once at startup; this is that cost per process.
+void benchSharedMemory(const IpcBenchOptions& options, Report& report) {
+    SharedMemory shm;
+    if (!shm.create(IPC_PRIVATE, sizeof(SharedState))) return report.fail("shm_attach");
+    std::vector<uint64_t> attachNs;
+    std::vector<uint64_t> detachNs;
+    attachNs.reserve(options.ops);
+    detachNs.reserve(options.ops);
+    uint64_t start = nowNs();
+    for (size_t i = 0; i < options.ops; ++i) {
+        uint64_t t0 = nowNs();
+        void* addr = shm.attach();
+        if (!addr) break;
+        uint64_t t1 = nowNs();
+        if (!shm.detach(addr)) break;
+        uint64_t t2 = nowNs();
+        attachNs.push_back(t1 - t0);
+        detachNs.push_back(t2 - t1);
+    }
+    double seconds = static_cast<double>(nowNs() - start) / 1e9;
+    shm.destroy();
+
+    CaseResult attach{"shm_attach", sizeof(SharedState)};
+    attach.ops = attachNs.size();
+    attach.seconds = seconds;
+    fillLatency(attachNs, attach);
+    report.add(attach);
+    CaseResult detach{"shm_detach", sizeof(SharedState)};
+    detach.ops = detachNs.size();
+    detach.seconds = seconds;
+    fillLatency(detachNs, detach);
+    report.add(detach);
+}
+
+/** @brief Queues, semaphore and shared state a role's metrics context points at. */
+struct MetricsFixture {
+    MessageQueue registration;
+    MessageQueue triage;
+    std::array<MessageQueue, kSpecialistCount> specialists;
+    Semaphore waitSem;
+    std::unique_ptr<SharedState> shared{std::make_unique<SharedState>()};
+
+    bool create() {
+        bool ok = registration.create(IPC_PRIVATE) && triage.create(IPC_PRIVATE) && waitSem.create(IPC_PRIVATE, 50);
+        for (MessageQueue& queue : specialists) ok = ok && queue.create(IPC_PRIVATE);
+        return ok;
+    }
+
+    void destroy() {
+        registration.destroy();
+        triage.destroy();
+        for (MessageQueue& queue : specialists) queue.destroy();
+        waitSem.destroy();
+    }
+
+    LogMetricsContext context() {
+        std::array<const MessageQueue*, kSpecialistCount> specQueues{};
+        for (int i = 0; i < kSpecialistCount; ++i) specQueues[i] = &specialists[i];
+        return LogMetricsContext{shared.get(), &registration, &triage, specQueues, waitSem.id()};
+    }
+};
+
+enum class MetricsMode { None, Probe, Published };
+
+const char* metricsModeName(MetricsMode mode) {
+    switch (mode) {
+        case MetricsMode::None: return "none";
+        case MetricsMode::Probe: return "probe";
+        case MetricsMode::Published: return "published";
+    }
+    return "?";
+}
+
+void applyMetricsMode(MetricsMode mode, MetricsFixture& fixture) {
+    if (mode == MetricsMode::None) {
+        clearLogMetricsContext();
+        return;
+    }
+    LogMetricsContext context = fixture.context();
+    fixture.shared->metricsPublishIntervalMs = mode == MetricsMode::Published ? 10 : 0;
+    if (mode == MetricsMode::Published) {
+        fixture.shared->metrics.publish(sampleMetrics(context));
+    }
+    setLogMetricsContext(context);
+}
+
+// Producers call logEvent while one thread drains like the logger does (LOG_QUEUE or the rings);
+// the timed part is the logEvent call itself.
+void benchLogEventCase(const IpcBenchOptions& options, int producers, int logQueueId, LogRingArena* rings,
+                       const std::string& name, Report& report) {
+    StartGate gate;
+    std::atomic<bool> stop{false};
+    uint64_t droppedBefore = rings ? rings->dropped() : 0;
+    std::thread drain([&]() {
+        if (!rings) {
+            LogMessage msg{};
+            while (msgrcv(logQueueId, &msg, sizeof(msg) - sizeof(long), 0, 0) != -1 &&
+                   std::strncmp(msg.text, "END", sizeof(msg.text)) != 0) {
+            }
+            return;
+        }
+        for (;;) {
+            bool any = false;
+            for (size_t r = 0; r < rings->ringCount(); ++r) {
+                uint64_t stampNs = 0;
+                size_t size = 0;
+                while (rings->peek(r, stampNs, size)) {
+                    rings->pop(r);
+                    any = true;
+                }
+            }
+            if (!any) {
+                if (stop.load()) break;
+                rings->waitForData(5);
+            }
+        }
+    });
+    std::vector<std::vector<uint64_t>> latencies(static_cast<size_t>(producers));
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            std::vector<uint64_t>& samples = latencies[static_cast<size_t>(p)];
+            samples.reserve(options.ops);
+            const std::string text = "Registering patient id=" + std::to_string(p + 1) + " vip=0 persons=1";
+            gate.wait();
+            for (size_t i = 0; i < options.ops; ++i) {
+                uint64_t t0 = nowNs();
+                logEvent(logQueueId, Role::Registration1, static_cast<int>(i), text);
+                samples.push_back(nowNs() - t0);
+            }
+        });
+    }
+    uint64_t start = nowNs();
+    gate.open();
+    for (std::thread& t : threads) t.join();
+    double seconds = static_cast<double>(nowNs() - start) / 1e9;
+    if (rings) {
+        stop.store(true);
+    } else {
+        logEvent(logQueueId, Role::Director, 0, "END");
+    }
+    drain.join();
+
+    std::vector<uint64_t> samples;
+    for (const std::vector<uint64_t>& part : latencies) samples.insert(samples.end(), part.begin(), part.end());
+    CaseResult result{name, sizeof(LogMessage), producers, 1};
+    result.ops = samples.size();
+    result.seconds = seconds;
+    if (rings) result.extra.emplace_back("dropped", static_cast<long long>(rings->dropped() - droppedBefore));
+    fillLatency(samples, result);
+    report.add(result);
+}
+
+// Queue cases run first: once attached, the rings stay the log transport of this process.
+void benchLogEvent(const IpcBenchOptions& options, Report& report) {
+    const MetricsMode modes[] = {MetricsMode::None, MetricsMode::Probe, MetricsMode::Published};
+    bool queueWanted = false;
+    bool ringsWanted = false;
+    for (MetricsMode mode : modes) {
+        queueWanted = queueWanted || report.wants(std::string("log_event_queue_") + metricsModeName(mode));
+        ringsWanted = ringsWanted || report.wants(std::string("log_event_rings_") + metricsModeName(mode));
+    }
+    if (!queueWanted && !ringsWanted) return;
+    MessageQueue logQueue;
+    MetricsFixture fixture;
+    if (!logQueue.create(IPC_PRIVATE) || !fixture.create()) {
+        logQueue.destroy();
+        fixture.destroy();
+        return report.fail("log_event");
+    }
+    for (MetricsMode mode : modes) {
+        std::string name = std::string("log_event_queue_") + metricsModeName(mode);
+        if (!report.wants(name)) continue;
+        applyMetricsMode(mode, fixture);
+        for (int producers : options.threads) {
+            benchLogEventCase(options, producers, logQueue.id(), nullptr, name, report);
+        }
+    }
+
+    if (ringsWanted) {
+        key_t key = static_cast<key_t>(0x5B000000 | (getpid() & 0xffffff));
+        LogRingArena rings;
+        if (!rings.create(LogRingArena::nameForKey(key), 64, 512, sizeof(LogMessage)) || !attachLogRings(key)) {
+            report.fail("log_event_rings");
+        } else {
+            for (MetricsMode mode : modes) {
+                std::string name = std::string("log_event_rings_") + metricsModeName(mode);
+                if (!report.wants(name)) continue;
+                applyMetricsMode(mode, fixture);
+                for (int producers : options.threads) {
+                    benchLogEventCase(options, producers, logQueue.id(), &rings, name, report);
+                }
+            }
+        }
+        rings.destroy();
+    }
+    clearLogMetricsContext();
+    logQueue.destroy();
+    fixture.destroy();
+}
+
+void benchParse(const IpcBenchOptions& options, Report& report) {
+    size_t count = std::max(options.ops, kParseBatch);
+    std::vector<std::string> lines = synthesizeLog(count);
+    std::string blob;
+    for (const std::string& line : lines) {
+        blob += line;
+        blob.push_back('\n');
+    }
+    std::vector<std::string_view> views;
+    views.reserve(lines.size());
+    for (size_t pos = 0; pos < blob.size();) {
+        size_t nl = blob.find('\n', pos);
+        views.emplace_back(blob.data() + pos, nl - pos);
+        pos = nl + 1;
+    }
+    std::vector<uint64_t> samples;
+    samples.reserve(views.size() / kParseBatch + 1);
+    long long checksum = 0;
+    uint64_t start = nowNs();
+    for (size_t i = 0; i + kParseBatch <= views.size(); i += kParseBatch) {
+        uint64_t t0 = nowNs();
+        for (size_t j = i; j < i + kParseBatch; ++j) {
+            LogEntry entry;
+            if (parseLogLine(views[j], entry)) checksum += static_cast<int>(entry.kind) + entry.waitingCurrent;
+        }
+        samples.push_back((nowNs() - t0) / kParseBatch);
+    }
+    CaseResult result{"parse_log_line", blob.size() / views.size()};
+    result.ops = samples.size() * kParseBatch;
+    result.seconds = static_cast<double>(nowNs() - start) / 1e9;
+    result.extra.emplace_back("checksum", checksum);
+    fillLatency(samples, result);
+    report.add(result);
+}
+} // namespace
+
+int runIpcSuite(const IpcBenchOptions& options) {
+    for (size_t size : options.sizes) {
+        if (size < sizeof(long) + sizeof(uint64_t) || size > kMaxMessageBytes) {
+            std::cerr << "Message sizes must be in " << sizeof(long) + sizeof(uint64_t) << ".." << kMaxMessageBytes
+                      << " bytes" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    for (int threads : options.threads) {
+        if (threads <= 0) {
+            std::cerr << "Thread counts must be > 0" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    Report report(options);
+    std::fprintf(report.text(), "suite=ipc ops=%zu cpus=%u (latency per operation; mq_pipeline is send-to-receive)\n",
+                 options.ops, std::thread::hardware_concurrency());
+    for (size_t size : options.sizes) {
+        if (report.wants("mq_send") || report.wants("mq_receive")) benchQueueSendReceive(options, size, report);
+        if (report.wants("mq_receive_fifo")) benchQueuePriority(options, size, false, report);
+        if (report.wants("mq_receive_priority")) benchQueuePriority(options, size, true, report);
+        if (report.wants("mq_pipeline")) {
+            for (int pairs : options.threads) benchQueuePipeline(options, size, pairs, report);
+        }
+    }
+    benchSemaphore(options, report);
+    if (report.wants("shm_attach") || report.wants("shm_detach")) benchSharedMemory(options, report);
+    benchLogEvent(options, report);
+    if (report.wants("parse_log_line")) benchParse(options, report);
+
+    if (!options.jsonPath.empty() && !report.writeJson()) return EXIT_FAILURE;
+    return report.ok() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
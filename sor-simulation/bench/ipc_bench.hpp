@@ -0,0 +1,24 @@
+#pragma once
+
+// IPC suite of sor_bench: latency distributions and throughput of the primitives every role uses.
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/** @brief Options of `sor_bench ipc`. */
+struct IpcBenchOptions {
+    size_t ops{20000};                                  // timed operations per case (per producer when threaded)
+    std::vector<size_t> sizes{16, 64, 256, 1024, 4096}; // message sizes in bytes, mtype included
+    std::vector<int> threads{1, 2, 4};                  // producer (and consumer) counts for the threaded cases
+    std::string jsonPath;                               // also write the results as JSON ("-" = stdout)
+    std::string only;                                   // run only cases whose name starts with this prefix
+};
+
+/**
+ * @brief Run the IPC cases: MessageQueue send/receive (FIFO, negative-msgtyp priority, producer/consumer
+ * pipelines), Semaphore post/wait, SharedMemory attach/detach, logEvent per transport and metrics
+ * context, and parseLogLine. Prints one line per case.
+ * @return process exit code.
+ */
+int runIpcSuite(const IpcBenchOptions& options);
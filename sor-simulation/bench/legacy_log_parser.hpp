@@ -0,0 +1,156 @@
+#pragma once
+
+// Reference copy of the original visualizer ingest path (split into std::string fields, then a
+// chain of text.find() scans per line). Kept only so sor_bench can compare against it.
+
+#include <cctype>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace legacy {
+
+struct LogEntry {
+    int simTime{0};
+    int pid{0};
+    bool hasMetrics{false};
+    int waitingCurrent{0};
+    int waitingCapacity{0};
+    int regQueue{0};
+    int triageQueue{0};
+    int specialistsQueue{0};
+    int waitSem{0};
+    int stateSem{0};
+    std::string role;
+    std::string text;
+};
+
+inline int toIntSafe(const std::string& s) {
+    try {
+        return std::stoi(s);
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
+inline bool extractInt(const std::string& text, const std::string& key, int& out) {
+    size_t pos = 0;
+    while (true) {
+        pos = text.find(key, pos);
+        if (pos == std::string::npos) return false;
+        if (pos > 0 && std::isalnum(static_cast<unsigned char>(text[pos - 1]))) {
+            pos += key.size();
+            continue;
+        }
+        pos += key.size();
+        while (pos < text.size() && text[pos] == ' ') {
+            ++pos;
+        }
+        long val = 0;
+        bool found = false;
+        while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos]))) {
+            val = val * 10 + (text[pos] - '0');
+            found = true;
+            ++pos;
+        }
+        if (found) {
+            out = static_cast<int>(val);
+        }
+        return found;
+    }
+}
+
+inline std::vector<std::string> split(const std::string& line, char delim) {
+    std::vector<std::string> parts;
+    std::stringstream ss(line);
+    std::string item;
+    while (std::getline(ss, item, delim)) {
+        parts.push_back(item);
+    }
+    return parts;
+}
+
+inline bool parseLogLine(const std::string& line, LogEntry& out) {
+    auto parts = split(line, ';');
+    if (parts.size() < 3) {
+        return false;
+    }
+    out.simTime = toIntSafe(parts[0]);
+    out.pid = toIntSafe(parts[1]);
+
+    if (parts.size() >= 9 && parts[2].rfind("wR=", 0) == 0) {
+        out.hasMetrics = true;
+        auto slashPos = parts[2].find('/');
+        if (slashPos != std::string::npos) {
+            out.waitingCurrent = toIntSafe(parts[2].substr(3, slashPos - 3));
+            out.waitingCapacity = toIntSafe(parts[2].substr(slashPos + 1));
+        }
+        out.regQueue = toIntSafe(parts[3].substr(parts[3].find('=') + 1));
+        out.triageQueue = toIntSafe(parts[4].substr(parts[4].find('=') + 1));
+        out.specialistsQueue = toIntSafe(parts[5].substr(parts[5].find('=') + 1));
+        out.waitSem = toIntSafe(parts[6].substr(parts[6].find('=') + 1));
+        out.stateSem = toIntSafe(parts[7].substr(parts[7].find('=') + 1));
+        out.role = parts[8];
+        std::string remaining;
+        for (size_t i = 9; i < parts.size(); ++i) {
+            if (i > 9) remaining.push_back(';');
+            remaining += parts[i];
+        }
+        out.text = remaining;
+    } else {
+        out.role = parts[2];
+        std::string remaining;
+        for (size_t i = 3; i < parts.size(); ++i) {
+            if (i > 3) remaining.push_back(';');
+            remaining += parts[i];
+        }
+        out.text = remaining.empty() ? parts[2] : remaining;
+    }
+    return true;
+}
+
+/**
+ * @brief The classification work the old applyLogEntry/applyPatientUpdate did per line:
+ * role string compares plus a chain of text.find() scans until one matches. Messages added since
+ * (pool windows opening/parking, specialist shutdown) are scanned the same way, so sor_bench can
+ * check that both parsers classify every line alike.
+ * @return small integer kind (0 = nothing matched) so the result cannot be optimised away.
+ */
+inline int classify(const LogEntry& entry, int& patientId) {
+    const std::string& role = entry.role;
+    const std::string& text = entry.text;
+    int kind = 0;
+    if (role == "specialist" && text.find("started") != std::string::npos) kind = 1;
+    if (role == "director" && text.find("SIGUSR1") != std::string::npos) kind = 2;
+    if (role == "specialist" && text.find("SIGUSR1: temporary leave finished") != std::string::npos) kind = 3;
+    if (role == "reg1" && text.find("started") != std::string::npos) kind = 4;
+    if (role == "reg1" && text.find("shutting down") != std::string::npos) kind = 5;
+    if (role == "reg2" && text.find("Registration2 started") != std::string::npos) kind = 4;
+    if (role == "reg2" && text.find("Registration2 shutting down") != std::string::npos) kind = 5;
+    if (role == "triage" && text.find("Triage started") != std::string::npos) kind = 6;
+    if (role == "triage" && text.find("Triage shutting down") != std::string::npos) kind = 7;
+    if (role == "specialist" && text.find("Specialist shutting down") != std::string::npos) kind = 8;
+    if ((role == "reg1" || role == "reg2") && text.find("Registration") != std::string::npos) {
+        if (text.find(" opened") != std::string::npos) kind = 4;
+        if (text.find(" parked") != std::string::npos) kind = 5;
+    }
+
+    bool flowRole = role == "patient" || role == "triage" || role == "specialist" || role == "reg1" || role == "reg2";
+    if (!flowRole || !extractInt(text, "id=", patientId)) {
+        return kind;
+    }
+    bool reg = role == "reg1" || role == "reg2";
+    if (text.find("waiting to enter waiting room") != std::string::npos) return 10;
+    if (text.find("Patient arrived") != std::string::npos) return 11;
+    if (text.find("Patient registered") != std::string::npos) return 12;
+    if (reg && text.find("Registering patient") != std::string::npos) return 13;
+    if (reg && text.find("Forwarded patient") != std::string::npos) return 14;
+    if (reg && text.find("Dropped patient") != std::string::npos) return 15;
+    if (role == "triage" && text.find("Forwarded patient") != std::string::npos) return 16;
+    if (text.find("Patient sent home from triage") != std::string::npos) return 17;
+    if (role == "specialist" && text.find("Received patient") != std::string::npos) return 18;
+    if (role == "specialist" && text.find("Handled patient") != std::string::npos) return 19;
+    return kind;
+}
+
+} // namespace legacy
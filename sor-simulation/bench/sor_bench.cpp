@@ -0,0 +1,382 @@
+// sor_bench: micro-benchmarks for the simulator's hot paths.
+//
+//   sor_bench parser [--log <sor_run_*.log>] [--lines N] [--repeat R] [--min-speedup X]
+//   sor_bench binlog --log <sor_run_*.log> --bin <sor_run_*.sorbin> [--repeat R]
+//   sor_bench ipc [--ops N] [--sizes 16,64,...] [--threads 1,2,4] [--only <prefix>] [--json <path>|-]
+//
+// The parser suite replays a recorded log (or a synthetic one with the same line mix) through
+// the original split/find ingest path and through the string_view parser. It first checks that
+// both give every line the same kind, patient id and metrics (exit 1 on any mismatch), then
+// reports the median ns/line of R passes and the speedup. --min-speedup turns it into a gate
+// (exit 1 when the speedup is lower); the documented gate is --min-speedup 10.
+// The binlog suite takes the text and binary logs of one run (binaryLog=1) and compares their
+// size and the visualizer's decode cost per event.
+// The ipc suite (ipc_bench.cpp) reports latency percentiles and throughput of the IPC primitives
+// for every message size and thread count; --json also writes them machine-readably.
+
+#include "ipc_bench.hpp"
+#include "legacy_log_parser.hpp"
+#include "synthetic_log.hpp"
+#include "visualization/binary_log_reader.hpp"
+#include "visualization/log_parser.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+struct ParserOptions {
+    std::string logPath;
+    size_t lines{200000};
+    int repeat{5};
+    double minSpeedup{0.0};
+};
+
+/** @brief Parse "a,b,c" into positive integers; false on anything else. */
+template <typename T>
+bool parseList(const std::string& text, std::vector<T>& out) {
+    out.clear();
+    size_t pos = 0;
+    while (pos <= text.size()) {
+        size_t comma = text.find(',', pos);
+        if (comma == std::string::npos) comma = text.size();
+        int value = std::stoi(text.substr(pos, comma - pos));
+        if (value <= 0) return false;
+        out.push_back(static_cast<T>(value));
+        pos = comma + 1;
+    }
+    return !out.empty();
+}
+
+bool loadLog(const std::string& path, std::vector<std::string>& out) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty()) out.push_back(line);
+    }
+    return true;
+}
+
+/** @brief Median of a non-empty sample (sorted in place). */
+double median(std::vector<double>& values) {
+    std::sort(values.begin(), values.end());
+    size_t mid = values.size() / 2;
+    return values.size() % 2 == 1 ? values[mid] : (values[mid - 1] + values[mid]) / 2.0;
+}
+
+/** @brief Wall time in ns of one call of fn. */
+template <typename Fn>
+double passNs(Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+/** @brief Median wall time in ns of R passes of fn over all lines (steadier than best-of-R on a busy box). */
+template <typename Fn>
+double medianPassNs(int repeat, Fn&& fn) {
+    std::vector<double> passes;
+    passes.reserve(static_cast<size_t>(repeat));
+    for (int r = 0; r < repeat; ++r) {
+        passes.push_back(passNs(fn));
+    }
+    return median(passes);
+}
+
+/** @brief MessageKind that a legacy::classify() code stands for. */
+MessageKind legacyKind(int code) {
+    switch (code) {
+        case 1: return MessageKind::SpecialistStarted;
+        case 2: return MessageKind::DirectorSentLeave;
+        case 3: return MessageKind::SpecialistLeaveFinished;
+        case 4: return MessageKind::RegistrationStarted;
+        case 5: return MessageKind::RegistrationStopping;
+        case 6: return MessageKind::TriageStarted;
+        case 7: return MessageKind::TriageStopping;
+        case 8: return MessageKind::SpecialistStopping;
+        case 10: return MessageKind::PatientWaitingOutside;
+        case 11: return MessageKind::PatientArrived;
+        case 12: return MessageKind::PatientRegistered;
+        case 13: return MessageKind::RegisteringPatient;
+        case 14: return MessageKind::RegistrationForwarded;
+        case 15: return MessageKind::RegistrationDropped;
+        case 16: return MessageKind::TriageForwarded;
+        case 17: return MessageKind::TriageSentHome;
+        case 18: return MessageKind::SpecialistReceived;
+        case 19: return MessageKind::SpecialistHandled;
+        default: return MessageKind::Other;
+    }
+}
+
+/**
+ * @brief Parse every line with both parsers and compare the kind, the patient id of patient-flow
+ * kinds and the metric columns; prints the first mismatches to stderr.
+ * @return number of lines on which the parsers disagree.
+ */
+size_t checkParserParity(const std::vector<std::string>& lines, const std::vector<std::string_view>& views) {
+    size_t mismatches = 0;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        legacy::LogEntry old;
+        LogEntry now;
+        bool oldOk = legacy::parseLogLine(lines[i], old);
+        bool nowOk = parseLogLine(views[i], now);
+        bool same = oldOk == nowOk;
+        if (same && oldOk) {
+            int oldId = -1;
+            MessageKind oldKind = legacyKind(legacy::classify(old, oldId));
+            same = oldKind == now.kind && (!isPatientFlowKind(now.kind) || oldId == now.patientId) &&
+                   old.hasMetrics == now.hasMetrics && old.waitingCurrent == now.waitingCurrent &&
+                   old.waitingCapacity == now.waitingCapacity && old.regQueue == now.regQueue &&
+                   old.triageQueue == now.triageQueue && old.specialistsQueue == now.specialistsQueue &&
+                   old.waitSem == now.waitSem && old.stateSem == now.stateSem;
+        }
+        if (!same && ++mismatches <= 5) {
+            std::fprintf(stderr, "parser mismatch on line %zu: %s\n", i + 1, lines[i].c_str());
+        }
+    }
+    return mismatches;
+}
+
+int runParserSuite(const ParserOptions& options) {
+    std::vector<std::string> lines;
+    if (!options.logPath.empty()) {
+        if (!loadLog(options.logPath, lines)) {
+            std::cerr << "Cannot read log: " << options.logPath << std::endl;
+            return EXIT_FAILURE;
+        }
+    } else {
+        lines = synthesizeLog(options.lines);
+    }
+    if (lines.empty()) {
+        std::cerr << "No lines to parse" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    long long legacySum = 0;
+    auto legacyPass = [&]() {
+        long long sum = 0;
+        for (const std::string& line : lines) {
+            legacy::LogEntry entry;
+            if (!legacy::parseLogLine(line, entry)) continue;
+            int id = 0;
+            MessageKind kind = legacyKind(legacy::classify(entry, id));
+            sum += static_cast<int>(kind) + (isPatientFlowKind(kind) ? id : 0) + entry.waitingCurrent;
+        }
+        legacySum = sum;
+    };
+
+    // The visualizer parses views into one contiguous mapping (LogTail), so the new path does too.
+    std::string blob;
+    for (const std::string& line : lines) {
+        blob += line;
+        blob.push_back('\n');
+    }
+    std::vector<std::string_view> views;
+    views.reserve(lines.size());
+    for (size_t pos = 0; pos < blob.size();) {
+        size_t nl = blob.find('\n', pos);
+        views.emplace_back(blob.data() + pos, nl - pos);
+        pos = nl + 1;
+    }
+
+    size_t mismatches = checkParserParity(lines, views);
+    if (mismatches > 0) {
+        std::fprintf(stderr, "%zu of %zu lines parsed differently by the two parsers\n", mismatches, lines.size());
+        return EXIT_FAILURE;
+    }
+
+    long long newSum = 0;
+    auto newPass = [&]() {
+        long long sum = 0;
+        for (std::string_view line : views) {
+            LogEntry entry;
+            if (!parseLogLine(line, entry)) continue;
+            int id = entry.patientId < 0 ? 0 : entry.patientId;
+            sum += static_cast<int>(entry.kind) + id + entry.waitingCurrent;
+        }
+        newSum = sum;
+    };
+
+    // Passes alternate so a load spike on the box slows both sides of the ratio it lands in.
+    std::vector<double> legacyPasses;
+    std::vector<double> newPasses;
+    std::vector<double> ratios;
+    for (int r = 0; r < options.repeat; ++r) {
+        legacyPasses.push_back(passNs(legacyPass));
+        newPasses.push_back(passNs(newPass));
+        ratios.push_back(newPasses.back() > 0.0 ? legacyPasses.back() / newPasses.back() : 0.0);
+    }
+    double legacyNs = median(legacyPasses);
+    double newNs = median(newPasses);
+    double speedup = median(ratios);
+    double count = static_cast<double>(lines.size());
+    std::printf("suite=parser source=%s lines=%zu repeat=%d\n",
+                options.logPath.empty() ? "synthetic" : options.logPath.c_str(), lines.size(), options.repeat);
+    std::printf("  legacy split/find : %8.1f ns/line  %10.0f lines/s  (checksum %lld)\n", legacyNs / count,
+                count * 1e9 / legacyNs, legacySum);
+    std::printf("  string_view+kind  : %8.1f ns/line  %10.0f lines/s  (checksum %lld)\n", newNs / count,
+                count * 1e9 / newNs, newSum);
+    std::printf("  speedup           : %8.1fx (median of per-pass ratios)\n", speedup);
+    if (legacySum != newSum) {
+        std::fprintf(stderr, "checksums differ\n");
+        return EXIT_FAILURE;
+    }
+    if (options.minSpeedup > 0.0 && speedup < options.minSpeedup) {
+        std::fprintf(stderr, "speedup %.1fx below required %.1fx\n", speedup, options.minSpeedup);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+struct BinlogOptions {
+    std::string logPath;
+    std::string binPath;
+    int repeat{5};
+};
+
+bool loadBytes(const std::string& path, std::string& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+int runBinlogSuite(const BinlogOptions& options) {
+    std::string text;
+    std::string bin;
+    if (!loadBytes(options.logPath, text) || !loadBytes(options.binPath, bin)) {
+        std::cerr << "Cannot read " << options.logPath << " / " << options.binPath << std::endl;
+        return EXIT_FAILURE;
+    }
+    size_t headerBytes = 0;
+    if (detectLogFormat(bin, headerBytes) != LogFormat::Binary) {
+        std::cerr << "Not a binary log: " << options.binPath << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::vector<std::string_view> views;
+    for (size_t pos = 0; pos < text.size();) {
+        size_t nl = text.find('\n', pos);
+        if (nl == std::string::npos) break;
+        views.emplace_back(text.data() + pos, nl - pos);
+        pos = nl + 1;
+    }
+
+    long long textSum = 0;
+    double textNs = medianPassNs(options.repeat, [&]() {
+        long long sum = 0;
+        for (std::string_view line : views) {
+            LogEntry entry;
+            if (!parseLogLine(line, entry)) continue;
+            sum += static_cast<int>(entry.kind) + entry.patientId + entry.waitingCurrent;
+        }
+        textSum = sum;
+    });
+
+    size_t records = 0;
+    long long binSum = 0;
+    double binNs = medianPassNs(options.repeat, [&]() {
+        long long sum = 0;
+        size_t count = 0;
+        std::string_view rest(bin.data() + headerBytes, bin.size() - headerBytes);
+        size_t used = 0;
+        LogEntry entry;
+        while (readBinaryLogRecord(rest, used, entry)) {
+            sum += static_cast<int>(entry.kind) + entry.patientId + entry.waitingCurrent;
+            rest.remove_prefix(used);
+            ++count;
+        }
+        records = count;
+        binSum = sum;
+    });
+
+    double lines = static_cast<double>(views.size());
+    double recs = static_cast<double>(records);
+    std::printf("suite=binlog text=%s binary=%s\n", options.logPath.c_str(), options.binPath.c_str());
+    std::printf("  text   : %10zu bytes %8zu lines   %6.1f B/event %8.1f ns/event (checksum %lld)\n", text.size(),
+                views.size(), text.size() / lines, textNs / lines, textSum);
+    std::printf("  binary : %10zu bytes %8zu records %6.1f B/event %8.1f ns/event (checksum %lld)\n", bin.size(),
+                records, bin.size() / recs, binNs / recs, binSum);
+    std::printf("  ratio  : %8.1fx smaller, %.1fx faster to decode\n",
+                static_cast<double>(text.size()) / static_cast<double>(bin.size()), (textNs / lines) / (binNs / recs));
+    return EXIT_SUCCESS;
+}
+
+int usage(const char* exe) {
+    std::cerr << "Usage: " << exe
+              << " parser [--log <path>] [--lines N] [--repeat R] [--min-speedup X]\n"
+              << "       " << exe << " binlog --log <text log> --bin <binary log> [--repeat R]\n"
+              << "       " << exe
+              << " ipc [--ops N] [--sizes 16,64,256,1024,4096] [--threads 1,2,4] [--only <prefix>] [--json <path>|-]"
+              << std::endl;
+    return EXIT_FAILURE;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        return usage(argv[0]);
+    }
+    std::string suite = argv[1];
+    if (suite == "parser") {
+        ParserOptions options;
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) return usage(argv[0]);
+            try {
+                if (arg == "--log") options.logPath = argv[++i];
+                else if (arg == "--lines") options.lines = static_cast<size_t>(std::max(1, std::stoi(argv[++i])));
+                else if (arg == "--repeat") options.repeat = std::max(1, std::stoi(argv[++i]));
+                else if (arg == "--min-speedup") options.minSpeedup = std::stod(argv[++i]);
+                else return usage(argv[0]);
+            } catch (const std::exception&) {
+                return usage(argv[0]);
+            }
+        }
+        return runParserSuite(options);
+    }
+    if (suite == "binlog") {
+        BinlogOptions options;
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) return usage(argv[0]);
+            try {
+                if (arg == "--log") options.logPath = argv[++i];
+                else if (arg == "--bin") options.binPath = argv[++i];
+                else if (arg == "--repeat") options.repeat = std::max(1, std::stoi(argv[++i]));
+                else return usage(argv[0]);
+            } catch (const std::exception&) {
+                return usage(argv[0]);
+            }
+        }
+        if (options.logPath.empty() || options.binPath.empty()) return usage(argv[0]);
+        return runBinlogSuite(options);
+    }
+    if (suite == "ipc") {
+        IpcBenchOptions options;
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) return usage(argv[0]);
+            try {
+                if (arg == "--ops") options.ops = static_cast<size_t>(std::max(1, std::stoi(argv[++i])));
+                else if (arg == "--sizes") { if (!parseList(argv[++i], options.sizes)) return usage(argv[0]); }
+                else if (arg == "--threads") { if (!parseList(argv[++i], options.threads)) return usage(argv[0]); }
+                else if (arg == "--only") options.only = argv[++i];
+                else if (arg == "--json") options.jsonPath = argv[++i];
+                else return usage(argv[0]);
+            } catch (const std::exception&) {
+                return usage(argv[0]);
+            }
+        }
+        return runIpcSuite(options);
+    }
+    return usage(argv[0]);
+}
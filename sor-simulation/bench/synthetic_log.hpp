@@ -0,0 +1,41 @@
+#pragma once
+
+// Synthetic visualizer input shared by the parser and ipc suites of sor_bench.
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+/** @brief Synthetic log with the line mix of a typical run (metrics prefix on every line). */
+inline std::vector<std::string> synthesizeLog(size_t count) {
+    std::mt19937 rng(12345);
+    auto pick = [&](int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(rng); };
+    std::vector<std::string> out;
+    out.reserve(count);
+    char buf[256];
+    for (size_t i = 0; i < count; ++i) {
+        int id = static_cast<int>(i / 8) + 1;
+        int prefixLen = std::snprintf(buf, sizeof(buf), "%zu;%d;wR=%d/50;rQ=%d;tQ=%d;sQ=%d;wSem=%d;sSem=1;",
+                                      i / 4, 10000 + pick(0, 500), pick(0, 50), pick(0, 40), pick(0, 5),
+                                      pick(0, 10), pick(0, 50));
+        char* p = buf + prefixLen;
+        size_t room = sizeof(buf) - static_cast<size_t>(prefixLen);
+        switch (pick(0, 11)) {
+            case 0: std::snprintf(p, room, "patient;Patient waiting to enter waiting room id=%d persons=%d", id, pick(1, 2)); break;
+            case 1: std::snprintf(p, room, "patient;Patient arrived id=%d age=%d vip=%d persons=1 guardian=0", id, pick(1, 90), pick(0, 1)); break;
+            case 2: std::snprintf(p, room, "patient;Patient registered id=%d", id); break;
+            case 3: std::snprintf(p, room, "reg1;Registering patient id=%d vip=0 persons=1", id); break;
+            case 4: std::snprintf(p, room, "reg%d;Forwarded patient id=%d vip=0 persons=1", pick(1, 2), id); break;
+            case 5: std::snprintf(p, room, "triage;Forwarded patient id=%d to specialist=%d color=%d", id, pick(0, 5), pick(0, 2)); break;
+            case 6: std::snprintf(p, room, "specialist;Received patient id=%d color=%d persons=1", id, pick(0, 2)); break;
+            case 7: std::snprintf(p, room, "specialist;Handled patient id=%d outcome=home persons=1 color=%d specIdx=%d", id, pick(0, 2), pick(0, 5)); break;
+            case 8: std::snprintf(p, room, "patient;Child thread active for patient id=%d", id); break;
+            case 9: std::snprintf(p, room, "triage;Patient sent home from triage id=%d", id); break;
+            case 10: std::snprintf(p, room, "reg1;HEARTBEAT REG qLen=%d waitSem=%d inside=%d regPid=%d", pick(0, 40), pick(0, 50), pick(0, 50), pick(100, 999)); break;
+            default: std::snprintf(p, room, "director;Director sent SIGUSR1 to specialist pid=%d", pick(100, 999)); break;
+        }
+        out.emplace_back(buf);
+    }
+    return out;
+}
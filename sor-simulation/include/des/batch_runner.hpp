@@ -0,0 +1,64 @@
+#pragma once
+
+#include "des/des_engine.hpp"
+#include "model/config.hpp"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Options for a batch of independent DES replications.
+ */
+struct BatchOptions {
+    unsigned int firstSeed{1};
+    unsigned int lastSeed{1};   // inclusive
+    int jobs{1};                // worker threads (clamped to the number of runs)
+    long long horizonMs{0};     // virtual horizon of every replication
+};
+
+/**
+ * @brief Aggregate of one metric across all replications.
+ */
+struct MetricStats {
+    std::string name;
+    double mean{0.0};
+    double stddev{0.0};      // sample standard deviation
+    double ci95Half{0.0};    // half-width of the 95% confidence interval of the mean
+    double min{0.0};
+    double p5{0.0};
+    double p50{0.0};
+    double p95{0.0};
+    double max{0.0};
+};
+
+/**
+ * @brief Merged outcome of a batch run.
+ */
+struct BatchResult {
+    int runs{0};
+    int jobs{0};
+    unsigned int firstSeed{0};
+    unsigned int lastSeed{0};
+    long long horizonMs{0};
+    std::string specialistPolicy;   // specialistPolicy of every replication
+    long long totalEvents{0};
+    double wallMs{0.0};
+    std::vector<MetricStats> metrics;
+};
+
+/**
+ * @brief Run one DesEngine replication per seed on a pool of threads and merge the summaries.
+ * @param config validated configuration; randomSeed is replaced per replication.
+ * @param options seed range, parallelism and horizon.
+ * @return per-metric mean, 95% CI and percentiles (deterministic for a given seed range).
+ */
+BatchResult runBatch(const Config& config, const BatchOptions& options);
+
+/**
+ * @brief Write the merged statistics as a fixed-width text table.
+ * @param result merged batch statistics.
+ * @param out destination stream.
+ * @return true when the stream is still good after writing.
+ */
+bool writeBatchReport(const BatchResult& result, std::ostream& out);
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "model/config.hpp"
+#include "report/summary.hpp"
+
+/**
+ * @brief Options for a discrete-event run.
+ */
+struct DesOptions {
+    long long horizonMs;  // virtual milliseconds to simulate (same scale as the process mode)
+};
+
+/**
+ * @brief Outcome of a discrete-event run: the regular summary plus engine statistics.
+ */
+struct DesResult {
+    SummaryPayload summary;
+    long long eventsProcessed{0};
+    int patientsGenerated{0};
+    int peakWaitingRoom{0};      // persons inside the waiting room (max)
+    int peakOutsideQueue{0};     // patients queued outside for seats (max)
+    int peakRegistrationQueue{0};
+    double wallMs{0.0};
+};
+
+/**
+ * @brief Single-threaded discrete-event model of the SOR pipeline.
+ *
+ * Replays the process simulation (generator, waiting room, registration window pool driven by
+ * RegistrationScaler, triage, specialists with SIGUSR1 leaves) on a virtual clock driven by a
+ * priority-queue event calendar, so days of simulated time finish in well under a second.
+ * Durations come from Config scaled exactly like Director does; probabilities come from
+ * model/sim_rules so both modes share one set of rules.
+ */
+class DesEngine {
+public:
+    /** @brief Bind the engine to a validated configuration. */
+    explicit DesEngine(const Config& config);
+
+    /**
+     * @brief Run one replication until the virtual clock passes the horizon.
+     * @param options run options (horizon).
+     * @return summary and engine statistics.
+     */
+    DesResult run(const DesOptions& options) const;
+
+    /**
+     * @brief Default horizon: simulationDurationMinutes of (virtual) wall time, or one simulated day.
+     * @param config configuration used for the run.
+     * @param simMinutesOverride simulated minutes requested on the command line (<= 0 to ignore).
+     */
+    static long long defaultHorizonMs(const Config& config, int simMinutesOverride);
+
+private:
+    Config config_;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "ipc/message_queue.hpp"
+#include "model/aging_policy.hpp"
+#include "model/events.hpp"
+#include "model/shared_state.hpp"
+
+/**
+ * @brief Receive the next message of a class-prioritised queue (class c travels as mtype firstType + c).
+ *
+ * When the policy prefers a lower class over the strict order, that class is received by exact mtype
+ * without blocking; otherwise, or when that message is not there yet, this is the usual blocking
+ * negative-msgtyp receive. Either way the class's lane records the dequeue.
+ * @param queue queue to receive from.
+ * @param ev destination message.
+ * @param firstType mtype of class 0.
+ * @param lanes aging lanes of the queue, one per class.
+ * @param classes number of classes (at most kMaxAgingClasses).
+ * @param policy aging rules of the queue.
+ * @return true on success; false with errno set by the blocking receive.
+ */
+bool receiveAged(MessageQueue& queue, EventMessage& ev, long firstType, AgingLane* lanes, int classes,
+                 const AgingPolicy& policy);
+
+/**
+ * @brief Receive from a chosen class without blocking, falling back to the blocking strict-order
+ * receive when pick is 0 or negative or its message is not there; the received class's lane
+ * records the dequeue.
+ * @param pick class chosen by the caller (-1 = strict order).
+ * @return true on success; false with errno set by the blocking receive.
+ */
+bool receiveClass(MessageQueue& queue, EventMessage& ev, long firstType, AgingLane* lanes, int classes, int pick);
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <sys/types.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct LogRingArenaHeader;
+
+/**
+ * @brief Set of single-producer rings in POSIX shared memory for log records, drained by one consumer.
+ *
+ * A producer leases a free ring for the duration of one push (try-lock on the ring owner, never a
+ * wait), stamps the record with CLOCK_MONOTONIC, copies it in and publishes it. Stamps are therefore
+ * monotonic within a ring and the consumer can merge all rings by stamp. When every ring is leased or
+ * full the record is dropped and counted instead of blocking the producer.
+ * Typical usage: create() in the director, open() in every process that logs, destroy() at shutdown.
+ */
+class LogRingArena {
+public:
+    /** @brief Construct an empty handle (nothing mapped). */
+    LogRingArena();
+    ~LogRingArena();
+
+    LogRingArena(const LogRingArena&) = delete;
+    LogRingArena& operator=(const LogRingArena&) = delete;
+
+    /** @brief POSIX shm name of the arena belonging to a run's log key. */
+    static std::string nameForKey(key_t key);
+
+    /**
+     * @brief Create and initialize a new arena (fails if the name already exists).
+     * @param name POSIX shm object name (leading '/').
+     * @param rings number of rings (producers pushing at the same time without contention).
+     * @param ringSlots slots per ring (rounded up to a power of two).
+     * @param slotBytes maximum record size in bytes.
+     * @param permissions file-mode-style permissions (default 0600).
+     * @return true on success, false on failure (errno set).
+     */
+    bool create(const std::string& name, size_t rings, size_t ringSlots, size_t slotBytes, int permissions = 0600);
+
+    /**
+     * @brief Map an existing arena; a missing one (ENOENT) is not reported since the arena is optional.
+     * @param name POSIX shm object name.
+     * @return true on success, false on failure (errno set).
+     */
+    bool open(const std::string& name);
+
+    /**
+     * @brief Producer: append one record to a free ring; never blocks.
+     * @param data record bytes.
+     * @param size record size (at most slotBytes).
+     * @param hint in/out ring tried first; set to the ring used so a thread keeps to its ring.
+     * @return true when published, false when every ring was leased or full (counted in dropped()).
+     */
+    bool push(const void* data, size_t size, int& hint);
+
+    /** @brief Number of rings in the arena (0 when nothing is mapped). */
+    size_t ringCount() const;
+
+    /**
+     * @brief Consumer: oldest record of a ring without removing it.
+     * @param ring ring index.
+     * @param stampNs set to the record's CLOCK_MONOTONIC stamp.
+     * @param size set to the record size.
+     * @return record bytes (valid until pop(ring)), or nullptr when the ring is empty.
+     */
+    const void* peek(size_t ring, uint64_t& stampNs, size_t& size) const;
+
+    /** @brief Consumer: release the record returned by peek(ring). */
+    void pop(size_t ring);
+
+    /**
+     * @brief Consumer: sleep until a producer publishes into an empty arena or the timeout passes.
+     * @param timeoutMs upper bound of the wait.
+     * @return true when a record may be available, false on timeout.
+     */
+    bool waitForData(int timeoutMs);
+
+    /**
+     * @brief Consumer: free leases held by processes that died inside push().
+     * @return number of rings reclaimed.
+     */
+    size_t reclaimDeadOwners();
+
+    /** @brief Records dropped so far because no ring was free. */
+    uint64_t dropped() const;
+
+    /** @brief CLOCK_MONOTONIC in nanoseconds (the clock used for record stamps). */
+    static uint64_t nowNs();
+
+    /** @brief True when an arena is mapped. */
+    bool isOpen() const;
+
+    /** @brief Unmap the arena (the shm object itself stays). */
+    void close();
+
+    /**
+     * @brief Mark the arena closed (producers stop pushing) and unlink the shm object.
+     * @return true on success, false on failure.
+     */
+    bool destroy();
+
+    /**
+     * @brief Best-effort removal of a leftover shm object with the given name.
+     */
+    static void unlink(const std::string& name);
+
+private:
+    LogRingArenaHeader* header;
+    size_t mappedBytes;
+    std::string shmName;
+};
@@ -2,11 +2,23 @@
 
 #include <sys/types.h>
 #include <cstddef>
+#include <memory>
+
+class ShmRing;
+
+/**
+ * @brief Transport backing a MessageQueue handle.
+ */
+enum class QueueTransport {
+    SysV,    // System V message queue (msgsnd/msgrcv)
+    ShmRing  // POSIX shared-memory ring with futex blocking (see ShmRing)
+};
 
 /**
- * @brief Thin wrapper for System V message queues used for event passing.
+ * @brief Thin wrapper for event-passing queues (System V message queues or shared-memory rings).
  *
- * Use create() once, then send()/receive() to exchange typed messages by mtype.
+ * Use create()/createRing() once, then send()/receive() to exchange typed messages by mtype.
+ * Both transports honour msgrcv() type selection, so negative types keep VIP/color priority.
  * All methods return success/failure so callers can log errno appropriately.
  */
 class MessageQueue {
@@ -15,6 +27,11 @@ public:
     MessageQueue();
     ~MessageQueue();
 
+    MessageQueue(const MessageQueue&) = delete;
+    MessageQueue& operator=(const MessageQueue&) = delete;
+    MessageQueue(MessageQueue&&) noexcept;
+    MessageQueue& operator=(MessageQueue&&) noexcept;
+
     /**
      * @brief Create or get a queue for the given key.
      * @param key System V key (ftok or IPC_PRIVATE).
@@ -23,41 +40,66 @@ public:
      */
     bool create(key_t key, int permissions = 0600);
 
+    /**
+     * @brief Create a shared-memory ring queue named after the given key (removing a stale one first).
+     * @param key key used to derive the shm object name.
+     * @param laneSlots slots per priority lane.
+     * @param slotBytes largest message size that will be sent.
+     * @param permissions file-mode-style permissions (default 0600).
+     * @return true on success, false on failure.
+     */
+    bool createRing(key_t key, size_t laneSlots, size_t slotBytes, int permissions = 0600);
+
     /**
      * @brief Send a message of a given type.
      * @param msg pointer to message buffer (first field must be long mtype).
      * @param size number of bytes to send.
      * @param type message type value to set/read as mtype.
+     * @param flags msgsnd flags (e.g., IPC_NOWAIT -> EAGAIN when full).
      * @return true on success, false on failure.
      */
-    bool send(const void* msg, size_t size, long type);
+    bool send(const void* msg, size_t size, long type, int flags = 0);
 
     /**
      * @brief Receive a message of a given type.
      * @param buffer destination buffer.
      * @param size buffer size in bytes.
-     * @param type desired mtype (0 to accept any).
+     * @param type desired mtype (0 to accept any, negative for lowest mtype <= |type|).
      * @param flags msgrcv flags (e.g., IPC_NOWAIT).
      * @return true on success, false on failure.
      */
     bool receive(void* buffer, size_t size, long type, int flags = 0);
 
-    /** @brief Underlying queue id, or -1 if not created. */
+    /** @brief Number of queued messages (0 on error). */
+    int length() const;
+
+    /** @brief Underlying queue id, or -1 if not created or ring-backed. */
     int id() const;
 
+    /** @brief Transport in use by this handle. */
+    QueueTransport transport() const;
+
     /**
-     * @brief Remove the queue from the system (IPC_RMID).
+     * @brief Remove the queue from the system (IPC_RMID or ring unlink).
      * @return true on success, false on failure.
      */
     bool destroy();
 
     /**
-     * @brief Open an existing queue without reinitializing (msgget without IPC_CREAT).
+     * @brief Open an existing queue without reinitializing (msgget without IPC_CREAT or ring map).
      * @param key System V key.
+     * @param transport transport the owner created the queue with.
      * @return true on success, false on failure.
      */
-    bool open(key_t key);
+    bool open(key_t key, QueueTransport transport = QueueTransport::SysV);
+
+    /**
+     * @brief Unlink the shared-memory ring object derived from key, if any (orphan cleanup).
+     * @param key key the ring was created with.
+     */
+    static void unlinkRing(key_t key);
 
 private:
     int mqId;
+    std::unique_ptr<ShmRing> ring;
 };
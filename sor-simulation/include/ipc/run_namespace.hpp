@@ -0,0 +1,75 @@
+#pragma once
+
+#include <sys/types.h>
+#include <string>
+
+/** @brief Directory holding one registry file per live simulation run. */
+constexpr const char* kRunRegistryDir = "/tmp/sor-sim";
+
+/** @brief Project ids used for the per-run IPC keys (same letters the ftok scheme used). */
+constexpr char kLogKeyId = 'L';
+constexpr char kRegistrationKeyId = 'R';
+constexpr char kTriageKeyId = 'T';
+constexpr char kFirstSpecialistKeyId = 'A';  // 'A' + specialist index
+constexpr char kWaitingRoomKeyId = 'W';
+constexpr char kSharedStateKeyId = 'H';
+constexpr char kRegistrationGateKeyId = 'G';  // semaphore set parking the extra registration windows
+
+/**
+ * @brief Run-scoped IPC namespace: a unique key base reserved through a registry file.
+ *
+ * The director reserves a free key base by creating /tmp/sor-sim/run-<base>.reg with O_EXCL
+ * (so concurrent directors never share keys), checks that no foreign IPC object already sits on
+ * any of the run's keys, and passes the registry path to every child as its keyPath argument.
+ * Children resolve keys with ipcKey(), which reads the base back from the file.
+ */
+class RunNamespace {
+public:
+    RunNamespace() = default;
+    ~RunNamespace();
+
+    RunNamespace(const RunNamespace&) = delete;
+    RunNamespace& operator=(const RunNamespace&) = delete;
+
+    /**
+     * @brief Reserve a key base and write the registry file for this director.
+     * @param shmRingTransport true when pipeline queues are shm rings (recorded for cleanup).
+     * @return true on success, false when no base could be reserved (errno logged).
+     */
+    bool create(bool shmRingTransport);
+
+    /** @brief Key for one IPC object of this run (base | projId). */
+    key_t key(char projId) const;
+
+    /** @brief Registry file path; children receive it as keyPath. */
+    const std::string& registryPath() const { return path_; }
+
+    /** @brief Short printable run id (hex key base). */
+    const std::string& runId() const { return runId_; }
+
+    /** @brief Remove the registry file after the run's IPC objects are gone. */
+    void release();
+
+private:
+    std::string path_;
+    std::string runId_;
+    key_t base_{0};
+};
+
+/**
+ * @brief Resolve the key for projId: from a run registry file, or ftok() for any other path.
+ * @param keyPath registry path passed by the director (or an executable path for manual runs).
+ * @param projId object letter ('L', 'R', 'T', 'A'+i, 'W', 'H').
+ * @return key, or -1 on failure (like ftok).
+ */
+key_t ipcKey(const std::string& keyPath, char projId);
+
+/**
+ * @brief Remove IPC objects and registry files of runs whose director no longer exists.
+ *
+ * A run is orphaned when its director pid is gone or now belongs to a different process (start
+ * time differs). Objects of live runs are never touched.
+ * @param verbose print one line per live/removed run to stdout.
+ * @return number of orphaned runs cleaned up.
+ */
+int cleanupOrphanedRuns(bool verbose);
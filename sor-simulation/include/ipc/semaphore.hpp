@@ -14,13 +14,14 @@ public:
     ~Semaphore();
 
     /**
-     * @brief Create a semaphore set with one semaphore and initialize it.
+     * @brief Create a semaphore set and initialize every semaphore in it.
      * @param key System V key (ftok or IPC_PRIVATE).
      * @param initialValue starting count value.
      * @param permissions file-mode-style permissions (default 0600).
+     * @param count semaphores in the set (default 1).
      * @return true on success, false on failure.
      */
-    bool create(key_t key, int initialValue, int permissions = 0600);
+    bool create(key_t key, int initialValue, int permissions = 0600, int count = 1);
 
     /**
      * @brief P operation (decrement or block until available).
@@ -28,11 +29,20 @@ public:
      */
     bool wait();
 
+    /**
+     * @brief P operation with a timeout (semtimedop); lets callers poll a stop flag between attempts.
+     * @param timeoutMs maximum time to block in milliseconds.
+     * @param index semaphore within the set.
+     * @return true when acquired, false on timeout (errno EAGAIN), signal (EINTR), or failure.
+     */
+    bool waitFor(int timeoutMs, int index = 0);
+
     /**
      * @brief V operation (increment/unlock).
+     * @param index semaphore within the set.
      * @return true on success, false on failure.
      */
-    bool post();
+    bool post(int index = 0);
 
     /**
      * @brief Remove the semaphore set (IPC_RMID).
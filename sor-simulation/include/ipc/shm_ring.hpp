@@ -0,0 +1,89 @@
+#pragma once
+
+#include <sys/types.h>
+#include <cstddef>
+#include <string>
+
+struct ShmRingHeader;
+
+/**
+ * @brief Bounded multi-producer/multi-consumer ring of fixed-size message slots in POSIX shared memory.
+ *
+ * Messages are kept in per-mtype priority lanes so typed receives mirror msgrcv(): a negative type
+ * dequeues the lowest mtype <= |type| first and each lane is FIFO. Empty/full waits block on futexes.
+ * Typical usage: create() in the owner, open() in other processes, destroy() at shutdown.
+ */
+class ShmRing {
+public:
+    /** @brief Maximum number of distinct mtypes (priority lanes) per ring. */
+    static constexpr int kMaxLanes = 4;
+
+    /** @brief Construct an empty handle (nothing mapped). */
+    ShmRing();
+    ~ShmRing();
+
+    ShmRing(const ShmRing&) = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+
+    /**
+     * @brief Create and initialize a new ring segment (fails if the name already exists).
+     * @param name POSIX shm object name (leading '/').
+     * @param laneSlots slots per priority lane (rounded up to a power of two).
+     * @param slotBytes maximum message size in bytes (including the leading long mtype).
+     * @param permissions file-mode-style permissions (default 0600).
+     * @return true on success, false on failure (errno set).
+     */
+    bool create(const std::string& name, size_t laneSlots, size_t slotBytes, int permissions = 0600);
+
+    /**
+     * @brief Map an existing ring segment created by another process.
+     * @param name POSIX shm object name.
+     * @return true on success, false on failure (errno set).
+     */
+    bool open(const std::string& name);
+
+    /**
+     * @brief Enqueue one message into the lane for its mtype.
+     * @param msg message buffer (first field long mtype, already set to type).
+     * @param size message size in bytes.
+     * @param type mtype used to select the lane (> 0).
+     * @param nowait if true fail with EAGAIN instead of blocking when the lane is full.
+     * @return true on success, false on failure (errno set: EAGAIN, EINTR, EIDRM, EINVAL, ENOSPC).
+     */
+    bool push(const void* msg, size_t size, long type, bool nowait);
+
+    /**
+     * @brief Dequeue one message using msgrcv() type semantics.
+     * @param buffer destination buffer.
+     * @param size buffer size in bytes.
+     * @param type 0 = lowest mtype available, >0 = exact mtype, <0 = lowest mtype <= |type|.
+     * @param nowait if true fail with ENOMSG instead of blocking when nothing matches.
+     * @return true on success, false on failure (errno set: ENOMSG, EINTR, EIDRM).
+     */
+    bool pop(void* buffer, size_t size, long type, bool nowait);
+
+    /** @brief Number of messages currently queued across all lanes. */
+    int size() const;
+
+    /** @brief True when a segment is mapped. */
+    bool isOpen() const;
+
+    /** @brief Unmap the segment (the shm object itself stays). */
+    void close();
+
+    /**
+     * @brief Mark the ring closed (waking blocked peers with EIDRM) and unlink the shm object.
+     * @return true on success, false on failure.
+     */
+    bool destroy();
+
+    /**
+     * @brief Best-effort removal of a leftover shm object with the given name.
+     */
+    static void unlink(const std::string& name);
+
+private:
+    ShmRingHeader* header;
+    size_t mappedBytes;
+    std::string shmName;
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "model/events.hpp"
+#include "model/types.hpp"
+
+/**
+ * @brief File header of a binary event log ("SORBLOG" magic, format version, record size).
+ */
+struct BinaryLogHeader {
+    char magic[8];
+    uint16_t version;
+    uint16_t recordSize;  // sizeof(BinaryLogRecord) of the writer
+    uint32_t flags;       // reserved, 0
+};
+
+/**
+ * @brief Fixed-layout binary log record, followed by textLen bytes of free text.
+ *
+ * Typed events (patient flow, director leave) have textLen 0: their text is derived from the
+ * fields by formatEventText(). Free-text events keep their message verbatim in the tail.
+ */
+struct BinaryLogRecord {
+    uint8_t kind;         // LogEventKind
+    uint8_t role;         // Role
+    uint8_t flags;        // kRecord* bits, outcome + 1 in kRecordOutcomeShift
+    uint8_t textLen;      // bytes of text after the record
+    int32_t simTime;
+    int32_t pid;
+    int32_t subject;      // patient id or target pid, -1 when absent
+    uint16_t metrics[6];  // wR current, wR capacity, rQ, tQ, sQ, wSem (saturated at 65535)
+    uint8_t persons;      // 0 when absent
+    uint8_t age;          // 255 when absent
+    int8_t color;
+    int8_t specialist;
+};
+
+static_assert(sizeof(BinaryLogHeader) == 16, "binary log header layout");
+static_assert(sizeof(BinaryLogRecord) == 32, "binary log record layout");
+
+constexpr char kBinaryLogMagic[8] = {'S', 'O', 'R', 'B', 'L', 'O', 'G', '\0'};
+constexpr uint16_t kBinaryLogVersion = 1;
+constexpr uint8_t kRecordHasMetrics = 1u << 0;
+constexpr uint8_t kRecordVip = 1u << 1;
+constexpr uint8_t kRecordGuardian = 1u << 2;
+constexpr uint8_t kRecordStateSem = 1u << 5;
+constexpr int kRecordOutcomeShift = 3;  // two bits: 0 none, 1 home, 2 ward, 3 other facility
+
+/**
+ * @brief sSem column values. The state semaphore it used to show is gone (the shared counters are
+ * lock-free atomics); the column is kept only so the text log format and its parsers stay compatible.
+ * Role lines carry the old unlocked value, the logger's closing stats line its all-zero metrics block.
+ */
+constexpr int kLegacyStateSemUnlocked = 1;
+constexpr int kLegacyStateSemNone = 0;
+
+/** @brief Header for a new binary log written by this build. */
+BinaryLogHeader makeBinaryLogHeader();
+
+/**
+ * @brief Check a header read from a file.
+ * @return true when the magic, version and record size match this build.
+ */
+bool binaryLogHeaderValid(const BinaryLogHeader& header);
+
+/** @brief Binary log path paired with a text log ("run.log" -> "run.sorbin"). */
+std::string binaryLogPath(const std::string& textLogPath);
+
+/** @brief Role column label used in log lines ("director", "reg1", "specialist", ...). */
+const char* roleLabel(Role role);
+
+/**
+ * @brief Build the record for a message; the text tail is msg.text for free-text events.
+ * @param msg message received from LOG_QUEUE.
+ * @param stateSem value written as sSem in the text form (kLegacyStateSemUnlocked or kLegacyStateSemNone).
+ * @return record with textLen set (0 for typed events).
+ */
+BinaryLogRecord packLogRecord(const LogMessage& msg, int stateSem);
+
+/** @brief Typed fields of a record (the inverse of packLogRecord for typed kinds). */
+LogEventFields unpackLogFields(const BinaryLogRecord& record);
+
+/** @brief Kinds whose text is derived from LogEventFields (patient flow, director leave). */
+bool isTypedLogEvent(LogEventKind kind);
+
+/**
+ * @brief Write the text of a typed event exactly as the free-text senders used to.
+ * @param fields typed payload.
+ * @param out destination buffer (at least 128 bytes are enough for every kind).
+ * @param cap size of out.
+ * @return bytes written, 0 when the kind has no typed form.
+ */
+size_t formatEventText(const LogEventFields& fields, char* out, size_t cap);
+
+/**
+ * @brief Append one text log line for a record: "simTime;pid;[wR=..;sSem=;role;]message\n".
+ * @param record record fields (metrics, role, times).
+ * @param message the event text (tail or formatEventText output).
+ * @param out destination string (appended to).
+ */
+void appendTextLogLine(const BinaryLogRecord& record, std::string_view message, std::string& out);
+
+/**
+ * @brief Convert a binary log into the text format (the `log2text` mode).
+ * @param inPath binary log path.
+ * @param outPath text output path, or empty for stdout.
+ * @return 0 on success, non-zero on I/O or format errors.
+ */
+int binaryLogToText(const std::string& inPath, const std::string& outPath);
@@ -1,16 +1,40 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <string>
+#include <vector>
 
+#include "model/events.hpp"
+#include "model/metrics.hpp"
 #include "model/types.hpp"
 
-struct SharedState;
+#include <sys/types.h>
 
+class MessageQueue;
 struct SharedState;
 
 /**
- * @brief Dedicated logger writing text lines to a file descriptor.
+ * @brief Flush policy for the logger process (group commit).
+ */
+struct LoggerOptions {
+    size_t flushBytes{65536}; // flush once this many bytes are buffered
+    int flushIntervalMs{50};  // flush buffered lines at most this late once the queue is idle
+    bool fsyncOnFlush{false}; // fdatasync after every flush
+};
+
+/**
+ * @brief Batch statistics reported when the logger stops.
+ */
+struct LoggerStats {
+    long long records{0};
+    long long flushes{0};
+    long long bytes{0};
+    long long maxBatch{0};
+};
+
+/**
+ * @brief Dedicated logger buffering text lines and writing them to a file descriptor in batches.
  */
 class Logger {
 public:
@@ -31,51 +55,114 @@ public:
     bool openFile(const std::string& path);
 
     /**
-     * @brief Write one log line (implementation will append newline).
+     * @brief Append one log line to the buffer (newline added); flushes when the size threshold is hit.
      * @param line text to write.
      */
     void logLine(const std::string& line);
 
     /**
-     * @brief Close the file descriptor if open.
+     * @brief Append one pre-formatted record (a text line with its newline, or a binary record).
+     * @param data record bytes.
+     * @param len record size.
+     */
+    void appendBytes(const void* data, size_t len);
+
+    /**
+     * @brief Write all buffered lines with one write() loop (and fdatasync if configured).
+     * @return true on success, false on write failure.
+     */
+    bool flush();
+
+    /** @brief Replace the flush policy. */
+    void setOptions(const LoggerOptions& options);
+
+    /** @brief Records buffered since the last flush. */
+    size_t pendingRecords() const;
+
+    /** @brief Totals across all flushes so far. */
+    const LoggerStats& stats() const;
+
+    /**
+     * @brief Flush and close the file descriptor if open.
      */
     void closeFile();
 
 private:
+    void recordAppended();
+
     int fd;
+    LoggerOptions options_;
+    std::vector<char> buffer_;
+    size_t pendingRecords_;
+    LoggerStats stats_;
 };
 
 /**
- * @brief Blocking logger loop: read LogMessage from queue and write to file.
- * @param queueId message queue id for LOG_QUEUE.
+ * @brief Logger loop: merge the per-process log rings (and LOG_QUEUE) by stamp and write in batches.
+ * @param queueId message queue id for LOG_QUEUE (senders without rings, and the only source when ringName is empty).
  * @param path log file path.
+ * @param options flush thresholds and fsync policy.
+ * @param binaryPath when non-empty, also write every event as a binary record to this file.
+ * @param ringName shm name of the run's LogRingArena, or empty when log rings are disabled.
  * @return 0 on clean exit, non-zero on error.
  */
-int runLogger(int queueId, const std::string& path);
+int runLogger(int queueId, const std::string& path, const LoggerOptions& options = LoggerOptions{},
+              const std::string& binaryPath = std::string(), const std::string& ringName = std::string());
+
+/**
+ * @brief Send this process's log events through the run's shared-memory log rings.
+ * @param logKey IPC key of LOG_QUEUE (the arena is named after it).
+ * @return true when the run has log rings; otherwise logEvent keeps using LOG_QUEUE.
+ */
+bool attachLogRings(key_t logKey);
+
+/** @brief Log records this run dropped because every log ring was busy or full (0 without rings). */
+long long logRecordsDropped();
 
 /**
  * @brief System load context used to append shared-state and queue counts to logs.
  */
 struct LogMetricsContext {
     SharedState* sharedState;
-    int registrationQueueId;
-    int triageQueueId;
-    std::array<int, kSpecialistCount> specialistsQueueIds;
+    const MessageQueue* registrationQueue;
+    const MessageQueue* triageQueue;
+    std::array<const MessageQueue*, kSpecialistCount> specialistsQueues;
     int waitSemaphoreId;
-    int stateSemaphoreId;
 };
 
+/**
+ * @brief Probe the queues, semaphores and shared state named in a context (msgctl/semctl per field).
+ * @param context handles to sample; null/-1 entries read as 0.
+ * @return current load figures.
+ */
+MetricsSnapshot sampleMetrics(const LogMetricsContext& context);
+
 /**
  * @brief Set the context used by logEvent to append shared-state metrics.
  */
 void setLogMetricsContext(const LogMetricsContext& context);
 
 /**
- * @brief Convenience helper to send a LogMessage through LOG_QUEUE.
+ * @brief Drop the context set by setLogMetricsContext; later log messages carry no metrics.
+ */
+void clearLogMetricsContext();
+
+/**
+ * @brief Convenience helper to send a free-text LogMessage (log ring when attached, else LOG_QUEUE).
  * @param queueId message queue id for LOG_QUEUE.
  * @param role sender role.
  * @param simTime simulated time minutes.
- * @param text text payload.
- * @return true on success, false on failure.
+ * @param text text payload (truncated to LogMessage::text).
+ * @return true on success, false on failure (a full log ring drops the record instead of waiting).
  */
 bool logEvent(int queueId, Role role, int simTime, const std::string& text);
+
+/**
+ * @brief Send a typed event; the logger derives its text, so the sender formats nothing.
+ * @param queueId message queue id for LOG_QUEUE.
+ * @param role sender role.
+ * @param simTime simulated time minutes.
+ * @param fields event kind and payload (see isTypedLogEvent).
+ * @return true on success, false on failure.
+ */
+bool logEvent(int queueId, Role role, int simTime, const LogEventFields& fields);
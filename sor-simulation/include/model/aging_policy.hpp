@@ -0,0 +1,39 @@
+#pragma once
+
+#include "model/config.hpp"
+
+#include <array>
+
+/** @brief Most priority classes one queue carries (red/yellow/green on the specialist queues). */
+constexpr int kMaxAgingClasses = 3;
+
+/**
+ * @brief Aging rules of one class-prioritised queue; class 0 is the highest (VIP, red).
+ *
+ * Without aging a consumer always takes the lowest mtype, so a steady stream of VIP or red
+ * patients can hold lower classes back indefinitely. With aging the head of every class is
+ * ranked by its class index minus one level per stepMs it has waited, and a head that has
+ * waited maxWaitMs[class] or longer is taken before anything else (oldest overrun first).
+ */
+struct AgingPolicy {
+    int stepMs{0};                                  // waiting this long raises a message one class (0 = no aging)
+    std::array<int, kMaxAgingClasses> maxWaitMs{};  // per-class wait bound (0 = unbounded)
+
+    /** @brief True when the policy can change the strict class order. */
+    bool enabled() const;
+};
+
+/**
+ * @brief Class whose head should be served next.
+ * @param headAgeMs wait of every class's oldest message in milliseconds (-1 = empty or unknown).
+ * @param classes number of classes in headAgeMs (at most kMaxAgingClasses).
+ * @param policy aging rules of the queue.
+ * @return class index, or -1 when no class has a known head (serve in strict class order).
+ */
+int pickAgedClass(const long long* headAgeMs, int classes, const AgingPolicy& policy);
+
+/** @brief Policy of the registration and triage queues (VIP, normal), times scaled like service times. */
+AgingPolicy vipQueueAgingPolicy(const Config& cfg);
+
+/** @brief Policy of the specialist queues (red, yellow, green), times scaled like service times. */
+AgingPolicy colorQueueAgingPolicy(const Config& cfg);
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "model/types.hpp"
+
+#include <array>
 #include <cstdint>
 
 struct Config {
@@ -18,4 +21,30 @@ struct Config {
     int reconcileWaitSem; // 0/1 toggle for waitSem reconciliation guardrail
     int patientGenMinMs;
     int patientGenMaxMs;
+    int shmRingTransport; // 0 = System V message queues, 1 = shared-memory rings for the patient pipeline
+    int shmRingSlots;     // ring slots per priority lane (rounded up to a power of two)
+    int inProcessPatients;     // 0 = fork+execv per patient, 1 = patient lifecycles on a thread pool in the generator
+    int patientThreadPoolSize; // worker threads for in-process patients
+    int logFlushBytes;         // logger flushes once this many bytes are buffered
+    int logFlushIntervalMs;    // logger flushes idle buffered lines after this delay
+    int logFsync;              // 0/1: fdatasync the log after every flush
+    int metricsPublishIntervalMs; // director samples queue/semaphore metrics into shared memory at this period (0 = off)
+    int binaryLog;             // 0/1: logger also writes fixed-layout binary records (<log>.sorbin)
+    int logRings;              // 0 = every process sends logs to LOG_QUEUE, 1 = per-producer shared-memory log rings
+    int logRingCount;          // log rings in the arena (producers logging at once without contention)
+    int logRingSlots;          // records per log ring (rounded up to a power of two)
+    int timeSeriesIntervalMs;  // director records queue depths for the summary JSON/CSV at this period (0 = off)
+    int registrationWindowsMax;      // registration pool size: window 0 always open, the others start parked
+    int registrationScaleIntervalMs; // director samples the registration queue for the pool policy at this period
+    int registrationScaleCooldownMs; // minimum time between two pool changes (also the growth projection horizon)
+    std::array<int, kSpecialistCount> specialistDoctors; // doctors consuming each specialist queue (SpecialistType order)
+    int triageWorkers;               // triage processes consuming the triage queue concurrently
+    int agingStepMs;                 // queue wait that raises a message one priority class (0 = strict priority)
+    int maxWaitNormalMs;             // wait bound of non-VIP patients in the registration/triage queues (0 = none)
+    int maxWaitYellowMs;             // wait bound of yellow patients in the specialist queues (0 = none)
+    int maxWaitGreenMs;              // wait bound of green patients in the specialist queues (0 = none)
+    int specialistPolicy;            // SpecialistPolicyKind: how specialists choose the next colour
+    std::array<int, kTriageColorCount> specialistWfqWeights; // weighted fair queuing shares (red, yellow, green)
+    std::array<int, kTriageColorCount> specialistTargetMs;   // earliest-deadline-first targets after enqueue
+    std::array<int, kTriageColorCount> specialistExamPct;    // exam time per colour, percent of the drawn time
 };
@@ -1,7 +1,11 @@
 #pragma once
 
+#include "latency.hpp"
+#include "metrics.hpp"
 #include "types.hpp"
 
+#include <cstdint>
+
 struct EventMessage {
     long mtype;           // static_cast<long>(EventType)
     int  patientId;
@@ -10,14 +14,60 @@ struct EventMessage {
     int  isVip;
     int  age;
     int  personsCount;
+    HopStamps hops;       // CLOCK_MONOTONIC stamps of the hops passed so far
+    long long queuedNs;   // producer's stamp right before sending into the current queue (queue-wait metric)
     char extra[64];
 };
 
+/**
+ * @brief Kind of a log event. Typed kinds carry their payload in LogEventFields and the logger
+ * derives their text; Other and the lifecycle kinds travel as free text.
+ */
+enum class LogEventKind : uint8_t {
+    Other,
+    PatientWaitingOutside,   // patient: "Patient waiting to enter waiting room"
+    PatientArrived,          // patient: "Patient arrived"
+    PatientRegistered,       // patient: "Patient registered"
+    RegistrationStarted,     // reg1/reg2: "Registration started" / "Registration window N opened"
+    RegistrationStopping,    // reg1/reg2: "... shutting down" / "Registration window N parked"
+    RegisteringPatient,      // reg1/reg2: "Registering patient"
+    RegistrationForwarded,   // reg1/reg2: "Forwarded patient"
+    RegistrationDropped,     // reg1/reg2: "Dropped patient"
+    TriageStarted,           // triage: "Triage started"
+    TriageStopping,          // triage: "Triage shutting down"
+    TriageForwarded,         // triage: "Forwarded patient ... to specialist="
+    TriageSentHome,          // triage: "Patient sent home from triage"
+    SpecialistStarted,       // specialist: "Specialist <name> started"
+    SpecialistStopping,      // specialist: "Specialist shutting down"
+    SpecialistReceived,      // specialist: "Received patient"
+    SpecialistHandled,       // specialist: "Handled patient"
+    SpecialistLeaveFinished, // specialist: "SIGUSR1: temporary leave finished"
+    DirectorSentLeave        // director: "Director sent SIGUSR1 to specialist pid="
+};
+
+/**
+ * @brief Typed payload of a log event; -1 marks a field the kind does not carry.
+ */
+struct LogEventFields {
+    LogEventKind kind{LogEventKind::Other};
+    int subject{-1};     // patient id, or the target pid for DirectorSentLeave
+    int persons{-1};
+    int age{-1};
+    int vip{-1};
+    int guardian{-1};
+    int color{-1};       // TriageColor as int
+    int specialist{-1};  // SpecialistType as int
+    int outcome{-1};     // Outcome as int
+};
+
 // Log messages destined for LOG_QUEUE
 struct LogMessage {
     long mtype;           // e.g. 1 for all log events
     int  role;            // cast from Role enum
     int  simTime;         // simulated time (minutes)
     int  pid;             // process PID
-    char text[128];       // log line text (without timestamp prefix)
+    int  hasMetrics;      // 1 when `metrics` holds the sender's load snapshot
+    MetricsSnapshot metrics;
+    LogEventFields fields; // typed payload; kind Other means `text` is the whole message
+    char text[128];       // free-text message (without timestamp/metrics prefix)
 };
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "types.hpp"
+
+/**
+ * @brief Pipeline stages timed for every patient, from the hop stamps carried in EventMessage.
+ */
+enum class LatencyStage {
+    DoorToWaitingRoom,          // generated -> all waiting-room seats acquired
+    WaitingRoomToRegistration,  // inside -> a registration window picks the patient up
+    RegistrationToTriage,       // registration start -> triage picks the patient up
+    TriageToSpecialist,         // triage start -> specialist exam start
+    SpecialistExam,             // exam start -> exam end
+    TimeInSystem                // generated -> exam end
+};
+
+constexpr int kLatencyStageCount = 6;
+
+/**
+ * @brief Priority classes of the three class-prioritised queues, for per-class queue waits
+ * (send by the producer -> receive by the consumer, service time excluded).
+ */
+enum class QueueClass {
+    RegistrationVip,
+    RegistrationNormal,
+    TriageVip,
+    TriageNormal,
+    SpecialistRed,
+    SpecialistYellow,
+    SpecialistGreen
+};
+
+constexpr int kQueueClassCount = 7;
+
+/**
+ * @brief CLOCK_MONOTONIC stamps taken at each hop (ns; 0 = hop not reached yet).
+ */
+struct HopStamps {
+    long long doorNs{0};
+    long long waitingRoomNs{0};
+    long long registrationNs{0};
+    long long triageNs{0};
+};
+
+/** @brief CLOCK_MONOTONIC in nanoseconds (the clock used for hop stamps; comparable across processes). */
+long long hopClockNs();
+
+/**
+ * @brief Percentiles of one histogram, in microseconds.
+ */
+struct LatencySummary {
+    uint64_t count{0};
+    uint64_t meanUs{0};
+    uint64_t p50Us{0};
+    uint64_t p90Us{0};
+    uint64_t p99Us{0};
+    uint64_t maxUs{0};
+};
+
+/**
+ * @brief Log-linear (HDR-style) histogram of microsecond latencies, lock-free and address-free.
+ *
+ * Values below 64 us get exact buckets; above that every power of two is split into 32 linear
+ * sub-buckets, so a reported percentile is at most ~3% above the true value. Values beyond ~19 h
+ * land in the last bucket. Recording is a few relaxed atomic adds, safe from any process.
+ */
+struct LatencyHistogram {
+    static constexpr int kSubBucketBits = 5;
+    static constexpr int kBuckets = 1024;
+
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sumUs{0};
+    std::atomic<uint64_t> maxUs{0};
+    std::atomic<uint32_t> buckets[kBuckets]{};
+
+    /** @brief Add one sample (negative values count as 0). */
+    void record(long long micros);
+
+    /** @brief Count, mean, p50/p90/p99 (bucket upper bounds, capped at max) and max. */
+    LatencySummary summarize() const;
+
+    /** @brief Bucket index of a value. */
+    static int bucketFor(uint64_t micros);
+
+    /** @brief Largest value mapped to a bucket. */
+    static uint64_t bucketUpperBound(int bucket);
+};
+
+/**
+ * @brief Plain copy of all latency percentiles (stored in SummaryPayload).
+ */
+struct LatencyReport {
+    std::array<LatencySummary, kLatencyStageCount> stages{};
+    std::array<std::array<LatencySummary, kLatencyStageCount>, kTriageColorCount> byColor{};
+    std::array<std::array<LatencySummary, kLatencyStageCount>, kSpecialistCount> bySpecialist{};
+    std::array<LatencySummary, kQueueClassCount> queueWait{};
+};
+
+/**
+ * @brief Per-stage histograms for all patients, plus per-colour and per-specialist sets for patients
+ * who finished an exam. Lives in SharedState; each stage is recorded by the process that ends it.
+ */
+struct LatencyHistograms {
+    std::array<LatencyHistogram, kLatencyStageCount> stages;
+    std::array<std::array<LatencyHistogram, kLatencyStageCount>, kTriageColorCount> byColor;
+    std::array<std::array<LatencyHistogram, kLatencyStageCount>, kSpecialistCount> bySpecialist;
+    std::array<LatencyHistogram, kQueueClassCount> queueWait;
+
+    /**
+     * @brief Record one stage of one patient from two hop stamps.
+     * @param stage stage ending at this hop.
+     * @param startNs stamp of the previous hop (0 = unknown, nothing is recorded).
+     * @param endNs stamp of this hop.
+     */
+    void recordHop(LatencyStage stage, long long startNs, long long endNs);
+
+    /**
+     * @brief Record an exam: the exam and time-in-system stages overall, and every stage of the
+     * patient under its triage colour and specialist.
+     * @param hops stamps carried by the patient's message.
+     * @param examStartNs stamp when the specialist picked the patient up.
+     * @param examEndNs stamp when the exam finished.
+     * @param color TriageColor as int.
+     * @param specialist SpecialistType as int.
+     */
+    void recordExam(const HopStamps& hops, long long examStartNs, long long examEndNs, int color, int specialist);
+
+    /**
+     * @brief Record how long one message sat in its queue.
+     * @param cls queue and priority class the message travelled in.
+     * @param queuedNs stamp taken by the producer right before sending (0 = unknown, nothing is recorded).
+     * @param receivedNs stamp taken by the consumer after receiving.
+     */
+    void recordQueueWait(QueueClass cls, long long queuedNs, long long receivedNs);
+
+    /** @brief Percentiles of every histogram. */
+    LatencyReport report() const;
+};
+
+/** @brief Human-readable stage name ("Door -> waiting room", ...). */
+const char* latencyStageName(LatencyStage stage);
+
+/** @brief Stage key for machine-readable output ("door_to_waiting_room", ...). */
+const char* latencyStageKey(LatencyStage stage);
+
+/** @brief Human-readable queue class name ("Registration VIP", ...). */
+const char* queueClassName(QueueClass cls);
+
+/** @brief Queue class key for machine-readable output ("registration_vip", ...). */
+const char* queueClassKey(QueueClass cls);
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+
+/**
+ * @brief Load figures appended to every log line (wR/rQ/tQ/sQ/wSem).
+ */
+struct MetricsSnapshot {
+    int waitingInside{0};
+    int waitingCapacity{0};
+    int registrationQueueLen{0};
+    int triageQueueLen{0};
+    int specialistsQueueLen{0};
+    int waitSemaphoreValue{0};
+};
+
+/**
+ * @brief Seqlock-protected MetricsSnapshot living in shared memory.
+ *
+ * One publisher (the director's sampler thread) calls publish(); any process may call read(),
+ * which retries while a write is in progress. All fields are lock-free atomics so the block is
+ * address-free and safe to place in a System V segment.
+ */
+struct MetricsBlock {
+    std::atomic<unsigned int> sequence;  // odd while a write is in progress
+    std::atomic<int> waitingInside;
+    std::atomic<int> waitingCapacity;
+    std::atomic<int> registrationQueueLen;
+    std::atomic<int> triageQueueLen;
+    std::atomic<int> specialistsQueueLen;
+    std::atomic<int> waitSemaphoreValue;
+
+    /** @brief Store a new snapshot (single writer). */
+    void publish(const MetricsSnapshot& m) {
+        unsigned int seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        waitingInside.store(m.waitingInside, std::memory_order_relaxed);
+        waitingCapacity.store(m.waitingCapacity, std::memory_order_relaxed);
+        registrationQueueLen.store(m.registrationQueueLen, std::memory_order_relaxed);
+        triageQueueLen.store(m.triageQueueLen, std::memory_order_relaxed);
+        specialistsQueueLen.store(m.specialistsQueueLen, std::memory_order_relaxed);
+        waitSemaphoreValue.store(m.waitSemaphoreValue, std::memory_order_relaxed);
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copy out a consistent snapshot.
+     * @return false if nothing has been published yet.
+     */
+    bool read(MetricsSnapshot& out) const {
+        while (true) {
+            unsigned int before = sequence.load(std::memory_order_acquire);
+            if (before == 0) return false;
+            if (before & 1u) continue;
+            out.waitingInside = waitingInside.load(std::memory_order_relaxed);
+            out.waitingCapacity = waitingCapacity.load(std::memory_order_relaxed);
+            out.registrationQueueLen = registrationQueueLen.load(std::memory_order_relaxed);
+            out.triageQueueLen = triageQueueLen.load(std::memory_order_relaxed);
+            out.specialistsQueueLen = specialistsQueueLen.load(std::memory_order_relaxed);
+            out.waitSemaphoreValue = waitSemaphoreValue.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before) return true;
+        }
+    }
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+/** @brief Upper bound for registrationWindowsMax (window slots in SharedState, semaphores in the gate set). */
+constexpr int kMaxRegistrationWindows = 8;
+
+/**
+ * @brief Thresholds of the registration pool (window 0 is always open, the others on demand).
+ */
+struct RegistrationPolicy {
+    int maxWindows{2};      // pool size including window 0
+    int openThreshold{0};   // queue depth that opens one more window (K)
+    int closeThreshold{0};  // queue depth below which one window is parked (N/3)
+    int cooldownMs{0};      // minimum time between two changes; also the growth projection horizon
+};
+
+/**
+ * @brief Hysteresis on the registration queue depth and its growth rate.
+ *
+ * Growth is the queue slope in patients per second, smoothed exponentially with the cooldown as
+ * time constant. One more window opens when the depth projected one cooldown ahead reaches the
+ * open threshold while the queue is already there or still growing; one window parks when both
+ * the current and the projected depth are below the close threshold. At most one change happens
+ * per cooldown, so a burst opens windows one at a time. With two windows and a flat queue this is
+ * the original reg2 rule: open at >= K, close below N/3.
+ */
+class RegistrationScaler {
+public:
+    explicit RegistrationScaler(const RegistrationPolicy& policy) : policy_(policy) {}
+
+    /**
+     * @brief Feed one queue sample and decide.
+     * @param nowMs sample time (monotonic or virtual milliseconds).
+     * @param queueLen registration queue depth.
+     * @param openWindows windows open right now (window 0 included).
+     * @return +1 to open one more window, -1 to park one, 0 to keep the pool as it is.
+     */
+    int update(long long nowMs, int queueLen, int openWindows);
+
+    /** @brief Smoothed queue growth in patients per second. */
+    double growthPerSec() const { return growthPerSec_; }
+
+    /** @brief Queue depth expected one cooldown after the last sample. */
+    double projectedQueue() const { return projected_; }
+
+private:
+    RegistrationPolicy policy_;
+    bool sampled_{false};
+    bool changed_{false};
+    long long lastSampleMs_{0};
+    long long lastChangeMs_{0};
+    int lastQueueLen_{0};
+    double growthPerSec_{0.0};
+    double projected_{0.0};
+};
@@ -1,21 +1,160 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 
+#include "aging_policy.hpp"
+#include "latency.hpp"
+#include "metrics.hpp"
+#include "registration_policy.hpp"
+#include "specialist_policy.hpp"
+#include "types.hpp"
+
+/** @brief Cache line size used to keep independent writers' counters apart. */
+constexpr size_t kCacheLineBytes = 64;
+
+/**
+ * @brief Waiting-room occupancy; patients add on entry, registration subtracts on forward.
+ */
+struct alignas(kCacheLineBytes) WaitingRoomCounters {
+    std::atomic<int> currentInWaitingRoom{0};  // persons inside (including children+guardians)
+    std::atomic<int> queueRegistrationLen{0};  // registration queue length
+    std::atomic<int> totalPatients{0};
+};
+
+/**
+ * @brief Triage decisions of one triage worker; the director stores the pid, the worker writes the rest.
+ */
+struct alignas(kCacheLineBytes) TriageCounters {
+    std::atomic<int> red{0};
+    std::atomic<int> yellow{0};
+    std::atomic<int> green{0};
+    std::atomic<int> sentHome{0};
+    std::atomic<int> pid{0};
+    std::atomic<long long> busyNs{0};    // service time plus routing, receive to forward
+};
+
+/**
+ * @brief Exam outcomes of one specialty (one line per specialty; only its doctors write to it).
+ */
+struct alignas(kCacheLineBytes) OutcomeCounters {
+    std::atomic<int> home{0};
+    std::atomic<int> ward{0};
+    std::atomic<int> other{0};
+};
+
+/**
+ * @brief Work of one specialist doctor; the director stores the pid, the doctor writes the rest.
+ */
+struct alignas(kCacheLineBytes) DoctorCounters {
+    std::atomic<int> pid{0};
+    std::atomic<int> leaves{0};          // SIGUSR1 leaves taken
+    std::atomic<long long> exams{0};
+    std::atomic<long long> busyNs{0};    // exam time
+    std::atomic<long long> leaveNs{0};   // time away on SIGUSR1 leave
+};
+
+/** @brief Enqueue stamps remembered per aging lane; a deeper backlog reads as "age unknown". */
+constexpr int kAgingLaneSlots = 1024;
+
+/**
+ * @brief Enqueue times of one priority class of one queue, in send order.
+ *
+ * A SysV queue is FIFO per mtype but cannot be peeked, so producers note every successful send
+ * here and consumers every receive; the stamp of sequence number `dequeued` is then the age of
+ * the class's oldest message. Concurrent producers may note sends in a slightly different order
+ * than the queue holds them, so ages are exact only up to that race.
+ */
+struct AgingLane {
+    alignas(kCacheLineBytes) std::atomic<long long> enqueued{0};  // producers
+    alignas(kCacheLineBytes) std::atomic<long long> dequeued{0};  // consumers
+    struct Stamp {
+        std::atomic<long long> seq{-1};  // sequence number the stamp belongs to
+        std::atomic<long long> ns{0};
+    };
+    std::array<Stamp, kAgingLaneSlots> stamps;
+
+    /** @brief Record a successful send that was stamped queuedNs. */
+    void noteEnqueue(long long queuedNs);
+
+    /** @brief Record a receive from this class. */
+    void noteDequeue() { dequeued.fetch_add(1, std::memory_order_relaxed); }
+
+    /** @brief Messages sent but not yet received (best effort, never negative). */
+    long long queued() const {
+        long long n = enqueued.load(std::memory_order_relaxed) - dequeued.load(std::memory_order_relaxed);
+        return n > 0 ? n : 0;
+    }
+
+    /** @brief Wait of the oldest message in milliseconds; -1 when the class is empty or the stamp is gone. */
+    long long headAgeMs(long long nowNs) const;
+};
+
+/**
+ * @brief Aging lanes of every class-prioritised queue (index = mtype - first mtype of the queue).
+ */
+struct AgingLanes {
+    std::array<AgingLane, 2> registration;  // VIP, normal
+    std::array<AgingLane, 2> triage;        // VIP, normal
+    std::array<std::array<AgingLane, kMaxAgingClasses>, kSpecialistCount> specialists; // red, yellow, green
+};
+
+/**
+ * @brief Director-owned control flags.
+ */
+struct alignas(kCacheLineBytes) ControlFlags {
+    std::atomic<int> openRegistrationWindows{0};  // registration windows currently taking patients
+};
+
+/**
+ * @brief One window of the registration pool. The director sets open/pid; the window process
+ * reports whether it is taking patients and counts the patients it served and the time it spent on them.
+ */
+struct alignas(kCacheLineBytes) RegistrationWindowSlot {
+    std::atomic<int> open{0};            // 1 while the window should take patients
+    std::atomic<int> pid{0};
+    std::atomic<int> taking{0};          // set by the window: 1 between its "opened" and "parked"
+    std::atomic<long long> patients{0};  // patients taken off the queue (forwarded or dropped)
+    std::atomic<long long> busyNs{0};    // receive -> seats released, summed over those patients
+};
+
+/**
+ * @brief Plain copy of the shared counters taken at one instant (see SharedState::snapshot()).
+ */
+struct StateSnapshot {
+    int currentInWaitingRoom{0};
+    int waitingRoomCapacity{0};
+    int queueRegistrationLen{0};
+    int openRegistrationWindows{0};
+    int totalPatients{0};
+    int triageRed{0};
+    int triageYellow{0};
+    int triageGreen{0};
+    int triageSentHome{0};
+    int outcomeHome{0};
+    int outcomeWard{0};
+    int outcomeOther{0};
+
+    /** @brief Patients that left the system: exam outcomes plus those sent home from triage. */
+    int finishedPatients() const { return outcomeHome + outcomeWard + outcomeOther + triageSentHome; }
+};
+
+/**
+ * @brief Simulation state shared by all processes (System V segment 'H').
+ *
+ * Counters are lock-free std::atomic fields grouped per writer on separate cache lines; no
+ * semaphore guards them. Plain fields are written once by the director before any child starts.
+ * The director constructs the object in place (placement new) right after shmat().
+ */
 struct SharedState {
-    int currentInWaitingRoom;   // persons inside (including children+guardians)
     int waitingRoomCapacity;    // total capacity N
-    int queueRegistrationLen;   // registration queue length
-    int reg2Active;             // 0/1
     int timeScaleMsPerSimMinute;    // wall-clock ms per simulated minute
     int simulationDurationMinutes;  // total planned duration
     long long simStartMonotonicMs;  // CLOCK_MONOTONIC at start (ms)
-
-    int totalPatients;
-    int triageRed;
-    int triageYellow;
-    int triageGreen;
-    int triageSentHome;
+    int queueTransport;             // 0 = SysV queues, 1 = shm rings (see QueueTransport)
+    unsigned int randomSeed;        // config randomSeed; roles derive their RNG seeds from it (sim_rules.hpp)
 
     // Service times in milliseconds (real time)
     int registrationServiceMs;
@@ -25,13 +164,44 @@ struct SharedState {
     int specialistLeaveMinMs;
     int specialistLeaveMaxMs;
 
-    int outcomeHome;
-    int outcomeWard;
-    int outcomeOther;
-
     int directorPid;
     int registration1Pid;
-    int registration2Pid;
-    int triagePid;
-    // arrays for specialists etc. can be added later
+    int registrationWindowCount;    // pool size (registrationWindowsMax); slots past it stay unused
+    std::array<int, kSpecialistCount> doctorCount; // doctors per specialty (specialistDoctors)
+    int triageWorkerCount;          // triage workers spawned (triageWorkers); slots past it stay unused
+
+    int metricsPublishIntervalMs;   // >0 when the director publishes `metrics` (logEvent reads it instead of probing IPC)
+    AgingPolicy vipQueueAging;      // registration and triage queues (scaled agingStepMs / maxWaitNormalMs)
+    AgingPolicy colorQueueAging;    // specialist queues (scaled agingStepMs / maxWaitYellowMs / maxWaitGreenMs)
+    SpecialistPolicy specialistPolicy; // how specialists choose the next colour (scaled targets)
+
+    WaitingRoomCounters waitingRoom;
+    std::array<TriageCounters, kMaxTriageWorkers> triage; // one line per triage worker
+    std::array<OutcomeCounters, kSpecialistCount> outcomes;
+    std::array<std::array<DoctorCounters, kMaxDoctorsPerSpecialty>, kSpecialistCount> doctors;
+    ControlFlags control;
+    std::array<RegistrationWindowSlot, kMaxRegistrationWindows> registrationWindows;
+    alignas(kCacheLineBytes) MetricsBlock metrics;
+    alignas(kCacheLineBytes) LatencyHistograms latency;  // per-stage patient latencies (recorded at each hop)
+    AgingLanes aging;
+
+    /**
+     * @brief Consistent multi-field copy: re-reads until two consecutive passes agree.
+     * @return counters as they were at one instant (best effort after a bounded number of passes).
+     */
+    StateSnapshot snapshot() const;
 };
+
+/**
+ * @brief Subtract from a counter without going below zero (mirrors the old clamped updates).
+ */
+inline void subtractClamped(std::atomic<int>& counter, int amount) {
+    int current = counter.load(std::memory_order_relaxed);
+    int next = 0;
+    do {
+        next = current >= amount ? current - amount : 0;
+    } while (!counter.compare_exchange_weak(current, next, std::memory_order_relaxed));
+}
+
+static_assert(std::atomic<int>::is_always_lock_free, "SharedState counters must be lock-free across processes");
+static_assert(std::atomic<long long>::is_always_lock_free, "SharedState counters must be lock-free across processes");
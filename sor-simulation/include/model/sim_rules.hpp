@@ -0,0 +1,80 @@
+#pragma once
+
+#include "model/types.hpp"
+#include "util/random.hpp"
+
+/**
+ * @brief Patient attributes drawn at generation time.
+ */
+struct PatientTraits {
+    int  age;
+    bool isVip;
+    bool hasGuardian;   // children (<18) come with a guardian
+    int  personsCount;  // 1 or 2 (guardian + child)
+};
+
+/**
+ * @brief Final disposition after a specialist exam.
+ */
+enum class Outcome {
+    Home,
+    Ward,
+    OtherFacility
+};
+
+/** @brief Draw age/VIP/guardian for a new patient (~10% VIP). */
+PatientTraits drawPatientTraits(RandomGenerator& rng);
+
+/** @brief 5% of triaged patients are sent home without a specialist. */
+bool rollSentHomeFromTriage(RandomGenerator& rng);
+
+/** @brief Pick triage color with weighted probabilities (10% red, 35% yellow, 55% green). */
+TriageColor pickColor(RandomGenerator& rng);
+
+/** @brief Uniformly pick a specialist type. */
+SpecialistType pickSpecialist(RandomGenerator& rng);
+
+/**
+ * @brief RNG seeds derived from randomSeed. The DES engine and the process roles use the same
+ * offsets (generator = randomSeed itself), so a config seed fixes every draw in both modes.
+ */
+unsigned int triageSeed(unsigned int base, int worker);
+
+/** @brief Seed of one specialist doctor (see triageSeed). */
+unsigned int doctorSeed(unsigned int base, SpecialistType type, int doctor);
+
+/** @brief Seed of the director's SIGUSR1 leave draws (see triageSeed). */
+unsigned int directorSeed(unsigned int base);
+
+/** @brief Pick exam outcome (85% home, 14.5% ward, 0.5% other facility). */
+Outcome pickOutcome(RandomGenerator& rng);
+
+/** @brief Outcome label used in logs ("home", "ward", "otherFacility"). */
+const char* outcomeLabel(Outcome outcome);
+
+/** @brief Priority ordering for colors (lower is higher priority). */
+int colorPriority(TriageColor c);
+
+/** @brief Registration-queue mtype: VIPs use the lower type so negative msgtyp dequeues them first. */
+long arrivalMsgType(bool isVip);
+
+/** @brief Triage-queue mtype: VIPs first, same scheme as arrivals. */
+long registeredMsgType(bool isVip);
+
+/** @brief Specialist-queue mtype: base + specialist*10 + color priority. */
+long specialistMsgType(SpecialistType spec, TriageColor color);
+
+/** @brief Highest message type a specialist should accept (priority range). */
+long maxMsgTypeForSpec(SpecialistType t);
+
+/**
+ * @brief Scale a baseline duration (tuned for 20 ms per sim minute) to the configured time scale.
+ * @return 0 for non-positive input, otherwise at least 1 ms.
+ */
+int scaleAllowZeroMs(int baseMs, int msPerSimMinute);
+
+/** @brief Like scaleAllowZeroMs but never returns less than 1 ms. */
+int scaleAtLeastOneMs(int baseMs, int msPerSimMinute);
+
+/** @brief Scale a generator interval; non-positive input means one simulated minute. */
+int scaleIntervalMs(int baseMs, int msPerSimMinute);
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "model/aging_policy.hpp"
+#include "model/config.hpp"
+#include "model/types.hpp"
+
+#include <array>
+#include <string>
+
+/**
+ * @brief How a specialist chooses the colour it examines next (specialistPolicy).
+ */
+enum class SpecialistPolicyKind {
+    StrictPriority,   // red, then yellow, then green (queue aging applies)
+    WeightedFair,     // colours share the exams in proportion to their weights
+    ShortestExam,     // colour with the shortest expected exam first
+    EarliestDeadline  // head whose colour target time runs out first
+};
+
+/** @brief Config spelling of a policy ("strict", "wfq", "sef", "edf"). */
+const char* specialistPolicyName(SpecialistPolicyKind kind);
+
+/** @brief Parse the config spelling; false for an unknown name. */
+bool parseSpecialistPolicy(const std::string& text, SpecialistPolicyKind& out);
+
+/**
+ * @brief Scheduling settings shared by every specialist (lives in SharedState, so plain values only).
+ * Colour arrays are indexed red, yellow, green.
+ */
+struct SpecialistPolicy {
+    int kind{0};                                                 // SpecialistPolicyKind as int
+    std::array<int, kTriageColorCount> weights{{1, 1, 1}};       // weighted fair queuing shares
+    std::array<int, kTriageColorCount> targetMs{};               // deadline after enqueue (scaled ms)
+    std::array<int, kTriageColorCount> examPct{{100, 100, 100}}; // exam time per colour, percent of the drawn time
+
+    SpecialistPolicyKind policyKind() const { return static_cast<SpecialistPolicyKind>(kind); }
+};
+
+/** @brief Settings from the config; target times are scaled like service times. */
+SpecialistPolicy specialistPolicyFromConfig(const Config& cfg);
+
+/** @brief Exam time of a patient of the given colour from a drawn exam time (at least 1 ms). */
+int colorExamMs(const SpecialistPolicy& policy, TriageColor color, int drawnMs);
+
+/**
+ * @brief Colour picker of one doctor.
+ *
+ * Weighted fair queuing keeps start-time fair queuing tags per colour: a colour that starts a
+ * backlog begins at the current virtual time, so an idle colour does not bank credit. Shortest
+ * exam first ranks colours by examPct (the drawn exam time is colour-independent otherwise).
+ * Earliest deadline first compares targetMs minus the head's wait. Ties keep the higher priority.
+ */
+class SpecialistScheduler {
+public:
+    SpecialistScheduler(const SpecialistPolicy& policy, const AgingPolicy& aging) : policy_(policy), aging_(aging) {}
+
+    /**
+     * @brief Colour to receive next.
+     * @param queued messages waiting per colour (best effort; <= 0 = empty).
+     * @param headAgeMs wait of each colour's oldest message (-1 = empty or unknown).
+     * @return colour index, or -1 to take the strict priority order.
+     */
+    int pick(const long long* queued, const long long* headAgeMs) const;
+
+    /** @brief Account one exam of the given colour (the one actually received). */
+    void noteServed(int color);
+
+private:
+    SpecialistPolicy policy_;
+    AgingPolicy aging_;
+    std::array<double, kTriageColorCount> finishTag_{};
+    double virtualTime_{0.0};
+};
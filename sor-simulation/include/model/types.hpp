@@ -45,3 +45,6 @@ enum class Role {
 };
 
 constexpr int kSpecialistCount = 6;
+constexpr int kMaxDoctorsPerSpecialty = 8; // doctors sharing one specialist queue (specialistDoctors)
+constexpr int kMaxTriageWorkers = 8;       // triage nurses sharing the triage queue (triageWorkers)
+constexpr int kTriageColorCount = 3; // Red, Yellow, Green
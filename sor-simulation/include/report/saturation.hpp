@@ -0,0 +1,81 @@
+#pragma once
+
+#include "model/config.hpp"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Options for a saturation ramp (sor_sim saturate).
+ */
+struct SaturationOptions {
+    std::string selfPath;          // absolute path of sor_sim (roles are exec'd from each step's directory)
+    std::string outDir;            // per-step run directories are created below this directory
+    int steps{8};                  // maximum number of arrival-rate steps
+    int stepSeconds{10};           // wall-clock length of every step
+    int repeats{1};                // runs per step; the step reports their medians
+    double factor{0.75};           // generation interval multiplier between steps (< 1 raises the rate)
+    double minThroughputRatio{0.9}; // achieved / offered rate below this is not sustainable
+    double maxBacklogGrowth{0.05}; // backlog growth (patients/s) above this fraction of the offered rate is not sustainable
+};
+
+/**
+ * @brief Measurements of one step: one full process-mode run at a fixed generation interval.
+ */
+struct SaturationStep {
+    int index{0};
+    int patientGenMinMs{0};        // config units (baseline ms), as written to the step's config
+    int patientGenMaxMs{0};
+    double meanIntervalMs{0.0};    // wall-clock mean generation interval after time scaling
+    double offeredPerSec{0.0};     // patients the generator tries to start per second
+    double achievedPerSec{0.0};    // patients leaving the system (exam done or sent home) per second, second half
+    double backlogGrowthPerSec{0.0}; // slope of registration + triage + specialist queues over the second half
+    double p99TimeInSystemMs{0.0};
+    double cpuMsPerPatient{0.0};   // user + system CPU of the whole process tree per finished patient
+    long long finished{0};
+    long long forkFailures{0};     // "fork failed" lines in the step's log
+    long long childCapWaits{0};    // generator hit its cap on concurrent patients
+    long long logRecordsDropped{0};
+    int maxWaitSemDrift{0};        // largest "miss=" reported by the director's ERROR MON line
+    int exitCode{0};               // director exit code (-1 = the step could not be evaluated)
+    bool sustainable{false};
+    std::string verdict;           // why the step is not sustainable ("ok" otherwise)
+};
+
+/**
+ * @brief All steps of a ramp and the knee (the fastest sustainable step before the first one that is not).
+ */
+struct SaturationResult {
+    std::vector<SaturationStep> steps;
+    int kneeIndex{-1};             // index into steps, -1 when even the first step is not sustainable
+    int stepSeconds{0};
+    int repeats{1};
+    std::string outDir;
+};
+
+/**
+ * @brief Ramp the patient generation interval down with service times unchanged, running the
+ * full simulator (no visualizer) options.repeats times per step, each run in its own directory,
+ * and evaluating the runs' summaries, queue series and logs. Stops after two consecutive unsustainable steps, when the
+ * interval reaches 1 ms, or on SIGINT.
+ * @param config validated configuration (patientGenMinMs/MaxMs give the first step).
+ * @param options ramp shape and thresholds.
+ * @return per-step measurements and the knee.
+ */
+SaturationResult runSaturation(const Config& config, const SaturationOptions& options);
+
+/** @brief Offered rate at the knee in patients per second (0 without a knee). */
+double saturationKneeRate(const SaturationResult& result);
+
+/**
+ * @brief Write the steps as a fixed-width text table followed by the knee.
+ * @return true when the stream is still good.
+ */
+bool writeSaturationReport(const SaturationResult& result, std::ostream& out);
+
+/**
+ * @brief Write the steps and the knee as one JSON object.
+ * @return true on success, false on open/write failure.
+ */
+bool writeSaturationJson(const SaturationResult& result, const std::string& path);
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "model/latency.hpp"
+#include "model/types.hpp"
+#include "report/time_series.hpp"
+
+#include <sys/types.h>
+#include <array>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Activity of one registration window over the run (window 0 is open for the whole run).
+ */
+struct RegistrationWindowSummary {
+    pid_t pid{0};           // 0 in DES mode
+    int activations{0};     // times the window was opened
+    long long openMs{0};    // total time open
+    long long patients{0};  // patients taken off the registration queue
+    long long busyMs{0};    // time spent on those patients
+};
+
+/**
+ * @brief Decisions of one triage worker over the run.
+ */
+struct TriageWorkerSummary {
+    pid_t pid{0};           // 0 in DES mode
+    int red{0};
+    int yellow{0};
+    int green{0};
+    int sentHome{0};
+    long long busyMs{0};    // service time plus routing
+
+    /** @brief Patients this worker finished triaging. */
+    int patients() const { return red + yellow + green + sentHome; }
+};
+
+/**
+ * @brief Work of one specialist doctor over the run.
+ */
+struct DoctorSummary {
+    pid_t pid{0};           // 0 in DES mode
+    long long exams{0};     // patients examined
+    long long busyMs{0};    // time spent examining
+    int leaves{0};          // SIGUSR1 leaves taken
+    long long leaveMs{0};   // time spent on leave
+};
+
+/**
+ * @brief End-of-run statistics written to the summary file.
+ *
+ * Filled by the Director from SharedState (process mode) or by the DES engine (discrete-event mode);
+ * both paths share the same text layout so runs can be compared directly.
+ */
+struct SummaryPayload {
+    int totalPatients{0};
+    int waitingRoomCapacity{0};
+    int queueRegistrationLen{0};
+    int triageRed{0};
+    int triageYellow{0};
+    int triageGreen{0};
+    int triageSentHome{0};
+    int outcomeHome{0};
+    int outcomeWard{0};
+    int outcomeOther{0};
+    int timeScaleMsPerSimMinute{0};
+    int simulationDurationMinutes{0};
+    long long simulatedSeconds{0};
+    long long elapsedMs{0};     // wall-clock run length (virtual in DES mode); denominator of doctor utilization
+    std::string specialistPolicy{"strict"}; // specialistPolicy the doctors ran with
+    pid_t directorPid{0};
+    pid_t registration1Pid{0};
+    bool discreteEvent{false};  // true when produced by the DES engine (no processes spawned)
+    std::vector<RegistrationWindowSummary> registrationWindows; // one entry per pool window
+    int peakOpenRegistrationWindows{0};
+    std::vector<TriageWorkerSummary> triageWorkers; // one entry per triage worker
+    std::array<std::vector<DoctorSummary>, kSpecialistCount> doctors; // one entry per doctor of each specialty
+    long long logRecordsDropped{0}; // process mode: log records lost because every log ring was full
+    LatencyReport latency;      // per-stage patient latency percentiles (virtual time in DES mode)
+    QueueTimeSeries queueSeries; // queue depths over the run (empty when timeSeriesIntervalMs = 0)
+};
+
+/** @brief Format seconds as "Xd Xh Xm Xs". */
+std::string formatDuration(long long seconds);
+
+/** @brief Human-readable specialist name for an index into the specialist arrays. */
+const char* specialistName(int idx);
+
+/** @brief Finished exams of one triage colour (every colour for -1). */
+long long examsFinished(const SummaryPayload& payload, int color = -1);
+
+/** @brief Finished exams per second of elapsed time for one triage colour (every colour for -1). */
+double examThroughput(const SummaryPayload& payload, int color = -1);
+
+/**
+ * @brief Write the summary in the standard text layout.
+ * @param payload collected statistics.
+ * @param out open output stream.
+ * @return true when the stream is still good after writing.
+ */
+bool writeSummaryText(const SummaryPayload& payload, std::ofstream& out);
+
+/**
+ * @brief Write the summary as one JSON object: counts, latency percentiles in microseconds and the
+ * queue time series as parallel column arrays.
+ * @param payload collected statistics.
+ * @param path destination path (truncated).
+ * @return true on success, false on open/write failure.
+ */
+bool writeSummaryJson(const SummaryPayload& payload, const std::string& path);
+
+/**
+ * @brief Write the summary as "key,value" CSV rows with dotted keys matching the JSON
+ * layout (e.g. "latencyUs.stages.time_in_system.p99"); the time series goes to its own CSV.
+ * @param payload collected statistics.
+ * @param path destination path (truncated).
+ * @return true on success, false on open/write failure.
+ */
+bool writeSummaryCsv(const SummaryPayload& payload, const std::string& path);
+
+/**
+ * @brief Write the queue time series as CSV, one row per sample under a header row.
+ * @param series recorded samples.
+ * @param path destination path (truncated).
+ * @return true on success, false on open/write failure.
+ */
+bool writeQueueSeriesCsv(const QueueTimeSeries& series, const std::string& path);
+
+/**
+ * @brief Path of a file written next to a text summary: the ".txt" extension is replaced by suffix
+ * ("sor_summary_1.txt", "_series.csv" -> "sor_summary_1_series.csv").
+ */
+std::string summarySiblingPath(const std::string& textPath, const std::string& suffix);
+
+/**
+ * @brief Write the summary to a file (truncating it).
+ * @param payload collected statistics.
+ * @param path destination path.
+ * @return true on success, false on open/write failure.
+ */
+bool writeSummary(const SummaryPayload& payload, const std::string& path);
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "model/metrics.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Columnar record of queue depths (and patients finished so far) sampled at a fixed interval,
+ * one vector per column.
+ *
+ * Memory is bounded: when the buffer reaches its capacity every second sample is dropped and the
+ * effective interval doubles, so a long run keeps an evenly spaced, coarser series. Not thread-safe;
+ * one sampler appends, and the series is read once sampling has stopped.
+ */
+class QueueTimeSeries {
+public:
+    static constexpr size_t kDefaultCapacity = 16384;
+
+    /**
+     * @brief Start an empty series.
+     * @param intervalMs period at which record() is called (0 = series disabled).
+     * @param capacity samples kept before the series is thinned out.
+     */
+    explicit QueueTimeSeries(int intervalMs = 0, size_t capacity = kDefaultCapacity);
+
+    /**
+     * @brief Offer the sample of one tick; kept when the tick falls on the current (thinned) interval.
+     * @param elapsedMs milliseconds since the simulation start (wall clock, or virtual in DES mode).
+     * @param metrics queue depths and waiting-room figures at that moment.
+     * @param finished patients that left the system so far (exam outcome or sent home from triage).
+     */
+    void record(long long elapsedMs, const MetricsSnapshot& metrics, long long finished);
+
+    /** @brief Number of samples kept. */
+    size_t size() const { return elapsedMs_.size(); }
+
+    /** @brief Milliseconds between kept samples (base interval times the thinning factor). */
+    long long intervalMs() const { return static_cast<long long>(baseIntervalMs_) * stride_; }
+
+    const std::vector<long long>& elapsedMs() const { return elapsedMs_; }
+    const std::vector<int>& waitingRoom() const { return waitingRoom_; }
+    const std::vector<int>& registrationQueue() const { return registrationQueue_; }
+    const std::vector<int>& triageQueue() const { return triageQueue_; }
+    const std::vector<int>& specialistQueues() const { return specialistQueues_; }
+    const std::vector<int>& waitSemaphore() const { return waitSemaphore_; }
+    const std::vector<long long>& finished() const { return finished_; }
+
+private:
+    void thinOut();
+
+    int baseIntervalMs_;
+    size_t capacity_;
+    long long stride_{1};
+    long long ticks_{0};
+    std::vector<long long> elapsedMs_;
+    std::vector<int> waitingRoom_;
+    std::vector<int> registrationQueue_;
+    std::vector<int> triageQueue_;
+    std::vector<int> specialistQueues_;
+    std::vector<int> waitSemaphore_;
+    std::vector<long long> finished_;
+};
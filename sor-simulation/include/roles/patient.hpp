@@ -1,7 +1,24 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 
+class MessageQueue;
+class Semaphore;
+struct SharedState;
+
+/**
+ * @brief IPC handles a patient lifecycle needs; owned by the caller and shareable across threads.
+ */
+struct PatientContext {
+    MessageQueue* registrationQueue;
+    int logQueueId;
+    Semaphore* waitSemaphore;
+    SharedState* sharedState;
+    const std::atomic<bool>* stopFlag;  // set on SIGUSR2 (process) or generator shutdown (in-process)
+    bool spawnChildThread;              // child of a guardian pair gets its own thread (false: modelled inline)
+};
+
 /**
  * @brief Represents a single patient (or child+guardian) going through the SOR pipeline.
  */
@@ -10,8 +27,8 @@ public:
     Patient() = default;
 
     /**
-     * @brief Execute patient journey (registration -> triage -> specialist).
-     * @param keyPath path used for ftok keys.
+     * @brief Execute patient journey (registration -> triage -> specialist) as a standalone process.
+     * @param keyPath run registry path used to resolve IPC keys.
      * @param patientId logical id.
      * @param age age in years.
      * @param isVip VIP flag.
@@ -20,4 +37,12 @@ public:
      * @return 0 on completion or orderly shutdown.
      */
     int run(const std::string& keyPath, int patientId, int age, bool isVip, bool hasGuardian, int personsCount);
+
+    /**
+     * @brief Patient lifecycle on already-open IPC handles (used by run() and the in-process pool).
+     * @param ctx shared IPC handles and stop flag.
+     * @return 0 on completion or orderly shutdown, 1 on IPC failure.
+     */
+    static int lifecycle(const PatientContext& ctx, int patientId, int age, bool isVip, bool hasGuardian,
+                         int personsCount);
 };
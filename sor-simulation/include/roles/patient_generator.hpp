@@ -12,9 +12,10 @@ public:
 
     /**
      * @brief Main loop for spawning patients.
-     * @param keyPath path used for ftok keys (shared with director).
+     * @param exePath executable to exec for patient processes.
+     * @param keyPath run registry path used to resolve IPC keys (shared with director).
      * @param cfg configuration (time scale, totals, seed).
      * @return 0 on normal stop, non-zero on error.
      */
-    int run(const std::string& keyPath, const Config& cfg);
+    int run(const std::string& exePath, const std::string& keyPath, const Config& cfg);
 };
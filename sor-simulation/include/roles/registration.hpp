@@ -4,6 +4,10 @@
 
 /**
  * @brief One registration window consuming from REGISTRATION_QUEUE.
+ *
+ * Window 0 takes patients for the whole run. Windows 1.. belong to the director's pool: they are
+ * spawned at startup and park on their semaphore of the gate set until the director marks their
+ * slot open, and park again once it is closed (after the patient they may already be waiting for).
  */
 class Registration {
 public:
@@ -11,9 +15,9 @@ public:
 
     /**
      * @brief Process incoming patients and forward to triage.
-     * @param keyPath path used for ftok keys (shared with director).
-     * @param isSecond true if this instance represents the optional second window.
+     * @param keyPath run registry path used to resolve IPC keys (shared with director).
+     * @param window pool index (0 = always-open window; others log as reg2).
      * @return 0 on normal exit.
      */
-    int run(const std::string& keyPath, bool isSecond = false);
+    int run(const std::string& keyPath, int window = 0);
 };
@@ -5,6 +5,9 @@
 
 /**
  * @brief Specialist doctor handling one specialty and reacting to director signals.
+ *
+ * Every doctor of a specialty is its own process receiving from the specialty's queue, so a
+ * SIGUSR1 leave takes only that doctor away while the others keep examining.
  */
 class Specialist {
 public:
@@ -12,7 +15,10 @@ public:
 
     /**
      * @brief Process patients from SPECIALISTS_QUEUE; handle SIGUSR1/SIGUSR2.
+     * @param keyPath run registry path used to resolve IPC keys.
+     * @param type specialty (selects the queue).
+     * @param doctor index among the specialty's doctors (selects the DoctorCounters slot).
      * @return 0 on normal exit.
      */
-    int run(const std::string& keyPath, SpecialistType type);
+    int run(const std::string& keyPath, SpecialistType type, int doctor = 0);
 };
@@ -4,6 +4,9 @@
 
 /**
  * @brief Triage role assigning severity and destinations.
+ *
+ * Several workers may receive from TRIAGE_QUEUE at once; each counts its decisions in its own
+ * TriageCounters line, so workers never share a written cache line.
  */
 class Triage {
 public:
@@ -11,7 +14,9 @@ public:
 
     /**
      * @brief Consume from TRIAGE_QUEUE, assign colors, route to specialists/home.
+     * @param keyPath run registry path used to resolve IPC keys.
+     * @param worker index among the triage workers (selects the TriageCounters slot).
      * @return 0 on normal exit.
      */
-    int run(const std::string& keyPath);
+    int run(const std::string& keyPath, int worker = 0);
 };
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "visualization/log_parser.hpp"
+
+#include <cstddef>
+#include <string_view>
+
+/** @brief Result of looking for a binary log header at the start of a file. */
+enum class LogFormat {
+    Unknown,  // not enough bytes yet to tell
+    Text,
+    Binary,
+    Unsupported  // binary magic with a version/record size this build cannot read
+};
+
+/**
+ * @brief Identify a log from its first bytes (text lines start with a digit, binary logs with the magic).
+ * @param head bytes from offset 0.
+ * @param headerBytes set to the header size to skip when the result is Binary.
+ */
+LogFormat detectLogFormat(std::string_view head, size_t& headerBytes);
+
+/**
+ * @brief Decode one binary record into a LogEntry: a fixed-size copy plus the text view.
+ * @param bytes unread bytes starting at a record boundary.
+ * @param used set to the record size (fixed part plus text tail) on success.
+ * @param out entry with role/kind/patient id/metrics; typed records fill out.fields and leave the
+ * text empty, free-text records point text into bytes.
+ * @return false when bytes holds only part of a record.
+ */
+bool readBinaryLogRecord(std::string_view bytes, size_t& used, LogEntry& out);
@@ -1,10 +1,37 @@
 #pragma once
 
+#include "model/events.hpp"
 #include "model/types.hpp"
 
+#include <cstdint>
 #include <string>
-#include <vector>
+#include <string_view>
 
+/**
+ * @brief Role column of a log line, classified once while parsing.
+ */
+enum class LogRole : uint8_t {
+    Unknown,
+    Director,
+    PatientGenerator,
+    Patient,
+    Registration1,
+    Registration2,
+    Triage,
+    Specialist,
+    Logger
+};
+
+/**
+ * @brief Event kinds the visualizer reacts to; everything else is Other. Shared with the senders'
+ * typed events, so binary records carry the kind directly.
+ */
+using MessageKind = LogEventKind;
+
+/**
+ * @brief One parsed log line or binary record. role/text are views into the caller's buffer and
+ * are only valid while that buffer is (the visualizer applies each entry before reading the next).
+ */
 struct LogEntry {
     int simTime{0};
     int pid{0};
@@ -16,18 +43,20 @@ struct LogEntry {
     int specialistsQueue{0};
     int waitSem{0};
     int stateSem{0};
-    std::string role;
-    std::string text;
+    LogRole roleKind{LogRole::Unknown};
+    MessageKind kind{MessageKind::Other};
+    int patientId{-1};  // "id=" of patient-flow kinds (see isPatientFlowKind), -1 otherwise
+    bool typed{false};  // fields holds the payload and text is empty (binary records; see formatEventText)
+    LogEventFields fields;
+    std::string_view role;
+    std::string_view text;
 };
 
-/** @brief Safe stoi returning 0 on failure. */
-int toIntSafe(const std::string& s);
+/** @brief Parse a decimal int with from_chars; 0 on failure (like the old stoi-based helper). */
+int toIntSafe(std::string_view s);
 
 /** @brief Extract integer value for a given key in free-form text. */
-bool extractInt(const std::string& text, const std::string& key, int& out);
-
-/** @brief Split string by delimiter into parts. */
-std::vector<std::string> split(const std::string& line, char delim);
+bool extractInt(std::string_view text, std::string_view key, int& out);
 
 /** @brief Map integer to TriageColor. */
 TriageColor colorFromInt(int value);
@@ -42,7 +71,21 @@ std::string specialistName(SpecialistType t);
 std::string specialistNameColored(SpecialistType t);
 
 /** @brief Infer SpecialistType from descriptive label text. */
-SpecialistType specialistFromLabel(const std::string& text);
+SpecialistType specialistFromLabel(std::string_view text);
+
+/** @brief Kinds that carry "id=" and move a patient between stages. */
+bool isPatientFlowKind(MessageKind kind);
+
+/** @brief Classify the role column ("director", "reg1", "specialist", ...). */
+LogRole classifyRole(std::string_view role);
+
+/** @brief Classify a message once from its role and leading words (first-byte dispatch + prefix match). */
+MessageKind classifyMessage(LogRole role, std::string_view text);
 
-/** @brief Parse a log line into structured LogEntry (handles metric-prefixed format). */
-bool parseLogLine(const std::string& line, LogEntry& out);
+/**
+ * @brief Parse a log line (plain or metric-prefixed format) without allocating.
+ * @param line one line without the trailing newline; must outlive the returned views.
+ * @param out parsed fields, role/kind classification, and views of role/text.
+ * @return false when the line has fewer than three fields.
+ */
+bool parseLogLine(std::string_view line, LogEntry& out);
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <sys/types.h>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Incremental reader for a growing log file: mmap for the bytes, inotify for wakeups.
+ *
+ * nextLines() maps only the unread tail of the file (at most kMaxWindowBytes at a time) and
+ * returns its complete lines as views into the mapping; a trailing partial line is left for the
+ * next call. Record-oriented readers use nextBytes()/consume() instead and decide themselves how
+ * much of the window is complete. waitForChange() sleeps on inotify IN_MODIFY instead of a fixed
+ * poll interval.
+ */
+class LogTail {
+public:
+    /** @brief Largest file window mapped at once, so multi-GB backlogs are consumed in slices. */
+    static constexpr size_t kMaxWindowBytes = 64u << 20;
+
+    LogTail() = default;
+    ~LogTail();
+
+    LogTail(const LogTail&) = delete;
+    LogTail& operator=(const LogTail&) = delete;
+
+    /**
+     * @brief Open the file for reading and register an inotify watch (polling fallback if unavailable).
+     * @param path log file path.
+     * @return true when the file could be opened.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Map the next unread slice and split it into complete lines (without '\n').
+     * @return views valid until the next call to nextLines() or close(); empty when nothing new.
+     */
+    const std::vector<std::string_view>& nextLines();
+
+    /**
+     * @brief Map the next unread slice without consuming it.
+     * @return view valid until the next nextBytes()/nextLines() or close(); empty when nothing new.
+     */
+    std::string_view nextBytes();
+
+    /** @brief Mark bytes of the last nextBytes() view as read; the rest is returned again next time. */
+    void consume(size_t bytes);
+
+    /**
+     * @brief Block until the file changes or the timeout expires (returns early on signals).
+     * @param timeoutMs maximum wait in milliseconds.
+     * @return true when inotify reported a change (or inotify is unavailable), false on timeout.
+     */
+    bool waitForChange(int timeoutMs);
+
+    /** @brief Release the mapping, the watch, and the file descriptor. */
+    void close();
+
+    /** @brief Bytes consumed so far (offset of the first unread byte). */
+    off_t offset() const { return offset_; }
+
+private:
+    std::string_view mapUnread();
+    void unmapWindow();
+
+    int fd_{-1};
+    int inotifyFd_{-1};
+    int watchId_{-1};
+    off_t offset_{0};
+    void* window_{nullptr};
+    size_t windowLen_{0};
+    std::vector<std::string_view> lines_;
+};
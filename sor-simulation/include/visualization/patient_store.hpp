@@ -0,0 +1,187 @@
+#pragma once
+
+#include "model/types.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class Stage {
+    OutsideQueue,
+    WaitingRoom,
+    RegistrationQueue,
+    TriageQueue,
+    SpecialistQueue,
+    SpecialistActive,
+    Done,
+    SentHome
+};
+
+/** @brief Number of Stage values (for per-stage arrays). */
+constexpr int kStageCount = static_cast<int>(Stage::SentHome) + 1;
+
+struct PatientView {
+    int id{0};
+    int pid{0};
+    int patientPid{0};
+    int persons{1};
+    bool hasGuardian{false};
+    bool isVip{false};
+    TriageColor color{TriageColor::None};
+    SpecialistType specialist{SpecialistType::None};
+    Stage stage{Stage::OutsideQueue};
+    bool registrationInProgress{false};
+    std::string registrationWindow;
+    std::string outcome;
+    int lastSimTime{0};
+    int waitOrder{-1};
+    int regOrder{-1};
+    int triageOrder{-1};
+};
+
+/**
+ * @brief Live patients of the visualizer: a slab of PatientView plus an open-addressing id index.
+ *
+ * Slots are reused through a free list, so the slab never grows past the peak number of live
+ * patients (capped at kMaxLivePatients; beyond that the stalest patient is evicted). Finished
+ * patients are removed with finish(); their ids are remembered for the last kFinishedMemory
+ * finishes so late log lines for them are ignored instead of resurrecting the patient.
+ *
+ * Every live patient is also linked into an intrusive list for its stage (in the order it entered
+ * the stage) and, while queued at or inside a specialist room, into that specialist's list
+ * (ascending id). reindex() keeps the lists in step after a PatientView was modified, so readers
+ * walk only the rows they display.
+ */
+class PatientStore {
+public:
+    static constexpr size_t kMaxLivePatients = 1u << 16;
+    static constexpr size_t kFinishedMemory = 4096;
+
+    PatientStore();
+
+    /** @brief Live patient with this id, or nullptr. */
+    PatientView* find(int id);
+    const PatientView* find(int id) const;
+
+    /**
+     * @brief Live patient with this id, created on first sight.
+     * @return nullptr when the id belongs to a recently finished patient.
+     */
+    PatientView* ensure(int id);
+
+    /** @brief Drop a live patient (it reached Done/SentHome); its id is remembered as finished. */
+    void finish(int id);
+
+    /** @brief Relink pv after its stage, specialist or persons changed (pv must come from this store). */
+    void reindex(const PatientView& pv);
+
+    /** @brief Number of live patients. */
+    size_t size() const { return liveCount_; }
+
+    /** @brief Live patients currently in a stage. */
+    size_t stageCount(Stage stage) const { return stageLists_[static_cast<size_t>(stage)].size; }
+
+    /** @brief Persons (patient plus guardian) currently in a stage. */
+    long stagePersons(Stage stage) const { return stagePersons_[static_cast<size_t>(stage)]; }
+
+    /** @brief Patients queued for (active == false) or inside (active == true) a specialist room. */
+    size_t specialistCount(SpecialistType type, bool active) const {
+        int list = specialistList(type, active ? Stage::SpecialistActive : Stage::SpecialistQueue);
+        return list < 0 ? 0 : specialistLists_[static_cast<size_t>(list)].size;
+    }
+
+    /** @brief Visit patients of a stage in the order they entered it; stops when fn returns false. */
+    template <typename Fn>
+    void forEachInStage(Stage stage, Fn&& fn) const {
+        for (int32_t s = stageLists_[static_cast<size_t>(stage)].head; s >= 0;
+             s = links_[static_cast<size_t>(s)].next) {
+            if (!fn(slab_[static_cast<size_t>(s)])) return;
+        }
+    }
+
+    /** @brief Visit a specialist's queued or in-room patients by ascending id; stops when fn returns false. */
+    template <typename Fn>
+    void forEachAtSpecialist(SpecialistType type, bool active, Fn&& fn) const {
+        int list = specialistList(type, active ? Stage::SpecialistActive : Stage::SpecialistQueue);
+        if (list < 0) return;
+        for (int32_t s = specialistLists_[static_cast<size_t>(list)].head; s >= 0;
+             s = links_[static_cast<size_t>(s)].specNext) {
+            if (!fn(slab_[static_cast<size_t>(s)])) return;
+        }
+    }
+
+    /** @brief Patients dropped with finish() so far. */
+    uint64_t finishedCount() const { return finishedCount_; }
+
+    /** @brief Live patients dropped because the store was full. */
+    uint64_t evictedCount() const { return evictedCount_; }
+
+    /** @brief Visit every live patient (slab order). */
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (size_t i = 0; i < slab_.size(); ++i) {
+            if (slotLive_[i]) fn(slab_[i]);
+        }
+    }
+
+private:
+    static constexpr int kEmptyId = INT32_MIN;
+    static constexpr int32_t kFinishedSlot = -1;
+
+    struct IndexEntry {
+        int id{kEmptyId};
+        int32_t slot{kFinishedSlot};  // slab index, or kFinishedSlot for a remembered finished id
+    };
+
+    /** @brief List membership of a slab slot, as of the last reindex(). */
+    struct Links {
+        int32_t prev{-1};
+        int32_t next{-1};
+        int32_t specPrev{-1};
+        int32_t specNext{-1};
+        Stage stage{Stage::OutsideQueue};
+        int specList{-1};
+        int persons{1};
+    };
+
+    struct ListHead {
+        int32_t head{-1};
+        int32_t tail{-1};
+        size_t size{0};
+    };
+
+    /** @brief Specialist list for (type, stage), or -1 when the patient is not at a specialist. */
+    static int specialistList(SpecialistType type, Stage stage);
+
+    size_t bucketFor(int id) const;
+    IndexEntry* lookup(int id);
+    const IndexEntry* lookup(int id) const;
+    void insertIndex(int id, int32_t slot);
+    void eraseIndex(int id);
+    void growIndex();
+    void rememberFinished(int id);
+    void evictStalest();
+    void releaseSlot(int32_t slot);
+    void linkStage(int32_t slot);
+    void unlinkStage(int32_t slot);
+    void linkSpecialist(int32_t slot, int list);
+    void unlinkSpecialist(int32_t slot);
+
+    std::vector<PatientView> slab_;
+    std::vector<uint8_t> slotLive_;
+    std::vector<Links> links_;
+    std::vector<int32_t> freeSlots_;
+    std::vector<IndexEntry> index_;
+    size_t indexUsed_{0};
+    size_t liveCount_{0};
+    std::array<ListHead, kStageCount> stageLists_{};
+    std::array<long, kStageCount> stagePersons_{};
+    std::array<ListHead, kSpecialistCount * 2> specialistLists_{};
+    std::array<int, kFinishedMemory> finishedRing_{};
+    size_t finishedHead_{0};
+    size_t finishedFill_{0};
+    uint64_t finishedCount_{0};
+    uint64_t evictedCount_{0};
+};
@@ -3,6 +3,7 @@
 #include "visualization/state.hpp"
 
 #include <algorithm>
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -18,13 +19,12 @@ std::vector<std::string> wrapTokens(const std::vector<std::string>& tokens, size
 /** @brief Pad/truncate a string to width (ANSI-aware). */
 std::string padded(const std::string& s, size_t width);
 
+/** @brief Keep the limit smallest items by keyFn, sorted; only those are ordered (partial sort). */
 template <typename KeyFn>
 void trimQueue(std::vector<const PatientView*>& items, int limit, KeyFn keyFn) {
     if (limit < 0) return;
-    std::sort(items.begin(), items.end(), [&](const PatientView* a, const PatientView* b) {
-        return keyFn(a) < keyFn(b);
-    });
-    if (static_cast<int>(items.size()) > limit) {
-        items.resize(static_cast<size_t>(limit));
-    }
+    size_t keep = std::min(items.size(), static_cast<size_t>(limit));
+    std::partial_sort(items.begin(), items.begin() + static_cast<std::ptrdiff_t>(keep), items.end(),
+                      [&](const PatientView* a, const PatientView* b) { return keyFn(a) < keyFn(b); });
+    items.resize(keep);
 }
@@ -2,14 +2,19 @@
 
 #include "visualization/state.hpp"
 
+#include <ostream>
+
 /** @brief Render waiting room / triage / entrance overview with live stats. */
-void renderTopSection(const VisualizationState& state);
+void renderTopSection(const VisualizationState& state, std::ostream& out);
 
 /** @brief Render the trailing set of recent log actions. */
-void renderActions(const VisualizationState& state);
+void renderActions(const VisualizationState& state, std::ostream& out);
 
-/** @brief Render specialist queues/active patients and per-specialist stats. */
-void renderSpecialists(const VisualizationState& state);
+/** @brief Render specialist queues/active patients, per-specialist stats and per-doctor utilization. */
+void renderSpecialists(const VisualizationState& state, std::ostream& out);
 
-/** @brief Full frame render: clears screen then draws all sections. */
-void render(const VisualizationState& state);
+/**
+ * @brief Full frame text: all sections, top to bottom, without screen-control sequences
+ * (TerminalCanvas turns it into terminal updates).
+ */
+void renderFrame(const VisualizationState& state, std::ostream& out);
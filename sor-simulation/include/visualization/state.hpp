@@ -2,45 +2,62 @@
 
 #include "model/types.hpp"
 #include "visualization/log_parser.hpp"
+#include "visualization/patient_store.hpp"
 
 #include <array>
-#include <deque>
-#include <map>
+#include <cstdint>
 #include <string>
 #include <vector>
 
-enum class Stage {
-    OutsideQueue,
-    WaitingRoom,
-    RegistrationQueue,
-    TriageQueue,
-    SpecialistQueue,
-    SpecialistActive,
-    Done,
-    SentHome
+/**
+ * @brief Most recent action lines, oldest first; slots are reused so steady-state ingest does not allocate.
+ */
+class ActionRing {
+public:
+    static constexpr size_t kCapacity = 14;
+
+    /** @brief Number of stored lines (at most kCapacity). */
+    size_t size() const { return count_; }
+
+    /** @brief Line i, where 0 is the oldest retained line. */
+    const std::string& operator[](size_t i) const { return slots_[(head_ + i) % kCapacity]; }
+
+    /** @brief Cleared slot for the newest line (overwrites the oldest when full). */
+    std::string& pushSlot() {
+        size_t idx = (head_ + count_) % kCapacity;
+        if (count_ == kCapacity) {
+            head_ = (head_ + 1) % kCapacity;
+        } else {
+            ++count_;
+        }
+        slots_[idx].clear();
+        return slots_[idx];
+    }
+
+private:
+    std::array<std::string, kCapacity> slots_{};
+    size_t head_{0};
+    size_t count_{0};
 };
 
-struct PatientView {
-    int id{0};
+/**
+ * @brief One specialist doctor as seen in the log; busy time is measured in simulated minutes.
+ */
+struct DoctorView {
     int pid{0};
-    int patientPid{0};
-    int persons{1};
-    bool hasGuardian{false};
-    bool isVip{false};
-    TriageColor color{TriageColor::None};
-    SpecialistType specialist{SpecialistType::None};
-    Stage stage{Stage::OutsideQueue};
-    bool registrationInProgress{false};
-    std::string registrationWindow;
-    std::string outcome;
-    int lastSimTime{0};
-    int waitOrder{-1};
-    int regOrder{-1};
-    int triageOrder{-1};
+    int index{0};           // doctor index within the specialty ("doctor N" in the start line)
+    bool onLeave{false};
+    int busySince{-1};      // simTime of the exam in progress, -1 when idle
+    long long busyMinutes{0};
+    int handled{0};
+    int startSim{0};
+
+    /** @brief Busy share of the time since the doctor started, counting an exam in progress. */
+    double utilization(int nowSim) const;
 };
 
 struct VisualizationState {
-    std::map<int, PatientView> patients;
+    PatientStore patients;  // live patients only; finished ones are folded into the counters below
     int waitingCurrent{0};
     int waitingCapacity{0};
     int waitSem{0};
@@ -48,14 +65,13 @@ struct VisualizationState {
     int triageQueue{0};
     int specialistsQueue{0};
     bool reg1Active{false};
-    bool reg2Active{false};
-    bool triageActive{false};
-    std::deque<std::string> lastActions;
+    int poolWindowsOpen{0};  // registration windows 1.. currently open (reg2 "opened"/"parked" lines)
+    int triageWorkersActive{0}; // triage workers between their "Triage started" and "shutting down" lines
+    ActionRing lastActions;
     int waitSeq{0};
     int regSeq{0};
     int triageSeq{0};
-    std::array<int, kSpecialistCount> specialistPids{};
-    std::array<bool, kSpecialistCount> specialistOnLeave{};
+    std::array<std::vector<DoctorView>, kSpecialistCount> doctors; // ordered by doctor index
     std::array<int, kSpecialistCount> specialistHandled{};
     std::array<int, kSpecialistCount> specialistHome{};
     std::array<int, kSpecialistCount> specialistWard{};
@@ -70,8 +86,11 @@ struct VisualizationState {
     int latestSimTime{0};
 };
 
-/** @brief Ensure a PatientView exists for id, returning a reference. */
-PatientView& ensurePatient(VisualizationState& state, int patientId);
+/**
+ * @brief Ensure a PatientView exists for id.
+ * @return the live patient, or nullptr when id belongs to a patient that already finished.
+ */
+PatientView* ensurePatient(VisualizationState& state, int patientId);
 
 /** @brief Apply patient-specific updates derived from a log entry. */
 void applyPatientUpdate(const LogEntry& entry, VisualizationState& state);
@@ -79,5 +98,6 @@ void applyPatientUpdate(const LogEntry& entry, VisualizationState& state);
 /** @brief Apply a log entry to mutate the visualization state. */
 void applyLogEntry(const LogEntry& entry, VisualizationState& state);
 
-/** @brief Collect pointers to patients filtered by stage. */
-std::vector<const PatientView*> collectPatientsByStage(const VisualizationState& state, Stage stage);
+/** @brief Collect up to limit patients of a stage, in the order they entered it. */
+std::vector<const PatientView*> collectPatientsByStage(const VisualizationState& state, Stage stage,
+                                                       size_t limit = SIZE_MAX);
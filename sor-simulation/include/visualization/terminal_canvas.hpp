@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Double-buffered cell grid that turns rendered frame text into minimal terminal updates.
+ *
+ * present() parses a frame (lines of text with SGR colour escapes) into cells, compares them with
+ * the previously presented frame and writes only the changed spans, using cursor moves to skip
+ * unchanged cells, in one write(2). The first frame, and the first after invalidate(), is a full
+ * clear-and-draw.
+ */
+class TerminalCanvas {
+public:
+    /** @brief Output accounting for one presented frame. */
+    struct FrameStats {
+        size_t bytes{0};         // bytes written for this frame
+        size_t fullBytes{0};     // bytes a clear-and-redraw of the same frame would have written
+        size_t changedCells{0};  // cells that differed from the previous frame
+    };
+
+    explicit TerminalCanvas(int fd);
+    ~TerminalCanvas();
+
+    TerminalCanvas(const TerminalCanvas&) = delete;
+    TerminalCanvas& operator=(const TerminalCanvas&) = delete;
+
+    /**
+     * @brief Diff a frame against the previous one and write the changes.
+     * @param frame text lines separated by '\n'; only SGR sequences ("\033[...m") are interpreted.
+     * @return byte and cell counts for the frame.
+     */
+    FrameStats present(std::string_view frame);
+
+    /** @brief Forget the previous frame (e.g. after a terminal resize); the next present() redraws fully. */
+    void invalidate() { valid_ = false; }
+
+    /** @brief Frames presented so far. */
+    uint64_t frames() const { return frames_; }
+
+    /** @brief Bytes written by all presented frames. */
+    uint64_t totalBytes() const { return totalBytes_; }
+
+    /** @brief Bytes the same frames would have cost as full redraws. */
+    uint64_t totalFullBytes() const { return totalFullBytes_; }
+
+private:
+    /** @brief One terminal cell: a glyph (up to one UTF-8 sequence) and an interned style id. */
+    struct Cell {
+        char glyph[4]{' ', 0, 0, 0};
+        uint8_t len{1};
+        uint16_t style{0};
+
+        bool operator==(const Cell& other) const;
+        bool operator!=(const Cell& other) const { return !(*this == other); }
+    };
+
+    using Row = std::vector<Cell>;
+
+    void parse(std::string_view frame, std::vector<Row>& rows);
+    uint16_t internStyle(const std::string& sgr);
+    void emitStyle(uint16_t style);
+    void emitCursor(size_t row, size_t col);
+    bool writeAll();
+
+    int fd_;
+    bool valid_{false};
+    std::vector<Row> front_;  // what the terminal shows
+    std::vector<Row> back_;   // frame being presented
+    std::vector<std::string> styles_{std::string()};
+    std::unordered_map<std::string, uint16_t> styleIds_{{std::string(), 0}};
+    std::string out_;
+    uint16_t outStyle_{0};
+    uint64_t frames_{0};
+    uint64_t totalBytes_{0};
+    uint64_t totalFullBytes_{0};
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+/**
+ * @brief Lock-free single-producer/single-consumer handoff of whole values (triple buffering).
+ *
+ * The writer fills writeBuffer() and publish()es it; the reader acquire()s the newest published
+ * value into readBuffer(). Neither side ever waits for the other, a value is never torn, and the
+ * reader simply skips values that were superseded before it looked. Buffers are reused, so
+ * copy-assigning into writeBuffer() keeps the capacity of their containers.
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    /** @brief Writer's private buffer. */
+    T& writeBuffer() { return buffers_[writeIdx_]; }
+
+    /** @brief Hand writeBuffer() to the reader; the writer continues on a free buffer. */
+    void publish() {
+        writeIdx_ = middle_.exchange(writeIdx_ | kFresh, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    /**
+     * @brief Swap in the newest published value, if any.
+     * @return true when readBuffer() now holds a value the reader has not seen yet.
+     */
+    bool acquire() {
+        if ((middle_.load(std::memory_order_acquire) & kFresh) == 0) {
+            return false;
+        }
+        readIdx_ = middle_.exchange(readIdx_, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+
+    /** @brief Reader's current value (default-constructed until the first acquire()). */
+    const T& readBuffer() const { return buffers_[readIdx_]; }
+
+private:
+    static constexpr unsigned kIndexMask = 3;
+    static constexpr unsigned kFresh = 4;
+
+    std::array<T, 3> buffers_{};
+    alignas(64) unsigned writeIdx_{0};
+    alignas(64) std::atomic<unsigned> middle_{1};
+    alignas(64) unsigned readIdx_{2};
+};
@@ -0,0 +1,210 @@
+#include "des/batch_runner.hpp"
+
+#include "model/specialist_policy.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+namespace {
+/** @brief z value of the two-sided 95% normal interval. */
+constexpr double kZ95 = 1.96;
+
+/** @brief Per-replication values, in the same order as kMetricNames. */
+constexpr const char* kMetricNames[] = {
+    "totalPatients",
+    "triageRed",
+    "triageYellow",
+    "triageGreen",
+    "triageSentHome",
+    "outcomeHome",
+    "outcomeWard",
+    "outcomeOther",
+    "homeRate",
+    "wardRate",
+    "registrationActivations",
+    "peakRegistrationWindows",
+    "peakWaitingRoom",
+    "waitingRoomSaturation",
+    "peakOutsideQueue",
+    "peakRegistrationQueue",
+    "queueRegistrationAtEnd",
+    "examsPerSecond",
+    "redQueueWaitP99Ms",
+    "yellowQueueWaitP99Ms",
+    "greenQueueWaitP99Ms",
+};
+constexpr size_t kMetricCount = sizeof(kMetricNames) / sizeof(kMetricNames[0]);
+
+using RunValues = std::array<double, kMetricCount>;
+
+/** @brief Ratio that stays 0 for an empty denominator. */
+double ratio(int num, int den) {
+    return den > 0 ? static_cast<double>(num) / static_cast<double>(den) : 0.0;
+}
+
+/** @brief Openings of the on-demand registration windows (window 0 is open from the start). */
+int extraWindowActivations(const SummaryPayload& s) {
+    int total = 0;
+    for (size_t i = 1; i < s.registrationWindows.size(); ++i) {
+        total += s.registrationWindows[i].activations;
+    }
+    return total;
+}
+
+/** @brief p99 specialist queue wait of one colour in milliseconds. */
+double colorWaitP99Ms(const SummaryPayload& s, TriageColor color) {
+    int cls = static_cast<int>(QueueClass::SpecialistRed) + static_cast<int>(color);
+    return static_cast<double>(s.latency.queueWait[cls].p99Us) / 1000.0;
+}
+
+/** @brief Flatten one replication into the metric vector. */
+RunValues extractValues(const DesResult& result, int capacity) {
+    const SummaryPayload& s = result.summary;
+    int disposed = s.outcomeHome + s.outcomeWard + s.outcomeOther;
+    return RunValues{
+        static_cast<double>(s.totalPatients),
+        static_cast<double>(s.triageRed),
+        static_cast<double>(s.triageYellow),
+        static_cast<double>(s.triageGreen),
+        static_cast<double>(s.triageSentHome),
+        static_cast<double>(s.outcomeHome),
+        static_cast<double>(s.outcomeWard),
+        static_cast<double>(s.outcomeOther),
+        ratio(s.outcomeHome, disposed),
+        ratio(s.outcomeWard, disposed),
+        static_cast<double>(extraWindowActivations(s)),
+        static_cast<double>(s.peakOpenRegistrationWindows),
+        static_cast<double>(result.peakWaitingRoom),
+        ratio(result.peakWaitingRoom, capacity),
+        static_cast<double>(result.peakOutsideQueue),
+        static_cast<double>(result.peakRegistrationQueue),
+        static_cast<double>(s.queueRegistrationLen),
+        examThroughput(s),
+        colorWaitP99Ms(s, TriageColor::Red),
+        colorWaitP99Ms(s, TriageColor::Yellow),
+        colorWaitP99Ms(s, TriageColor::Green),
+    };
+}
+
+/** @brief Nearest-rank percentile of an already sorted sample. */
+double percentile(const std::vector<double>& sorted, double pct) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t rank = static_cast<size_t>(std::ceil(pct / 100.0 * static_cast<double>(sorted.size())));
+    rank = std::min(std::max<size_t>(rank, 1), sorted.size());
+    return sorted[rank - 1];
+}
+
+/** @brief Mean, sample deviation, CI and percentiles of one metric column. */
+MetricStats summarize(const char* name, std::vector<double> values) {
+    MetricStats stats;
+    stats.name = name;
+    if (values.empty()) {
+        return stats;
+    }
+    double sum = 0.0;
+    for (double v : values) {
+        sum += v;
+    }
+    double n = static_cast<double>(values.size());
+    stats.mean = sum / n;
+    if (values.size() > 1) {
+        double sq = 0.0;
+        for (double v : values) {
+            sq += (v - stats.mean) * (v - stats.mean);
+        }
+        stats.stddev = std::sqrt(sq / (n - 1.0));
+        stats.ci95Half = kZ95 * stats.stddev / std::sqrt(n);
+    }
+    std::sort(values.begin(), values.end());
+    stats.min = values.front();
+    stats.p5 = percentile(values, 5.0);
+    stats.p50 = percentile(values, 50.0);
+    stats.p95 = percentile(values, 95.0);
+    stats.max = values.back();
+    return stats;
+}
+} // namespace
+
+BatchResult runBatch(const Config& config, const BatchOptions& options) {
+    BatchResult result;
+    result.firstSeed = options.firstSeed;
+    result.lastSeed = std::max(options.firstSeed, options.lastSeed);
+    result.horizonMs = options.horizonMs;
+    result.runs = static_cast<int>(result.lastSeed - result.firstSeed) + 1;
+    result.specialistPolicy = specialistPolicyName(static_cast<SpecialistPolicyKind>(config.specialistPolicy));
+    result.jobs = std::max(1, std::min(options.jobs, result.runs));
+
+    std::vector<RunValues> values(static_cast<size_t>(result.runs));
+    std::vector<long long> events(static_cast<size_t>(result.runs), 0);
+    std::atomic<int> nextRun{0};
+
+    // Each worker claims the next seed; results land in per-seed slots so the merge is deterministic.
+    auto worker = [&]() {
+        for (int idx = nextRun.fetch_add(1); idx < result.runs; idx = nextRun.fetch_add(1)) {
+            Config runConfig = config;
+            runConfig.randomSeed = result.firstSeed + static_cast<unsigned int>(idx);
+            DesEngine engine(runConfig);
+            DesResult run = engine.run(DesOptions{options.horizonMs});
+            values[static_cast<size_t>(idx)] = extractValues(run, config.N_waitingRoom);
+            events[static_cast<size_t>(idx)] = run.eventsProcessed;
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    threads.reserve(static_cast<size_t>(result.jobs - 1));
+    for (int i = 1; i < result.jobs; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : threads) {
+        t.join();
+    }
+    result.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    for (long long e : events) {
+        result.totalEvents += e;
+    }
+    result.metrics.reserve(kMetricCount);
+    for (size_t m = 0; m < kMetricCount; ++m) {
+        std::vector<double> column;
+        column.reserve(values.size());
+        for (const RunValues& run : values) {
+            column.push_back(run[m]);
+        }
+        result.metrics.push_back(summarize(kMetricNames[m], std::move(column)));
+    }
+    return result;
+}
+
+bool writeBatchReport(const BatchResult& result, std::ostream& out) {
+    out << "SOR batch summary\n";
+    out << "=================\n";
+    out << "Engine: discrete-event (virtual clock)\n";
+    out << "Replications: " << result.runs << " (seeds " << result.firstSeed << ".." << result.lastSeed << ")\n";
+    out << "Jobs: " << result.jobs << "\n";
+    out << "Specialist policy: " << result.specialistPolicy << "\n";
+    out << "Horizon per run (virtual ms): " << result.horizonMs << "\n";
+    out << "Events processed: " << result.totalEvents << "\n";
+    out << "Wall time (ms): " << static_cast<long long>(result.wallMs) << "\n";
+    out << "Confidence interval: mean +/- 1.96 * s / sqrt(n); percentiles are nearest-rank\n\n";
+
+    char line[256];
+    std::snprintf(line, sizeof(line), "%-24s %12s %12s %12s %10s %10s %10s %10s %10s\n", "metric", "mean", "ci95-",
+                  "ci95+", "min", "p5", "p50", "p95", "max");
+    out << line;
+    for (const MetricStats& m : result.metrics) {
+        std::snprintf(line, sizeof(line), "%-24s %12.4f %12.4f %12.4f %10.4g %10.4g %10.4g %10.4g %10.4g\n",
+                      m.name.c_str(), m.mean, m.mean - m.ci95Half, m.mean + m.ci95Half, m.min, m.p5, m.p50, m.p95,
+                      m.max);
+        out << line;
+    }
+    return static_cast<bool>(out);
+}
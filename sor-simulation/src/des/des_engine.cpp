@@ -0,0 +1,571 @@
+#include "des/des_engine.hpp"
+
+#include "model/aging_policy.hpp"
+#include "model/latency.hpp"
+#include "model/metrics.hpp"
+#include "model/registration_policy.hpp"
+#include "model/sim_rules.hpp"
+#include "model/specialist_policy.hpp"
+#include "model/types.hpp"
+#include "util/random.hpp"
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <queue>
+#include <vector>
+
+namespace {
+constexpr int kUsr1IntervalMs = 1000;     // SIGUSR1 roll period
+constexpr int kUsr1ChancePercent = 5;
+constexpr size_t kMaxOutsidePatients = 2000; // generator child cap
+constexpr int kGeneratorBackoffMs = 50;
+
+enum class DesEventKind {
+    Arrival,
+    RegistrationDone,
+    TriageDone,
+    ExamDone,
+    LeaveDone,
+    RegistrationTick,
+    Usr1Tick,
+    SeriesTick
+};
+
+struct DesEvent {
+    long long timeMs;
+    long long seq;     // insertion order breaks ties deterministically
+    DesEventKind kind;
+    int index;         // window / triage worker index, or specialty * kMaxDoctorsPerSpecialty + doctor
+    int patient;       // index into the patient table (-1 when unused)
+};
+
+/** @brief Min-heap ordering on (time, seq). */
+struct LaterFirst {
+    bool operator()(const DesEvent& a, const DesEvent& b) const {
+        if (a.timeMs != b.timeMs) return a.timeMs > b.timeMs;
+        return a.seq > b.seq;
+    }
+};
+
+struct DesPatient {
+    PatientTraits traits;
+    TriageColor color{TriageColor::None};
+    HopStamps hops;       // virtual-clock stamps (see DesRun::stampNs)
+    long long examStartNs{0};
+};
+
+/** @brief Patient taken from a ClassQueue with the class and virtual time it was queued at. */
+struct ClassQueueEntry {
+    int patient{-1};
+    int cls{0};
+    long long queuedMs{0};
+};
+
+/**
+ * @brief Per-class FIFOs mirroring the priority mtypes of one IPC queue (VIP/normal or
+ * red/yellow/green); pop applies the same aging rules as receiveAged, take serves a class
+ * chosen by the caller the way receiveClass does.
+ */
+template <int Classes>
+struct ClassQueue {
+    std::array<std::deque<ClassQueueEntry>, Classes> byClass;
+
+    void push(int p, int cls, long long nowMs) { byClass[cls].push_back(ClassQueueEntry{p, cls, nowMs}); }
+    bool empty() const {
+        for (const auto& q : byClass) {
+            if (!q.empty()) return false;
+        }
+        return true;
+    }
+    int size() const {
+        int total = 0;
+        for (const auto& q : byClass) total += static_cast<int>(q.size());
+        return total;
+    }
+    /** @brief Depth and head wait of every class (-1 for an empty class). */
+    void headState(long long nowMs, long long* queued, long long* headAgeMs) const {
+        for (int c = 0; c < Classes; ++c) {
+            queued[c] = static_cast<long long>(byClass[c].size());
+            headAgeMs[c] = byClass[c].empty() ? -1 : nowMs - byClass[c].front().queuedMs;
+        }
+    }
+    ClassQueueEntry pop(long long nowMs, const AgingPolicy& policy) {
+        int cls = -1;
+        if (policy.enabled()) {
+            long long queued[Classes];
+            long long headAgeMs[Classes];
+            headState(nowMs, queued, headAgeMs);
+            cls = pickAgedClass(headAgeMs, Classes, policy);
+        }
+        return take(cls);
+    }
+    /** @brief Head of class cls, or of the first non-empty class when cls is negative or empty. */
+    ClassQueueEntry take(int cls) {
+        if (cls < 0 || byClass[cls].empty()) {
+            cls = 0;
+            while (cls < Classes - 1 && byClass[cls].empty()) ++cls;
+        }
+        ClassQueueEntry entry = byClass[cls].front();
+        byClass[cls].pop_front();
+        return entry;
+    }
+};
+
+/** @brief Registration and triage queue: class 0 VIP, class 1 normal. */
+using VipQueue = ClassQueue<2>;
+
+enum class SpecialistState { Idle, Busy, OnLeave };
+
+struct DesDoctor {
+    SpecialistState state{SpecialistState::Idle};
+    int patient{-1};  // patient in the current exam
+    bool leaveRequested{false};
+    long long examStartMs{0};
+    long long leaveStartMs{0};
+    RandomGenerator rng;
+    SpecialistScheduler scheduler;
+    DoctorSummary stats;
+
+    DesDoctor(unsigned int seed, const SpecialistScheduler& scheduler) : rng(seed), scheduler(scheduler) {}
+};
+
+/** @brief One specialty: a shared queue served by its doctors (lowest idle index first). */
+struct DesSpecialist {
+    ClassQueue<3> queue; // red, yellow, green
+    std::vector<DesDoctor> doctors;
+};
+
+struct DesTriageWorker {
+    bool busy{false};
+    long long servingSinceMs{0};
+    TriageWorkerSummary stats;
+};
+
+struct RegistrationWindow {
+    bool active{false};
+    bool busy{false};
+    long long servingSinceMs{0};
+    long long openedAtMs{0};
+    RegistrationWindowSummary stats;
+};
+
+/**
+ * @brief Mutable state of one replication; the engine object itself stays const and reusable.
+ */
+class DesRun {
+public:
+    DesRun(const Config& cfg, long long horizonMs)
+        : cfg_(cfg),
+          horizonMs_(horizonMs),
+          genRng_(cfg.randomSeed),
+          triageRng_(triageSeed(cfg.randomSeed, 0)),
+          directorRng_(directorSeed(cfg.randomSeed)),
+          scaler_(RegistrationPolicy{cfg.registrationWindowsMax, cfg.K_registrationThreshold, cfg.N_waitingRoom / 3,
+                                     cfg.registrationScaleCooldownMs}) {
+        regMs_ = scaleAllowZeroMs(cfg.registrationServiceMs, cfg.timeScaleMsPerSimMinute);
+        triageMs_ = scaleAllowZeroMs(cfg.triageServiceMs, cfg.timeScaleMsPerSimMinute);
+        examMin_ = scaleAtLeastOneMs(cfg.specialistExamMinMs, cfg.timeScaleMsPerSimMinute);
+        examMax_ = scaleAtLeastOneMs(cfg.specialistExamMaxMs, cfg.timeScaleMsPerSimMinute);
+        if (examMax_ < examMin_) examMax_ = examMin_;
+        leaveMin_ = scaleAtLeastOneMs(cfg.specialistLeaveMinMs, cfg.timeScaleMsPerSimMinute);
+        leaveMax_ = scaleAtLeastOneMs(cfg.specialistLeaveMaxMs, cfg.timeScaleMsPerSimMinute);
+        if (leaveMax_ < leaveMin_) leaveMax_ = leaveMin_;
+        genMin_ = scaleIntervalMs(cfg.patientGenMinMs, cfg.timeScaleMsPerSimMinute);
+        genMax_ = scaleIntervalMs(cfg.patientGenMaxMs, cfg.timeScaleMsPerSimMinute);
+        if (genMax_ < genMin_) genMax_ = genMin_;
+        freeSeats_ = cfg.N_waitingRoom;
+        vipAging_ = vipQueueAgingPolicy(cfg);
+        colorAging_ = colorQueueAgingPolicy(cfg);
+        specialistPolicy_ = specialistPolicyFromConfig(cfg);
+        // Doctor 0 keeps the single-specialist seed so runs with one doctor per specialty replay unchanged.
+        specialists_.resize(kSpecialistCount);
+        for (int i = 0; i < kSpecialistCount; ++i) {
+            for (int d = 0; d < cfg.specialistDoctors[i]; ++d) {
+                specialists_[i].doctors.emplace_back(
+                    doctorSeed(cfg.randomSeed, static_cast<SpecialistType>(i), d),
+                    SpecialistScheduler(specialistPolicy_, colorAging_));
+            }
+            doctorTotal_ += cfg.specialistDoctors[i];
+        }
+        openWindow(0);
+        summary_.queueSeries = QueueTimeSeries(cfg.timeSeriesIntervalMs);
+    }
+
+    DesResult run() {
+        auto wallStart = std::chrono::steady_clock::now();
+        schedule(0, DesEventKind::Arrival, 0, -1);
+        schedule(cfg_.registrationScaleIntervalMs, DesEventKind::RegistrationTick, 0, -1);
+        schedule(kUsr1IntervalMs, DesEventKind::Usr1Tick, 0, -1);
+        if (cfg_.timeSeriesIntervalMs > 0) {
+            schedule(0, DesEventKind::SeriesTick, 0, -1);
+        }
+
+        while (!calendar_.empty()) {
+            DesEvent ev = calendar_.top();
+            if (ev.timeMs > horizonMs_) break;
+            calendar_.pop();
+            nowMs_ = ev.timeMs;
+            result_.eventsProcessed += 1;
+            dispatch(ev);
+        }
+        nowMs_ = horizonMs_;
+
+        fillSummary();
+        auto wallEnd = std::chrono::steady_clock::now();
+        result_.wallMs = std::chrono::duration<double, std::milli>(wallEnd - wallStart).count();
+        return result_;
+    }
+
+private:
+    /** @brief Virtual clock as a hop stamp; shifted by 1 ms so 0 keeps meaning "hop not reached". */
+    long long stampNs() const { return stampNs(nowMs_); }
+    static long long stampNs(long long timeMs) { return (timeMs + 1) * 1000000LL; }
+
+    void recordQueueWait(QueueClass first, const ClassQueueEntry& entry) {
+        latency_->recordQueueWait(static_cast<QueueClass>(static_cast<int>(first) + entry.cls),
+                                  stampNs(entry.queuedMs), stampNs());
+    }
+
+    void schedule(long long delayMs, DesEventKind kind, int index, int patient) {
+        calendar_.push(DesEvent{nowMs_ + delayMs, nextSeq_++, kind, index, patient});
+    }
+
+    void dispatch(const DesEvent& ev) {
+        switch (ev.kind) {
+            case DesEventKind::Arrival: onArrival(); break;
+            case DesEventKind::RegistrationDone: onRegistrationDone(ev.index, ev.patient); break;
+            case DesEventKind::TriageDone: onTriageDone(ev.index, ev.patient); break;
+            case DesEventKind::ExamDone: onExamDone(ev.index); break;
+            case DesEventKind::LeaveDone: onLeaveDone(ev.index); break;
+            case DesEventKind::RegistrationTick: onRegistrationTick(); break;
+            case DesEventKind::Usr1Tick: onUsr1Tick(); break;
+            case DesEventKind::SeriesTick: onSeriesTick(); break;
+        }
+    }
+
+    // Generator: one patient per interval; blocks (retries) while too many patients wait outside.
+    void onArrival() {
+        if (outside_.size() >= kMaxOutsidePatients) {
+            schedule(kGeneratorBackoffMs, DesEventKind::Arrival, 0, -1);
+            return;
+        }
+        DesPatient patient;
+        patient.traits = drawPatientTraits(genRng_);
+        patient.hops.doorNs = stampNs();
+        patients_.push_back(patient);
+        result_.patientsGenerated += 1;
+        outside_.push_back(static_cast<int>(patients_.size()) - 1);
+        if (static_cast<int>(outside_.size()) > result_.peakOutsideQueue) {
+            result_.peakOutsideQueue = static_cast<int>(outside_.size());
+        }
+        admitFromOutside();
+        schedule(genRng_.uniformInt(genMin_, genMax_), DesEventKind::Arrival, 0, -1);
+    }
+
+    // Waiting room: FIFO admission, a guardian+child pair takes both seats at once.
+    void admitFromOutside() {
+        while (!outside_.empty()) {
+            int p = outside_.front();
+            int persons = patients_[p].traits.personsCount;
+            if (persons > freeSeats_) break;
+            outside_.pop_front();
+            patients_[p].hops.waitingRoomNs = stampNs();
+            latency_->recordHop(LatencyStage::DoorToWaitingRoom, patients_[p].hops.doorNs,
+                                patients_[p].hops.waitingRoomNs);
+            freeSeats_ -= persons;
+            inWaitingRoom_ += persons;
+            totalPatients_ += 1;
+            if (inWaitingRoom_ > result_.peakWaitingRoom) result_.peakWaitingRoom = inWaitingRoom_;
+            registrationQueue_.push(p, patients_[p].traits.isVip ? 0 : 1, nowMs_);
+            if (registrationQueue_.size() > result_.peakRegistrationQueue) {
+                result_.peakRegistrationQueue = registrationQueue_.size();
+            }
+        }
+        startRegistration();
+    }
+
+    void startRegistration() {
+        for (int w = 0; w < openWindows_; ++w) {
+            RegistrationWindow& window = windows_[w];
+            if (window.busy || registrationQueue_.empty()) continue;
+            window.busy = true;
+            window.servingSinceMs = nowMs_;
+            ClassQueueEntry entry = registrationQueue_.pop(nowMs_, vipAging_);
+            recordQueueWait(QueueClass::RegistrationVip, entry);
+            int p = entry.patient;
+            HopStamps& hops = patients_[p].hops;
+            hops.registrationNs = stampNs();
+            latency_->recordHop(LatencyStage::WaitingRoomToRegistration, hops.waitingRoomNs, hops.registrationNs);
+            schedule(regMs_, DesEventKind::RegistrationDone, w, p);
+        }
+    }
+
+    // Registration forwards to triage and frees the patient's seats.
+    void onRegistrationDone(int window, int p) {
+        RegistrationWindow& w = windows_[window];
+        w.busy = false;
+        w.stats.patients += 1;
+        w.stats.busyMs += nowMs_ - w.servingSinceMs;
+        const PatientTraits& traits = patients_[p].traits;
+        triageQueue_.push(p, traits.isVip ? 0 : 1, nowMs_);
+        freeSeats_ += traits.personsCount;
+        inWaitingRoom_ -= traits.personsCount;
+        admitFromOutside();
+        startTriage();
+    }
+
+    // Idle workers take patients in index order; decisions share one RNG drawn in event order.
+    void startTriage() {
+        for (int w = 0; w < cfg_.triageWorkers && !triageQueue_.empty(); ++w) {
+            DesTriageWorker& worker = triageWorkers_[w];
+            if (worker.busy) continue;
+            worker.busy = true;
+            worker.servingSinceMs = nowMs_;
+            ClassQueueEntry entry = triageQueue_.pop(nowMs_, vipAging_);
+            recordQueueWait(QueueClass::TriageVip, entry);
+            int p = entry.patient;
+            HopStamps& hops = patients_[p].hops;
+            hops.triageNs = stampNs();
+            latency_->recordHop(LatencyStage::RegistrationToTriage, hops.registrationNs, hops.triageNs);
+            schedule(triageMs_, DesEventKind::TriageDone, w, p);
+        }
+    }
+
+    void onTriageDone(int w, int p) {
+        DesTriageWorker& worker = triageWorkers_[w];
+        worker.busy = false;
+        worker.stats.busyMs += nowMs_ - worker.servingSinceMs;
+        if (rollSentHomeFromTriage(triageRng_)) {
+            summary_.triageSentHome += 1;
+            worker.stats.sentHome += 1;
+        } else {
+            TriageColor color = pickColor(triageRng_);
+            switch (color) {
+                case TriageColor::Red: summary_.triageRed += 1; worker.stats.red += 1; break;
+                case TriageColor::Yellow: summary_.triageYellow += 1; worker.stats.yellow += 1; break;
+                default: summary_.triageGreen += 1; worker.stats.green += 1; break;
+            }
+            int spec = static_cast<int>(pickSpecialist(triageRng_));
+            patients_[p].color = color;
+            specialists_[spec].queue.push(p, colorPriority(color) - 1, nowMs_);
+            startExam(spec);
+        }
+        startTriage();
+    }
+
+    void startExam(int spec) {
+        DesSpecialist& s = specialists_[spec];
+        for (size_t d = 0; d < s.doctors.size() && !s.queue.empty(); ++d) {
+            DesDoctor& doctor = s.doctors[d];
+            if (doctor.state != SpecialistState::Idle) continue;
+            long long queued[kTriageColorCount];
+            long long headAgeMs[kTriageColorCount];
+            s.queue.headState(nowMs_, queued, headAgeMs);
+            ClassQueueEntry entry = s.queue.take(doctor.scheduler.pick(queued, headAgeMs));
+            doctor.scheduler.noteServed(entry.cls);
+            recordQueueWait(QueueClass::SpecialistRed, entry);
+            doctor.patient = entry.patient;
+            DesPatient& patient = patients_[doctor.patient];
+            patient.examStartNs = stampNs();
+            latency_->recordHop(LatencyStage::TriageToSpecialist, patient.hops.triageNs, patient.examStartNs);
+            doctor.state = SpecialistState::Busy;
+            doctor.examStartMs = nowMs_;
+            schedule(colorExamMs(specialistPolicy_, patient.color, doctor.rng.uniformInt(examMin_, examMax_)),
+                     DesEventKind::ExamDone,
+                     spec * kMaxDoctorsPerSpecialty + static_cast<int>(d), -1);
+        }
+    }
+
+    void onExamDone(int index) {
+        int spec = index / kMaxDoctorsPerSpecialty;
+        DesDoctor& doctor = specialists_[spec].doctors[index % kMaxDoctorsPerSpecialty];
+        const DesPatient& patient = patients_[doctor.patient];
+        latency_->recordExam(patient.hops, patient.examStartNs, stampNs(), static_cast<int>(patient.color), spec);
+        switch (pickOutcome(doctor.rng)) {
+            case Outcome::Home: summary_.outcomeHome += 1; break;
+            case Outcome::Ward: summary_.outcomeWard += 1; break;
+            default: summary_.outcomeOther += 1; break;
+        }
+        doctor.stats.exams += 1;
+        doctor.stats.busyMs += nowMs_ - doctor.examStartMs;
+        doctor.state = SpecialistState::Idle;
+        if (doctor.leaveRequested) {
+            startLeave(index);
+            return;
+        }
+        startExam(spec);
+    }
+
+    // SIGUSR1: the doctor finishes the current exam, then steps out for leaveMin..leaveMax.
+    void startLeave(int index) {
+        DesDoctor& doctor = specialists_[index / kMaxDoctorsPerSpecialty].doctors[index % kMaxDoctorsPerSpecialty];
+        doctor.leaveRequested = false;
+        doctor.state = SpecialistState::OnLeave;
+        doctor.leaveStartMs = nowMs_;
+        schedule(doctor.rng.uniformInt(leaveMin_, leaveMax_), DesEventKind::LeaveDone, index, -1);
+    }
+
+    void onLeaveDone(int index) {
+        int spec = index / kMaxDoctorsPerSpecialty;
+        DesDoctor& doctor = specialists_[spec].doctors[index % kMaxDoctorsPerSpecialty];
+        doctor.state = SpecialistState::Idle;
+        doctor.stats.leaves += 1;
+        doctor.stats.leaveMs += nowMs_ - doctor.leaveStartMs;
+        startExam(spec);
+    }
+
+    // Windows open in index order and park from the highest index, like the director's pool.
+    void openWindow(int w) {
+        RegistrationWindow& window = windows_[w];
+        window.active = true;
+        window.openedAtMs = nowMs_;
+        window.stats.activations += 1;
+        openWindows_ = w + 1;
+        if (openWindows_ > summary_.peakOpenRegistrationWindows) summary_.peakOpenRegistrationWindows = openWindows_;
+    }
+
+    void closeWindow(int w) {
+        RegistrationWindow& window = windows_[w];
+        window.active = false;
+        window.stats.openMs += nowMs_ - window.openedAtMs;
+        openWindows_ = w;
+    }
+
+    // Director's registration pool policy; a parked window still forwards the patient it holds.
+    void onRegistrationTick() {
+        int decision = scaler_.update(nowMs_, registrationQueue_.size(), openWindows_);
+        if (decision > 0) {
+            openWindow(openWindows_);
+            startRegistration();
+        } else if (decision < 0) {
+            closeWindow(openWindows_ - 1);
+        }
+        schedule(cfg_.registrationScaleIntervalMs, DesEventKind::RegistrationTick, 0, -1);
+    }
+
+    void onUsr1Tick() {
+        // Like the director: one doctor drawn uniformly over all specialties' doctors.
+        if (directorRng_.uniformInt(0, 99) < kUsr1ChancePercent) {
+            int pick = directorRng_.uniformInt(0, doctorTotal_ - 1);
+            int spec = 0;
+            while (pick >= static_cast<int>(specialists_[spec].doctors.size())) {
+                pick -= static_cast<int>(specialists_[spec].doctors.size());
+                ++spec;
+            }
+            DesDoctor& doctor = specialists_[spec].doctors[pick];
+            if (doctor.state == SpecialistState::Idle) {
+                startLeave(spec * kMaxDoctorsPerSpecialty + pick);
+            } else if (doctor.state == SpecialistState::Busy) {
+                doctor.leaveRequested = true;
+            }
+        }
+        schedule(kUsr1IntervalMs, DesEventKind::Usr1Tick, 0, -1);
+    }
+
+    // Same figures the process-mode director samples; waitSem is the number of free seats.
+    void onSeriesTick() {
+        MetricsSnapshot metrics;
+        metrics.waitingInside = inWaitingRoom_;
+        metrics.waitingCapacity = cfg_.N_waitingRoom;
+        metrics.registrationQueueLen = registrationQueue_.size();
+        metrics.triageQueueLen = triageQueue_.size();
+        for (const DesSpecialist& s : specialists_) {
+            metrics.specialistsQueueLen += s.queue.size();
+        }
+        metrics.waitSemaphoreValue = freeSeats_;
+        summary_.queueSeries.record(nowMs_, metrics, summary_.outcomeHome + summary_.outcomeWard +
+                                                         summary_.outcomeOther + summary_.triageSentHome);
+        schedule(cfg_.timeSeriesIntervalMs, DesEventKind::SeriesTick, 0, -1);
+    }
+
+    void fillSummary() {
+        summary_.discreteEvent = true;
+        summary_.totalPatients = totalPatients_;
+        summary_.waitingRoomCapacity = cfg_.N_waitingRoom;
+        summary_.queueRegistrationLen = registrationQueue_.size();
+        summary_.timeScaleMsPerSimMinute = cfg_.timeScaleMsPerSimMinute;
+        summary_.simulationDurationMinutes = cfg_.simulationDurationMinutes;
+        long long simulatedMinutes = nowMs_ / cfg_.timeScaleMsPerSimMinute;
+        long long remainderMs = nowMs_ % cfg_.timeScaleMsPerSimMinute;
+        summary_.simulatedSeconds = simulatedMinutes * 60 + (remainderMs * 60) / cfg_.timeScaleMsPerSimMinute;
+        summary_.latency = latency_->report();
+        for (int w = 0; w < cfg_.registrationWindowsMax; ++w) {
+            RegistrationWindow& window = windows_[w];
+            if (window.active) window.stats.openMs += nowMs_ - window.openedAtMs;
+            summary_.registrationWindows.push_back(window.stats);
+        }
+        summary_.elapsedMs = nowMs_;
+        summary_.specialistPolicy = specialistPolicyName(specialistPolicy_.policyKind());
+        for (int w = 0; w < cfg_.triageWorkers; ++w) {
+            summary_.triageWorkers.push_back(triageWorkers_[w].stats);
+        }
+        for (int i = 0; i < kSpecialistCount; ++i) {
+            for (const DesDoctor& doctor : specialists_[i].doctors) {
+                summary_.doctors[i].push_back(doctor.stats);
+            }
+        }
+        result_.summary = summary_;
+    }
+
+    const Config& cfg_;
+    long long horizonMs_;
+    long long nowMs_{0};
+    long long nextSeq_{0};
+    std::priority_queue<DesEvent, std::vector<DesEvent>, LaterFirst> calendar_;
+
+    RandomGenerator genRng_;
+    RandomGenerator triageRng_;
+    RandomGenerator directorRng_;
+    RegistrationScaler scaler_;
+
+    int regMs_{0};
+    int triageMs_{0};
+    int examMin_{0};
+    int examMax_{0};
+    int leaveMin_{0};
+    int leaveMax_{0};
+    int genMin_{0};
+    int genMax_{0};
+
+    std::vector<DesPatient> patients_;
+    std::deque<int> outside_;
+    int freeSeats_{0};
+    int inWaitingRoom_{0};
+    int totalPatients_{0};
+    VipQueue registrationQueue_;
+    std::array<RegistrationWindow, kMaxRegistrationWindows> windows_{};
+    int openWindows_{0};
+    VipQueue triageQueue_;
+    std::array<DesTriageWorker, kMaxTriageWorkers> triageWorkers_{};
+    std::vector<DesSpecialist> specialists_;
+    int doctorTotal_{0};
+    AgingPolicy vipAging_;
+    AgingPolicy colorAging_;
+    SpecialistPolicy specialistPolicy_;
+
+    // Heap-allocated: the histograms are ~250 KB and batch replications run on worker threads.
+    std::unique_ptr<LatencyHistograms> latency_{std::make_unique<LatencyHistograms>()};
+    SummaryPayload summary_;
+    DesResult result_;
+};
+} // namespace
+
+DesEngine::DesEngine(const Config& config) : config_(config) {}
+
+DesResult DesEngine::run(const DesOptions& options) const {
+    DesRun run(config_, options.horizonMs);
+    return run.run();
+}
+
+long long DesEngine::defaultHorizonMs(const Config& config, int simMinutesOverride) {
+    if (simMinutesOverride > 0) {
+        return static_cast<long long>(simMinutesOverride) * config.timeScaleMsPerSimMinute;
+    }
+    if (config.simulationDurationMinutes > 0) {
+        // The process mode stops after this many wall-clock minutes; replay the same span virtually.
+        return static_cast<long long>(config.simulationDurationMinutes) * 60000LL;
+    }
+    return 24LL * 60 * config.timeScaleMsPerSimMinute; // one simulated day
+}
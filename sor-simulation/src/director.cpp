@@ -1,13 +1,19 @@
 #include "director.hpp"
 
+#include "ipc/log_ring.hpp"
 #include "ipc/message_queue.hpp"
+#include "ipc/run_namespace.hpp"
 #include "ipc/semaphore.hpp"
 #include "ipc/shared_memory.hpp"
+#include "logging/binary_log.hpp"
 #include "logging/logger.hpp"
 #include "model/config.hpp"
 #include "model/events.hpp"
+#include "model/registration_policy.hpp"
 #include "model/shared_state.hpp"
+#include "model/sim_rules.hpp"
 #include "model/types.hpp"
+#include "report/summary.hpp"
 #include "roles/triage.hpp"
 #include "roles/specialist.hpp"
 #include "util/error.hpp"
@@ -18,7 +24,10 @@
 #include <sys/sem.h>
 #include <sys/shm.h>
 #include <sys/wait.h>
+#include <cerrno>
+#include <cstdio>
 #include <cstring>
+#include <new>
 #include <ctime>
 #include <string>
 #include <vector>
@@ -27,22 +36,23 @@
 #include <chrono>
 #include <thread>
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <array>
 
 namespace {
-constexpr int kDefaultTimeScaleMsPerSimMinute = 20;
-
 struct IpcIds {
     int logQueue{-1};
-    int regQueue{-1};
-    int triageQueue{-1};
-    std::array<int, kSpecialistCount> specialistsQueue{};
+    LogRingArena logRings;
+    MessageQueue regQueue;
+    MessageQueue triageQueue;
+    std::array<MessageQueue, kSpecialistCount> specialistsQueue;
     int shmId{-1};
     int semWaitingRoom{-1};
-    int semSharedState{-1};
+    Semaphore registrationGate;
 };
 
 std::atomic<bool> stopRequested(false);
@@ -83,128 +93,77 @@ int realMinutesFrom(long long startMs) {
     return static_cast<int>(delta / 60000); // 60s * 1000ms
 }
 
-/** @brief Set up logger/registration/triage/specialist queues, clearing stale ones and tuning capacity. */
-bool createQueues(const std::string& keyPath, IpcIds& ids) {
+/** @brief Set up logger/registration/triage/specialist queues on the run's keys and tune capacity. */
+bool createQueues(const RunNamespace& ns, const Config& cfg, IpcIds& ids) {
     MessageQueue logQ;
-    MessageQueue regQ;
-    MessageQueue triQ;
-    std::array<MessageQueue, kSpecialistCount> specQs;
 
-    key_t logKey = ftok(keyPath.c_str(), 'L');
-    key_t regKey = ftok(keyPath.c_str(), 'R');
-    key_t triKey = ftok(keyPath.c_str(), 'T');
+    // Keys are unique to this run (RunNamespace), so nothing here can belong to another instance.
+    key_t logKey = ns.key(kLogKeyId);
+    key_t regKey = ns.key(kRegistrationKeyId);
+    key_t triKey = ns.key(kTriageKeyId);
     std::array<key_t, kSpecialistCount> specKeys;
     for (int i = 0; i < kSpecialistCount; ++i) {
-        specKeys[i] = ftok(keyPath.c_str(), 'A' + i);
-    }
-    if (logKey == -1 || regKey == -1 || triKey == -1) {
-        logErrno("ftok failed");
-        return false;
-    }
-    for (int i = 0; i < kSpecialistCount; ++i) {
-        if (specKeys[i] == -1) {
-            logErrno("ftok failed for specialist queue");
-            return false;
-        }
+        specKeys[i] = ns.key(static_cast<char>(kFirstSpecialistKeyId + i));
     }
 
-    // Best effort: remove stale queues from previous crashed runs.
-    auto removeIfExists = [](key_t key) {
-        int qid = msgget(key, 0);
-        if (qid != -1) {
-            msgctl(qid, IPC_RMID, nullptr);
+    // Pipeline queues use either SysV queues or shm rings; the log queue always stays SysV.
+    auto createPipelineQueue = [&](MessageQueue& queue, key_t key) {
+        if (cfg.shmRingTransport != 0) {
+            return queue.createRing(key, static_cast<size_t>(cfg.shmRingSlots), sizeof(EventMessage), 0600);
         }
+        return queue.create(key, 0600);
     };
-    removeIfExists(logKey);
-    removeIfExists(regKey);
-    removeIfExists(triKey);
-    for (int i = 0; i < kSpecialistCount; ++i) {
-        removeIfExists(specKeys[i]);
-    }
-
-    if (!logQ.create(logKey, 0600) || !regQ.create(regKey, 0600) ||
-        !triQ.create(triKey, 0600)) {
+    if (!logQ.create(logKey, 0600) || !createPipelineQueue(ids.regQueue, regKey) ||
+        !createPipelineQueue(ids.triageQueue, triKey)) {
         return false;
     }
+    // Log rings sit in front of LOG_QUEUE; every process attaches to them right after opening the queue.
+    if (cfg.logRings != 0) {
+        if (!ids.logRings.create(LogRingArena::nameForKey(logKey), static_cast<size_t>(cfg.logRingCount),
+                                 static_cast<size_t>(cfg.logRingSlots), sizeof(LogMessage), 0600) ||
+            !attachLogRings(logKey)) {
+            return false;
+        }
+    }
     for (int i = 0; i < kSpecialistCount; ++i) {
-        if (!specQs[i].create(specKeys[i], 0600)) {
+        if (!createPipelineQueue(ids.specialistsQueue[i], specKeys[i])) {
             return false;
         }
     }
 
     // Increase per-queue capacity to avoid blocking when traffic spikes.
     auto tuneQueue = [](int qid) {
+        if (qid == -1) return; // ring-backed queue
         struct msqid_ds ds {};
         if (msgctl(qid, IPC_STAT, &ds) == -1) return;
         ds.msg_qbytes = 262144; // 256 KB if permitted by system limits
         msgctl(qid, IPC_SET, &ds);
     };
     tuneQueue(logQ.id());
-    tuneQueue(regQ.id());
-    tuneQueue(triQ.id());
+    tuneQueue(ids.regQueue.id());
+    tuneQueue(ids.triageQueue.id());
     for (int i = 0; i < kSpecialistCount; ++i) {
-        tuneQueue(specQs[i].id());
+        tuneQueue(ids.specialistsQueue[i].id());
     }
 
     ids.logQueue = logQ.id();
-    ids.regQueue = regQ.id();
-    ids.triageQueue = triQ.id();
-    for (int i = 0; i < kSpecialistCount; ++i) {
-        ids.specialistsQueue[i] = specQs[i].id();
-    }
     return true;
 }
 
-/** @brief Create waiting-room and shared-state semaphores; remove stale sets first. */
-bool createSemaphores(const std::string& keyPath, const Config& cfg, IpcIds& ids) {
-    key_t waitKey = ftok(keyPath.c_str(), 'W');
-    key_t stateKey = ftok(keyPath.c_str(), 'M');
-    if (waitKey == -1 || stateKey == -1) {
-        logErrno("ftok for semaphores failed");
-        return false;
-    }
-
-    // Best effort cleanup of stale semaphores from previous crashed runs.
-    auto removeIfExists = [](key_t key) {
-        int sid = semget(key, 1, 0);
-        if (sid != -1) {
-            semctl(sid, 0, IPC_RMID);
-        }
-    };
-    removeIfExists(waitKey);
-    removeIfExists(stateKey);
-
+/** @brief Create the waiting-room semaphore and the registration gate set (one per pool window) on the run's keys. */
+bool createSemaphores(const RunNamespace& ns, const Config& cfg, IpcIds& ids) {
     Semaphore waitSem;
-    Semaphore stateSem;
-    if (!waitSem.create(waitKey, cfg.N_waitingRoom, 0600)) {
+    if (!waitSem.create(ns.key(kWaitingRoomKeyId), cfg.N_waitingRoom, 0600)) {
         return false;
     }
     ids.semWaitingRoom = waitSem.id();
-    if (!stateSem.create(stateKey, 1, 0600)) {
-        if (ids.semWaitingRoom != -1) {
-            semctl(ids.semWaitingRoom, 0, IPC_RMID);
-            ids.semWaitingRoom = -1;
-        }
-        return false;
-    }
-    ids.semSharedState = stateSem.id();
-    return true;
+    return ids.registrationGate.create(ns.key(kRegistrationGateKeyId), 0, 0600, cfg.registrationWindowsMax);
 }
 
-/** @brief Allocate and attach shared memory for SharedState, wiping any leftovers. */
-bool createSharedState(const std::string& keyPath, IpcIds& ids, SharedState*& stateOut) {
+/** @brief Allocate and attach shared memory for SharedState on the run's key. */
+bool createSharedState(const RunNamespace& ns, IpcIds& ids, SharedState*& stateOut) {
     SharedMemory shm;
-    key_t shmKey = ftok(keyPath.c_str(), 'H');
-    if (shmKey == -1) {
-        logErrno("ftok for shm failed");
-        return false;
-    }
-    // Remove stale shared memory if present (previous crash).
-    int staleId = shmget(shmKey, 0, 0);
-    if (staleId != -1) {
-        shmctl(staleId, IPC_RMID, nullptr);
-    }
-    if (!shm.create(shmKey, sizeof(SharedState), 0600)) {
+    if (!shm.create(ns.key(kSharedStateKeyId), sizeof(SharedState), 0600)) {
         return false;
     }
     void* addr = shm.attach();
@@ -212,39 +171,14 @@ bool createSharedState(const std::string& keyPath, IpcIds& ids, SharedState*& st
         shmctl(shm.id(), IPC_RMID, nullptr);
         return false;
     }
-    auto* shared = static_cast<SharedState*>(addr);
-    std::memset(shared, 0, sizeof(SharedState));
+    // Construct in place so every atomic counter starts from a defined zero state.
+    std::memset(addr, 0, sizeof(SharedState));
+    auto* shared = new (addr) SharedState();
     ids.shmId = shm.id();
     stateOut = shared;
     return true;
 }
 
-std::string formatDuration(long long seconds) {
-    long long days = seconds / 86400;
-    seconds %= 86400;
-    long long hours = seconds / 3600;
-    seconds %= 3600;
-    long long minutes = seconds / 60;
-    seconds %= 60;
-    std::ostringstream oss;
-    oss << days << "d " << hours << "h " << minutes << "m " << seconds << "s";
-    return oss.str();
-}
-
-struct SpecialistNames {
-    static const char* name(int idx) {
-        switch (static_cast<SpecialistType>(idx)) {
-            case SpecialistType::Cardiologist: return "Cardiologist";
-            case SpecialistType::Neurologist: return "Neurologist";
-            case SpecialistType::Ophthalmologist: return "Ophthalmologist";
-            case SpecialistType::Laryngologist: return "Laryngologist";
-            case SpecialistType::Surgeon: return "Surgeon";
-            case SpecialistType::Paediatrician: return "Paediatrician";
-            default: return "Unknown";
-        }
-    }
-};
-
 /**
  * @brief Forks and execs a child process with provided argv, logging fork/exec errors.
  * Parent receives the child's pid; child only returns on exec failure (_exit(1)).
@@ -270,113 +204,290 @@ pid_t forkExec(const std::string& exePath, const std::vector<std::string>& argv,
     return pid;
 }
 
-struct SummaryPayload {
-    int totalPatients{0};
-    int waitingRoomCapacity{0};
-    int queueRegistrationLen{0};
-    int triageRed{0};
-    int triageYellow{0};
-    int triageGreen{0};
-    int triageSentHome{0};
-    int outcomeHome{0};
-    int outcomeWard{0};
-    int outcomeOther{0};
-    int timeScaleMsPerSimMinute{0};
-    int simulationDurationMinutes{0};
-    long long simulatedSeconds{0};
-    pid_t directorPid{0};
-    pid_t registration1Pid{0};
-    pid_t registration2Pid{0};
-    pid_t triagePid{0};
-    std::vector<pid_t> reg2History;
-    std::array<pid_t, kSpecialistCount> specialistPids{};
-};
-
-SummaryPayload buildPayload(const SharedState* state, long long simulatedSeconds,
-                            const std::vector<pid_t>& reg2History,
-                            const std::array<pid_t, kSpecialistCount>& specialistPids) {
+SummaryPayload buildPayload(const SharedState* state, long long simulatedSeconds, long long elapsedMs) {
     SummaryPayload payload;
-    payload.totalPatients = state->totalPatients;
-    payload.waitingRoomCapacity = state->waitingRoomCapacity;
-    payload.queueRegistrationLen = state->queueRegistrationLen;
-    payload.triageRed = state->triageRed;
-    payload.triageYellow = state->triageYellow;
-    payload.triageGreen = state->triageGreen;
-    payload.triageSentHome = state->triageSentHome;
-    payload.outcomeHome = state->outcomeHome;
-    payload.outcomeWard = state->outcomeWard;
-    payload.outcomeOther = state->outcomeOther;
+    StateSnapshot counters = state->snapshot();
+    payload.totalPatients = counters.totalPatients;
+    payload.waitingRoomCapacity = counters.waitingRoomCapacity;
+    payload.queueRegistrationLen = counters.queueRegistrationLen;
+    payload.triageRed = counters.triageRed;
+    payload.triageYellow = counters.triageYellow;
+    payload.triageGreen = counters.triageGreen;
+    payload.triageSentHome = counters.triageSentHome;
+    payload.outcomeHome = counters.outcomeHome;
+    payload.outcomeWard = counters.outcomeWard;
+    payload.outcomeOther = counters.outcomeOther;
     payload.timeScaleMsPerSimMinute = state->timeScaleMsPerSimMinute;
     payload.simulationDurationMinutes = state->simulationDurationMinutes;
     payload.simulatedSeconds = simulatedSeconds;
+    payload.elapsedMs = elapsedMs;
+    payload.specialistPolicy = specialistPolicyName(state->specialistPolicy.policyKind());
     payload.directorPid = state->directorPid;
     payload.registration1Pid = state->registration1Pid;
-    payload.registration2Pid = state->registration2Pid;
-    payload.triagePid = state->triagePid;
-    payload.reg2History = reg2History;
-    payload.specialistPids = specialistPids;
+    for (int w = 0; w < state->triageWorkerCount; ++w) {
+        const TriageCounters& counters = state->triage[w];
+        TriageWorkerSummary worker;
+        worker.pid = counters.pid.load(std::memory_order_relaxed);
+        worker.red = counters.red.load(std::memory_order_relaxed);
+        worker.yellow = counters.yellow.load(std::memory_order_relaxed);
+        worker.green = counters.green.load(std::memory_order_relaxed);
+        worker.sentHome = counters.sentHome.load(std::memory_order_relaxed);
+        worker.busyMs = counters.busyNs.load(std::memory_order_relaxed) / 1000000;
+        payload.triageWorkers.push_back(worker);
+    }
+    for (int s = 0; s < kSpecialistCount; ++s) {
+        for (int d = 0; d < state->doctorCount[s]; ++d) {
+            const DoctorCounters& counters = state->doctors[s][d];
+            DoctorSummary doctor;
+            doctor.pid = counters.pid.load(std::memory_order_relaxed);
+            doctor.exams = counters.exams.load(std::memory_order_relaxed);
+            doctor.busyMs = counters.busyNs.load(std::memory_order_relaxed) / 1000000;
+            doctor.leaves = counters.leaves.load(std::memory_order_relaxed);
+            doctor.leaveMs = counters.leaveNs.load(std::memory_order_relaxed) / 1000000;
+            payload.doctors[s].push_back(doctor);
+        }
+    }
     return payload;
 }
 
-std::string joinHistory(const std::vector<pid_t>& values) {
-    std::ostringstream oss;
-    for (size_t i = 0; i < values.size(); ++i) {
-        if (i > 0) oss << ", ";
-        oss << values[i];
-    }
-    return oss.str();
+/** @brief Start a helper thread with SIGINT/SIGUSR2 blocked so both stay on the director's main thread. */
+template <typename Fn>
+std::thread startHelperThread(Fn fn) {
+    sigset_t blockSet;
+    sigset_t oldSet;
+    sigemptyset(&blockSet);
+    sigaddset(&blockSet, SIGINT);
+    sigaddset(&blockSet, SIGUSR2);
+    pthread_sigmask(SIG_BLOCK, &blockSet, &oldSet);
+    std::thread thread(std::move(fn));
+    pthread_sigmask(SIG_SETMASK, &oldSet, nullptr);
+    return thread;
 }
 
-bool writeSummaryText(const SummaryPayload& payload, std::ofstream& out) {
-    out << "SOR Simulation Summary\n";
-    out << "======================\n";
-    out << "Total patients processed: " << payload.totalPatients << "\n";
-    out << "Waiting room capacity: " << payload.waitingRoomCapacity << "\n";
-    out << "Registered queue length at shutdown: " << payload.queueRegistrationLen << "\n";
-    out << "Triage outcomes:\n";
-    out << "  Red:    " << payload.triageRed << "\n";
-    out << "  Yellow: " << payload.triageYellow << "\n";
-    out << "  Green:  " << payload.triageGreen << "\n";
-    out << "  Sent home from triage: " << payload.triageSentHome << "\n";
-    out << "Final dispositions:\n";
-    out << "  Home:       " << payload.outcomeHome << "\n";
-    out << "  Ward:       " << payload.outcomeWard << "\n";
-    out << "  Other:      " << payload.outcomeOther << "\n";
-    out << "Time scale (ms per minute): " << payload.timeScaleMsPerSimMinute << "\n";
-    out << "Simulation duration (config minutes): " << payload.simulationDurationMinutes << "\n";
-    out << "Simulated elapsed time: " << formatDuration(payload.simulatedSeconds) << "\n";
-    out << "Process IDs:\n";
-    out << "  Director:      " << payload.directorPid << "\n";
-    out << "  Registration1: " << payload.registration1Pid << "\n";
-    out << "  Triage:        " << payload.triagePid << "\n";
-    out << "  Specialists:\n";
-    for (int i = 0; i < kSpecialistCount; ++i) {
-        out << "    " << SpecialistNames::name(i) << ": ";
-        if (payload.specialistPids[i] != 0) {
-            out << payload.specialistPids[i] << "\n";
-        } else {
-            out << "not spawned\n";
+/**
+ * @brief Director-side sampler: probes queues/semaphores at a fixed period and publishes the
+ * result into SharedState::metrics so logEvent in every process reads it with plain loads.
+ */
+class MetricsPublisher {
+public:
+    ~MetricsPublisher() { stop(); }
+
+    void start(SharedState* shared, const LogMetricsContext& context, int intervalMs) {
+        shared_ = shared;
+        context_ = context;
+        intervalMs_ = intervalMs;
+        publishOnce();
+        thread_ = startHelperThread([this]() {
+            while (!stop_.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs_));
+                publishOnce();
+            }
+        });
+    }
+
+    void stop() {
+        stop_.store(true);
+        if (thread_.joinable()) thread_.join();
+    }
+
+private:
+    void publishOnce() { shared_->metrics.publish(sampleMetrics(context_)); }
+
+    SharedState* shared_{nullptr};
+    LogMetricsContext context_{};
+    int intervalMs_{0};
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
+
+/**
+ * @brief Director-side recorder of the queue time series written with the summary. It probes the
+ * IPC objects itself, so the series does not depend on metricsPublishIntervalMs.
+ */
+class QueueSeriesRecorder {
+public:
+    ~QueueSeriesRecorder() { stop(); }
+
+    void start(const LogMetricsContext& context, long long startMs, int intervalMs) {
+        context_ = context;
+        series_ = QueueTimeSeries(intervalMs);
+        thread_ = startHelperThread([this, startMs, intervalMs]() {
+            const auto interval = std::chrono::milliseconds(intervalMs);
+            auto nextTick = std::chrono::steady_clock::now();
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!stop_) {
+                series_.record(monotonicMs() - startMs, sampleMetrics(context_),
+                               context_.sharedState->snapshot().finishedPatients());
+                nextTick += interval;
+                wake_.wait_until(lock, nextTick, [this]() { return stop_; });
+            }
+        });
+    }
+
+    /** @brief Stop sampling; series() is stable afterwards. */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
         }
+        wake_.notify_all();
+        if (thread_.joinable()) thread_.join();
     }
-    out << "Registration2 history: ";
-    if (payload.reg2History.empty()) {
-        out << "Not spawned during the simulation\n";
-    } else {
-        out << joinHistory(payload.reg2History) << "\n";
+
+    const QueueTimeSeries& series() const { return series_; }
+
+private:
+    LogMetricsContext context_{};
+    QueueTimeSeries series_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_{false};
+    std::thread thread_;
+};
+
+/**
+ * @brief Director-side registration pool: samples the registration queue depth from shared memory
+ * every registrationScaleIntervalMs and opens or parks windows 1.. as RegistrationScaler decides.
+ * The windows are already running (spawned parked at startup), so opening one is a flag store plus
+ * a post on its gate semaphore instead of a fork+exec.
+ */
+class RegistrationPool {
+public:
+    ~RegistrationPool() { stop(); }
+
+    void start(SharedState* shared, Semaphore* gate, int logQueue, const Config& config, long long simStartMs) {
+        shared_ = shared;
+        gate_ = gate;
+        logQueue_ = logQueue;
+        simStartMs_ = simStartMs;
+        msPerSimMinute_ = config.timeScaleMsPerSimMinute;
+        windowCount_ = config.registrationWindowsMax;
+        windows_.assign(static_cast<size_t>(windowCount_), RegistrationWindowSummary{});
+        openedAtMs_.assign(static_cast<size_t>(windowCount_), 0);
+        RegistrationScaler scaler(RegistrationPolicy{windowCount_, config.K_registrationThreshold,
+                                                     config.N_waitingRoom / 3, config.registrationScaleCooldownMs});
+        const int intervalMs = config.registrationScaleIntervalMs;
+        // Window 0 is open for the whole run.
+        open(0, monotonicMs());
+        thread_ = startHelperThread([this, scaler, intervalMs]() mutable {
+            const auto interval = std::chrono::milliseconds(intervalMs);
+            auto nextTick = std::chrono::steady_clock::now();
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!stop_) {
+                long long nowMs = monotonicMs();
+                int qlen = shared_->waitingRoom.queueRegistrationLen.load(std::memory_order_relaxed);
+                int decision = scaler.update(nowMs, qlen, open_);
+                if (decision > 0) {
+                    int window = open_;
+                    open(window, nowMs);
+                    logChange(window, "opening", qlen, scaler);
+                } else if (decision < 0) {
+                    int window = open_ - 1;
+                    close(window, nowMs);
+                    logChange(window, "parking", qlen, scaler);
+                }
+                // A park signal that landed just before the window blocked in its receive is lost;
+                // repeat it until the window reports itself parked.
+                for (int w = open_ > 1 ? open_ : 1; w < windowCount_; ++w) {
+                    interruptParked(w);
+                }
+                nextTick += interval;
+                wake_.wait_until(lock, nextTick, [this]() { return stop_; });
+            }
+        });
     }
-    return true;
-}
 
-bool writeSummary(const SummaryPayload& payload, const std::string& path) {
-    std::ofstream out(path, std::ios::out | std::ios::trunc);
-    if (!out) {
-        logErrno("summary file open failed");
-        return false;
+    /** @brief Stop deciding and close the open-time books; later changes no longer happen. */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stop_) return;
+            stop_ = true;
+        }
+        wake_.notify_all();
+        if (thread_.joinable()) thread_.join();
+        long long nowMs = monotonicMs();
+        for (int w = 0; w < open_; ++w) {
+            windows_[w].openMs += nowMs - openedAtMs_[w];
+        }
     }
-    return writeSummaryText(payload, out);
-}
 
-void destroyIpc(const IpcIds& ids, SharedState* attachedState) {
+    /** @brief Number of pool windows including window 0. */
+    int windowCount() const { return windowCount_; }
+
+    /** @brief Per-window activity; call after stop() and after the windows exited. */
+    std::vector<RegistrationWindowSummary> summary() const {
+        std::vector<RegistrationWindowSummary> out = windows_;
+        for (int w = 0; w < windowCount_; ++w) {
+            const RegistrationWindowSlot& slot = shared_->registrationWindows[w];
+            out[w].pid = slot.pid.load();
+            out[w].patients = slot.patients.load();
+            out[w].busyMs = slot.busyNs.load() / 1000000LL;
+        }
+        return out;
+    }
+
+    int peakOpen() const { return peakOpen_; }
+
+private:
+    void open(int window, long long nowMs) {
+        shared_->registrationWindows[window].open.store(1, std::memory_order_release);
+        if (window > 0 && !gate_->post(window)) {
+            logErrno("registration gate post failed");
+        }
+        windows_[window].activations += 1;
+        openedAtMs_[window] = nowMs;
+        open_ = window + 1;
+        if (open_ > peakOpen_) peakOpen_ = open_;
+        shared_->control.openRegistrationWindows.store(open_);
+    }
+
+    void close(int window, long long nowMs) {
+        shared_->registrationWindows[window].open.store(0, std::memory_order_release);
+        interruptParked(window);
+        windows_[window].openMs += nowMs - openedAtMs_[window];
+        open_ = window;
+        shared_->control.openRegistrationWindows.store(open_);
+    }
+
+    /**
+     * @brief Wake a parked window that is still blocked in its receive: SIGUSR1 (installed without
+     * SA_RESTART) makes the receive fail with EINTR, and the window re-reads its open flag. Only
+     * windows that report taking=1 are signalled, so the handler is installed by then.
+     */
+    void interruptParked(int window) {
+        const RegistrationWindowSlot& slot = shared_->registrationWindows[window];
+        int pid = slot.pid.load();
+        if (pid > 0 && slot.taking.load(std::memory_order_acquire) != 0 && kill(pid, SIGUSR1) == -1 &&
+            errno != ESRCH) {
+            logErrno("registration park signal failed");
+        }
+    }
+
+    void logChange(int window, const char* action, int qlen, const RegistrationScaler& scaler) {
+        char buf[160];
+        std::snprintf(buf, sizeof(buf), "Registration window %d %s (regQ=%d growth=%.1f/s projected=%.0f open=%d/%d)",
+                      window, action, qlen, scaler.growthPerSec(), scaler.projectedQueue(), open_, windowCount_);
+        logEvent(logQueue_, Role::Director, simMinutesFrom(simStartMs_, msPerSimMinute_), buf);
+    }
+
+    SharedState* shared_{nullptr};
+    Semaphore* gate_{nullptr};
+    int logQueue_{-1};
+    long long simStartMs_{0};
+    int msPerSimMinute_{0};
+    int windowCount_{0};
+    int open_{0};
+    int peakOpen_{0};
+    std::vector<RegistrationWindowSummary> windows_;
+    std::vector<long long> openedAtMs_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_{false};
+    std::thread thread_;
+};
+
+void destroyIpc(IpcIds& ids, SharedState* attachedState) {
     if (attachedState) {
         shmdt(attachedState);
     }
@@ -385,22 +496,20 @@ void destroyIpc(const IpcIds& ids, SharedState* attachedState) {
             logErrno("cleanup log queue failed");
         }
     }
-    if (ids.regQueue != -1) {
-        if (msgctl(ids.regQueue, IPC_RMID, nullptr) == -1) {
-            logErrno("cleanup reg queue failed");
-        }
+    if (ids.logRings.isOpen() && !ids.logRings.destroy()) {
+        logErrno("cleanup log rings failed");
     }
-    if (ids.triageQueue != -1) {
-        if (msgctl(ids.triageQueue, IPC_RMID, nullptr) == -1) {
-            logErrno("cleanup triage queue failed");
-        }
-    }
-    for (int qid : ids.specialistsQueue) {
-        if (qid != -1) {
-            if (msgctl(qid, IPC_RMID, nullptr) == -1) {
-                logErrno("cleanup specialists queue failed");
-            }
+    // Pipeline queues may be SysV or ring-backed; skip handles that were never created.
+    auto destroyQueue = [](MessageQueue& queue, const char* errMsg) {
+        if (queue.id() == -1 && queue.transport() != QueueTransport::ShmRing) return;
+        if (!queue.destroy()) {
+            logErrno(errMsg);
         }
+    };
+    destroyQueue(ids.regQueue, "cleanup reg queue failed");
+    destroyQueue(ids.triageQueue, "cleanup triage queue failed");
+    for (auto& queue : ids.specialistsQueue) {
+        destroyQueue(queue, "cleanup specialists queue failed");
     }
     if (ids.shmId != -1) {
         if (shmctl(ids.shmId, IPC_RMID, nullptr) == -1) {
@@ -412,10 +521,8 @@ void destroyIpc(const IpcIds& ids, SharedState* attachedState) {
             logErrno("cleanup waiting room semaphore failed");
         }
     }
-    if (ids.semSharedState != -1) {
-        if (semctl(ids.semSharedState, 0, IPC_RMID) == -1) {
-            logErrno("cleanup shared state semaphore failed");
-        }
+    if (ids.registrationGate.id() != -1 && !ids.registrationGate.destroy()) {
+        logErrno("cleanup registration gate failed");
     }
 }
 } // namespace
@@ -423,20 +530,32 @@ void destroyIpc(const IpcIds& ids, SharedState* attachedState) {
 // Director entry point (see header for details).
 int Director::run(const std::string& selfPath, const Config& config, const std::string* logPathOverride) {
     IpcIds ids;
-    ids.specialistsQueue.fill(-1);
     SharedState* shared = nullptr;
     bool ok = true;
-    Semaphore stateSemGuard;
-    struct msqid_ds regStats{};
+    MetricsPublisher metricsPublisher;
+    QueueSeriesRecorder seriesRecorder;
+    RegistrationPool registrationPool;
     lastSummaryPath_.clear();
 
-    if (!createQueues(selfPath, ids)) {
+    // Reclaim objects of runs whose director died, then reserve keys of our own.
+    int orphans = cleanupOrphanedRuns(false);
+    if (orphans > 0) {
+        std::cerr << "Director: removed IPC objects of " << orphans << " orphaned run(s)" << std::endl;
+    }
+    RunNamespace runNamespace;
+    if (!runNamespace.create(config.shmRingTransport != 0)) {
         ok = false;
     }
-    if (ok && !createSemaphores(selfPath, config, ids)) {
+    // Children resolve IPC keys from the registry file instead of ftok(argv[0]).
+    const std::string& keyPath = runNamespace.registryPath();
+
+    if (ok && !createQueues(runNamespace, config, ids)) {
         ok = false;
     }
-    if (ok && !createSharedState(selfPath, ids, shared)) {
+    if (ok && !createSemaphores(runNamespace, config, ids)) {
+        ok = false;
+    }
+    if (ok && !createSharedState(runNamespace, ids, shared)) {
         ok = false;
     }
 
@@ -447,7 +566,13 @@ int Director::run(const std::string& selfPath, const Config& config, const std::
     pid_t loggerPid = -1;
     if (ok) {
         std::string queueIdStr = std::to_string(ids.logQueue);
-        std::vector<std::string> args{selfPath, "logger", queueIdStr, logPath};
+        std::vector<std::string> args{selfPath, "logger", queueIdStr, logPath,
+                                      std::to_string(config.logFlushBytes),
+                                      std::to_string(config.logFlushIntervalMs),
+                                      std::to_string(config.logFsync),
+                                      config.binaryLog ? binaryLogPath(logPath) : std::string(),
+                                      config.logRings ? LogRingArena::nameForKey(runNamespace.key(kLogKeyId))
+                                                      : std::string()};
         loggerPid = forkExec(selfPath, args, "fork for logger failed", "execv for logger failed");
         if (loggerPid == -1) ok = false;
     }
@@ -467,18 +592,9 @@ int Director::run(const std::string& selfPath, const Config& config, const std::
     long long simStartMs = monotonicMs();
     auto simNow = [&]() { return simMinutesFrom(simStartMs, config.timeScaleMsPerSimMinute); };
     // Scales a base duration with the configured time scale; preserves zero/negative as zero.
-    auto scaleAllowZero = [&](int baseMs) {
-        if (baseMs <= 0) return 0;
-        long long scaled = static_cast<long long>(baseMs) * config.timeScaleMsPerSimMinute /
-                           kDefaultTimeScaleMsPerSimMinute;
-        if (scaled <= 0) scaled = 1;
-        return static_cast<int>(scaled);
-    };
+    auto scaleAllowZero = [&](int baseMs) { return scaleAllowZeroMs(baseMs, config.timeScaleMsPerSimMinute); };
     // Scales a base duration and clamps to at least 1 ms to avoid zero-time steps.
-    auto scaleAtLeastOne = [&](int baseMs) {
-        int v = scaleAllowZero(baseMs);
-        return v <= 0 ? 1 : v;
-    };
+    auto scaleAtLeastOne = [&](int baseMs) { return scaleAtLeastOneMs(baseMs, config.timeScaleMsPerSimMinute); };
     int scaledRegMs = scaleAllowZero(config.registrationServiceMs);
     int scaledTriageMs = scaleAllowZero(config.triageServiceMs);
     int scaledSpecMin = scaleAtLeastOne(config.specialistExamMinMs);
@@ -493,45 +609,55 @@ int Director::run(const std::string& selfPath, const Config& config, const std::
     }
 
     if (ok && shared) {
-        shared->currentInWaitingRoom = 0;
         shared->waitingRoomCapacity = config.N_waitingRoom;
-        shared->queueRegistrationLen = 0;
-        shared->reg2Active = 0;
         shared->timeScaleMsPerSimMinute = config.timeScaleMsPerSimMinute;
         shared->simulationDurationMinutes = config.simulationDurationMinutes;
         shared->simStartMonotonicMs = simStartMs;
-        shared->totalPatients = 0;
-        shared->triageRed = shared->triageYellow = shared->triageGreen = shared->triageSentHome = 0;
+        shared->queueTransport = config.shmRingTransport;
+        shared->randomSeed = config.randomSeed;
         shared->registrationServiceMs = scaledRegMs;
         shared->triageServiceMs = scaledTriageMs;
         shared->specialistExamMinMs = scaledSpecMin;
         shared->specialistExamMaxMs = scaledSpecMax;
         shared->specialistLeaveMinMs = scaledLeaveMin;
         shared->specialistLeaveMaxMs = scaledLeaveMax;
-        shared->outcomeHome = shared->outcomeWard = shared->outcomeOther = 0;
         shared->directorPid = getpid();
-        shared->registration1Pid = shared->registration2Pid = shared->triagePid = 0;
-    }
-    if (ok) {
-        key_t stateKey = ftok(selfPath.c_str(), 'M');
-        if (stateKey == -1 || !stateSemGuard.open(stateKey)) {
-            ok = false;
-        }
+        shared->registration1Pid = 0;
+        shared->triageWorkerCount = config.triageWorkers;
+        shared->vipQueueAging = vipQueueAgingPolicy(config);
+        shared->colorQueueAging = colorQueueAgingPolicy(config);
+        shared->specialistPolicy = specialistPolicyFromConfig(config);
+        shared->registrationWindowCount = config.registrationWindowsMax;
+        shared->doctorCount = config.specialistDoctors;
     }
 
     if (ok && shared) {
-        setLogMetricsContext({shared, ids.regQueue, ids.triageQueue, ids.specialistsQueue,
-                              ids.semWaitingRoom, ids.semSharedState});
+        std::array<const MessageQueue*, kSpecialistCount> specQueues{};
+        for (int i = 0; i < kSpecialistCount; ++i) {
+            specQueues[i] = &ids.specialistsQueue[i];
+        }
+        LogMetricsContext metricsContext{shared, &ids.regQueue, &ids.triageQueue, specQueues,
+                                         ids.semWaitingRoom};
+        setLogMetricsContext(metricsContext);
+        if (config.metricsPublishIntervalMs > 0) {
+            // Publish before any child starts so their first log lines already see real values.
+            metricsPublisher.start(shared, metricsContext, config.metricsPublishIntervalMs);
+            shared->metricsPublishIntervalMs = config.metricsPublishIntervalMs;
+        }
+        if (config.timeSeriesIntervalMs > 0) {
+            seriesRecorder.start(metricsContext, simStartMs, config.timeSeriesIntervalMs);
+        }
     }
 
     pid_t reg1Pid = -1;
-    pid_t reg2Pid = -1;
-    pid_t triagePid = -1;
+    std::vector<pid_t> poolPids; // registration windows 1.. (parked until the pool opens them)
+    std::vector<pid_t> triagePids;
     pid_t generatorPid = -1;
 
     if (ok) {
         int simTime = simNow();
-        logEvent(ids.logQueue, Role::Director, simTime, "Director: IPC initialized, logger spawned: " + logPath);
+        logEvent(ids.logQueue, Role::Director, simTime, "Director: IPC initialized, logger spawned: " + logPath +
+                                                                  " run=" + runNamespace.runId());
         logEvent(ids.logQueue, Role::Director, simTime,
                  "Simulation config N=" + std::to_string(config.N_waitingRoom) +
                  " K=" + std::to_string(config.K_registrationThreshold) +
@@ -544,36 +670,64 @@ int Director::run(const std::string& selfPath, const Config& config, const std::
                  " leaveMinMax=" + std::to_string(scaledLeaveMin) +
                  "/" + std::to_string(scaledLeaveMax) +
                  " reconcileWaitSem=" + std::to_string(reconcileWaitSemEnabled ? 1 : 0));
+        // The config line above already fills a log record; runtime choices get their own line.
+        logEvent(ids.logQueue, Role::Director, simTime,
+                 std::string("Runtime transport=") + (config.shmRingTransport != 0 ? "shmring" : "sysv") +
+                 " patients=" + (config.inProcessPatients != 0 ? "threads" : "processes"));
+        logEvent(ids.logQueue, Role::Director, simTime,
+                 "Scheduling agingStep=" + std::to_string(shared ? shared->vipQueueAging.stepMs : 0) +
+                 " specialistPolicy=" +
+                 specialistPolicyName(static_cast<SpecialistPolicyKind>(config.specialistPolicy)));
         logEvent(ids.logQueue, Role::Director, simTime,
                  "Director PIDs: reg1=" + std::to_string(reg1Pid) +
-                 " reg2=" + std::to_string(reg2Pid) +
-                 " triage=" + std::to_string(triagePid) +
+                 " regWindows=" + std::to_string(config.registrationWindowsMax) +
+                 " triageWorkers=" + std::to_string(config.triageWorkers) +
                  " gen=" + std::to_string(generatorPid));
     }
 
     if (ok) {
-        std::vector<std::string> args{selfPath, "registration", selfPath};
+        std::vector<std::string> args{selfPath, "registration", keyPath};
         reg1Pid = forkExec(selfPath, args, "fork for registration failed", "execv for registration failed");
         if (reg1Pid == -1) {
             ok = false;
         } else {
             if (shared) {
                 shared->registration1Pid = reg1Pid;
+                shared->registrationWindows[0].pid.store(reg1Pid);
             }
             logEvent(ids.logQueue, Role::Director, simNow(), "Registration1 spawned");
         }
     }
-    if (ok) {
-        std::vector<std::string> args{selfPath, "triage", selfPath};
-        triagePid = forkExec(selfPath, args, "fork for triage failed", "execv for triage failed");
-        if (triagePid == -1) {
+    // Warm pool: the extra windows attach to IPC now and park, so opening one later costs no fork.
+    for (int window = 1; ok && window < config.registrationWindowsMax; ++window) {
+        std::vector<std::string> args{selfPath, "registration", keyPath, std::to_string(window)};
+        pid_t pid = forkExec(selfPath, args, "fork for registration window failed", "execv for registration window failed");
+        if (pid == -1) {
             ok = false;
-        } else {
-            if (shared) {
-                shared->triagePid = triagePid;
-            }
-            logEvent(ids.logQueue, Role::Director, simNow(), "Triage spawned");
+            break;
+        }
+        poolPids.push_back(pid);
+        if (shared) {
+            shared->registrationWindows[window].pid.store(pid);
+        }
+        logEvent(ids.logQueue, Role::Director, simNow(), "Registration window " + std::to_string(window) + " spawned (parked)");
+    }
+    if (ok && shared) {
+        registrationPool.start(shared, &ids.registrationGate, ids.logQueue, config, simStartMs);
+    }
+    // Triage workers all receive from the triage queue; each owns one TriageCounters line.
+    for (int worker = 0; ok && worker < config.triageWorkers; ++worker) {
+        std::vector<std::string> args{selfPath, "triage", keyPath, std::to_string(worker)};
+        pid_t pid = forkExec(selfPath, args, "fork for triage failed", "execv for triage failed");
+        if (pid == -1) {
+            ok = false;
+            break;
         }
+        triagePids.push_back(pid);
+        if (shared) {
+            shared->triage[worker].pid.store(pid, std::memory_order_relaxed);
+        }
+        logEvent(ids.logQueue, Role::Director, simNow(), "Triage worker " + std::to_string(worker) + " spawned");
     }
 
     if (ok) {
@@ -584,9 +738,11 @@ int Director::run(const std::string& selfPath, const Config& config, const std::
             std::to_string(config.timeScaleMsPerSimMinute),
             std::to_string(config.randomSeed),
             std::to_string(config.patientGenMinMs),
-            std::to_string(config.patientGenMaxMs)
+            std::to_string(config.patientGenMaxMs),
+            std::to_string(config.inProcessPatients),
+            std::to_string(config.patientThreadPoolSize)
         };
-        std::vector<std::string> args{selfPath, "patient_generator", selfPath};
+        std::vector<std::string> args{selfPath, "patient_generator", keyPath};
         args.insert(args.end(), argVals.begin(), argVals.end());
         generatorPid = forkExec(selfPath, args, "fork for patient generator failed", "execv for patient generator failed");
         if (generatorPid == -1) {
@@ -595,21 +751,20 @@ int Director::run(const std::string& selfPath, const Config& config, const std::
             logEvent(ids.logQueue, Role::Director, simNow(), "Patient generator spawned");
         }
     }
+    // Every doctor of a specialty receives from the same queue; SIGUSR1 targets one doctor at a time.
     std::vector<pid_t> specialistPids;
-    std::array<pid_t, kSpecialistCount> specialistPidMap{};
-    std::vector<pid_t> reg2History;
-    if (ok) {
-        for (int i = 0; i < kSpecialistCount; ++i) {
-            std::string typeStr = std::to_string(i);
-            std::vector<std::string> args{selfPath, "specialist", selfPath, typeStr};
+    for (int i = 0; ok && i < kSpecialistCount; ++i) {
+        for (int d = 0; d < config.specialistDoctors[i]; ++d) {
+            std::vector<std::string> args{selfPath, "specialist", keyPath, std::to_string(i), std::to_string(d)};
             pid_t pid = forkExec(selfPath, args, "fork for specialist failed", "execv for specialist failed");
             if (pid == -1) {
                 ok = false;
                 break;
             }
             specialistPids.push_back(pid);
-            specialistPidMap[i] = pid;
-            logEvent(ids.logQueue, Role::Director, simNow(), "Specialist spawned type " + std::to_string(i));
+            if (shared) shared->doctors[i][d].pid.store(pid, std::memory_order_relaxed);
+            logEvent(ids.logQueue, Role::Director, simNow(),
+                     "Specialist spawned type " + std::to_string(i) + " doctor " + std::to_string(d));
         }
     }
 
@@ -640,7 +795,7 @@ int Director::run(const std::string& selfPath, const Config& config, const std::
 
     // Run until user interruption (Ctrl+C) or configured duration elapses.
     const int chunkMs = 100;
-    RandomGenerator directorRng(static_cast<unsigned int>(std::time(nullptr)));
+    RandomGenerator directorRng(directorSeed(config.randomSeed));
     int sigusr1CooldownMs = 1000; // attempt SIGUSR1 roughly every second if specialists exist
     int elapsedSinceUsr1 = 0;
     long long lastMonitorLogMs = monotonicMs();
@@ -656,53 +811,6 @@ int Director::run(const std::string& selfPath, const Config& config, const std::
             break;
         }
         elapsedSinceUsr1 += chunkMs;
-        // Dynamically manage Registration2 based on waiting-room load.
-        if (shared) {
-            int qlen = 0;
-            // Prefer real queue depth from msgctl; fallback to shared counter.
-            if (ids.regQueue != -1 && msgctl(ids.regQueue, IPC_STAT, &regStats) == 0) {
-                qlen = static_cast<int>(regStats.msg_qnum);
-            }
-            stateSemGuard.wait();
-            int sharedLen = shared->queueRegistrationLen;
-            int reg2Flag = shared->reg2Active;
-            int waitingRoomLoad = shared->currentInWaitingRoom;
-            stateSemGuard.post();
-            if (sharedLen > qlen) qlen = sharedLen;
-            // Hysteresis: open when queue >= K, close when queue falls below N/3.
-            int openThreshold = config.K_registrationThreshold;
-            int closeThreshold = config.N_waitingRoom / 3;
-            if (!reg2Flag && qlen >= openThreshold) {
-                std::vector<std::string> args{selfPath, "registration2", selfPath};
-                pid_t pid = forkExec(selfPath, args, "fork for registration2 failed", "execv for registration2 failed");
-                if (pid > 0) {
-                    reg2Pid = pid;
-                    reg2History.push_back(pid);
-                    stateSemGuard.wait();
-                    shared->reg2Active = 1;
-                    shared->registration2Pid = pid;
-                    stateSemGuard.post();
-                    logEvent(ids.logQueue, Role::Director, simTime,
-                             "Registration2 spawned (regQ=" + std::to_string(qlen) +
-                             " waitingRoom=" + std::to_string(waitingRoomLoad) +
-                             "/" + std::to_string(config.N_waitingRoom) + ")");
-                }
-            } else if (reg2Flag && qlen < closeThreshold) {
-                if (reg2Pid > 0) {
-                    kill(reg2Pid, SIGUSR2);
-                    logEvent(ids.logQueue, Role::Director, simTime,
-                             "Registration2 closing (regQ=" + std::to_string(qlen) +
-                             " waitingRoom=" + std::to_string(waitingRoomLoad) +
-                             "/" + std::to_string(config.N_waitingRoom) + ")");
-                    waitWithTimeout(reg2Pid, "registration2");
-                    reg2Pid = -1;
-                }
-                stateSemGuard.wait();
-                shared->reg2Active = 0;
-                shared->registration2Pid = 0;
-                stateSemGuard.post();
-            }
-        }
         // Periodic monitor log with ERROR prefix to spot stalls/died processes.
         long long nowMs = monotonicMs();
         if (nowMs - lastMonitorLogMs >= 5000 && ids.semWaitingRoom != -1) {
@@ -712,28 +820,18 @@ int Director::run(const std::string& selfPath, const Config& config, const std::
                 logErrno("ERROR MONITOR semctl GETVAL failed for waiting room");
                 wsemVal = -1;
             }
-            int regQLen = 0;
-            if (ids.regQueue != -1 && msgctl(ids.regQueue, IPC_STAT, &regStats) == 0) {
-                regQLen = static_cast<int>(regStats.msg_qnum);
-            }
-            int triQLen = 0;
-            if (ids.triageQueue != -1) {
-                struct msqid_ds triStats {};
-                if (msgctl(ids.triageQueue, IPC_STAT, &triStats) == 0) {
-                    triQLen = static_cast<int>(triStats.msg_qnum);
-                }
-            }
-            int inside = 0;
-            stateSemGuard.wait();
-            if (shared) {
-                inside = shared->currentInWaitingRoom;
-            }
-            stateSemGuard.post();
+            int inside = shared ? shared->waitingRoom.currentInWaitingRoom.load() : 0;
             int expectedFree = (shared ? shared->waitingRoomCapacity : 0) - inside;
             int missing = expectedFree - wsemVal;
             bool reg1Alive = reg1Pid > 0 && kill(reg1Pid, 0) == 0;
-            bool reg2Alive = reg2Pid > 0 && kill(reg2Pid, 0) == 0;
-            bool triAlive = triagePid > 0 && kill(triagePid, 0) == 0;
+            int poolAlive = 0;
+            for (pid_t pid : poolPids) {
+                if (kill(pid, 0) == 0) ++poolAlive;
+            }
+            int triageAlive = 0;
+            for (pid_t pid : triagePids) {
+                if (kill(pid, 0) == 0) ++triageAlive;
+            }
             int semPid = -1;
             int waiters = -1;
             int zeroWaiters = -1;
@@ -770,8 +868,9 @@ int Director::run(const std::string& selfPath, const Config& config, const std::
                      " z=" + std::to_string(zeroWaiters) +
                      " ot=" + std::to_string(static_cast<long long>(semInfo.sem_otime)) +
                      " r1=" + std::to_string(reg1Alive ? 1 : 0) +
-                     " r2=" + std::to_string(reg2Alive ? 1 : 0) +
-                     " t=" + std::to_string(triAlive ? 1 : 0));
+                     " rp=" + std::to_string(poolAlive) +
+                     " rOpen=" + std::to_string(shared ? shared->control.openRegistrationWindows.load() : 0) +
+                     " t=" + std::to_string(triageAlive));
             // No automatic reconcile here; we want to catch the first drift to find root cause.
         }
         if (!specialistPids.empty() && elapsedSinceUsr1 >= sigusr1CooldownMs) {
@@ -781,12 +880,16 @@ int Director::run(const std::string& selfPath, const Config& config, const std::
                 pid_t target = specialistPids[directorRng.uniformInt(0, static_cast<int>(specialistPids.size()) - 1)];
                 if (target > 0) {
                     kill(target, SIGUSR1);
-                    logEvent(ids.logQueue, Role::Director, simTime, "Director sent SIGUSR1 to specialist pid=" + std::to_string(target));
+                    LogEventFields leave;
+                    leave.kind = LogEventKind::DirectorSentLeave;
+                    leave.subject = static_cast<int>(target);
+                    logEvent(ids.logQueue, Role::Director, simTime, leave);
                 }
             }
         }
     }
 
+    registrationPool.stop();
     int stopSimTime = simNow();
     if (sigusr2Requested.load()) {
         logEvent(ids.logQueue, Role::Director, stopSimTime, "Director received SIGUSR2, broadcasting shutdown");
@@ -799,16 +902,24 @@ int Director::run(const std::string& selfPath, const Config& config, const std::
     // Coordinated shutdown: send SIGUSR2 individually (process group removed for portability).
     logEvent(ids.logQueue, Role::Director, stopSimTime, "Director initiating shutdown (SIGUSR2 to children)");
     if (reg1Pid > 0) kill(reg1Pid, SIGUSR2);
-    if (reg2Pid > 0) kill(reg2Pid, SIGUSR2);
-    if (triagePid > 0) kill(triagePid, SIGUSR2);
+    for (pid_t pid : poolPids) {
+        kill(pid, SIGUSR2);
+    }
+    for (pid_t pid : triagePids) {
+        kill(pid, SIGUSR2);
+    }
     for (pid_t pid : specialistPids) {
         if (pid > 0) kill(pid, SIGUSR2);
     }
     if (generatorPid > 0) kill(generatorPid, SIGUSR2);
 
     waitWithTimeout(reg1Pid, "registration");
-    waitWithTimeout(reg2Pid, "registration2");
-    waitWithTimeout(triagePid, "triage");
+    for (pid_t pid : poolPids) {
+        waitWithTimeout(pid, "registration window");
+    }
+    for (pid_t pid : triagePids) {
+        waitWithTimeout(pid, "triage");
+    }
     for (pid_t pid : specialistPids) {
         waitWithTimeout(pid, "specialist");
     }
@@ -826,11 +937,32 @@ int Director::run(const std::string& selfPath, const Config& config, const std::
             long long remainderMs = deltaMs % shared->timeScaleMsPerSimMinute;
             simulatedSeconds = simulatedMinutes * 60 + (remainderMs * 60) / shared->timeScaleMsPerSimMinute;
         }
-        SummaryPayload payload = buildPayload(shared, simulatedSeconds, reg2History, specialistPidMap);
+        long long elapsedMs = nowMs - shared->simStartMonotonicMs;
+        SummaryPayload payload = buildPayload(shared, simulatedSeconds, elapsedMs < 0 ? 0 : elapsedMs);
+        if (registrationPool.windowCount() > 0) {
+            payload.registrationWindows = registrationPool.summary();
+            payload.peakOpenRegistrationWindows = registrationPool.peakOpen();
+        }
+        payload.logRecordsDropped = logRecordsDropped();
+        payload.latency = shared->latency.report();
+        seriesRecorder.stop();
+        payload.queueSeries = seriesRecorder.series();
         if (writeSummary(payload, summaryPath)) {
             logEvent(ids.logQueue, Role::Director, stopSimTime, "Summary saved: " + summaryPath);
             lastSummaryPath_ = summaryPath;
         }
+        std::string jsonPath = summarySiblingPath(summaryPath, ".json");
+        if (writeSummaryJson(payload, jsonPath)) {
+            logEvent(ids.logQueue, Role::Director, stopSimTime, "Summary saved: " + jsonPath);
+        }
+        std::string csvPath = summarySiblingPath(summaryPath, ".csv");
+        if (writeSummaryCsv(payload, csvPath)) {
+            logEvent(ids.logQueue, Role::Director, stopSimTime, "Summary saved: " + csvPath);
+        }
+        std::string seriesPath = summarySiblingPath(summaryPath, "_series.csv");
+        if (writeQueueSeriesCsv(payload.queueSeries, seriesPath)) {
+            logEvent(ids.logQueue, Role::Director, stopSimTime, "Summary saved: " + seriesPath);
+        }
     }
     // send termination marker for logger after children have had a chance to log shutdown
     if (ok) {
@@ -838,6 +970,8 @@ int Director::run(const std::string& selfPath, const Config& config, const std::
     }
     waitWithTimeout(loggerPid, "logger");
 
+    seriesRecorder.stop();
+    metricsPublisher.stop();
     destroyIpc(ids, shared);
 
     return ok ? 0 : 1;
@@ -0,0 +1,31 @@
+#include "ipc/aging_receive.hpp"
+
+#include <sys/ipc.h>
+
+bool receiveAged(MessageQueue& queue, EventMessage& ev, long firstType, AgingLane* lanes, int classes,
+                 const AgingPolicy& policy) {
+    int pick = -1;
+    if (policy.enabled()) {
+        long long nowNs = hopClockNs();
+        long long headAgeMs[kMaxAgingClasses];
+        for (int c = 0; c < classes; ++c) {
+            headAgeMs[c] = lanes[c].headAgeMs(nowNs);
+        }
+        pick = pickAgedClass(headAgeMs, classes, policy);
+    }
+    return receiveClass(queue, ev, firstType, lanes, classes, pick);
+}
+
+bool receiveClass(MessageQueue& queue, EventMessage& ev, long firstType, AgingLane* lanes, int classes, int pick) {
+    // Class 0 is what the strict receive returns anyway.
+    if (pick > 0 && pick < classes && queue.receive(&ev, sizeof(EventMessage), firstType + pick, IPC_NOWAIT)) {
+        lanes[pick].noteDequeue();
+        return true;
+    }
+    if (!queue.receive(&ev, sizeof(EventMessage), -(firstType + classes - 1))) {
+        return false;
+    }
+    long cls = ev.mtype - firstType;
+    if (cls >= 0 && cls < classes) lanes[cls].noteDequeue();
+    return true;
+}
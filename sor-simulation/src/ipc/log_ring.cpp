@@ -0,0 +1,361 @@
+#include "ipc/log_ring.hpp"
+
+#include "util/error.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+constexpr uint32_t kArenaMagic = 0x534f524c; // "SORL"
+constexpr uint32_t kArenaVersion = 1;
+constexpr size_t kCacheLine = 64;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "log rings need lock-free 64-bit atomics");
+static_assert(std::atomic<int32_t>::is_always_lock_free, "log rings need lock-free 32-bit atomics");
+
+/** @brief Slot prefix: producer's stamp and the stored record length. */
+struct LogSlotHeader {
+    uint64_t stampNs;
+    uint64_t size;
+};
+
+/**
+ * @brief One ring: the lease word, the producer index and the consumer index on separate lines.
+ * head is only written by the current leaseholder, tail only by the consumer.
+ */
+struct alignas(kCacheLine) LogRingHeader {
+    std::atomic<int32_t> owner; // pid of the leaseholder, 0 = free
+    alignas(kCacheLine) std::atomic<uint64_t> head;
+    alignas(kCacheLine) std::atomic<uint64_t> tail;
+};
+
+size_t roundUpPow2(size_t v) {
+    size_t p = 2;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+size_t alignUp(size_t v, size_t a) {
+    return (v + a - 1) / a * a;
+}
+
+int futexWait(std::atomic<uint32_t>* addr, uint32_t expected, int timeoutMs) {
+    struct timespec ts {};
+    ts.tv_sec = timeoutMs / 1000;
+    ts.tv_nsec = static_cast<long>(timeoutMs % 1000) * 1000000L;
+    return static_cast<int>(syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT,
+                                    expected, &ts, nullptr, 0));
+}
+
+void futexWakeAll(std::atomic<uint32_t>* addr) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+} // namespace
+
+struct LogRingArenaHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t ringCount;
+    uint64_t ringSlots;
+    uint64_t slotBytes;
+    uint64_t slotStride;
+    uint64_t totalBytes;
+    std::atomic<uint32_t> closed;
+    // Consumer sets `sleeping` before it parks on `doorbell`; the first producer to clear it rings.
+    alignas(kCacheLine) std::atomic<uint32_t> doorbell;
+    std::atomic<uint32_t> sleeping;
+    alignas(kCacheLine) std::atomic<uint64_t> dropped;
+};
+
+namespace {
+size_t ringsOffset() {
+    return alignUp(sizeof(LogRingArenaHeader), kCacheLine);
+}
+
+size_t slotsOffset(const LogRingArenaHeader* h) {
+    return ringsOffset() + static_cast<size_t>(h->ringCount) * sizeof(LogRingHeader);
+}
+
+LogRingHeader& ringAt(LogRingArenaHeader* h, size_t ring) {
+    auto* base = reinterpret_cast<unsigned char*>(h) + ringsOffset();
+    return reinterpret_cast<LogRingHeader*>(base)[ring];
+}
+
+LogSlotHeader* slotAt(LogRingArenaHeader* h, size_t ring, uint64_t pos) {
+    auto* base = reinterpret_cast<unsigned char*>(h) + slotsOffset(h);
+    size_t index = ring * h->ringSlots + static_cast<size_t>(pos & (h->ringSlots - 1));
+    return reinterpret_cast<LogSlotHeader*>(base + index * h->slotStride);
+}
+
+unsigned char* slotPayload(LogSlotHeader* s) {
+    return reinterpret_cast<unsigned char*>(s) + sizeof(LogSlotHeader);
+}
+
+bool anyRingHasData(LogRingArenaHeader* h) {
+    for (size_t i = 0; i < h->ringCount; ++i) {
+        LogRingHeader& r = ringAt(h, i);
+        if (r.head.load(std::memory_order_acquire) != r.tail.load(std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief Wake the consumer if it is parked (pairs with the fence in waitForData). */
+void ringDoorbell(LogRingArenaHeader* h) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (h->sleeping.load(std::memory_order_relaxed) != 0 && h->sleeping.exchange(0, std::memory_order_seq_cst) != 0) {
+        h->doorbell.fetch_add(1, std::memory_order_seq_cst);
+        futexWakeAll(&h->doorbell);
+    }
+}
+} // namespace
+
+LogRingArena::LogRingArena() : header(nullptr), mappedBytes(0) {}
+
+LogRingArena::~LogRingArena() {
+    close();
+}
+
+std::string LogRingArena::nameForKey(key_t key) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "/sor_logring_%08x", static_cast<unsigned int>(key));
+    return buf;
+}
+
+// Create the segment; ftruncate zero-fills it, so every ring starts free and empty.
+bool LogRingArena::create(const std::string& name, size_t rings, size_t ringSlots, size_t slotBytes,
+                          int permissions) {
+    close();
+    if (rings == 0 || ringSlots == 0 || slotBytes == 0) {
+        errno = EINVAL;
+        return false;
+    }
+    size_t slots = roundUpPow2(ringSlots);
+    size_t stride = alignUp(sizeof(LogSlotHeader) + slotBytes, alignof(LogSlotHeader));
+    size_t total = ringsOffset() + rings * sizeof(LogRingHeader) + rings * slots * stride;
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, static_cast<mode_t>(permissions));
+    if (fd == -1) {
+        logErrno("shm_open log rings failed");
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(total)) == -1) {
+        logErrno("ftruncate log rings failed");
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* addr = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        logErrno("mmap log rings failed");
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    auto* h = new (addr) LogRingArenaHeader();
+    h->magic = kArenaMagic;
+    h->version = kArenaVersion;
+    h->ringCount = rings;
+    h->ringSlots = slots;
+    h->slotBytes = slotBytes;
+    h->slotStride = stride;
+    h->totalBytes = total;
+    for (size_t i = 0; i < rings; ++i) {
+        new (&ringAt(h, i)) LogRingHeader();
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    header = h;
+    mappedBytes = total;
+    shmName = name;
+    return true;
+}
+
+// Map an existing arena and validate its header.
+bool LogRingArena::open(const std::string& name) {
+    close();
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd == -1) {
+        if (errno != ENOENT) {
+            logErrno("shm_open log rings open failed");
+        }
+        return false;
+    }
+    struct stat st {};
+    if (fstat(fd, &st) == -1 || static_cast<size_t>(st.st_size) < sizeof(LogRingArenaHeader)) {
+        logErrno("log rings segment too small");
+        ::close(fd);
+        errno = EINVAL;
+        return false;
+    }
+    size_t total = static_cast<size_t>(st.st_size);
+    void* addr = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        logErrno("mmap log rings open failed");
+        return false;
+    }
+    auto* h = static_cast<LogRingArenaHeader*>(addr);
+    if (h->magic != kArenaMagic || h->version != kArenaVersion || h->totalBytes != total) {
+        munmap(addr, total);
+        errno = EINVAL;
+        logErrno("log rings header mismatch");
+        return false;
+    }
+    header = h;
+    mappedBytes = total;
+    shmName = name;
+    return true;
+}
+
+// Lease -> stamp -> copy -> publish -> release; a busy or full ring is skipped, never waited for.
+bool LogRingArena::push(const void* data, size_t size, int& hint) {
+    if (!header || size > header->slotBytes) {
+        errno = EINVAL;
+        return false;
+    }
+    LogRingArenaHeader* h = header;
+    if (h->closed.load(std::memory_order_acquire)) {
+        errno = EIDRM;
+        return false;
+    }
+    const int32_t self = static_cast<int32_t>(getpid());
+    const size_t rings = static_cast<size_t>(h->ringCount);
+    const size_t start = static_cast<size_t>(hint < 0 ? 0 : hint) % rings;
+    for (size_t k = 0; k < rings; ++k) {
+        size_t ring = (start + k) % rings;
+        LogRingHeader& r = ringAt(h, ring);
+        int32_t expected = 0;
+        if (r.owner.load(std::memory_order_relaxed) != 0 ||
+            !r.owner.compare_exchange_strong(expected, self, std::memory_order_acquire, std::memory_order_relaxed)) {
+            continue;
+        }
+        uint64_t pos = r.head.load(std::memory_order_relaxed);
+        if (pos - r.tail.load(std::memory_order_acquire) >= h->ringSlots) {
+            r.owner.store(0, std::memory_order_release);
+            continue; // full
+        }
+        LogSlotHeader* slot = slotAt(h, ring, pos);
+        slot->stampNs = nowNs();
+        slot->size = size;
+        std::memcpy(slotPayload(slot), data, size);
+        r.head.store(pos + 1, std::memory_order_release);
+        r.owner.store(0, std::memory_order_release);
+        hint = static_cast<int>(ring);
+        ringDoorbell(h);
+        return true;
+    }
+    h->dropped.fetch_add(1, std::memory_order_relaxed);
+    errno = EAGAIN;
+    return false;
+}
+
+size_t LogRingArena::ringCount() const {
+    return header ? static_cast<size_t>(header->ringCount) : 0;
+}
+
+const void* LogRingArena::peek(size_t ring, uint64_t& stampNs, size_t& size) const {
+    LogRingHeader& r = ringAt(header, ring);
+    uint64_t pos = r.tail.load(std::memory_order_relaxed);
+    if (r.head.load(std::memory_order_acquire) == pos) {
+        return nullptr;
+    }
+    LogSlotHeader* slot = slotAt(header, ring, pos);
+    stampNs = slot->stampNs;
+    size = static_cast<size_t>(slot->size);
+    return slotPayload(slot);
+}
+
+void LogRingArena::pop(size_t ring) {
+    LogRingHeader& r = ringAt(header, ring);
+    r.tail.store(r.tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// Announce the sleep, then re-check the rings: a producer publishing after the check sees `sleeping`.
+bool LogRingArena::waitForData(int timeoutMs) {
+    if (!header) return false;
+    LogRingArenaHeader* h = header;
+    h->sleeping.store(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    uint32_t observed = h->doorbell.load(std::memory_order_seq_cst);
+    if (anyRingHasData(h) || h->closed.load(std::memory_order_acquire)) {
+        h->sleeping.store(0, std::memory_order_relaxed);
+        return true;
+    }
+    futexWait(&h->doorbell, observed, timeoutMs);
+    h->sleeping.store(0, std::memory_order_relaxed);
+    return h->doorbell.load(std::memory_order_acquire) != observed;
+}
+
+size_t LogRingArena::reclaimDeadOwners() {
+    if (!header) return 0;
+    size_t reclaimed = 0;
+    for (size_t i = 0; i < header->ringCount; ++i) {
+        LogRingHeader& r = ringAt(header, i);
+        int32_t owner = r.owner.load(std::memory_order_acquire);
+        if (owner <= 0 || kill(owner, 0) == 0 || errno != ESRCH) continue;
+        // A push that died before publishing left head untouched, so the ring is consistent.
+        if (r.owner.compare_exchange_strong(owner, 0, std::memory_order_acq_rel)) {
+            ++reclaimed;
+        }
+    }
+    return reclaimed;
+}
+
+uint64_t LogRingArena::dropped() const {
+    return header ? header->dropped.load(std::memory_order_relaxed) : 0;
+}
+
+uint64_t LogRingArena::nowNs() {
+    struct timespec ts {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+bool LogRingArena::isOpen() const {
+    return header != nullptr;
+}
+
+void LogRingArena::close() {
+    if (header) {
+        munmap(header, mappedBytes);
+        header = nullptr;
+        mappedBytes = 0;
+    }
+}
+
+bool LogRingArena::destroy() {
+    if (!header) {
+        logErrno("LogRingArena::destroy called before create");
+        return false;
+    }
+    header->closed.store(1, std::memory_order_release);
+    header->doorbell.fetch_add(1, std::memory_order_seq_cst);
+    futexWakeAll(&header->doorbell);
+    bool ok = true;
+    if (shm_unlink(shmName.c_str()) == -1 && errno != ENOENT) {
+        logErrno("shm_unlink log rings failed");
+        ok = false;
+    }
+    close();
+    return ok;
+}
+
+void LogRingArena::unlink(const std::string& name) {
+    shm_unlink(name.c_str());
+}
@@ -1,16 +1,37 @@
 #include "ipc/message_queue.hpp"
 
+#include "ipc/shm_ring.hpp"
 #include "util/error.hpp"
 
 #include <sys/ipc.h>
 #include <sys/msg.h>
 #include <cerrno>
+#include <cstdio>
 #include <cstring>
+#include <string>
+
+namespace {
+/** @brief POSIX shm name for the ring that stands in for a SysV key. */
+std::string ringNameForKey(key_t key) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "/sor_ring_%08x", static_cast<unsigned int>(key));
+    return buf;
+}
+
+/** @brief Expected control-flow errors that callers handle themselves (no stderr noise). */
+bool isQuietErrno(int err) {
+    return err == EINTR || err == EAGAIN || err == ENOMSG || err == EIDRM || err == EINVAL;
+}
+} // namespace
 
 MessageQueue::MessageQueue() : mqId(-1) {}
 
 MessageQueue::~MessageQueue() = default;
 
+MessageQueue::MessageQueue(MessageQueue&&) noexcept = default;
+
+MessageQueue& MessageQueue::operator=(MessageQueue&&) noexcept = default;
+
 // Create/open a SysV message queue and cache its id.
 bool MessageQueue::create(key_t key, int permissions) {
     mqId = msgget(key, IPC_CREAT | permissions);
@@ -21,9 +42,22 @@ bool MessageQueue::create(key_t key, int permissions) {
     return true;
 }
 
+// Create a shared-memory ring; a leftover object with the same name is removed first.
+bool MessageQueue::createRing(key_t key, size_t laneSlots, size_t slotBytes, int permissions) {
+    std::string name = ringNameForKey(key);
+    ShmRing::unlink(name);
+    auto created = std::make_unique<ShmRing>();
+    if (!created->create(name, laneSlots, slotBytes, permissions)) {
+        return false;
+    }
+    ring = std::move(created);
+    mqId = -1;
+    return true;
+}
+
 // Send a message: writes mtype header then dispatches payload.
-bool MessageQueue::send(const void* msg, size_t size, long type) {
-    if (mqId == -1) {
+bool MessageQueue::send(const void* msg, size_t size, long type, int flags) {
+    if (mqId == -1 && !ring) {
         logErrno("MessageQueue::send called before create");
         return false;
     }
@@ -35,10 +69,22 @@ bool MessageQueue::send(const void* msg, size_t size, long type) {
     // ensure mtype is set
     long* mutableMsg = const_cast<long*>(reinterpret_cast<const long*>(msg));
     mutableMsg[0] = type;
-    size_t payloadSize = size - sizeof(long);
 
-    if (msgsnd(mqId, msg, payloadSize, 0) == -1) {
-        logErrno("msgsnd failed");
+    if (ring) {
+        if (!ring->push(msg, size, type, (flags & IPC_NOWAIT) != 0)) {
+            int err = errno;
+            if (!isQuietErrno(err)) logErrno("ring push failed");
+            errno = err;
+            return false;
+        }
+        return true;
+    }
+
+    size_t payloadSize = size - sizeof(long);
+    if (msgsnd(mqId, msg, payloadSize, flags) == -1) {
+        int err = errno;
+        if (!isQuietErrno(err)) logErrno("msgsnd failed");
+        errno = err;
         return false;
     }
     return true;
@@ -46,7 +92,7 @@ bool MessageQueue::send(const void* msg, size_t size, long type) {
 
 // Receive a message with optional msgtyp filtering and flags.
 bool MessageQueue::receive(void* buffer, size_t size, long type, int flags) {
-    if (mqId == -1) {
+    if (mqId == -1 && !ring) {
         logErrno("MessageQueue::receive called before create");
         return false;
     }
@@ -55,20 +101,53 @@ bool MessageQueue::receive(void* buffer, size_t size, long type, int flags) {
         return false;
     }
 
+    if (ring) {
+        if (!ring->pop(buffer, size, type, (flags & IPC_NOWAIT) != 0)) {
+            int err = errno;
+            if (!isQuietErrno(err)) logErrno("ring pop failed");
+            errno = err;
+            return false;
+        }
+        return true;
+    }
+
     size_t payloadSize = size - sizeof(long);
     if (msgrcv(mqId, buffer, payloadSize, type, flags) == -1) {
-        logErrno("msgrcv failed");
+        int err = errno;
+        if (!isQuietErrno(err)) logErrno("msgrcv failed");
+        errno = err;
         return false;
     }
     return true;
 }
 
+int MessageQueue::length() const {
+    if (ring) {
+        return ring->size();
+    }
+    if (mqId == -1) return 0;
+    struct msqid_ds stats {};
+    if (msgctl(mqId, IPC_STAT, &stats) == -1) {
+        return 0;
+    }
+    return static_cast<int>(stats.msg_qnum);
+}
+
 int MessageQueue::id() const {
     return mqId;
 }
 
-// Remove the queue (IPC_RMID).
+QueueTransport MessageQueue::transport() const {
+    return ring ? QueueTransport::ShmRing : QueueTransport::SysV;
+}
+
+// Remove the queue (IPC_RMID) or unlink the ring segment.
 bool MessageQueue::destroy() {
+    if (ring) {
+        bool ok = ring->destroy();
+        ring.reset();
+        return ok;
+    }
     if (mqId == -1) {
         logErrno("MessageQueue::destroy called before create");
         return false;
@@ -77,11 +156,21 @@ bool MessageQueue::destroy() {
         logErrno("msgctl IPC_RMID failed");
         return false;
     }
+    mqId = -1;
     return true;
 }
 
 // Attach to an existing queue without creating it.
-bool MessageQueue::open(key_t key) {
+bool MessageQueue::open(key_t key, QueueTransport transport) {
+    if (transport == QueueTransport::ShmRing) {
+        auto opened = std::make_unique<ShmRing>();
+        if (!opened->open(ringNameForKey(key))) {
+            return false;
+        }
+        ring = std::move(opened);
+        mqId = -1;
+        return true;
+    }
     mqId = msgget(key, 0);
     if (mqId == -1) {
         logErrno("msgget open failed");
@@ -89,3 +178,8 @@ bool MessageQueue::open(key_t key) {
     }
     return true;
 }
+
+// Remove a ring left behind by a run whose director died (ENOENT is fine).
+void MessageQueue::unlinkRing(key_t key) {
+    ShmRing::unlink(ringNameForKey(key));
+}
@@ -0,0 +1,295 @@
+#include "ipc/run_namespace.hpp"
+
+#include "ipc/log_ring.hpp"
+#include "ipc/message_queue.hpp"
+#include "model/types.hpp"
+#include "util/error.hpp"
+
+#include <sys/ipc.h>
+#include <sys/msg.h>
+#include <sys/sem.h>
+#include <sys/shm.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+/** @brief High byte tagging run-scoped keys; the 16-bit slot and the project id fill the rest. */
+constexpr key_t kKeyTag = static_cast<key_t>(0x53000000);
+constexpr int kSlotCount = 1 << 16;
+constexpr const char* kRegistryPrefix = "run-";
+constexpr const char* kRegistrySuffix = ".reg";
+constexpr long kIncompleteRecordGraceSec = 60;
+
+/**
+ * @brief Contents of one registry file.
+ */
+struct RunRecord {
+    std::string runId;
+    key_t keyBase{0};
+    pid_t directorPid{0};
+    unsigned long long startTicks{0};
+    int shmRing{0};
+};
+
+key_t baseForSlot(int slot) {
+    return kKeyTag | static_cast<key_t>(slot << 8);
+}
+
+/** @brief Every project id a run uses. */
+std::vector<char> runProjectIds() {
+    std::vector<char> ids{kLogKeyId, kRegistrationKeyId, kTriageKeyId, kWaitingRoomKeyId, kSharedStateKeyId,
+                         kRegistrationGateKeyId};
+    for (int i = 0; i < kSpecialistCount; ++i) {
+        ids.push_back(static_cast<char>(kFirstSpecialistKeyId + i));
+    }
+    return ids;
+}
+
+/** @brief Process start time in clock ticks (/proc/<pid>/stat field 22), 0 if unavailable. */
+unsigned long long processStartTicks(pid_t pid) {
+    std::ifstream in("/proc/" + std::to_string(pid) + "/stat");
+    std::string line;
+    if (!in || !std::getline(in, line)) {
+        return 0;
+    }
+    // comm (field 2) may contain spaces; fields after the closing ')' are space separated.
+    size_t close = line.rfind(')');
+    if (close == std::string::npos) {
+        return 0;
+    }
+    std::istringstream fields(line.substr(close + 2));
+    std::string field;
+    unsigned long long ticks = 0;
+    for (int idx = 3; idx <= 22 && (fields >> field); ++idx) {
+        if (idx == 22) {
+            try {
+                ticks = std::stoull(field);
+            } catch (const std::exception&) {
+                ticks = 0;
+            }
+        }
+    }
+    return ticks;
+}
+
+bool readRecord(const std::string& path, RunRecord& record) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    bool haveBase = false;
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        std::string key = line.substr(0, eq);
+        std::string val = line.substr(eq + 1);
+        try {
+            if (key == "runId") record.runId = val;
+            else if (key == "keyBase") { record.keyBase = static_cast<key_t>(std::stol(val)); haveBase = true; }
+            else if (key == "directorPid") record.directorPid = static_cast<pid_t>(std::stol(val));
+            else if (key == "startTicks") record.startTicks = std::stoull(val);
+            else if (key == "shmRing") record.shmRing = std::stoi(val);
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return haveBase;
+}
+
+/** @brief True when some IPC object (of any program) already uses one of the slot's keys. */
+bool slotOccupied(key_t base) {
+    for (char id : runProjectIds()) {
+        key_t key = base | static_cast<key_t>(id);
+        if (msgget(key, 0) != -1 || semget(key, 0, 0) != -1 || shmget(key, 0, 0) != -1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief Remove every object a run may have created; missing ones are ignored. */
+void removeRunObjects(key_t base) {
+    for (char id : runProjectIds()) {
+        key_t key = base | static_cast<key_t>(id);
+        int qid = msgget(key, 0);
+        if (qid != -1) msgctl(qid, IPC_RMID, nullptr);
+        int sid = semget(key, 0, 0);
+        if (sid != -1) semctl(sid, 0, IPC_RMID);
+        int mid = shmget(key, 0, 0);
+        if (mid != -1) shmctl(mid, IPC_RMID, nullptr);
+        MessageQueue::unlinkRing(key);
+        LogRingArena::unlink(LogRingArena::nameForKey(key));
+    }
+}
+
+/** @brief Director is gone, or its pid now belongs to a process started at another time. */
+bool isOrphaned(const RunRecord& record) {
+    if (record.directorPid <= 0) {
+        return true;
+    }
+    if (kill(record.directorPid, 0) == -1 && errno == ESRCH) {
+        return true;
+    }
+    unsigned long long ticks = processStartTicks(record.directorPid);
+    return record.startTicks != 0 && ticks != 0 && ticks != record.startTicks;
+}
+
+bool ensureRegistryDir() {
+    if (mkdir(kRunRegistryDir, 0777) == 0) {
+        // Shared like /tmp: anyone may register, only owners may remove their files.
+        chmod(kRunRegistryDir, 01777);
+        return true;
+    }
+    if (errno == EEXIST) {
+        return true;
+    }
+    logErrno("mkdir run registry failed");
+    return false;
+}
+} // namespace
+
+RunNamespace::~RunNamespace() {
+    release();
+}
+
+// Reserve the first free slot starting at a pid/time derived position.
+bool RunNamespace::create(bool shmRingTransport) {
+    if (!ensureRegistryDir()) {
+        return false;
+    }
+    pid_t self = getpid();
+    int start = static_cast<int>((static_cast<unsigned long>(self) * 2654435761UL ^
+                                  static_cast<unsigned long>(std::time(nullptr))) % kSlotCount);
+    for (int probe = 0; probe < kSlotCount; ++probe) {
+        int slot = (start + probe) % kSlotCount;
+        key_t base = baseForSlot(slot);
+        char idBuf[16];
+        std::snprintf(idBuf, sizeof(idBuf), "%04x", slot);
+        std::string path = std::string(kRunRegistryDir) + "/" + kRegistryPrefix + idBuf + kRegistrySuffix;
+        int fd = ::open(path.c_str(), O_CREAT | O_EXCL | O_WRONLY, 0644);
+        if (fd == -1) {
+            if (errno == EEXIST) continue;  // another run holds this slot
+            logErrno("create run registry file failed");
+            return false;
+        }
+        if (slotOccupied(base)) {
+            // Keys taken by something we do not own; leave it alone and try the next slot.
+            ::close(fd);
+            ::unlink(path.c_str());
+            continue;
+        }
+        std::ostringstream content;
+        content << "runId=" << idBuf << "\n"
+                << "keyBase=" << base << "\n"
+                << "directorPid=" << self << "\n"
+                << "startTicks=" << processStartTicks(self) << "\n"
+                << "shmRing=" << (shmRingTransport ? 1 : 0) << "\n";
+        std::string text = content.str();
+        bool written = ::write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size());
+        ::close(fd);
+        if (!written) {
+            logErrno("write run registry file failed");
+            ::unlink(path.c_str());
+            return false;
+        }
+        path_ = path;
+        runId_ = idBuf;
+        base_ = base;
+        return true;
+    }
+    errno = ENOSPC;
+    logErrno("no free run namespace slot");
+    return false;
+}
+
+key_t RunNamespace::key(char projId) const {
+    return base_ | static_cast<key_t>(projId);
+}
+
+void RunNamespace::release() {
+    if (!path_.empty()) {
+        ::unlink(path_.c_str());
+        path_.clear();
+    }
+}
+
+// Registry paths resolve through the file (cached per process); anything else falls back to ftok.
+key_t ipcKey(const std::string& keyPath, char projId) {
+    const std::string suffix = kRegistrySuffix;
+    bool isRegistry = keyPath.size() > suffix.size() &&
+                      keyPath.compare(keyPath.size() - suffix.size(), suffix.size(), suffix) == 0;
+    if (!isRegistry) {
+        return ftok(keyPath.c_str(), projId);
+    }
+    static std::mutex cacheMutex;
+    static std::string cachedPath;
+    static key_t cachedBase = 0;
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (cachedPath != keyPath) {
+        RunRecord record;
+        if (!readRecord(keyPath, record)) {
+            errno = ENOENT;
+            return -1;
+        }
+        cachedPath = keyPath;
+        cachedBase = record.keyBase;
+    }
+    return cachedBase | static_cast<key_t>(projId);
+}
+
+int cleanupOrphanedRuns(bool verbose) {
+    DIR* dir = opendir(kRunRegistryDir);
+    if (!dir) {
+        return 0;
+    }
+    std::vector<std::string> files;
+    while (dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        const std::string suffix = kRegistrySuffix;
+        if (name.rfind(kRegistryPrefix, 0) == 0 && name.size() > suffix.size() &&
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            files.push_back(std::string(kRunRegistryDir) + "/" + name);
+        }
+    }
+    closedir(dir);
+
+    int removed = 0;
+    for (const std::string& path : files) {
+        RunRecord record;
+        if (!readRecord(path, record)) {
+            // Usually half-written by a director that is starting right now; stale after a grace period.
+            struct stat st {};
+            if (stat(path.c_str(), &st) == 0 && std::time(nullptr) - st.st_mtime > kIncompleteRecordGraceSec) {
+                ::unlink(path.c_str());
+            }
+            continue;
+        }
+        if (!isOrphaned(record)) {
+            if (verbose) {
+                std::cout << "live run " << record.runId << " director=" << record.directorPid << "\n";
+            }
+            continue;
+        }
+        removeRunObjects(record.keyBase);
+        if (::unlink(path.c_str()) == 0 || errno == ENOENT) {
+            ++removed;
+            if (verbose) {
+                std::cout << "removed orphaned run " << record.runId << " (director " << record.directorPid
+                          << " gone)\n";
+            }
+        }
+    }
+    return removed;
+}
@@ -6,21 +6,24 @@
 #include <sys/sem.h>
 #include <cerrno>
 #include <cstring>
+#include <ctime>
 
 Semaphore::Semaphore() : semId(-1) {}
 
 Semaphore::~Semaphore() = default;
 
-// Create a single-count System V semaphore and initialize its value.
-bool Semaphore::create(key_t key, int initialValue, int permissions) {
-    semId = semget(key, 1, IPC_CREAT | permissions);
+// Create a System V semaphore set and initialize every member to the same value.
+bool Semaphore::create(key_t key, int initialValue, int permissions, int count) {
+    semId = semget(key, count, IPC_CREAT | permissions);
     if (semId == -1) {
         logErrno("semget failed");
         return false;
     }
-    if (semctl(semId, 0, SETVAL, initialValue) == -1) {
-        logErrno("semctl SETVAL failed");
-        return false;
+    for (int i = 0; i < count; ++i) {
+        if (semctl(semId, i, SETVAL, initialValue) == -1) {
+            logErrno("semctl SETVAL failed");
+            return false;
+        }
     }
     return true;
 }
@@ -43,12 +46,25 @@ bool Semaphore::wait() {
     }
 }
 
+// Timed P-operation; EINTR is reported so signal-driven shutdown can be observed.
+bool Semaphore::waitFor(int timeoutMs, int index) {
+    if (semId == -1) {
+        errno = EINVAL;
+        return false;
+    }
+    struct sembuf op {static_cast<unsigned short>(index), -1, 0};
+    struct timespec timeout {};
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_nsec = static_cast<long>(timeoutMs % 1000) * 1000000L;
+    return semtimedop(semId, &op, 1, &timeout) == 0;
+}
+
 // V-operation (semop +1) to release.
-bool Semaphore::post() {
+bool Semaphore::post(int index) {
     if (semId == -1) {
         return false;
     }
-    struct sembuf op {0, 1, 0};
+    struct sembuf op {static_cast<unsigned short>(index), 1, 0};
     while (true) {
         if (semop(semId, &op, 1) == 0) {
             return true;
@@ -0,0 +1,424 @@
+#include "ipc/shm_ring.hpp"
+
+#include "util/error.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+constexpr uint32_t kRingMagic = 0x534f5252; // "SORR"
+constexpr uint32_t kRingVersion = 1;
+constexpr int kFutexWaitSliceMs = 200; // bounded sleeps so a dead peer cannot park us forever
+constexpr size_t kCacheLine = 64;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring needs lock-free 64-bit atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "ring needs lock-free 32-bit atomics");
+static_assert(std::atomic<long>::is_always_lock_free, "ring needs lock-free long atomics");
+
+/** @brief Slot prefix: Vyukov sequence number plus stored payload length. */
+struct SlotHeader {
+    std::atomic<uint64_t> seq;
+    uint64_t size;
+};
+
+/** @brief Event counter used with futex wait/wake (address-free across processes). */
+struct alignas(kCacheLine) WaitPoint {
+    std::atomic<uint32_t> seq;
+    std::atomic<uint32_t> waiters;
+};
+
+struct alignas(kCacheLine) LaneHeader {
+    std::atomic<long> mtype; // 0 = unclaimed
+    alignas(kCacheLine) std::atomic<uint64_t> enqueuePos;
+    alignas(kCacheLine) std::atomic<uint64_t> dequeuePos;
+};
+
+size_t roundUpPow2(size_t v) {
+    size_t p = 2;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+size_t alignUp(size_t v, size_t a) {
+    return (v + a - 1) / a * a;
+}
+
+int futexWait(std::atomic<uint32_t>* addr, uint32_t expected, int timeoutMs) {
+    struct timespec ts {};
+    ts.tv_sec = timeoutMs / 1000;
+    ts.tv_nsec = static_cast<long>(timeoutMs % 1000) * 1000000L;
+    return static_cast<int>(syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT,
+                                    expected, &ts, nullptr, 0));
+}
+
+void futexWakeAll(std::atomic<uint32_t>* addr) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+void notify(WaitPoint& wp) {
+    wp.seq.fetch_add(1, std::memory_order_seq_cst);
+    if (wp.waiters.load(std::memory_order_seq_cst) > 0) {
+        futexWakeAll(&wp.seq);
+    }
+}
+} // namespace
+
+struct ShmRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t laneSlots;
+    uint64_t slotBytes;
+    uint64_t slotStride;
+    uint64_t totalBytes;
+    std::atomic<uint32_t> closed;
+    WaitPoint notEmpty;
+    WaitPoint notFull;
+    LaneHeader lanes[ShmRing::kMaxLanes];
+};
+
+namespace {
+size_t slotsOffset() {
+    return alignUp(sizeof(ShmRingHeader), kCacheLine);
+}
+
+SlotHeader* slotAt(ShmRingHeader* h, int lane, uint64_t pos) {
+    auto* base = reinterpret_cast<unsigned char*>(h) + slotsOffset();
+    size_t index = static_cast<size_t>(lane) * h->laneSlots + static_cast<size_t>(pos & (h->laneSlots - 1));
+    return reinterpret_cast<SlotHeader*>(base + index * h->slotStride);
+}
+
+unsigned char* slotPayload(SlotHeader* s) {
+    return reinterpret_cast<unsigned char*>(s) + sizeof(SlotHeader);
+}
+
+bool typeMatches(long want, long have) {
+    if (want == 0) return true;
+    if (want > 0) return have == want;
+    return have <= -want;
+}
+
+/** @brief True if the lane head holds a published message (racy hint, no ownership). */
+bool laneHasItem(ShmRingHeader* h, int lane) {
+    uint64_t pos = h->lanes[lane].dequeuePos.load(std::memory_order_relaxed);
+    return slotAt(h, lane, pos)->seq.load(std::memory_order_acquire) == pos + 1;
+}
+
+/** @brief Pick the claimed lane with the lowest matching mtype that currently has data. */
+int bestLane(ShmRingHeader* h, long type) {
+    int best = -1;
+    long bestType = 0;
+    for (int i = 0; i < ShmRing::kMaxLanes; ++i) {
+        long m = h->lanes[i].mtype.load(std::memory_order_acquire);
+        if (m == 0 || !typeMatches(type, m)) continue;
+        if (best != -1 && m >= bestType) continue;
+        if (laneHasItem(h, i)) {
+            best = i;
+            bestType = m;
+        }
+    }
+    return best;
+}
+
+/** @brief Find (or claim) the lane serving mtype; -1 when all lanes serve other types. */
+int laneFor(ShmRingHeader* h, long type) {
+    for (int i = 0; i < ShmRing::kMaxLanes; ++i) {
+        long m = h->lanes[i].mtype.load(std::memory_order_acquire);
+        if (m == type) return i;
+        if (m == 0) {
+            long expected = 0;
+            if (h->lanes[i].mtype.compare_exchange_strong(expected, type, std::memory_order_acq_rel) ||
+                expected == type) {
+                return i;
+            }
+        }
+    }
+    return -1;
+}
+
+bool tryEnqueue(ShmRingHeader* h, int lane, const void* msg, size_t size) {
+    LaneHeader& l = h->lanes[lane];
+    uint64_t pos = l.enqueuePos.load(std::memory_order_relaxed);
+    SlotHeader* slot = nullptr;
+    while (true) {
+        slot = slotAt(h, lane, pos);
+        uint64_t seq = slot->seq.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+        if (diff == 0) {
+            if (l.enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            return false; // full
+        } else {
+            pos = l.enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+    slot->size = size;
+    std::memcpy(slotPayload(slot), msg, size);
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool tryDequeue(ShmRingHeader* h, int lane, void* buffer, size_t size) {
+    LaneHeader& l = h->lanes[lane];
+    uint64_t pos = l.dequeuePos.load(std::memory_order_relaxed);
+    SlotHeader* slot = nullptr;
+    while (true) {
+        slot = slotAt(h, lane, pos);
+        uint64_t seq = slot->seq.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1);
+        if (diff == 0) {
+            if (l.dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            return false; // empty
+        } else {
+            pos = l.dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+    size_t stored = static_cast<size_t>(slot->size);
+    std::memcpy(buffer, slotPayload(slot), stored < size ? stored : size);
+    slot->seq.store(pos + h->laneSlots, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Block on a wait point until ready() holds, the ring closes, or a signal interrupts.
+ * @return 0 when ready() may hold, otherwise EIDRM/EINTR.
+ */
+template <typename Ready>
+int waitUntil(ShmRingHeader* h, WaitPoint& wp, Ready ready) {
+    while (true) {
+        if (h->closed.load(std::memory_order_acquire)) return EIDRM;
+        wp.waiters.fetch_add(1, std::memory_order_seq_cst);
+        uint32_t observed = wp.seq.load(std::memory_order_seq_cst);
+        if (ready() || h->closed.load(std::memory_order_acquire)) {
+            wp.waiters.fetch_sub(1, std::memory_order_seq_cst);
+            return h->closed.load(std::memory_order_acquire) ? EIDRM : 0;
+        }
+        int rc = futexWait(&wp.seq, observed, kFutexWaitSliceMs);
+        int err = errno;
+        wp.waiters.fetch_sub(1, std::memory_order_seq_cst);
+        if (rc == -1 && err == EINTR) return EINTR;
+        if (wp.seq.load(std::memory_order_acquire) != observed) return 0;
+        // Timed out or spurious wakeup: re-check predicate on the next iteration.
+    }
+}
+} // namespace
+
+ShmRing::ShmRing() : header(nullptr), mappedBytes(0) {}
+
+ShmRing::~ShmRing() {
+    close();
+}
+
+// Create the segment, size it and initialize lane sequence numbers.
+bool ShmRing::create(const std::string& name, size_t laneSlots, size_t slotBytes, int permissions) {
+    close();
+    if (laneSlots == 0 || slotBytes < sizeof(long)) {
+        errno = EINVAL;
+        return false;
+    }
+    size_t lanes = roundUpPow2(laneSlots);
+    size_t stride = alignUp(sizeof(SlotHeader) + slotBytes, alignof(SlotHeader));
+    size_t total = slotsOffset() + lanes * static_cast<size_t>(kMaxLanes) * stride;
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, static_cast<mode_t>(permissions));
+    if (fd == -1) {
+        logErrno("shm_open ring failed");
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(total)) == -1) {
+        logErrno("ftruncate ring failed");
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* addr = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        logErrno("mmap ring failed");
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    // ftruncate zero-fills, so atomics start at 0; only lane sequences need seeding.
+    auto* h = new (addr) ShmRingHeader();
+    h->magic = kRingMagic;
+    h->version = kRingVersion;
+    h->laneSlots = lanes;
+    h->slotBytes = slotBytes;
+    h->slotStride = stride;
+    h->totalBytes = total;
+    for (int lane = 0; lane < kMaxLanes; ++lane) {
+        for (uint64_t i = 0; i < lanes; ++i) {
+            slotAt(h, lane, i)->seq.store(i, std::memory_order_relaxed);
+        }
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    header = h;
+    mappedBytes = total;
+    shmName = name;
+    return true;
+}
+
+// Map an existing ring and validate its header.
+bool ShmRing::open(const std::string& name) {
+    close();
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd == -1) {
+        logErrno("shm_open ring open failed");
+        return false;
+    }
+    struct stat st {};
+    if (fstat(fd, &st) == -1 || static_cast<size_t>(st.st_size) < sizeof(ShmRingHeader)) {
+        logErrno("ring segment too small");
+        ::close(fd);
+        errno = EINVAL;
+        return false;
+    }
+    size_t total = static_cast<size_t>(st.st_size);
+    void* addr = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        logErrno("mmap ring open failed");
+        return false;
+    }
+    auto* h = static_cast<ShmRingHeader*>(addr);
+    if (h->magic != kRingMagic || h->version != kRingVersion || h->totalBytes != total) {
+        munmap(addr, total);
+        errno = EINVAL;
+        logErrno("ring header mismatch");
+        return false;
+    }
+    header = h;
+    mappedBytes = total;
+    shmName = name;
+    return true;
+}
+
+bool ShmRing::push(const void* msg, size_t size, long type, bool nowait) {
+    if (!header) {
+        errno = EINVAL;
+        return false;
+    }
+    if (type <= 0 || size > header->slotBytes) {
+        errno = EINVAL;
+        return false;
+    }
+    int lane = laneFor(header, type);
+    if (lane == -1) {
+        errno = ENOSPC;
+        return false;
+    }
+    while (true) {
+        if (header->closed.load(std::memory_order_acquire)) {
+            errno = EIDRM;
+            return false;
+        }
+        if (tryEnqueue(header, lane, msg, size)) {
+            notify(header->notEmpty);
+            return true;
+        }
+        if (nowait) {
+            errno = EAGAIN;
+            return false;
+        }
+        ShmRingHeader* h = header;
+        int rc = waitUntil(h, h->notFull, [h, lane]() {
+            LaneHeader& l = h->lanes[lane];
+            uint64_t pos = l.enqueuePos.load(std::memory_order_relaxed);
+            return slotAt(h, lane, pos)->seq.load(std::memory_order_acquire) == pos;
+        });
+        if (rc != 0) {
+            errno = rc;
+            return false;
+        }
+    }
+}
+
+bool ShmRing::pop(void* buffer, size_t size, long type, bool nowait) {
+    if (!header) {
+        errno = EINVAL;
+        return false;
+    }
+    while (true) {
+        if (header->closed.load(std::memory_order_acquire)) {
+            errno = EIDRM;
+            return false;
+        }
+        int lane = bestLane(header, type);
+        if (lane != -1) {
+            if (tryDequeue(header, lane, buffer, size)) {
+                notify(header->notFull);
+                return true;
+            }
+            continue; // lost the race for that head; rescan for the next best lane
+        }
+        if (nowait) {
+            errno = ENOMSG;
+            return false;
+        }
+        ShmRingHeader* h = header;
+        int rc = waitUntil(h, h->notEmpty, [h, type]() { return bestLane(h, type) != -1; });
+        if (rc != 0) {
+            errno = rc;
+            return false;
+        }
+    }
+}
+
+int ShmRing::size() const {
+    if (!header) return 0;
+    long long total = 0;
+    for (int i = 0; i < kMaxLanes; ++i) {
+        const LaneHeader& l = header->lanes[i];
+        long long enq = static_cast<long long>(l.enqueuePos.load(std::memory_order_relaxed));
+        long long deq = static_cast<long long>(l.dequeuePos.load(std::memory_order_relaxed));
+        if (enq > deq) total += enq - deq;
+    }
+    return static_cast<int>(total);
+}
+
+bool ShmRing::isOpen() const {
+    return header != nullptr;
+}
+
+void ShmRing::close() {
+    if (header) {
+        munmap(header, mappedBytes);
+        header = nullptr;
+        mappedBytes = 0;
+    }
+}
+
+// Flag closed so blocked peers return EIDRM (like IPC_RMID), then unlink the name.
+bool ShmRing::destroy() {
+    if (!header) {
+        logErrno("ShmRing::destroy called before create");
+        return false;
+    }
+    header->closed.store(1, std::memory_order_release);
+    notify(header->notEmpty);
+    notify(header->notFull);
+    bool ok = true;
+    if (shm_unlink(shmName.c_str()) == -1 && errno != ENOENT) {
+        logErrno("shm_unlink ring failed");
+        ok = false;
+    }
+    close();
+    return ok;
+}
+
+void ShmRing::unlink(const std::string& name) {
+    shm_unlink(name.c_str());
+}
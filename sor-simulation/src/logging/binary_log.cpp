@@ -0,0 +1,315 @@
+#include "logging/binary_log.hpp"
+
+#include "model/sim_rules.hpp"
+#include "util/error.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace {
+uint16_t saturate16(int value) {
+    return static_cast<uint16_t>(std::clamp(value, 0, 65535));
+}
+
+/** @brief Bounded append into a caller buffer; silently truncates like the old 128-byte text field. */
+class TextWriter {
+public:
+    TextWriter(char* out, size_t cap) : cur_(out), begin_(out), end_(out + cap) {}
+
+    TextWriter& str(std::string_view s) {
+        size_t n = std::min(s.size(), static_cast<size_t>(end_ - cur_));
+        std::memcpy(cur_, s.data(), n);
+        cur_ += n;
+        return *this;
+    }
+
+    TextWriter& num(int value) {
+        auto res = std::to_chars(cur_, end_, value);
+        if (res.ec == std::errc()) cur_ = res.ptr;
+        return *this;
+    }
+
+    size_t size() const { return static_cast<size_t>(cur_ - begin_); }
+
+private:
+    char* cur_;
+    char* begin_;
+    char* end_;
+};
+
+bool writeAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+} // namespace
+
+BinaryLogHeader makeBinaryLogHeader() {
+    BinaryLogHeader header{};
+    std::memcpy(header.magic, kBinaryLogMagic, sizeof(header.magic));
+    header.version = kBinaryLogVersion;
+    header.recordSize = sizeof(BinaryLogRecord);
+    header.flags = 0;
+    return header;
+}
+
+bool binaryLogHeaderValid(const BinaryLogHeader& header) {
+    return std::memcmp(header.magic, kBinaryLogMagic, sizeof(header.magic)) == 0 &&
+           header.version == kBinaryLogVersion && header.recordSize == sizeof(BinaryLogRecord);
+}
+
+std::string binaryLogPath(const std::string& textLogPath) {
+    const std::string ext = ".log";
+    if (textLogPath.size() > ext.size() &&
+        textLogPath.compare(textLogPath.size() - ext.size(), ext.size(), ext) == 0) {
+        return textLogPath.substr(0, textLogPath.size() - ext.size()) + ".sorbin";
+    }
+    return textLogPath + ".sorbin";
+}
+
+const char* roleLabel(Role role) {
+    switch (role) {
+        case Role::Director: return "director";
+        case Role::PatientGenerator: return "patient_gen";
+        case Role::Patient: return "patient";
+        case Role::Registration1: return "reg1";
+        case Role::Registration2: return "reg2";
+        case Role::Triage: return "triage";
+        case Role::SpecialistCardio:
+        case Role::SpecialistNeuro:
+        case Role::SpecialistOphthalmo:
+        case Role::SpecialistLaryng:
+        case Role::SpecialistSurgeon:
+        case Role::SpecialistPaediatric:
+            return "specialist";
+        case Role::Logger: return "logger";
+        default: return "unknown";
+    }
+}
+
+BinaryLogRecord packLogRecord(const LogMessage& msg, int stateSem) {
+    BinaryLogRecord rec{};
+    const LogEventFields& f = msg.fields;
+    rec.kind = static_cast<uint8_t>(f.kind);
+    rec.role = static_cast<uint8_t>(msg.role);
+    rec.simTime = msg.simTime;
+    rec.pid = msg.pid;
+    rec.subject = f.subject;
+    if (msg.hasMetrics) {
+        rec.flags |= kRecordHasMetrics;
+        rec.metrics[0] = saturate16(msg.metrics.waitingInside);
+        rec.metrics[1] = saturate16(msg.metrics.waitingCapacity);
+        rec.metrics[2] = saturate16(msg.metrics.registrationQueueLen);
+        rec.metrics[3] = saturate16(msg.metrics.triageQueueLen);
+        rec.metrics[4] = saturate16(msg.metrics.specialistsQueueLen);
+        rec.metrics[5] = saturate16(msg.metrics.waitSemaphoreValue);
+        if (stateSem != 0) rec.flags |= kRecordStateSem;
+    }
+    if (f.vip > 0) rec.flags |= kRecordVip;
+    if (f.guardian > 0) rec.flags |= kRecordGuardian;
+    if (f.outcome >= 0 && f.outcome <= 2) {
+        rec.flags |= static_cast<uint8_t>((f.outcome + 1) << kRecordOutcomeShift);
+    }
+    rec.persons = static_cast<uint8_t>(std::clamp(f.persons, 0, 255));
+    rec.age = static_cast<uint8_t>(f.age >= 0 ? std::min(f.age, 254) : 255);
+    rec.color = static_cast<int8_t>(std::clamp(f.color, -1, 127));
+    rec.specialist = static_cast<int8_t>(std::clamp(f.specialist, -1, 127));
+    if (!isTypedLogEvent(f.kind)) {
+        rec.textLen = static_cast<uint8_t>(strnlen(msg.text, sizeof(msg.text)));
+    }
+    return rec;
+}
+
+LogEventFields unpackLogFields(const BinaryLogRecord& rec) {
+    LogEventFields f;
+    f.kind = static_cast<LogEventKind>(rec.kind);
+    f.subject = rec.subject;
+    f.persons = rec.persons > 0 ? rec.persons : -1;
+    f.age = rec.age != 255 ? rec.age : -1;
+    f.vip = (rec.flags & kRecordVip) ? 1 : 0;
+    f.guardian = (rec.flags & kRecordGuardian) ? 1 : 0;
+    f.color = rec.color;
+    f.specialist = rec.specialist;
+    int outcome = (rec.flags >> kRecordOutcomeShift) & 3;
+    f.outcome = outcome > 0 ? outcome - 1 : -1;
+    return f;
+}
+
+bool isTypedLogEvent(LogEventKind kind) {
+    switch (kind) {
+        case LogEventKind::PatientWaitingOutside:
+        case LogEventKind::PatientArrived:
+        case LogEventKind::PatientRegistered:
+        case LogEventKind::RegisteringPatient:
+        case LogEventKind::RegistrationForwarded:
+        case LogEventKind::RegistrationDropped:
+        case LogEventKind::TriageForwarded:
+        case LogEventKind::TriageSentHome:
+        case LogEventKind::SpecialistReceived:
+        case LogEventKind::SpecialistHandled:
+        case LogEventKind::DirectorSentLeave:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Mirrors the strings the senders built with std::to_string before typed events existed.
+size_t formatEventText(const LogEventFields& f, char* out, size_t cap) {
+    TextWriter w(out, cap);
+    switch (f.kind) {
+        case LogEventKind::PatientWaitingOutside:
+            w.str("Patient waiting to enter waiting room id=").num(f.subject).str(" persons=").num(f.persons);
+            break;
+        case LogEventKind::PatientArrived:
+            w.str("Patient arrived id=").num(f.subject).str(" age=").num(f.age).str(" vip=").num(f.vip)
+             .str(" persons=").num(f.persons).str(" guardian=").num(f.guardian);
+            break;
+        case LogEventKind::PatientRegistered:
+            w.str("Patient registered id=").num(f.subject);
+            break;
+        case LogEventKind::RegisteringPatient:
+            w.str("Registering patient id=").num(f.subject).str(" vip=").num(f.vip).str(" persons=").num(f.persons);
+            break;
+        case LogEventKind::RegistrationForwarded:
+            w.str("Forwarded patient id=").num(f.subject).str(" vip=").num(f.vip).str(" persons=").num(f.persons);
+            break;
+        case LogEventKind::RegistrationDropped:
+            w.str("Dropped patient id=").num(f.subject).str(" due to triage send failure; released waiting room slots");
+            break;
+        case LogEventKind::TriageForwarded:
+            w.str("Forwarded patient id=").num(f.subject).str(" to specialist=").num(f.specialist)
+             .str(" color=").num(f.color);
+            break;
+        case LogEventKind::TriageSentHome:
+            w.str("Patient sent home from triage id=").num(f.subject);
+            break;
+        case LogEventKind::SpecialistReceived:
+            w.str("Received patient id=").num(f.subject).str(" color=").num(f.color).str(" persons=").num(f.persons);
+            break;
+        case LogEventKind::SpecialistHandled:
+            w.str("Handled patient id=").num(f.subject).str(" outcome=")
+             .str(outcomeLabel(static_cast<Outcome>(std::clamp(f.outcome, 0, 2))))
+             .str(" persons=").num(f.persons).str(" color=").num(f.color).str(" specIdx=").num(f.specialist);
+            break;
+        case LogEventKind::DirectorSentLeave:
+            w.str("Director sent SIGUSR1 to specialist pid=").num(f.subject);
+            break;
+        default:
+            return 0;
+    }
+    return w.size();
+}
+
+void appendTextLogLine(const BinaryLogRecord& rec, std::string_view message, std::string& out) {
+    char buf[24];
+    auto appendNum = [&](int value) {
+        auto res = std::to_chars(buf, buf + sizeof(buf), value);
+        out.append(buf, static_cast<size_t>(res.ptr - buf));
+    };
+    appendNum(rec.simTime);
+    out.push_back(';');
+    appendNum(rec.pid);
+    out.push_back(';');
+    if (rec.flags & kRecordHasMetrics) {
+        // Same layout the senders used to prepend: wR=cur/cap;rQ=;tQ=;sQ=;wSem=;sSem=;role;
+        out.append("wR=");
+        appendNum(rec.metrics[0]);
+        out.push_back('/');
+        appendNum(rec.metrics[1]);
+        out.append(";rQ=");
+        appendNum(rec.metrics[2]);
+        out.append(";tQ=");
+        appendNum(rec.metrics[3]);
+        out.append(";sQ=");
+        appendNum(rec.metrics[4]);
+        out.append(";wSem=");
+        appendNum(rec.metrics[5]);
+        out.append((rec.flags & kRecordStateSem) ? ";sSem=1;" : ";sSem=0;");
+        out.append(roleLabel(static_cast<Role>(rec.role)));
+        out.push_back(';');
+    }
+    out.append(message);
+    out.push_back('\n');
+}
+
+// Whole-file conversion; binary logs are an order of magnitude smaller than their text form.
+int binaryLogToText(const std::string& inPath, const std::string& outPath) {
+    int in = ::open(inPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in == -1) {
+        logErrno("log2text open input failed");
+        return 1;
+    }
+    std::vector<char> data;
+    char chunk[1 << 16];
+    while (true) {
+        ssize_t n = ::read(in, chunk, sizeof(chunk));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            logErrno("log2text read failed");
+            ::close(in);
+            return 1;
+        }
+        if (n == 0) break;
+        data.insert(data.end(), chunk, chunk + n);
+    }
+    ::close(in);
+
+    BinaryLogHeader header{};
+    if (data.size() < sizeof(header)) {
+        std::cerr << "log2text: " << inPath << " is too short for a binary log header" << std::endl;
+        return 1;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (!binaryLogHeaderValid(header)) {
+        std::cerr << "log2text: " << inPath << " is not a version " << kBinaryLogVersion << " binary log" << std::endl;
+        return 1;
+    }
+
+    int out = STDOUT_FILENO;
+    if (!outPath.empty()) {
+        out = ::open(outPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (out == -1) {
+            logErrno("log2text open output failed");
+            return 1;
+        }
+    }
+
+    std::string text;
+    char message[160];
+    size_t pos = sizeof(header);
+    bool ok = true;
+    while (pos + sizeof(BinaryLogRecord) <= data.size()) {
+        BinaryLogRecord rec;
+        std::memcpy(&rec, data.data() + pos, sizeof(rec));
+        size_t next = pos + sizeof(rec) + rec.textLen;
+        if (next > data.size()) break;  // record cut off by a crash: ignore the torn tail
+        std::string_view msg(data.data() + pos + sizeof(rec), rec.textLen);
+        if (rec.textLen == 0) {
+            msg = std::string_view(message, formatEventText(unpackLogFields(rec), message, sizeof(message)));
+        }
+        appendTextLogLine(rec, msg, text);
+        pos = next;
+        if (text.size() >= sizeof(chunk)) {
+            ok = writeAll(out, text.data(), text.size()) && ok;
+            text.clear();
+        }
+    }
+    ok = writeAll(out, text.data(), text.size()) && ok;
+    if (!ok) logErrno("log2text write failed");
+    if (out != STDOUT_FILENO) ::close(out);
+    return ok ? 0 : 1;
+}
@@ -1,23 +1,38 @@
 #include "logging/logger.hpp"
 
+#include "ipc/log_ring.hpp"
+#include "ipc/message_queue.hpp"
+#include "logging/binary_log.hpp"
 #include "util/error.hpp"
 
 #include <fcntl.h>
 #include <signal.h>
 #include <string>
+#include <string_view>
 #include <sys/msg.h>
 #include <sys/sem.h>
+#include <sys/stat.h>
 #include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
 #include <cstring>
+#include <ctime>
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <utility>
+#include <vector>
 
 #include "model/events.hpp"
 #include "model/shared_state.hpp"
 #include "model/types.hpp"
 
-Logger::Logger() : fd(-1) {}
+Logger::Logger() : fd(-1), pendingRecords_(0) {}
 
-Logger::Logger(const std::string& path) : fd(-1) {
+Logger::Logger(const std::string& path) : fd(-1), pendingRecords_(0) {
     openFile(path);
 }
 
@@ -30,51 +45,118 @@ bool Logger::openFile(const std::string& path) {
         logErrno("open log file failed");
         return false;
     }
+    buffer_.reserve(options_.flushBytes + sizeof(LogMessage) + 32);
     return true;
 }
 
+void Logger::setOptions(const LoggerOptions& options) {
+    options_ = options;
+    buffer_.reserve(options_.flushBytes + sizeof(LogMessage) + 32);
+}
+
 void Logger::logLine(const std::string& line) {
+    buffer_.insert(buffer_.end(), line.begin(), line.end());
+    buffer_.push_back('\n');
+    recordAppended();
+}
+
+void Logger::appendBytes(const void* data, size_t len) {
+    const char* bytes = static_cast<const char*>(data);
+    buffer_.insert(buffer_.end(), bytes, bytes + len);
+    recordAppended();
+}
+
+void Logger::recordAppended() {
+    pendingRecords_ += 1;
+    if (buffer_.size() >= options_.flushBytes) {
+        flush();
+    }
+}
+
+bool Logger::flush() {
+    if (buffer_.empty()) {
+        return true;
+    }
     if (fd == -1) {
-        logErrno("logLine called with closed fd");
-        return;
+        logErrno("flush called with closed fd");
+        buffer_.clear();
+        pendingRecords_ = 0;
+        return false;
     }
-    std::string withNewline = line;
-    withNewline.push_back('\n');
-    ssize_t written = ::write(fd, withNewline.data(), withNewline.size());
-    if (written == -1) {
-        logErrno("write failed");
+    bool ok = true;
+    size_t offset = 0;
+    while (offset < buffer_.size()) {
+        ssize_t written = ::write(fd, buffer_.data() + offset, buffer_.size() - offset);
+        if (written == -1) {
+            if (errno == EINTR) continue;
+            logErrno("write failed");
+            ok = false;
+            break;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    if (ok && options_.fsyncOnFlush && ::fdatasync(fd) == -1) {
+        logErrno("fdatasync failed");
+        ok = false;
+    }
+    stats_.flushes += 1;
+    stats_.records += static_cast<long long>(pendingRecords_);
+    stats_.bytes += static_cast<long long>(offset);
+    if (static_cast<long long>(pendingRecords_) > stats_.maxBatch) {
+        stats_.maxBatch = static_cast<long long>(pendingRecords_);
     }
+    buffer_.clear();
+    pendingRecords_ = 0;
+    return ok;
+}
+
+size_t Logger::pendingRecords() const {
+    return pendingRecords_;
+}
+
+const LoggerStats& Logger::stats() const {
+    return stats_;
 }
 
 void Logger::closeFile() {
     if (fd != -1) {
+        flush();
         ::close(fd);
         fd = -1;
     }
 }
 
 namespace {
-struct MetricsSnapshot {
-    int waitingInside{0};
-    int waitingCapacity{0};
-    int registrationQueueLen{0};
-    int triageQueueLen{0};
-    int specialistsQueueLen{0};
-    int waitSemaphoreValue{0};
-    int stateSemaphoreValue{0};
-};
-
 LogMetricsContext g_logMetricsContext{};
 bool g_metricsContextSet = false;
+LogRingArena g_logRings;
+std::atomic<int> g_logThreads{0};
 
-/** @brief Safe queue length probe (0 on error). */
-int queueLength(int qid) {
-    if (qid < 0) return 0;
-    struct msqid_ds stats{};
-    if (msgctl(qid, IPC_STAT, &stats) == -1) {
-        return 0;
-    }
-    return static_cast<int>(stats.msg_qnum);
+/** @brief Idle poll slice while lines are buffered but the queue is empty. */
+constexpr long long kIdlePollMs = 2;
+/** @brief Ring records wait this long before they are merged, so a slower publisher on another ring still sorts in. */
+constexpr uint64_t kMergeHoldbackNs = 5000000ULL;
+/** @brief Shortest sleep while records sit in the holdback window. */
+constexpr uint64_t kMinHoldbackSleepNs = 200000ULL;
+/** @brief Longest doorbell wait, so LOG_QUEUE senders without rings are still picked up promptly. */
+constexpr long long kQueuePollMs = 20;
+/** @brief How often leases of dead producers are reclaimed. */
+constexpr long long kReclaimIntervalMs = 500;
+
+long long monotonicMs() {
+    struct timespec ts {};
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == -1) return 0;
+    return static_cast<long long>(ts.tv_sec) * 1000LL + ts.tv_nsec / 1000000LL;
+}
+
+/** @brief Director's END marker (free text "END"; the metrics prefix is added by the logger). */
+bool isEndMarker(const LogMessage& msg) {
+    return msg.fields.kind == LogEventKind::Other && std::strncmp(msg.text, "END", sizeof(msg.text)) == 0;
+}
+
+/** @brief Safe queue length probe (0 when the queue is not known). */
+int queueLength(const MessageQueue* queue) {
+    return queue ? queue->length() : 0;
 }
 
 /** @brief Safe semaphore value probe (0 on error). */
@@ -87,51 +169,244 @@ int semaphoreValue(int semId) {
     return val;
 }
 
-/** @brief Gather current queue/semaphore/shared-state metrics for log enrichment. */
+/** @brief Metrics for log enrichment: the published snapshot when available, else direct probes. */
 MetricsSnapshot collectMetrics() {
     MetricsSnapshot metrics{};
     if (!g_metricsContextSet) {
         return metrics;
     }
-    if (g_logMetricsContext.sharedState) {
-        metrics.waitingInside = g_logMetricsContext.sharedState->currentInWaitingRoom;
-        metrics.waitingCapacity = g_logMetricsContext.sharedState->waitingRoomCapacity;
+    // Published snapshot: plain loads instead of ~10 msgctl/semctl syscalls per line.
+    const SharedState* shared = g_logMetricsContext.sharedState;
+    if (shared && shared->metricsPublishIntervalMs > 0 && shared->metrics.read(metrics)) {
+        return metrics;
     }
-    metrics.registrationQueueLen = queueLength(g_logMetricsContext.registrationQueueId);
-    metrics.triageQueueLen = queueLength(g_logMetricsContext.triageQueueId);
-    metrics.specialistsQueueLen = 0;
-    for (int qid : g_logMetricsContext.specialistsQueueIds) {
-        metrics.specialistsQueueLen += queueLength(qid);
+    return sampleMetrics(g_logMetricsContext);
+}
+
+/**
+ * @brief Queue a message on LOG_QUEUE; retries briefly on EAGAIN so lifecycle logs that drive the
+ * visualizer are not dropped.
+ */
+bool sendLogMessage(int queueId, LogMessage& msg) {
+    size_t payloadSize = sizeof(LogMessage) - sizeof(long);
+    const int kMaxRetry = 20; // ~20ms total with 1ms sleeps
+    int attempts = 0;
+    while (attempts < kMaxRetry) {
+        if (msgsnd(queueId, &msg, payloadSize, IPC_NOWAIT) == 0) {
+            return true;
+        }
+        if (errno == EAGAIN) {
+            ++attempts;
+            usleep(1000);
+            continue;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EIDRM && errno != EINVAL) {
+            logErrno("logEvent msgsnd failed");
+        }
+        return false;
     }
-    metrics.waitSemaphoreValue = semaphoreValue(g_logMetricsContext.waitSemaphoreId);
-    metrics.stateSemaphoreValue = semaphoreValue(g_logMetricsContext.stateSemaphoreId);
-    return metrics;
+    // Final blocking attempt; if it fails we drop but at least tried to flush.
+    if (msgsnd(queueId, &msg, payloadSize, 0) == -1) {
+        if (errno != EIDRM && errno != EINVAL) {
+            logErrno("logEvent msgsnd failed (blocking)");
+        }
+        return false;
+    }
+    return true;
+}
+
+/** @brief Deliver a message to this process's log ring (never waits), or to LOG_QUEUE without rings. */
+bool deliverLogMessage(int queueId, LogMessage& msg) {
+    // END must never be dropped; the logger still merges the rings fully after receiving it.
+    if (!g_logRings.isOpen() || isEndMarker(msg)) {
+        return sendLogMessage(queueId, msg);
+    }
+    // Each thread starts on its own ring and stays on whichever ring it last used.
+    thread_local int ringHint = -1;
+    if (ringHint < 0) {
+        ringHint = static_cast<int>((static_cast<unsigned>(getpid()) + static_cast<unsigned>(g_logThreads.fetch_add(1))) &
+                                    0x7fffffffu);
+    }
+    return g_logRings.push(&msg, sizeof(msg), ringHint);
 }
 
-std::string roleLabel(int roleInt) {
-    auto role = static_cast<Role>(roleInt);
-    switch (role) {
-        case Role::Director: return "director";
-        case Role::PatientGenerator: return "patient_gen";
-        case Role::Patient: return "patient";
-        case Role::Registration1: return "reg1";
-        case Role::Registration2: return "reg2";
-        case Role::Triage: return "triage";
-        case Role::SpecialistCardio:
-        case Role::SpecialistNeuro:
-        case Role::SpecialistOphthalmo:
-        case Role::SpecialistLaryng:
-        case Role::SpecialistSurgeon:
-        case Role::SpecialistPaediatric:
-            return "specialist";
-        case Role::Logger: return "logger";
-        default: return "unknown";
+/** @brief Common header of every LogMessage: routing, identity, and the sender's load snapshot. */
+LogMessage makeLogMessage(Role role, int simTime) {
+    LogMessage msg{};
+    msg.mtype = static_cast<long>(EventType::LogMessage);
+    msg.role = static_cast<int>(role);
+    msg.simTime = simTime;
+    msg.pid = getpid();
+    if (g_metricsContextSet) {
+        msg.hasMetrics = 1;
+        msg.metrics = collectMetrics();
     }
+    return msg;
 }
+
+/** @brief Text and binary sinks of the logger process; both are flushed together. */
+class LogSinks {
+public:
+    LogSinks(const std::string& path, const std::string& binaryPath, const LoggerOptions& options)
+        : text_(path) {
+        text_.setOptions(options);
+        if (!binaryPath.empty()) {
+            binaryEnabled_ = binary_.openFile(binaryPath);
+            binary_.setOptions(options);
+            struct stat st {};
+            if (binaryEnabled_ && stat(binaryPath.c_str(), &st) == 0 && st.st_size == 0) {
+                // Header goes out at once so readers can identify the file before the first flush.
+                BinaryLogHeader header = makeBinaryLogHeader();
+                binary_.appendBytes(&header, sizeof(header));
+                binary_.flush();
+            }
+        }
+    }
+
+    /** @brief Append one event to both sinks. */
+    void append(const LogMessage& msg, int stateSem) {
+        BinaryLogRecord rec = packLogRecord(msg, stateSem);
+        std::string_view message(msg.text, rec.textLen);
+        if (rec.textLen == 0) {
+            message = std::string_view(scratch_, formatEventText(msg.fields, scratch_, sizeof(scratch_)));
+        }
+        line_.clear();
+        appendTextLogLine(rec, message, line_);
+        text_.appendBytes(line_.data(), line_.size());
+        if (binaryEnabled_) {
+            char packed[sizeof(BinaryLogRecord) + sizeof(msg.text)];
+            std::memcpy(packed, &rec, sizeof(rec));
+            std::memcpy(packed + sizeof(rec), msg.text, rec.textLen);
+            binary_.appendBytes(packed, sizeof(rec) + rec.textLen);
+        }
+    }
+
+    size_t pendingRecords() const { return text_.pendingRecords(); }
+
+    void flush() {
+        text_.flush();
+        if (binaryEnabled_) binary_.flush();
+    }
+
+    void close() {
+        text_.closeFile();
+        binary_.closeFile();
+    }
+
+    const LoggerStats& stats() const { return text_.stats(); }
+    const LoggerStats& binaryStats() const { return binary_.stats(); }
+    bool binaryEnabled() const { return binaryEnabled_; }
+
+private:
+    Logger text_;
+    Logger binary_;
+    bool binaryEnabled_{false};
+    std::string line_;
+    char scratch_[160];
+};
+
+/**
+ * @brief K-way merge of the log rings (each already in stamp order) plus LOG_QUEUE, whose messages are
+ * stamped on receipt.
+ */
+class LogMerge {
+public:
+    LogMerge(LogRingArena& rings, int queueId) : rings_(rings), queueId_(queueId) {}
+
+    /**
+     * @brief Move LOG_QUEUE messages into the merge.
+     * @param block wait for the first message (only used when there are no rings to wait on).
+     * @return false on a msgrcv error other than EINTR/ENOMSG.
+     */
+    bool pollQueue(bool block) {
+        while (true) {
+            LogMessage msg{};
+            ssize_t res = msgrcv(queueId_, &msg, sizeof(LogMessage) - sizeof(long),
+                                 static_cast<long>(EventType::LogMessage), block ? 0 : IPC_NOWAIT);
+            if (res == -1) {
+                if (errno == EINTR || errno == ENOMSG) return true;
+                logErrno("Logger msgrcv failed");
+                return false;
+            }
+            queued_.emplace_back(LogRingArena::nowNs(), msg);
+            block = false;
+        }
+    }
+
+    /**
+     * @brief Emit, in stamp order, every record stamped at or before watermarkNs.
+     * @return number of records emitted.
+     */
+    size_t emitUpTo(uint64_t watermarkNs, const std::function<void(const LogMessage&)>& emit) {
+        const size_t queueSource = rings_.ringCount();
+        heap_.clear();
+        for (size_t ring = 0; ring < queueSource; ++ring) {
+            pushHead(ring, watermarkNs);
+        }
+        pushHead(queueSource, watermarkNs);
+        size_t emitted = 0;
+        LogMessage msg{};
+        while (!heap_.empty()) {
+            std::pop_heap(heap_.begin(), heap_.end(), std::greater<>());
+            size_t source = heap_.back().second;
+            heap_.pop_back();
+            if (source == queueSource) {
+                msg = queued_.front().second;
+                queued_.pop_front();
+            } else {
+                uint64_t stamp = 0;
+                size_t size = 0;
+                const void* record = rings_.peek(source, stamp, size);
+                msg = LogMessage{};
+                std::memcpy(&msg, record, std::min(size, sizeof(msg)));
+                rings_.pop(source);
+            }
+            emit(msg);
+            ++emitted;
+            pushHead(source, watermarkNs);
+        }
+        return emitted;
+    }
+
+    /** @brief Stamp of the oldest record not emitted yet (UINT64_MAX when everything is drained). */
+    uint64_t earliestStamp() const {
+        uint64_t earliest = queued_.empty() ? UINT64_MAX : queued_.front().first;
+        for (size_t ring = 0; ring < rings_.ringCount(); ++ring) {
+            uint64_t stamp = 0;
+            size_t size = 0;
+            if (rings_.peek(ring, stamp, size) && stamp < earliest) earliest = stamp;
+        }
+        return earliest;
+    }
+
+private:
+    void pushHead(size_t source, uint64_t watermarkNs) {
+        uint64_t stamp = 0;
+        size_t size = 0;
+        if (source == rings_.ringCount()) {
+            if (queued_.empty()) return;
+            stamp = queued_.front().first;
+        } else if (!rings_.peek(source, stamp, size)) {
+            return;
+        }
+        if (stamp > watermarkNs) return;
+        heap_.emplace_back(stamp, source);
+        std::push_heap(heap_.begin(), heap_.end(), std::greater<>());
+    }
+
+    LogRingArena& rings_;
+    int queueId_;
+    std::deque<std::pair<uint64_t, LogMessage>> queued_;
+    std::vector<std::pair<uint64_t, size_t>> heap_;
+};
 } // namespace
 
 // Logger process entry (see header for details).
-int runLogger(int queueId, const std::string& path) {
+int runLogger(int queueId, const std::string& path, const LoggerOptions& options, const std::string& binaryPath,
+              const std::string& ringName) {
     // Ignore SIGINT so logger survives Ctrl+C until it receives END.
     struct sigaction saIgnore {};
     saIgnore.sa_handler = SIG_IGN;
@@ -139,98 +414,165 @@ int runLogger(int queueId, const std::string& path) {
     saIgnore.sa_flags = 0;
     sigaction(SIGINT, &saIgnore, nullptr);
 
-    Logger logger(path);
+    LogSinks logger(path, binaryPath, options);
     if (queueId == -1) {
         logErrno("runLogger invalid queue id");
         return 1;
     }
+    LogRingArena rings;
+    const bool ringsOpen = !ringName.empty() && rings.open(ringName);
+    LogMerge merge(rings, queueId);
+    // Queue-only messages are stamped on receipt and already in order, so they need no holdback.
+    const uint64_t holdbackNs = ringsOpen ? kMergeHoldbackNs : 0;
 
     bool ok = true;
-    while (true) {
-        LogMessage msg{};
-        ssize_t res = msgrcv(queueId, &msg, sizeof(LogMessage) - sizeof(long),
-                             static_cast<long>(EventType::LogMessage), 0);
-        if (res == -1) {
-            if (errno == EINTR) {
-                continue;
-            }
-            logErrno("Logger msgrcv failed");
+    bool endSeen = false;
+    int lastSimTime = 0;
+    long long firstPendingMs = 0;
+    long long lastReclaimMs = monotonicMs();
+    auto emit = [&](const LogMessage& msg) {
+        lastSimTime = msg.simTime;
+        if (logger.pendingRecords() == 0) {
+            firstPendingMs = monotonicMs();
+        }
+        // Semicolon-separated line for easy parsing/CSV import:
+        // simTime;pid;wR;rQ;tQ;sQ;wSem;sSem;who;text
+        logger.append(msg, kLegacyStateSemUnlocked);
+        if (isEndMarker(msg)) {
+            endSeen = true;
+        }
+    };
+    while (!endSeen) {
+        bool havePending = logger.pendingRecords() > 0;
+        // Without rings LOG_QUEUE is the only source: block on it while nothing is buffered.
+        if (!merge.pollQueue(!ringsOpen && !havePending)) {
             ok = false;
             break;
         }
-
-        if (std::strncmp(msg.text, "END", 3) == 0) {
-            break;
+        uint64_t nowNs = LogRingArena::nowNs();
+        if (merge.emitUpTo(nowNs - holdbackNs, emit) > 0 || endSeen) {
+            continue;
         }
 
-        // Semicolon-separated line for easy parsing/CSV import:
-        // simTime;pid;wR;rQ;tQ;sQ;wSem;sSem;who;text
-        std::string line = std::to_string(msg.simTime) + ";"
-                         + std::to_string(msg.pid) + ";"
-                         + msg.text;
-        logger.logLine(line);
+        long long nowMs = monotonicMs();
+        if (ringsOpen && nowMs - lastReclaimMs >= kReclaimIntervalMs) {
+            rings.reclaimDeadOwners();
+            lastReclaimMs = nowMs;
+        }
+        // Sources are idle: flush once the oldest buffered line reached the interval.
+        havePending = logger.pendingRecords() > 0;
+        long long waitedMs = nowMs - firstPendingMs;
+        if (havePending && waitedMs >= options.flushIntervalMs) {
+            logger.flush();
+            continue;
+        }
+        long long budgetMs = havePending ? options.flushIntervalMs - waitedMs : kQueuePollMs;
+        uint64_t earliest = merge.earliestStamp();
+        if (earliest != UINT64_MAX) {
+            // Records are waiting out the holdback window: sleep until the oldest one is due.
+            uint64_t dueNs = earliest + holdbackNs;
+            uint64_t sleepNs = dueNs > nowNs ? dueNs - nowNs : 0;
+            sleepNs = std::max(sleepNs, kMinHoldbackSleepNs);
+            sleepNs = std::min<uint64_t>(sleepNs, static_cast<uint64_t>(budgetMs) * 1000000ULL);
+            struct timespec ts {};
+            ts.tv_sec = static_cast<time_t>(sleepNs / 1000000000ULL);
+            ts.tv_nsec = static_cast<long>(sleepNs % 1000000000ULL);
+            nanosleep(&ts, nullptr);
+        } else if (ringsOpen) {
+            rings.waitForData(static_cast<int>(std::min(budgetMs, kQueuePollMs)));
+        } else {
+            usleep(static_cast<useconds_t>(std::min(budgetMs, kIdlePollMs) * 1000));
+        }
+    }
+    // Everyone else has exited once END is sent, so whatever is still queued sorts in without a holdback.
+    if (ok) {
+        merge.pollQueue(false);
+        merge.emitUpTo(UINT64_MAX, emit);
     }
 
-    logger.closeFile();
+    logger.flush();
+    const LoggerStats& stats = logger.stats();
+    long long avgBatch = stats.flushes > 0 ? stats.records / stats.flushes : 0;
+    std::string statsText = "Logger stats records=" + std::to_string(stats.records) +
+                            " flushes=" + std::to_string(stats.flushes) +
+                            " avgBatch=" + std::to_string(avgBatch) +
+                            " maxBatch=" + std::to_string(stats.maxBatch) +
+                            " bytes=" + std::to_string(stats.bytes) +
+                            " fsync=" + std::to_string(options.fsyncOnFlush ? 1 : 0);
+    if (logger.binaryEnabled()) {
+        statsText += " binaryBytes=" + std::to_string(logger.binaryStats().bytes);
+    }
+    uint64_t dropped = rings.dropped();
+    if (ringsOpen) {
+        statsText += " dropped=" + std::to_string(dropped);
+    }
+    if (dropped > 0) {
+        std::cerr << "Logger: " << dropped << " log records dropped (all log rings busy or full)" << std::endl;
+    }
+    LogMessage statsMsg{};
+    statsMsg.role = static_cast<int>(Role::Logger);
+    statsMsg.simTime = lastSimTime;
+    statsMsg.pid = static_cast<int>(getpid());
+    statsMsg.hasMetrics = 1;  // all-zero metrics block, as before
+    std::strncpy(statsMsg.text, statsText.c_str(), sizeof(statsMsg.text) - 1);
+    logger.append(statsMsg, kLegacyStateSemNone);
+    logger.close();
     return ok ? 0 : 1;
 }
 
+// Probe queues/semaphores/shared state directly (see header).
+MetricsSnapshot sampleMetrics(const LogMetricsContext& context) {
+    MetricsSnapshot metrics{};
+    if (context.sharedState) {
+        metrics.waitingInside = context.sharedState->waitingRoom.currentInWaitingRoom.load(std::memory_order_relaxed);
+        metrics.waitingCapacity = context.sharedState->waitingRoomCapacity;
+    }
+    metrics.registrationQueueLen = queueLength(context.registrationQueue);
+    metrics.triageQueueLen = queueLength(context.triageQueue);
+    metrics.specialistsQueueLen = 0;
+    for (const MessageQueue* queue : context.specialistsQueues) {
+        metrics.specialistsQueueLen += queueLength(queue);
+    }
+    metrics.waitSemaphoreValue = semaphoreValue(context.waitSemaphoreId);
+    return metrics;
+}
+
 void setLogMetricsContext(const LogMetricsContext& context) {
     g_logMetricsContext = context;
     g_metricsContextSet = true;
 }
 
-// Send a LogMessage, optionally enriched with live metrics (see header).
+void clearLogMetricsContext() {
+    g_metricsContextSet = false;
+    g_logMetricsContext = LogMetricsContext{};
+}
+
+// Send a free-text LogMessage with the sender's metrics snapshot (see header).
 bool logEvent(int queueId, Role role, int simTime, const std::string& text) {
     if (queueId == -1) {
         logErrno("logEvent invalid queue id");
         return false;
     }
-    LogMessage msg{};
-    msg.mtype = static_cast<long>(EventType::LogMessage);
-    msg.role = static_cast<int>(role);
-    msg.simTime = simTime;
-    msg.pid = getpid();
-    std::string finalText = text;
-    if (g_metricsContextSet) {
-        MetricsSnapshot metrics = collectMetrics();
-        finalText = "wR=" + std::to_string(metrics.waitingInside) + "/" + std::to_string(metrics.waitingCapacity) + ";"
-                  + "rQ=" + std::to_string(metrics.registrationQueueLen) + ";"
-                  + "tQ=" + std::to_string(metrics.triageQueueLen) + ";"
-                  + "sQ=" + std::to_string(metrics.specialistsQueueLen) + ";"
-                  + "wSem=" + std::to_string(metrics.waitSemaphoreValue) + ";"
-                  + "sSem=" + std::to_string(metrics.stateSemaphoreValue) + ";"
-                  + roleLabel(static_cast<int>(role)) + ";"
-                  + text;
-    }
-    std::strncpy(msg.text, finalText.c_str(), sizeof(msg.text) - 1);
-    size_t payloadSize = sizeof(LogMessage) - sizeof(long);
-    // Retry briefly on EAGAIN to avoid dropping lifecycle logs that drive the visualizer.
-    const int kMaxRetry = 20; // ~20ms total with 1ms sleeps
-    int attempts = 0;
-    while (attempts < kMaxRetry) {
-        if (msgsnd(queueId, &msg, payloadSize, IPC_NOWAIT) == 0) {
-            return true;
-        }
-        if (errno == EAGAIN) {
-            ++attempts;
-            usleep(1000);
-            continue;
-        }
-        if (errno == EINTR) {
-            continue;
-        }
-        if (errno != EIDRM && errno != EINVAL) {
-            logErrno("logEvent msgsnd failed");
-        }
-        return false;
-    }
-    // Final blocking attempt; if it fails we drop but at least tried to flush.
-    if (msgsnd(queueId, &msg, payloadSize, 0) == -1) {
-        if (errno != EIDRM && errno != EINVAL) {
-            logErrno("logEvent msgsnd failed (blocking)");
-        }
+    LogMessage msg = makeLogMessage(role, simTime);
+    std::strncpy(msg.text, text.c_str(), sizeof(msg.text) - 1);
+    return deliverLogMessage(queueId, msg);
+}
+
+// Send a typed event; its text is produced by the logger (see header).
+bool logEvent(int queueId, Role role, int simTime, const LogEventFields& fields) {
+    if (queueId == -1) {
+        logErrno("logEvent invalid queue id");
         return false;
     }
-    return true;
+    LogMessage msg = makeLogMessage(role, simTime);
+    msg.fields = fields;
+    return deliverLogMessage(queueId, msg);
+}
+
+bool attachLogRings(key_t logKey) {
+    return g_logRings.open(LogRingArena::nameForKey(logKey));
+}
+
+long long logRecordsDropped() {
+    return static_cast<long long>(g_logRings.dropped());
 }
@@ -1,17 +1,28 @@
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <cstdlib>
 #include <fstream>
+#include <sstream>
 #include <ctime>
 #include <cstdio>
 #include <csignal>
 #include <sys/wait.h>
+#include <thread>
 #include <unistd.h>
 #include <vector>
 
+#include "des/batch_runner.hpp"
+#include "des/des_engine.hpp"
 #include "director.hpp"
+#include "ipc/run_namespace.hpp"
+#include "logging/binary_log.hpp"
 #include "logging/logger.hpp"
 #include "model/config.hpp"
+#include "model/registration_policy.hpp"
+#include "model/specialist_policy.hpp"
+#include "report/saturation.hpp"
+#include "report/summary.hpp"
 #include "roles/registration.hpp"
 #include "roles/triage.hpp"
 #include "roles/specialist.hpp"
@@ -20,6 +31,46 @@
 #include "visualization/visualizer.hpp"
 
 namespace {
+/**
+ * @brief Parse specialistDoctors: one count for every specialty, or one per specialty in
+ * SpecialistType order ("2,1,1,1,2,1").
+ */
+bool parseDoctorCounts(const std::string& value, std::array<int, kSpecialistCount>& out) {
+    std::vector<int> counts;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        counts.push_back(std::stoi(item));
+    }
+    if (counts.size() == 1) counts.assign(kSpecialistCount, counts[0]);
+    if (counts.size() != static_cast<size_t>(kSpecialistCount)) return false;
+    for (int i = 0; i < kSpecialistCount; ++i) {
+        if (counts[i] < 1 || counts[i] > kMaxDoctorsPerSpecialty) return false;
+        out[i] = counts[i];
+    }
+    return true;
+}
+
+/**
+ * @brief Parse a per-colour setting: one value for every colour, or "red,yellow,green".
+ */
+bool parseColorValues(const std::string& value, std::array<int, kTriageColorCount>& out, int minValue,
+                      int maxValue) {
+    std::vector<int> values;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        values.push_back(std::stoi(item));
+    }
+    if (values.size() == 1) values.assign(kTriageColorCount, values[0]);
+    if (values.size() != static_cast<size_t>(kTriageColorCount)) return false;
+    for (int c = 0; c < kTriageColorCount; ++c) {
+        if (values[c] < minValue || values[c] > maxValue) return false;
+        out[c] = values[c];
+    }
+    return true;
+}
+
 /**
  * @brief Load key/value pairs from config file with defaults and validation.
  * @param path path to config file.
@@ -49,6 +100,32 @@ bool parseConfigFile(const std::string& path, Config& cfg, std::string& err) {
     cfg.reconcileWaitSem = 0;
     cfg.patientGenMinMs = cfg.timeScaleMsPerSimMinute;
     cfg.patientGenMaxMs = cfg.timeScaleMsPerSimMinute;
+    cfg.shmRingTransport = 0;
+    cfg.shmRingSlots = 1024;
+    cfg.inProcessPatients = 0;
+    cfg.patientThreadPoolSize = 64;
+    cfg.logFlushBytes = 65536;
+    cfg.logFlushIntervalMs = 50;
+    cfg.logFsync = 0;
+    cfg.metricsPublishIntervalMs = 10;
+    cfg.binaryLog = 0;
+    cfg.logRings = 1;
+    cfg.logRingCount = 64;
+    cfg.logRingSlots = 512;
+    cfg.timeSeriesIntervalMs = 100;
+    cfg.registrationWindowsMax = 4;
+    cfg.registrationScaleIntervalMs = 20;
+    cfg.registrationScaleCooldownMs = 500;
+    cfg.specialistDoctors.fill(1);
+    cfg.triageWorkers = 1;
+    cfg.agingStepMs = 0;
+    cfg.maxWaitNormalMs = 0;
+    cfg.maxWaitYellowMs = 0;
+    cfg.maxWaitGreenMs = 0;
+    cfg.specialistPolicy = static_cast<int>(SpecialistPolicyKind::StrictPriority);
+    cfg.specialistWfqWeights = {{6, 3, 1}};
+    cfg.specialistTargetMs = {{100, 400, 1600}};
+    cfg.specialistExamPct = {{100, 100, 100}};
 
     auto trim = [](const std::string& s) {
         size_t b = s.find_first_not_of(" \t\r\n");
@@ -81,6 +158,56 @@ bool parseConfigFile(const std::string& path, Config& cfg, std::string& err) {
             else if (key == "reconcileWaitSem") cfg.reconcileWaitSem = std::stoi(val);
             else if (key == "patientGenMinMs") cfg.patientGenMinMs = std::stoi(val);
             else if (key == "patientGenMaxMs") cfg.patientGenMaxMs = std::stoi(val);
+            else if (key == "shmRingTransport") cfg.shmRingTransport = std::stoi(val);
+            else if (key == "shmRingSlots") cfg.shmRingSlots = std::stoi(val);
+            else if (key == "inProcessPatients") cfg.inProcessPatients = std::stoi(val);
+            else if (key == "patientThreadPoolSize") cfg.patientThreadPoolSize = std::stoi(val);
+            else if (key == "logFlushBytes") cfg.logFlushBytes = std::stoi(val);
+            else if (key == "logFlushIntervalMs") cfg.logFlushIntervalMs = std::stoi(val);
+            else if (key == "logFsync") cfg.logFsync = std::stoi(val);
+            else if (key == "metricsPublishIntervalMs") cfg.metricsPublishIntervalMs = std::stoi(val);
+            else if (key == "binaryLog") cfg.binaryLog = std::stoi(val);
+            else if (key == "logRings") cfg.logRings = std::stoi(val);
+            else if (key == "logRingCount") cfg.logRingCount = std::stoi(val);
+            else if (key == "logRingSlots") cfg.logRingSlots = std::stoi(val);
+            else if (key == "timeSeriesIntervalMs") cfg.timeSeriesIntervalMs = std::stoi(val);
+            else if (key == "registrationWindowsMax") cfg.registrationWindowsMax = std::stoi(val);
+            else if (key == "registrationScaleIntervalMs") cfg.registrationScaleIntervalMs = std::stoi(val);
+            else if (key == "registrationScaleCooldownMs") cfg.registrationScaleCooldownMs = std::stoi(val);
+            else if (key == "triageWorkers") cfg.triageWorkers = std::stoi(val);
+            else if (key == "agingStepMs") cfg.agingStepMs = std::stoi(val);
+            else if (key == "maxWaitNormalMs") cfg.maxWaitNormalMs = std::stoi(val);
+            else if (key == "maxWaitYellowMs") cfg.maxWaitYellowMs = std::stoi(val);
+            else if (key == "maxWaitGreenMs") cfg.maxWaitGreenMs = std::stoi(val);
+            else if (key == "specialistDoctors") {
+                if (!parseDoctorCounts(val, cfg.specialistDoctors)) {
+                    err = "specialistDoctors must be one count or " + std::to_string(kSpecialistCount) +
+                          " comma-separated counts, each in 1.." + std::to_string(kMaxDoctorsPerSpecialty);
+                    return false;
+                }
+            } else if (key == "specialistPolicy") {
+                SpecialistPolicyKind kind;
+                if (!parseSpecialistPolicy(val, kind)) {
+                    err = "specialistPolicy must be strict, wfq, sef or edf";
+                    return false;
+                }
+                cfg.specialistPolicy = static_cast<int>(kind);
+            } else if (key == "specialistWfqWeights") {
+                if (!parseColorValues(val, cfg.specialistWfqWeights, 1, 1000)) {
+                    err = "specialistWfqWeights must be one weight or red,yellow,green weights, each in 1..1000";
+                    return false;
+                }
+            } else if (key == "specialistTargetMs") {
+                if (!parseColorValues(val, cfg.specialistTargetMs, 1, 100000000)) {
+                    err = "specialistTargetMs must be one target or red,yellow,green targets, each > 0";
+                    return false;
+                }
+            } else if (key == "specialistExamPct") {
+                if (!parseColorValues(val, cfg.specialistExamPct, 1, 1000)) {
+                    err = "specialistExamPct must be one percentage or red,yellow,green percentages, each in 1..1000";
+                    return false;
+                }
+            }
         } catch (const std::exception&) {
             err = "Invalid value for key: " + key;
             return false;
@@ -132,11 +259,333 @@ bool parseConfigFile(const std::string& path, Config& cfg, std::string& err) {
         err = "patientGenMinMs/maxMs must be >0 and max>=min";
         return false;
     }
+    if (cfg.shmRingTransport != 0 && cfg.shmRingTransport != 1) {
+        err = "shmRingTransport must be 0 or 1";
+        return false;
+    }
+    if (cfg.shmRingSlots <= 0 || cfg.shmRingSlots > (1 << 20)) {
+        err = "shmRingSlots must be in 1..1048576";
+        return false;
+    }
+    if (cfg.inProcessPatients != 0 && cfg.inProcessPatients != 1) {
+        err = "inProcessPatients must be 0 or 1";
+        return false;
+    }
+    if (cfg.patientThreadPoolSize <= 0 || cfg.patientThreadPoolSize > 4096) {
+        err = "patientThreadPoolSize must be in 1..4096";
+        return false;
+    }
+    if (cfg.logFlushBytes < 0 || cfg.logFlushBytes > (64 << 20)) {
+        err = "logFlushBytes must be in 0..67108864";
+        return false;
+    }
+    if (cfg.logFlushIntervalMs < 0) {
+        err = "logFlushIntervalMs must be >= 0";
+        return false;
+    }
+    if (cfg.logFsync != 0 && cfg.logFsync != 1) {
+        err = "logFsync must be 0 or 1";
+        return false;
+    }
+    if (cfg.metricsPublishIntervalMs < 0) {
+        err = "metricsPublishIntervalMs must be >= 0";
+        return false;
+    }
+    if (cfg.binaryLog != 0 && cfg.binaryLog != 1) {
+        err = "binaryLog must be 0 or 1";
+        return false;
+    }
+    if (cfg.logRings != 0 && cfg.logRings != 1) {
+        err = "logRings must be 0 or 1";
+        return false;
+    }
+    if (cfg.logRingCount <= 0 || cfg.logRingCount > 4096) {
+        err = "logRingCount must be in 1..4096";
+        return false;
+    }
+    if (cfg.logRingSlots <= 0 || cfg.logRingSlots > (1 << 16)) {
+        err = "logRingSlots must be in 1..65536";
+        return false;
+    }
+    if (cfg.timeSeriesIntervalMs < 0) {
+        err = "timeSeriesIntervalMs must be >= 0";
+        return false;
+    }
+    if (cfg.registrationWindowsMax < 1 || cfg.registrationWindowsMax > kMaxRegistrationWindows) {
+        err = "registrationWindowsMax must be in 1.." + std::to_string(kMaxRegistrationWindows);
+        return false;
+    }
+    if (cfg.registrationScaleIntervalMs <= 0) {
+        err = "registrationScaleIntervalMs must be > 0";
+        return false;
+    }
+    if (cfg.registrationScaleCooldownMs < 0) {
+        err = "registrationScaleCooldownMs must be >= 0";
+        return false;
+    }
+    if (cfg.triageWorkers < 1 || cfg.triageWorkers > kMaxTriageWorkers) {
+        err = "triageWorkers must be in 1.." + std::to_string(kMaxTriageWorkers);
+        return false;
+    }
+    if (cfg.agingStepMs < 0 || cfg.maxWaitNormalMs < 0 || cfg.maxWaitYellowMs < 0 || cfg.maxWaitGreenMs < 0) {
+        err = "agingStepMs and maxWait*Ms must be >= 0";
+        return false;
+    }
     return true;
 }
+
+/**
+ * @brief Discrete-event mode: sor_sim des --config <path> [--sim-minutes N].
+ *
+ * Runs the whole pipeline on a virtual clock in this process (no IPC, no logger/visualizer),
+ * writes the usual sor_summary_<ts>.txt (plus .json/.csv/_series.csv) and prints it with engine statistics.
+ */
+int runDesMode(int argc, char* argv[]) {
+    std::string configPath = "config.cfg";
+    int simMinutes = 0;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--config" && i + 1 < argc) {
+            configPath = argv[++i];
+        } else if (arg == "--sim-minutes" && i + 1 < argc) {
+            try {
+                simMinutes = std::stoi(argv[++i]);
+            } catch (const std::exception&) {
+                simMinutes = -1;
+            }
+            if (simMinutes <= 0) {
+                std::cerr << "--sim-minutes must be > 0" << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else {
+            std::cerr << "DES usage: " << argv[0] << " des --config <path> [--sim-minutes N]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    Config cfg{};
+    std::string err;
+    if (!parseConfigFile(configPath, cfg, err)) {
+        std::cerr << "Config error: " << err << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    DesEngine engine(cfg);
+    DesOptions options{DesEngine::defaultHorizonMs(cfg, simMinutes)};
+    DesResult result = engine.run(options);
+
+    std::string summaryPath = "sor_summary_" + std::to_string(static_cast<long long>(std::time(nullptr))) + ".txt";
+    if (!writeSummary(result.summary, summaryPath) ||
+        !writeSummaryJson(result.summary, summarySiblingPath(summaryPath, ".json")) ||
+        !writeSummaryCsv(result.summary, summarySiblingPath(summaryPath, ".csv")) ||
+        !writeQueueSeriesCsv(result.summary.queueSeries, summarySiblingPath(summaryPath, "_series.csv"))) {
+        return EXIT_FAILURE;
+    }
+    std::ifstream in(summaryPath);
+    if (in) {
+        std::cout << "=== " << summaryPath << " ===\n";
+        std::cout << in.rdbuf();
+    }
+    std::cout << "DES engine: events=" << result.eventsProcessed
+              << " patientsGenerated=" << result.patientsGenerated
+              << " peakWaitingRoom=" << result.peakWaitingRoom << "/" << cfg.N_waitingRoom
+              << " peakOutside=" << result.peakOutsideQueue
+              << " peakRegQ=" << result.peakRegistrationQueue
+              << " wallMs=" << result.wallMs << std::endl;
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Parse "A..B" (or a single seed "A") into an inclusive seed range.
+ * @return true when both bounds are valid and A <= B.
+ */
+bool parseSeedRange(const std::string& text, unsigned int& first, unsigned int& last) {
+    try {
+        size_t dots = text.find("..");
+        size_t used = 0;
+        if (dots == std::string::npos) {
+            first = last = static_cast<unsigned int>(std::stoul(text, &used));
+            return used == text.size();
+        }
+        std::string lo = text.substr(0, dots);
+        std::string hi = text.substr(dots + 2);
+        first = static_cast<unsigned int>(std::stoul(lo, &used));
+        if (used != lo.size()) return false;
+        last = static_cast<unsigned int>(std::stoul(hi, &used));
+        if (used != hi.size()) return false;
+    } catch (const std::exception&) {
+        return false;
+    }
+    return first <= last;
+}
+
+/**
+ * @brief Batch mode: sor_sim batch --config <path> --seeds A..B [--jobs N] [--sim-minutes N].
+ *
+ * Runs one DES replication per seed across N threads (default: hardware concurrency), writes the
+ * merged statistics to sor_batch_<ts>.txt and prints them.
+ */
+int runBatchMode(int argc, char* argv[]) {
+    const std::string usage = std::string("Batch usage: ") + argv[0] +
+                              " batch --config <path> --seeds A..B [--jobs N] [--sim-minutes N]";
+    std::string configPath = "config.cfg";
+    unsigned int firstSeed = 0;
+    unsigned int lastSeed = 0;
+    bool haveSeeds = false;
+    int jobs = static_cast<int>(std::thread::hardware_concurrency());
+    int simMinutes = 0;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--config" && i + 1 < argc) {
+            configPath = argv[++i];
+        } else if (arg == "--seeds" && i + 1 < argc) {
+            if (!parseSeedRange(argv[++i], firstSeed, lastSeed)) {
+                std::cerr << "--seeds must be A..B with A <= B" << std::endl;
+                return EXIT_FAILURE;
+            }
+            haveSeeds = true;
+        } else if ((arg == "--jobs" || arg == "--sim-minutes") && i + 1 < argc) {
+            int value = -1;
+            try {
+                value = std::stoi(argv[++i]);
+            } catch (const std::exception&) {
+                value = -1;
+            }
+            if (value <= 0) {
+                std::cerr << arg << " must be > 0" << std::endl;
+                return EXIT_FAILURE;
+            }
+            (arg == "--jobs" ? jobs : simMinutes) = value;
+        } else {
+            std::cerr << usage << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    if (!haveSeeds) {
+        std::cerr << usage << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (lastSeed - firstSeed >= 1000000u) {
+        std::cerr << "--seeds range is limited to 1000000 replications" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Config cfg{};
+    std::string err;
+    if (!parseConfigFile(configPath, cfg, err)) {
+        std::cerr << "Config error: " << err << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    BatchOptions options;
+    options.firstSeed = firstSeed;
+    options.lastSeed = lastSeed;
+    options.jobs = std::max(1, jobs);
+    options.horizonMs = DesEngine::defaultHorizonMs(cfg, simMinutes);
+    BatchResult result = runBatch(cfg, options);
+
+    std::string reportPath = "sor_batch_" + std::to_string(static_cast<long long>(std::time(nullptr))) + ".txt";
+    std::ofstream out(reportPath, std::ios::trunc);
+    if (!out || !writeBatchReport(result, out)) {
+        std::cerr << "Failed to write batch report: " << reportPath << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "=== " << reportPath << " ===\n";
+    writeBatchReport(result, std::cout);
+    return EXIT_SUCCESS;
+}
+
+/** @brief Absolute path of the running executable (step runs chdir before exec'ing roles). */
+std::string selfExecutablePath(const char* argv0) {
+    char buf[4096];
+    ssize_t len = readlink("/proc/self/exe", buf, sizeof(buf) - 1);
+    if (len <= 0) return argv0;
+    buf[len] = '\0';
+    return buf;
+}
+
+/**
+ * @brief Saturation mode: sor_sim saturate --config <path> [--steps N] [--step-seconds N] [--factor F]
+ * [--repeats N] [--min-rate R].
+ *
+ * Runs the process-mode simulator once per step with a shorter generation interval each time,
+ * writes sor_saturation_<ts>.txt/.json with the knee, and exits 1 when the knee is below --min-rate.
+ */
+int runSaturationMode(int argc, char* argv[]) {
+    const std::string usage = std::string("Saturation usage: ") + argv[0] +
+                              " saturate --config <path> [--steps N] [--step-seconds N] [--factor F] [--repeats N]"
+                              " [--min-rate R]";
+    std::string configPath = "config.cfg";
+    SaturationOptions options;
+    double minRate = 0.0;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << usage << std::endl;
+            return EXIT_FAILURE;
+        }
+        try {
+            if (arg == "--config") {
+                configPath = argv[++i];
+            } else if (arg == "--steps") {
+                options.steps = std::stoi(argv[++i]);
+            } else if (arg == "--step-seconds") {
+                options.stepSeconds = std::stoi(argv[++i]);
+            } else if (arg == "--factor") {
+                options.factor = std::stod(argv[++i]);
+            } else if (arg == "--repeats") {
+                options.repeats = std::stoi(argv[++i]);
+            } else if (arg == "--min-rate") {
+                minRate = std::stod(argv[++i]);
+            } else {
+                std::cerr << usage << std::endl;
+                return EXIT_FAILURE;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid value for " << arg << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    if (options.steps <= 0 || options.stepSeconds <= 0 || options.repeats <= 0 || options.factor <= 0.0 ||
+        options.factor >= 1.0) {
+        std::cerr << "--steps, --step-seconds and --repeats must be > 0, --factor in (0, 1)" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Config cfg{};
+    std::string err;
+    if (!parseConfigFile(configPath, cfg, err)) {
+        std::cerr << "Config error: " << err << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string stamp = std::to_string(static_cast<long long>(std::time(nullptr)));
+    options.selfPath = selfExecutablePath(argv[0]);
+    options.outDir = "sor_saturation_" + stamp;
+    SaturationResult result = runSaturation(cfg, options);
+    if (result.steps.empty()) {
+        std::cerr << "Saturation ramp produced no steps" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string reportPath = "sor_saturation_" + stamp + ".txt";
+    std::ofstream out(reportPath, std::ios::trunc);
+    if (!out || !writeSaturationReport(result, out) || !writeSaturationJson(result, "sor_saturation_" + stamp + ".json")) {
+        std::cerr << "Failed to write saturation report: " << reportPath << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "=== " << reportPath << " ===\n";
+    writeSaturationReport(result, std::cout);
+    double kneeRate = saturationKneeRate(result);
+    if (minRate > 0.0 && kneeRate < minRate) {
+        std::cerr << "Knee at " << kneeRate << " patients/s is below --min-rate " << minRate << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
 } // namespace
 
-// Entry point dispatches run modes (simulator, visualizer, logger, or individual roles) and shares IPC via ftok keys from argv[0].
+// Entry point dispatches run modes (simulator, visualizer, logger, or individual roles); roles get the run registry path as keyPath.
 int main(int argc, char* argv[]) {
     if (argc >= 3 && std::string(argv[1]) == "visualize") {
         int intervalMs = 200;
@@ -152,55 +601,91 @@ int main(int argc, char* argv[]) {
 
     if (argc >= 2 && std::string(argv[1]) == "logger") {
         if (argc < 4) {
-            std::cerr << "Logger mode usage: " << argv[0] << " logger <queueId> <logPath>" << std::endl;
+            std::cerr << "Logger mode usage: " << argv[0]
+                      << " logger <queueId> <logPath> [flushBytes] [flushIntervalMs] [fsync] [binaryLogPath] [logRingName]"
+                      << std::endl;
             return EXIT_FAILURE;
         }
         int queueId = std::stoi(argv[2]);
         std::string logPath = argv[3];
-        return runLogger(queueId, logPath);
+        LoggerOptions options;
+        if (argc >= 5) {
+            options.flushBytes = static_cast<size_t>(std::max(0, std::stoi(argv[4])));
+        }
+        if (argc >= 6) {
+            options.flushIntervalMs = std::max(0, std::stoi(argv[5]));
+        }
+        if (argc >= 7) {
+            options.fsyncOnFlush = std::stoi(argv[6]) != 0;
+        }
+        std::string binaryPath = argc >= 8 ? argv[7] : "";
+        std::string ringName = argc >= 9 ? argv[8] : "";
+        return runLogger(queueId, logPath, options, binaryPath, ringName);
     }
 
-    if (argc >= 2 && std::string(argv[1]) == "registration") {
+    if (argc >= 2 && std::string(argv[1]) == "log2text") {
         if (argc < 3) {
-            std::cerr << "Registration mode usage: " << argv[0] << " registration <keyPath>" << std::endl;
+            std::cerr << "log2text usage: " << argv[0] << " log2text <binaryLog> [outPath]" << std::endl;
             return EXIT_FAILURE;
         }
-        Registration reg;
-        return reg.run(argv[2], false);
+        return binaryLogToText(argv[2], argc >= 4 ? argv[3] : "");
     }
 
-    if (argc >= 2 && std::string(argv[1]) == "registration2") {
+    if (argc >= 2 && std::string(argv[1]) == "registration") {
         if (argc < 3) {
-            std::cerr << "Registration2 mode usage: " << argv[0] << " registration2 <keyPath>" << std::endl;
+            std::cerr << "Registration mode usage: " << argv[0] << " registration <keyPath> [window]" << std::endl;
             return EXIT_FAILURE;
         }
+        int window = 0;
+        if (argc >= 4) {
+            try {
+                window = std::stoi(argv[3]);
+            } catch (const std::exception&) {
+                window = -1;
+            }
+            if (window < 0 || window >= kMaxRegistrationWindows) {
+                std::cerr << "Registration window must be in 0.." << kMaxRegistrationWindows - 1 << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
         Registration reg;
-        return reg.run(argv[2], true);
+        return reg.run(argv[2], window);
     }
 
     if (argc >= 2 && std::string(argv[1]) == "triage") {
         if (argc < 3) {
-            std::cerr << "Triage mode usage: " << argv[0] << " triage <keyPath>" << std::endl;
+            std::cerr << "Triage mode usage: " << argv[0] << " triage <keyPath> [worker]" << std::endl;
+            return EXIT_FAILURE;
+        }
+        int worker = argc >= 4 ? std::stoi(argv[3]) : 0;
+        if (worker < 0 || worker >= kMaxTriageWorkers) {
+            std::cerr << "Triage worker must be in 0.." << kMaxTriageWorkers - 1 << std::endl;
             return EXIT_FAILURE;
         }
         Triage triage;
-        return triage.run(argv[2]);
+        return triage.run(argv[2], worker);
     }
 
     if (argc >= 2 && std::string(argv[1]) == "specialist") {
         if (argc < 4) {
-            std::cerr << "Specialist mode usage: " << argv[0] << " specialist <keyPath> <typeInt>" << std::endl;
+            std::cerr << "Specialist mode usage: " << argv[0] << " specialist <keyPath> <typeInt> [doctor]" << std::endl;
             return EXIT_FAILURE;
         }
         SpecialistType type = static_cast<SpecialistType>(std::stoi(argv[3]));
+        int doctor = argc >= 5 ? std::stoi(argv[4]) : 0;
+        if (doctor < 0 || doctor >= kMaxDoctorsPerSpecialty) {
+            std::cerr << "Specialist doctor must be in 0.." << kMaxDoctorsPerSpecialty - 1 << std::endl;
+            return EXIT_FAILURE;
+        }
         Specialist spec;
-        return spec.run(argv[2], type);
+        return spec.run(argv[2], type, doctor);
     }
 
     if (argc >= 2 && std::string(argv[1]) == "patient_generator") {
         if (argc < 8) {
             std::cerr << "Patient generator usage: " << argv[0]
                       << " patient_generator <keyPath> <N> <K> <simMinutes> <msPerMinute> <seed> [genMinMs] [genMaxMs]"
+                      << " [inProcess] [threads]"
                       << std::endl;
             return EXIT_FAILURE;
         }
@@ -226,8 +711,16 @@ int main(int argc, char* argv[]) {
         if (argc >= 10) {
             cfg.patientGenMaxMs = std::stoi(argv[9]);
         }
+        cfg.inProcessPatients = 0;
+        cfg.patientThreadPoolSize = 64;
+        if (argc >= 11) {
+            cfg.inProcessPatients = std::stoi(argv[10]) != 0 ? 1 : 0;
+        }
+        if (argc >= 12) {
+            cfg.patientThreadPoolSize = std::max(1, std::stoi(argv[11]));
+        }
         PatientGenerator gen;
-        return gen.run(argv[2], cfg);
+        return gen.run(argv[0], argv[2], cfg);
     }
 
     if (argc >= 2 && std::string(argv[1]) == "patient") {
@@ -246,6 +739,25 @@ int main(int argc, char* argv[]) {
         return pat.run(argv[2], id, age, isVip, hasGuardian, personsCount);
     }
 
+    if (argc >= 2 && std::string(argv[1]) == "des") {
+        return runDesMode(argc, argv);
+    }
+
+    if (argc >= 2 && std::string(argv[1]) == "batch") {
+        return runBatchMode(argc, argv);
+    }
+
+    if (argc >= 2 && std::string(argv[1]) == "saturate") {
+        return runSaturationMode(argc, argv);
+    }
+
+    if (argc >= 2 && std::string(argv[1]) == "cleanup") {
+        // Lists live runs and removes IPC objects of runs whose director is gone.
+        int removed = cleanupOrphanedRuns(true);
+        std::cout << "Orphaned runs removed: " << removed << " (registry " << kRunRegistryDir << ")" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
     Config cfg{};
     std::string err;
     bool configOk = false;
@@ -274,6 +786,32 @@ int main(int argc, char* argv[]) {
             cfg.reconcileWaitSem = 0;
             cfg.patientGenMinMs = cfg.timeScaleMsPerSimMinute;
             cfg.patientGenMaxMs = cfg.timeScaleMsPerSimMinute;
+            cfg.shmRingTransport = 0;
+            cfg.shmRingSlots = 1024;
+            cfg.inProcessPatients = 0;
+            cfg.patientThreadPoolSize = 64;
+            cfg.logFlushBytes = 65536;
+            cfg.logFlushIntervalMs = 50;
+            cfg.logFsync = 0;
+            cfg.metricsPublishIntervalMs = 10;
+            cfg.binaryLog = 0;
+            cfg.logRings = 1;
+            cfg.logRingCount = 64;
+            cfg.logRingSlots = 512;
+            cfg.timeSeriesIntervalMs = 100;
+            cfg.registrationWindowsMax = 4;
+            cfg.registrationScaleIntervalMs = 20;
+            cfg.registrationScaleCooldownMs = 500;
+            cfg.specialistDoctors.fill(1);
+            cfg.triageWorkers = 1;
+            cfg.agingStepMs = 0;
+            cfg.maxWaitNormalMs = 0;
+            cfg.maxWaitYellowMs = 0;
+            cfg.maxWaitGreenMs = 0;
+            cfg.specialistPolicy = static_cast<int>(SpecialistPolicyKind::StrictPriority);
+            cfg.specialistWfqWeights = {{6, 3, 1}};
+            cfg.specialistTargetMs = {{100, 400, 1600}};
+            cfg.specialistExamPct = {{100, 100, 100}};
             // basic validation
             if (cfg.N_waitingRoom <= 0) {
                 err = "N_waitingRoom must be > 0";
@@ -331,7 +869,9 @@ int main(int argc, char* argv[]) {
         std::vector<char*> args;
         args.push_back(const_cast<char*>(argv[0]));
         args.push_back(const_cast<char*>("visualize"));
-        args.push_back(const_cast<char*>(logPath.c_str()));
+        // The visualizer decodes the binary log when there is one (no text parsing).
+        std::string vizLogPath = cfg.binaryLog ? binaryLogPath(logPath) : logPath;
+        args.push_back(const_cast<char*>(vizLogPath.c_str()));
         std::string intervalStr = std::to_string(cfg.visualizerRenderIntervalMs);
         args.push_back(const_cast<char*>(intervalStr.c_str()));
         args.push_back(nullptr);
@@ -0,0 +1,54 @@
+#include "model/aging_policy.hpp"
+
+#include "model/sim_rules.hpp"
+
+bool AgingPolicy::enabled() const {
+    if (stepMs > 0) return true;
+    for (int bound : maxWaitMs) {
+        if (bound > 0) return true;
+    }
+    return false;
+}
+
+int pickAgedClass(const long long* headAgeMs, int classes, const AgingPolicy& policy) {
+    // A head past its bound wins; among several, the one furthest past it.
+    int overdue = -1;
+    long long overdueBy = -1;
+    for (int c = 0; c < classes; ++c) {
+        int bound = policy.maxWaitMs[c];
+        if (headAgeMs[c] < 0 || bound <= 0 || headAgeMs[c] < bound) continue;
+        if (headAgeMs[c] - bound > overdueBy) {
+            overdue = c;
+            overdueBy = headAgeMs[c] - bound;
+        }
+    }
+    if (overdue >= 0) return overdue;
+
+    // Effective level = class - waited steps; ties keep the higher class.
+    int best = -1;
+    long long bestLevel = 0;
+    for (int c = 0; c < classes; ++c) {
+        if (headAgeMs[c] < 0) continue;
+        long long level = c - (policy.stepMs > 0 ? headAgeMs[c] / policy.stepMs : 0);
+        if (best < 0 || level < bestLevel) {
+            best = c;
+            bestLevel = level;
+        }
+    }
+    return best;
+}
+
+AgingPolicy vipQueueAgingPolicy(const Config& cfg) {
+    AgingPolicy policy;
+    policy.stepMs = scaleAllowZeroMs(cfg.agingStepMs, cfg.timeScaleMsPerSimMinute);
+    policy.maxWaitMs[1] = scaleAllowZeroMs(cfg.maxWaitNormalMs, cfg.timeScaleMsPerSimMinute);
+    return policy;
+}
+
+AgingPolicy colorQueueAgingPolicy(const Config& cfg) {
+    AgingPolicy policy;
+    policy.stepMs = scaleAllowZeroMs(cfg.agingStepMs, cfg.timeScaleMsPerSimMinute);
+    policy.maxWaitMs[1] = scaleAllowZeroMs(cfg.maxWaitYellowMs, cfg.timeScaleMsPerSimMinute);
+    policy.maxWaitMs[2] = scaleAllowZeroMs(cfg.maxWaitGreenMs, cfg.timeScaleMsPerSimMinute);
+    return policy;
+}
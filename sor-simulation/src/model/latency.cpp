@@ -0,0 +1,185 @@
+#include "model/latency.hpp"
+
+#include <ctime>
+
+namespace {
+constexpr int kLinearBuckets = 2 << LatencyHistogram::kSubBucketBits;  // exact buckets for 0..63 us
+constexpr uint64_t kSubBuckets = 1u << LatencyHistogram::kSubBucketBits;
+
+int highestBit(uint64_t v) {
+    return 63 - __builtin_clzll(v);
+}
+
+/** @brief Bucket holding the rank-th smallest sample (1-based). */
+int bucketOfRank(const LatencyHistogram& histogram, uint64_t rank) {
+    uint64_t seen = 0;
+    for (int i = 0; i < LatencyHistogram::kBuckets; ++i) {
+        seen += histogram.buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) return i;
+    }
+    return LatencyHistogram::kBuckets - 1;
+}
+
+long long toMicros(long long startNs, long long endNs) {
+    return (endNs - startNs) / 1000;
+}
+} // namespace
+
+long long hopClockNs() {
+    struct timespec ts {};
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == -1) return 0;
+    return static_cast<long long>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+int LatencyHistogram::bucketFor(uint64_t micros) {
+    if (micros < static_cast<uint64_t>(kLinearBuckets)) {
+        return static_cast<int>(micros);
+    }
+    int msb = highestBit(micros);
+    int shift = msb - kSubBucketBits;
+    int bucket = kLinearBuckets + (msb - kSubBucketBits - 1) * static_cast<int>(kSubBuckets) +
+                 static_cast<int>((micros >> shift) - kSubBuckets);
+    return bucket < kBuckets ? bucket : kBuckets - 1;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int bucket) {
+    if (bucket < kLinearBuckets) {
+        return static_cast<uint64_t>(bucket);
+    }
+    int octave = (bucket - kLinearBuckets) / static_cast<int>(kSubBuckets);
+    uint64_t sub = kSubBuckets + static_cast<uint64_t>((bucket - kLinearBuckets) % static_cast<int>(kSubBuckets));
+    int shift = octave + 1;
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(long long micros) {
+    uint64_t value = micros > 0 ? static_cast<uint64_t>(micros) : 0;
+    buckets[bucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sumUs.fetch_add(value, std::memory_order_relaxed);
+    uint64_t seenMax = maxUs.load(std::memory_order_relaxed);
+    while (value > seenMax && !maxUs.compare_exchange_weak(seenMax, value, std::memory_order_relaxed)) {
+    }
+}
+
+// Percentiles from a concurrent histogram are approximate by nature; count is re-derived from the
+// buckets so ranks always land inside the data that was actually scanned.
+LatencySummary LatencyHistogram::summarize() const {
+    LatencySummary summary;
+    uint64_t total = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        total += buckets[i].load(std::memory_order_relaxed);
+    }
+    if (total == 0) {
+        return summary;
+    }
+    summary.count = total;
+    summary.maxUs = maxUs.load(std::memory_order_relaxed);
+    summary.meanUs = sumUs.load(std::memory_order_relaxed) / total;
+    auto percentile = [&](uint64_t perMille) {
+        uint64_t rank = (total * perMille + 999) / 1000;
+        if (rank == 0) rank = 1;
+        uint64_t value = bucketUpperBound(bucketOfRank(*this, rank));
+        return value < summary.maxUs ? value : summary.maxUs;
+    };
+    summary.p50Us = percentile(500);
+    summary.p90Us = percentile(900);
+    summary.p99Us = percentile(990);
+    return summary;
+}
+
+void LatencyHistograms::recordHop(LatencyStage stage, long long startNs, long long endNs) {
+    if (startNs <= 0) return;
+    stages[static_cast<int>(stage)].record(toMicros(startNs, endNs));
+}
+
+void LatencyHistograms::recordExam(const HopStamps& hops, long long examStartNs, long long examEndNs, int color,
+                                   int specialist) {
+    recordHop(LatencyStage::SpecialistExam, examStartNs, examEndNs);
+    recordHop(LatencyStage::TimeInSystem, hops.doorNs, examEndNs);
+
+    const long long bounds[kLatencyStageCount][2] = {
+        {hops.doorNs, hops.waitingRoomNs},        {hops.waitingRoomNs, hops.registrationNs},
+        {hops.registrationNs, hops.triageNs},     {hops.triageNs, examStartNs},
+        {examStartNs, examEndNs},                 {hops.doorNs, examEndNs}};
+    bool knownColor = color >= 0 && color < kTriageColorCount;
+    bool knownSpecialist = specialist >= 0 && specialist < kSpecialistCount;
+    for (int stage = 0; stage < kLatencyStageCount; ++stage) {
+        if (bounds[stage][0] <= 0 || bounds[stage][1] <= 0) continue;
+        long long micros = toMicros(bounds[stage][0], bounds[stage][1]);
+        if (knownColor) byColor[color][stage].record(micros);
+        if (knownSpecialist) bySpecialist[specialist][stage].record(micros);
+    }
+}
+
+void LatencyHistograms::recordQueueWait(QueueClass cls, long long queuedNs, long long receivedNs) {
+    if (queuedNs <= 0) return;
+    queueWait[static_cast<int>(cls)].record(toMicros(queuedNs, receivedNs));
+}
+
+LatencyReport LatencyHistograms::report() const {
+    LatencyReport report;
+    for (int c = 0; c < kQueueClassCount; ++c) {
+        report.queueWait[c] = queueWait[c].summarize();
+    }
+    for (int stage = 0; stage < kLatencyStageCount; ++stage) {
+        report.stages[stage] = stages[stage].summarize();
+        for (int c = 0; c < kTriageColorCount; ++c) {
+            report.byColor[c][stage] = byColor[c][stage].summarize();
+        }
+        for (int s = 0; s < kSpecialistCount; ++s) {
+            report.bySpecialist[s][stage] = bySpecialist[s][stage].summarize();
+        }
+    }
+    return report;
+}
+
+const char* latencyStageName(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::DoorToWaitingRoom: return "Door -> waiting room";
+        case LatencyStage::WaitingRoomToRegistration: return "Waiting room -> registration";
+        case LatencyStage::RegistrationToTriage: return "Registration -> triage";
+        case LatencyStage::TriageToSpecialist: return "Triage -> specialist";
+        case LatencyStage::SpecialistExam: return "Specialist exam";
+        case LatencyStage::TimeInSystem: return "Time in system";
+    }
+    return "?";
+}
+
+const char* latencyStageKey(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::DoorToWaitingRoom: return "door_to_waiting_room";
+        case LatencyStage::WaitingRoomToRegistration: return "waiting_room_to_registration";
+        case LatencyStage::RegistrationToTriage: return "registration_to_triage";
+        case LatencyStage::TriageToSpecialist: return "triage_to_specialist";
+        case LatencyStage::SpecialistExam: return "specialist_exam";
+        case LatencyStage::TimeInSystem: return "time_in_system";
+    }
+    return "unknown";
+}
+
+const char* queueClassName(QueueClass cls) {
+    switch (cls) {
+        case QueueClass::RegistrationVip: return "Registration VIP";
+        case QueueClass::RegistrationNormal: return "Registration normal";
+        case QueueClass::TriageVip: return "Triage VIP";
+        case QueueClass::TriageNormal: return "Triage normal";
+        case QueueClass::SpecialistRed: return "Specialist red";
+        case QueueClass::SpecialistYellow: return "Specialist yellow";
+        case QueueClass::SpecialistGreen: return "Specialist green";
+    }
+    return "?";
+}
+
+const char* queueClassKey(QueueClass cls) {
+    switch (cls) {
+        case QueueClass::RegistrationVip: return "registration_vip";
+        case QueueClass::RegistrationNormal: return "registration_normal";
+        case QueueClass::TriageVip: return "triage_vip";
+        case QueueClass::TriageNormal: return "triage_normal";
+        case QueueClass::SpecialistRed: return "specialist_red";
+        case QueueClass::SpecialistYellow: return "specialist_yellow";
+        case QueueClass::SpecialistGreen: return "specialist_green";
+    }
+    return "unknown";
+}
@@ -0,0 +1,28 @@
+#include "model/registration_policy.hpp"
+
+int RegistrationScaler::update(long long nowMs, int queueLen, int openWindows) {
+    if (sampled_ && nowMs > lastSampleMs_) {
+        double dtMs = static_cast<double>(nowMs - lastSampleMs_);
+        double slope = (queueLen - lastQueueLen_) * 1000.0 / dtMs;
+        double alpha = dtMs / (dtMs + policy_.cooldownMs);
+        growthPerSec_ += alpha * (slope - growthPerSec_);
+    }
+    sampled_ = true;
+    lastSampleMs_ = nowMs;
+    lastQueueLen_ = queueLen;
+    projected_ = queueLen + growthPerSec_ * policy_.cooldownMs / 1000.0;
+
+    if (changed_ && nowMs - lastChangeMs_ < policy_.cooldownMs) return 0;
+    int decision = 0;
+    if (openWindows < policy_.maxWindows && projected_ >= policy_.openThreshold &&
+        (queueLen >= policy_.openThreshold || growthPerSec_ > 0.0)) {
+        decision = 1;
+    } else if (openWindows > 1 && queueLen < policy_.closeThreshold && projected_ < policy_.closeThreshold) {
+        decision = -1;
+    }
+    if (decision != 0) {
+        changed_ = true;
+        lastChangeMs_ = nowMs;
+    }
+    return decision;
+}
@@ -0,0 +1,66 @@
+#include "model/shared_state.hpp"
+
+namespace {
+/** @brief Passes before snapshot() settles for the latest read under heavy churn. */
+constexpr int kSnapshotAttempts = 8;
+
+StateSnapshot collectOnce(const SharedState& state) {
+    StateSnapshot s;
+    s.currentInWaitingRoom = state.waitingRoom.currentInWaitingRoom.load(std::memory_order_acquire);
+    s.waitingRoomCapacity = state.waitingRoomCapacity;
+    s.queueRegistrationLen = state.waitingRoom.queueRegistrationLen.load(std::memory_order_acquire);
+    s.totalPatients = state.waitingRoom.totalPatients.load(std::memory_order_acquire);
+    s.openRegistrationWindows = state.control.openRegistrationWindows.load(std::memory_order_acquire);
+    for (const TriageCounters& triage : state.triage) {
+        s.triageRed += triage.red.load(std::memory_order_acquire);
+        s.triageYellow += triage.yellow.load(std::memory_order_acquire);
+        s.triageGreen += triage.green.load(std::memory_order_acquire);
+        s.triageSentHome += triage.sentHome.load(std::memory_order_acquire);
+    }
+    for (const OutcomeCounters& outcome : state.outcomes) {
+        s.outcomeHome += outcome.home.load(std::memory_order_acquire);
+        s.outcomeWard += outcome.ward.load(std::memory_order_acquire);
+        s.outcomeOther += outcome.other.load(std::memory_order_acquire);
+    }
+    return s;
+}
+
+bool sameCounters(const StateSnapshot& a, const StateSnapshot& b) {
+    return a.currentInWaitingRoom == b.currentInWaitingRoom && a.queueRegistrationLen == b.queueRegistrationLen &&
+           a.totalPatients == b.totalPatients && a.openRegistrationWindows == b.openRegistrationWindows &&
+           a.triageRed == b.triageRed &&
+           a.triageYellow == b.triageYellow && a.triageGreen == b.triageGreen &&
+           a.triageSentHome == b.triageSentHome && a.outcomeHome == b.outcomeHome &&
+           a.outcomeWard == b.outcomeWard && a.outcomeOther == b.outcomeOther;
+}
+} // namespace
+
+void AgingLane::noteEnqueue(long long queuedNs) {
+    // Until the seq tag below is published, readers see the slot as "age unknown".
+    long long seq = enqueued.fetch_add(1, std::memory_order_acq_rel);
+    Stamp& stamp = stamps[static_cast<size_t>(seq) % stamps.size()];
+    stamp.ns.store(queuedNs, std::memory_order_relaxed);
+    stamp.seq.store(seq, std::memory_order_release);
+}
+
+long long AgingLane::headAgeMs(long long nowNs) const {
+    long long head = dequeued.load(std::memory_order_relaxed);
+    if (head >= enqueued.load(std::memory_order_acquire)) return -1;
+    const Stamp& stamp = stamps[static_cast<size_t>(head) % stamps.size()];
+    if (stamp.seq.load(std::memory_order_acquire) != head) return -1;
+    long long ageNs = nowNs - stamp.ns.load(std::memory_order_relaxed);
+    return ageNs > 0 ? ageNs / 1000000 : 0;
+}
+
+// Double-collect snapshot (see header for details).
+StateSnapshot SharedState::snapshot() const {
+    StateSnapshot previous = collectOnce(*this);
+    for (int attempt = 0; attempt < kSnapshotAttempts; ++attempt) {
+        StateSnapshot current = collectOnce(*this);
+        if (sameCounters(previous, current)) {
+            return current;
+        }
+        previous = current;
+    }
+    return previous;
+}
@@ -0,0 +1,118 @@
+#include "model/sim_rules.hpp"
+
+namespace {
+constexpr int kDefaultTimeScaleMsPerSimMinute = 20;
+/** @brief Seed offsets: doctors take 2 .. 2 + 6 * kMaxDoctorsPerSpecialty - 1, below the director's. */
+constexpr unsigned int kTriageSeedOffset = 1;
+constexpr unsigned int kDoctorSeedOffset = 2;
+constexpr unsigned int kDirectorSeedOffset = 100;
+constexpr unsigned int kExtraTriageSeedOffset = 200;
+} // namespace
+
+PatientTraits drawPatientTraits(RandomGenerator& rng) {
+    PatientTraits traits{};
+    traits.age = rng.uniformInt(1, 90);
+    traits.hasGuardian = traits.age < 18;
+    traits.personsCount = traits.hasGuardian ? 2 : 1;
+    traits.isVip = rng.uniformInt(0, 99) < 10; // ~10% VIP
+    return traits;
+}
+
+bool rollSentHomeFromTriage(RandomGenerator& rng) {
+    return rng.uniformInt(0, 99) < 5;
+}
+
+TriageColor pickColor(RandomGenerator& rng) {
+    int r = rng.uniformInt(0, 99);
+    if (r < 10) return TriageColor::Red;
+    if (r < 45) return TriageColor::Yellow;
+    return TriageColor::Green;
+}
+
+SpecialistType pickSpecialist(RandomGenerator& rng) {
+    int r = rng.uniformInt(0, 5);
+    switch (r) {
+        case 0: return SpecialistType::Cardiologist;
+        case 1: return SpecialistType::Neurologist;
+        case 2: return SpecialistType::Ophthalmologist;
+        case 3: return SpecialistType::Laryngologist;
+        case 4: return SpecialistType::Surgeon;
+        case 5: return SpecialistType::Paediatrician;
+        default: return SpecialistType::None;
+    }
+}
+
+Outcome pickOutcome(RandomGenerator& rng) {
+    int r = rng.uniformInt(0, 999);
+    if (r < 850) return Outcome::Home;
+    if (r < 995) return Outcome::Ward;
+    return Outcome::OtherFacility;
+}
+
+const char* outcomeLabel(Outcome outcome) {
+    switch (outcome) {
+        case Outcome::Home: return "home";
+        case Outcome::Ward: return "ward";
+        default: return "otherFacility";
+    }
+}
+
+int colorPriority(TriageColor c) {
+    switch (c) {
+        case TriageColor::Red: return 1;    // highest priority
+        case TriageColor::Yellow: return 2; // medium
+        case TriageColor::Green: return 3;  // lowest
+        default: return 3;
+    }
+}
+
+long arrivalMsgType(bool isVip) {
+    long baseType = static_cast<long>(EventType::PatientArrived);
+    return isVip ? baseType : baseType + 1;
+}
+
+long registeredMsgType(bool isVip) {
+    long baseType = static_cast<long>(EventType::PatientRegistered);
+    return isVip ? baseType : baseType + 1;
+}
+
+long specialistMsgType(SpecialistType spec, TriageColor color) {
+    return static_cast<long>(EventType::PatientToSpecialist) +
+           static_cast<int>(spec) * 10 + colorPriority(color);
+}
+
+long maxMsgTypeForSpec(SpecialistType t) {
+    // base + specialist*10 + maxPriority(3)
+    return static_cast<long>(EventType::PatientToSpecialist) + static_cast<int>(t) * 10 + 3;
+}
+
+// Worker 0 keeps the DES engine's single triage seed; extra workers sit past the director's offset.
+unsigned int triageSeed(unsigned int base, int worker) {
+    if (worker <= 0) return base + kTriageSeedOffset;
+    return base + kExtraTriageSeedOffset + static_cast<unsigned int>(worker);
+}
+
+unsigned int doctorSeed(unsigned int base, SpecialistType type, int doctor) {
+    return base + kDoctorSeedOffset + static_cast<unsigned int>(static_cast<int>(type) + doctor * kSpecialistCount);
+}
+
+unsigned int directorSeed(unsigned int base) {
+    return base + kDirectorSeedOffset;
+}
+
+int scaleAllowZeroMs(int baseMs, int msPerSimMinute) {
+    if (baseMs <= 0) return 0;
+    long long scaled = static_cast<long long>(baseMs) * msPerSimMinute / kDefaultTimeScaleMsPerSimMinute;
+    if (scaled <= 0) scaled = 1;
+    return static_cast<int>(scaled);
+}
+
+int scaleAtLeastOneMs(int baseMs, int msPerSimMinute) {
+    int v = scaleAllowZeroMs(baseMs, msPerSimMinute);
+    return v <= 0 ? 1 : v;
+}
+
+int scaleIntervalMs(int baseMs, int msPerSimMinute) {
+    if (baseMs <= 0) return msPerSimMinute;
+    return scaleAtLeastOneMs(baseMs, msPerSimMinute);
+}
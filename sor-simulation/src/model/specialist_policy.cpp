@@ -0,0 +1,89 @@
+#include "model/specialist_policy.hpp"
+
+#include "model/sim_rules.hpp"
+
+#include <algorithm>
+
+const char* specialistPolicyName(SpecialistPolicyKind kind) {
+    switch (kind) {
+        case SpecialistPolicyKind::StrictPriority: return "strict";
+        case SpecialistPolicyKind::WeightedFair: return "wfq";
+        case SpecialistPolicyKind::ShortestExam: return "sef";
+        case SpecialistPolicyKind::EarliestDeadline: return "edf";
+    }
+    return "unknown";
+}
+
+bool parseSpecialistPolicy(const std::string& text, SpecialistPolicyKind& out) {
+    for (SpecialistPolicyKind kind : {SpecialistPolicyKind::StrictPriority, SpecialistPolicyKind::WeightedFair,
+                                      SpecialistPolicyKind::ShortestExam, SpecialistPolicyKind::EarliestDeadline}) {
+        if (text == specialistPolicyName(kind)) {
+            out = kind;
+            return true;
+        }
+    }
+    return false;
+}
+
+SpecialistPolicy specialistPolicyFromConfig(const Config& cfg) {
+    SpecialistPolicy policy;
+    policy.kind = cfg.specialistPolicy;
+    policy.weights = cfg.specialistWfqWeights;
+    policy.examPct = cfg.specialistExamPct;
+    for (int c = 0; c < kTriageColorCount; ++c) {
+        policy.targetMs[c] = scaleAtLeastOneMs(cfg.specialistTargetMs[c], cfg.timeScaleMsPerSimMinute);
+    }
+    return policy;
+}
+
+int colorExamMs(const SpecialistPolicy& policy, TriageColor color, int drawnMs) {
+    int c = static_cast<int>(color);
+    if (c < 0 || c >= kTriageColorCount) return drawnMs;
+    return std::max(1, static_cast<int>(static_cast<long long>(drawnMs) * policy.examPct[c] / 100));
+}
+
+int SpecialistScheduler::pick(const long long* queued, const long long* headAgeMs) const {
+    int best = -1;
+    switch (policy_.policyKind()) {
+        case SpecialistPolicyKind::StrictPriority:
+            return aging_.enabled() ? pickAgedClass(headAgeMs, kTriageColorCount, aging_) : -1;
+        case SpecialistPolicyKind::WeightedFair: {
+            double bestFinish = 0.0;
+            for (int c = 0; c < kTriageColorCount; ++c) {
+                if (queued[c] <= 0) continue;
+                double finish = std::max(virtualTime_, finishTag_[c]) + 1.0 / policy_.weights[c];
+                if (best < 0 || finish < bestFinish) {
+                    best = c;
+                    bestFinish = finish;
+                }
+            }
+            return best;
+        }
+        case SpecialistPolicyKind::ShortestExam:
+            for (int c = 0; c < kTriageColorCount; ++c) {
+                if (queued[c] <= 0) continue;
+                if (best < 0 || policy_.examPct[c] < policy_.examPct[best]) best = c;
+            }
+            return best;
+        case SpecialistPolicyKind::EarliestDeadline: {
+            long long bestSlack = 0;
+            for (int c = 0; c < kTriageColorCount; ++c) {
+                if (headAgeMs[c] < 0) continue;
+                long long slack = policy_.targetMs[c] - headAgeMs[c];
+                if (best < 0 || slack < bestSlack) {
+                    best = c;
+                    bestSlack = slack;
+                }
+            }
+            return best;
+        }
+    }
+    return best;
+}
+
+void SpecialistScheduler::noteServed(int color) {
+    if (color < 0 || color >= kTriageColorCount) return;
+    double start = std::max(virtualTime_, finishTag_[color]);
+    finishTag_[color] = start + 1.0 / policy_.weights[color];
+    virtualTime_ = start;
+}
@@ -0,0 +1,445 @@
+#include "report/saturation.hpp"
+
+#include "director.hpp"
+#include "model/sim_rules.hpp"
+#include "report/summary.hpp"
+#include "util/error.hpp"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+namespace {
+/** @brief Consecutive unsustainable steps after which the ramp stops. */
+constexpr int kStepsPastKnee = 2;
+/** @brief Generator interval used when the config leaves patientGenMinMs/MaxMs at 0 (one sim minute). */
+constexpr int kBaselineIntervalMs = 20;
+/** @brief Series used for the backlog slope when the config disables it. */
+constexpr int kFallbackSeriesIntervalMs = 100;
+/** @brief Longest wait for a step's director to write its summary after SIGINT. */
+constexpr int kShutdownGraceSeconds = 60;
+
+volatile sig_atomic_t g_interrupted = 0;
+
+void handleInterrupt(int) {
+    g_interrupted = 1;
+}
+
+/** @brief First file in dir whose name starts with prefix and ends with suffix ("" when none). */
+std::string findFile(const std::string& dir, const std::string& prefix, const std::string& suffix) {
+    DIR* d = opendir(dir.c_str());
+    if (!d) return std::string();
+    std::string found;
+    while (struct dirent* entry = readdir(d)) {
+        std::string name = entry->d_name;
+        if (name.size() >= prefix.size() + suffix.size() && name.compare(0, prefix.size(), prefix) == 0 &&
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            found = dir + "/" + name;
+            break;
+        }
+    }
+    closedir(d);
+    return found;
+}
+
+/** @brief key,value rows of a summary CSV. */
+std::map<std::string, std::string> readSummaryCsv(const std::string& path) {
+    std::map<std::string, std::string> values;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t comma = line.find(',');
+        if (comma != std::string::npos) values[line.substr(0, comma)] = line.substr(comma + 1);
+    }
+    return values;
+}
+
+long long csvNumber(const std::map<std::string, std::string>& values, const std::string& key) {
+    auto it = values.find(key);
+    if (it == values.end()) return 0;
+    try {
+        return std::stoll(it->second);
+    } catch (const std::exception&) {
+        return 0;
+    }
+}
+
+/** @brief Figures of the second half of a step's queue series. */
+struct SeriesTail {
+    double backlogSlopePerSec{0.0};
+    double finishedPerSec{-1.0};  // -1 when the series is too short to tell
+};
+
+// Both figures cover only the second half of the run, so startup and the initial fill of an empty
+// pipeline count neither as backlog growth nor as missing throughput: least-squares slope of the
+// registration + triage + specialist queues, and the finished-count delta over that window. Samples
+// after stopSeconds (the SIGINT) are shutdown, not load, and are ignored.
+SeriesTail seriesTail(const std::string& seriesPath, double stopSeconds) {
+    SeriesTail tail;
+    std::ifstream in(seriesPath);
+    std::string line;
+    std::getline(in, line);  // header
+    struct Point {
+        double seconds;
+        double backlog;
+        long long finished;
+    };
+    std::vector<Point> points;
+    while (std::getline(in, line)) {
+        long long elapsedMs = 0, finished = 0;
+        int waitingRoom = 0, registration = 0, triage = 0, specialists = 0, waitSem = 0;
+        if (std::sscanf(line.c_str(), "%lld,%d,%d,%d,%d,%d,%lld", &elapsedMs, &waitingRoom, &registration, &triage,
+                        &specialists, &waitSem, &finished) == 7 &&
+            static_cast<double>(elapsedMs) / 1000.0 <= stopSeconds) {
+            points.push_back({static_cast<double>(elapsedMs) / 1000.0,
+                              static_cast<double>(registration + triage + specialists), finished});
+        }
+    }
+    if (points.size() < 4) return tail;
+    double half = points.back().seconds / 2.0;
+    const Point* first = nullptr;
+    double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (const Point& p : points) {
+        if (p.seconds < half) continue;
+        if (!first) first = &p;
+        n += 1;
+        sx += p.seconds;
+        sy += p.backlog;
+        sxx += p.seconds * p.seconds;
+        sxy += p.seconds * p.backlog;
+    }
+    double denom = n * sxx - sx * sx;
+    if (n >= 2 && denom > 0.0) tail.backlogSlopePerSec = (n * sxy - sx * sy) / denom;
+    double window = points.back().seconds - (first ? first->seconds : 0.0);
+    if (first && window > 0.0) {
+        tail.finishedPerSec = static_cast<double>(points.back().finished - first->finished) / window;
+    }
+    return tail;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t mid = values.size() / 2;
+    return values.size() % 2 != 0 ? values[mid] : (values[mid - 1] + values[mid]) / 2.0;
+}
+
+/** @brief Count the overload symptoms the roles log: fork failures, child-cap waits, waitSem drift. */
+void scanLog(const std::string& logPath, SaturationStep& step) {
+    std::ifstream in(logPath);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.find("fork failed") != std::string::npos) {
+            ++step.forkFailures;
+        } else if (line.find("waiting for children slots") != std::string::npos) {
+            ++step.childCapWaits;
+        } else {
+            size_t mon = line.find("ERROR MON w=");
+            size_t miss = mon == std::string::npos ? mon : line.find(" miss=", mon);
+            if (miss != std::string::npos) {
+                int value = std::atoi(line.c_str() + miss + 6);
+                if (value > step.maxWaitSemDrift) step.maxWaitSemDrift = value;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Run the director in a child process inside dir for stepSeconds, then stop it with SIGINT
+ * like an operator would. Returns the exit code (-1 when the child could not run) and the CPU time
+ * of the whole process tree (every role is reaped by its parent, so wait4 of the director covers it).
+ */
+int runStepProcess(const std::string& selfPath, const Config& config, const std::string& dir, int stepSeconds,
+                   double& cpuSeconds, double& wallSeconds) {
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid == -1) {
+        logErrno("saturation fork failed");
+        return -1;
+    }
+    if (pid == 0) {
+        if (chdir(dir.c_str()) == -1) _exit(127);
+        int out = open("director.out", O_WRONLY | O_CREAT | O_TRUNC, 0600);
+        if (out != -1) {
+            dup2(out, STDOUT_FILENO);
+            dup2(out, STDERR_FILENO);
+            close(out);
+        }
+        Director director;
+        int rc = director.run(selfPath, config);
+        std::cout.flush();
+        _exit(rc);
+    }
+
+    auto deadline = start + std::chrono::seconds(stepSeconds);
+    int status = 0;
+    struct rusage usage {};
+    pid_t done = 0;
+    while (done == 0 && !g_interrupted && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        done = wait4(pid, &status, WNOHANG, &usage);
+    }
+    wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (done == 0) {
+        kill(pid, SIGINT);
+        auto graceEnd = std::chrono::steady_clock::now() + std::chrono::seconds(kShutdownGraceSeconds);
+        while (done == 0 && std::chrono::steady_clock::now() < graceEnd) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            done = wait4(pid, &status, WNOHANG, &usage);
+        }
+        if (done == 0) {
+            std::cerr << "Step in " << dir << " did not shut down; killing it" << std::endl;
+            kill(pid, SIGKILL);
+            done = wait4(pid, &status, 0, &usage);
+        }
+    }
+    if (done == -1) {
+        logErrno("saturation wait4 failed");
+        return -1;
+    }
+    cpuSeconds = static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+                 static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/**
+ * @brief Fill the measurements of one run of a step from the files its director wrote in dir.
+ * Throughput comes from the second half of the queue series (whole run when the series is too short).
+ */
+void measureRun(const std::string& dir, int exitCode, double cpuSeconds, double wallSeconds, SaturationStep& run) {
+    run.exitCode = exitCode;
+    std::string textPath = findFile(dir, "sor_summary_", ".txt");
+    std::map<std::string, std::string> summary;
+    if (!textPath.empty()) summary = readSummaryCsv(summarySiblingPath(textPath, ".csv"));
+    if (summary.empty()) {
+        run.exitCode = run.exitCode == 0 ? -1 : run.exitCode;
+    }
+    run.finished = csvNumber(summary, "outcomes.home") + csvNumber(summary, "outcomes.ward") +
+                   csvNumber(summary, "outcomes.other") + csvNumber(summary, "triage.sentHome");
+    SeriesTail tail;
+    if (!textPath.empty()) tail = seriesTail(summarySiblingPath(textPath, "_series.csv"), wallSeconds);
+    run.backlogGrowthPerSec = tail.backlogSlopePerSec;
+    if (tail.finishedPerSec >= 0.0) {
+        run.achievedPerSec = tail.finishedPerSec;
+    } else {
+        run.achievedPerSec = wallSeconds > 0.0 ? static_cast<double>(run.finished) / wallSeconds : 0.0;
+    }
+    run.p99TimeInSystemMs = static_cast<double>(csvNumber(summary, "latencyUs.stages.time_in_system.p99")) / 1000.0;
+    run.logRecordsDropped = csvNumber(summary, "logRecordsDropped");
+    run.cpuMsPerPatient = run.finished > 0 ? cpuSeconds * 1000.0 / static_cast<double>(run.finished) : 0.0;
+    scanLog(findFile(dir, "sor_run_", ".log"), run);
+}
+
+/**
+ * @brief Combine the runs of one step: medians of the rates and latencies, worst case of the
+ * overload counters, and the first failing exit code.
+ */
+void combineRuns(const std::vector<SaturationStep>& runs, SaturationStep& step) {
+    std::vector<double> achieved, backlog, p99, cpu, finished;
+    for (const SaturationStep& run : runs) {
+        achieved.push_back(run.achievedPerSec);
+        backlog.push_back(run.backlogGrowthPerSec);
+        p99.push_back(run.p99TimeInSystemMs);
+        cpu.push_back(run.cpuMsPerPatient);
+        finished.push_back(static_cast<double>(run.finished));
+        step.forkFailures = std::max(step.forkFailures, run.forkFailures);
+        step.childCapWaits = std::max(step.childCapWaits, run.childCapWaits);
+        step.logRecordsDropped = std::max(step.logRecordsDropped, run.logRecordsDropped);
+        step.maxWaitSemDrift = std::max(step.maxWaitSemDrift, run.maxWaitSemDrift);
+        if (step.exitCode == 0) step.exitCode = run.exitCode;
+    }
+    step.achievedPerSec = median(achieved);
+    step.backlogGrowthPerSec = median(backlog);
+    step.p99TimeInSystemMs = median(p99);
+    step.cpuMsPerPatient = median(cpu);
+    step.finished = std::llround(median(finished));
+}
+
+void judgeStep(const SaturationOptions& options, SaturationStep& step) {
+    std::ostringstream why;
+    if (step.exitCode != 0) {
+        why << "director exit " << step.exitCode << "; ";
+    }
+    if (step.achievedPerSec < options.minThroughputRatio * step.offeredPerSec) {
+        why << "throughput " << static_cast<int>(100.0 * step.achievedPerSec / step.offeredPerSec) << "% of offered; ";
+    }
+    if (step.backlogGrowthPerSec > options.maxBacklogGrowth * step.offeredPerSec) {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "backlog +%.1f/s; ", step.backlogGrowthPerSec);
+        why << buf;
+    }
+    if (step.forkFailures > 0) {
+        why << step.forkFailures << " fork failures; ";
+    }
+    step.verdict = why.str();
+    step.sustainable = step.verdict.empty();
+    if (step.sustainable) {
+        step.verdict = "ok";
+    } else {
+        step.verdict.resize(step.verdict.size() - 2);
+    }
+}
+
+int scaledOrBaseline(int baseMs) {
+    return baseMs > 0 ? baseMs : kBaselineIntervalMs;
+}
+} // namespace
+
+SaturationResult runSaturation(const Config& config, const SaturationOptions& options) {
+    SaturationResult result;
+    result.stepSeconds = options.stepSeconds;
+    result.repeats = options.repeats;
+    result.outDir = options.outDir;
+    if (mkdir(options.outDir.c_str(), 0700) == -1 && errno != EEXIST) {
+        logErrno("saturation output directory");
+        return result;
+    }
+    struct sigaction sa {};
+    struct sigaction oldSa {};
+    sa.sa_handler = handleInterrupt;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, &oldSa);
+    g_interrupted = 0;
+
+    double genMin = scaledOrBaseline(config.patientGenMinMs);
+    double genMax = std::max(genMin, static_cast<double>(scaledOrBaseline(config.patientGenMaxMs)));
+    int unsustainableRun = 0;
+    bool pastKnee = false;
+    for (int i = 0; i < options.steps && !g_interrupted; ++i) {
+        SaturationStep step;
+        step.index = i;
+        step.patientGenMinMs = std::max(1, static_cast<int>(std::lround(genMin)));
+        step.patientGenMaxMs = std::max(step.patientGenMinMs, static_cast<int>(std::lround(genMax)));
+        genMin *= options.factor;
+        genMax *= options.factor;
+
+        Config stepConfig = config;
+        stepConfig.patientGenMinMs = step.patientGenMinMs;
+        stepConfig.patientGenMaxMs = step.patientGenMaxMs;
+        stepConfig.simulationDurationMinutes = 0;  // the step is ended by SIGINT
+        if (stepConfig.timeSeriesIntervalMs <= 0) stepConfig.timeSeriesIntervalMs = kFallbackSeriesIntervalMs;
+        int scaledMin = scaleIntervalMs(step.patientGenMinMs, config.timeScaleMsPerSimMinute);
+        int scaledMax = scaleIntervalMs(step.patientGenMaxMs, config.timeScaleMsPerSimMinute);
+        step.meanIntervalMs = (scaledMin + std::max(scaledMin, scaledMax)) / 2.0;
+        step.offeredPerSec = 1000.0 / step.meanIntervalMs;
+
+        std::cerr << "step " << i << ": patientGenMinMs=" << step.patientGenMinMs
+                  << " patientGenMaxMs=" << step.patientGenMaxMs << " offered=" << step.offeredPerSec << "/s"
+                  << std::endl;
+        // Every repeat runs the same config (same randomSeed), so they differ only in scheduling noise.
+        std::vector<SaturationStep> runs;
+        for (int r = 0; r < options.repeats && !g_interrupted; ++r) {
+            std::string dir = options.outDir + "/step_" + std::to_string(i);
+            if (options.repeats > 1) dir += "_" + std::to_string(r);
+            if (mkdir(dir.c_str(), 0700) == -1 && errno != EEXIST) {
+                logErrno("saturation step directory");
+                break;
+            }
+            double cpuSeconds = 0.0;
+            double wallSeconds = 0.0;
+            int exitCode = runStepProcess(options.selfPath, stepConfig, dir, options.stepSeconds, cpuSeconds,
+                                          wallSeconds);
+            SaturationStep run;
+            measureRun(dir, exitCode, cpuSeconds, wallSeconds, run);
+            runs.push_back(run);
+        }
+        if (runs.empty()) break;
+        combineRuns(runs, step);
+        judgeStep(options, step);
+        result.steps.push_back(step);
+
+        if (step.sustainable) {
+            unsustainableRun = 0;
+            if (!pastKnee) result.kneeIndex = i;
+        } else {
+            pastKnee = true;
+            if (++unsustainableRun >= kStepsPastKnee) break;
+        }
+        if (step.meanIntervalMs <= 1.0) break;
+    }
+    sigaction(SIGINT, &oldSa, nullptr);
+    return result;
+}
+
+double saturationKneeRate(const SaturationResult& result) {
+    if (result.kneeIndex < 0) return 0.0;
+    return result.steps[static_cast<size_t>(result.kneeIndex)].offeredPerSec;
+}
+
+bool writeSaturationReport(const SaturationResult& result, std::ostream& out) {
+    out << "SOR saturation ramp\n";
+    out << "===================\n";
+    out << "Steps: " << result.steps.size() << " x " << result.stepSeconds << " s";
+    if (result.repeats > 1) out << ", median of " << result.repeats << " runs each";
+    out << " (runs in " << result.outDir << ")\n";
+    out << "Rates are patients per wall second over the second half of each run; backlog = registration + triage + "
+           "specialist queues\n\n";
+    char line[320];
+    std::snprintf(line, sizeof(line), "%4s %11s %9s %9s %9s %10s %11s %8s %7s %6s %6s %6s  %s\n", "step", "genMs",
+                  "offered", "achieved", "backlog/s", "p99 TIS ms", "CPU ms/pat", "finished", "forkErr", "cap",
+                  "logDrp", "wDrift", "verdict");
+    out << line;
+    for (const SaturationStep& s : result.steps) {
+        std::string gen = std::to_string(s.patientGenMinMs) + ".." + std::to_string(s.patientGenMaxMs);
+        std::snprintf(line, sizeof(line), "%4d %11s %9.1f %9.1f %9.2f %10.1f %11.2f %8lld %7lld %6lld %6lld %6d  %s\n",
+                      s.index, gen.c_str(), s.offeredPerSec, s.achievedPerSec, s.backlogGrowthPerSec,
+                      s.p99TimeInSystemMs, s.cpuMsPerPatient, s.finished, s.forkFailures, s.childCapWaits,
+                      s.logRecordsDropped, s.maxWaitSemDrift, s.verdict.c_str());
+        out << line;
+    }
+    out << "\n";
+    if (result.kneeIndex < 0) {
+        out << "Knee: none (the first step is already unsustainable)\n";
+    } else {
+        const SaturationStep& k = result.steps[static_cast<size_t>(result.kneeIndex)];
+        std::snprintf(line, sizeof(line),
+                      "Knee: step %d, %.1f patients/s offered (%.1f achieved, patientGenMinMs=%d patientGenMaxMs=%d)\n",
+                      k.index, k.offeredPerSec, k.achievedPerSec, k.patientGenMinMs, k.patientGenMaxMs);
+        out << line;
+        if (static_cast<size_t>(result.kneeIndex) + 1 == result.steps.size()) {
+            out << "(no unsustainable step reached; the knee is at least this rate)\n";
+        }
+    }
+    return static_cast<bool>(out);
+}
+
+// Hand-written JSON: only the verdict is free text, and it never contains quotes or backslashes.
+bool writeSaturationJson(const SaturationResult& result, const std::string& path) {
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out) {
+        logErrno("saturation json open failed");
+        return false;
+    }
+    out << "{\n  \"stepSeconds\": " << result.stepSeconds << ",\n  \"repeats\": " << result.repeats
+        << ",\n  \"kneeStep\": " << result.kneeIndex
+        << ",\n  \"kneeOfferedPerSec\": " << saturationKneeRate(result) << ",\n  \"steps\": [";
+    for (size_t i = 0; i < result.steps.size(); ++i) {
+        const SaturationStep& s = result.steps[i];
+        out << (i > 0 ? "," : "") << "\n    {\"step\": " << s.index << ", \"patientGenMinMs\": " << s.patientGenMinMs
+            << ", \"patientGenMaxMs\": " << s.patientGenMaxMs << ", \"meanIntervalMs\": " << s.meanIntervalMs
+            << ", \"offeredPerSec\": " << s.offeredPerSec << ", \"achievedPerSec\": " << s.achievedPerSec
+            << ", \"backlogGrowthPerSec\": " << s.backlogGrowthPerSec << ", \"p99TimeInSystemMs\": "
+            << s.p99TimeInSystemMs << ", \"cpuMsPerPatient\": " << s.cpuMsPerPatient << ", \"finished\": " << s.finished
+            << ", \"forkFailures\": " << s.forkFailures << ", \"childCapWaits\": " << s.childCapWaits
+            << ", \"logRecordsDropped\": " << s.logRecordsDropped << ", \"maxWaitSemDrift\": " << s.maxWaitSemDrift
+            << ", \"exitCode\": " << s.exitCode << ", \"sustainable\": " << (s.sustainable ? "true" : "false")
+            << ", \"verdict\": \"" << s.verdict << "\"}";
+    }
+    out << "\n  ]\n}\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,461 @@
+#include "report/summary.hpp"
+
+#include "util/error.hpp"
+
+#include <cctype>
+#include <cstdio>
+#include <sstream>
+
+namespace {
+const char* const kColorKeys[kTriageColorCount] = {"red", "yellow", "green"};
+const char* const kColorLabels[kTriageColorCount] = {"Red:    ", "Yellow: ", "Green:  "};
+
+/** @brief Microseconds as milliseconds with one decimal. */
+std::string formatMs(uint64_t micros) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.1f", static_cast<double>(micros) / 1000.0);
+    return buf;
+}
+
+/** @brief "p50 / p90 / p99 / max (n=count)" in milliseconds, or "n/a" without samples. */
+std::string formatLatency(const LatencySummary& s) {
+    if (s.count == 0) return "n/a";
+    return formatMs(s.p50Us) + " / " + formatMs(s.p90Us) + " / " + formatMs(s.p99Us) + " / " + formatMs(s.maxUs) +
+           " (n=" + std::to_string(s.count) + ")";
+}
+
+void writeLatencyText(const LatencyReport& latency, std::ofstream& out) {
+    const int total = static_cast<int>(LatencyStage::TimeInSystem);
+    const int wait = static_cast<int>(LatencyStage::TriageToSpecialist);
+    out << "Patient latency (ms, p50 / p90 / p99 / max):\n";
+    for (int stage = 0; stage < kLatencyStageCount; ++stage) {
+        std::string label = std::string(latencyStageName(static_cast<LatencyStage>(stage))) + ":";
+        label.resize(31, ' ');
+        out << "  " << label << formatLatency(latency.stages[stage]) << "\n";
+    }
+    out << "Time in system by triage colour (ms):\n";
+    for (int c = 0; c < kTriageColorCount; ++c) {
+        out << "  " << kColorLabels[c] << formatLatency(latency.byColor[c][total]) << "\n";
+    }
+    out << "Triage -> specialist by triage colour (ms):\n";
+    for (int c = 0; c < kTriageColorCount; ++c) {
+        out << "  " << kColorLabels[c] << formatLatency(latency.byColor[c][wait]) << "\n";
+    }
+    out << "Queue wait by class (ms, send -> receive):\n";
+    for (int c = 0; c < kQueueClassCount; ++c) {
+        std::string label = std::string(queueClassName(static_cast<QueueClass>(c))) + ":";
+        label.resize(21, ' ');
+        out << "  " << label << formatLatency(latency.queueWait[c]) << "\n";
+    }
+    out << "Time in system by specialist (ms):\n";
+    for (int s = 0; s < kSpecialistCount; ++s) {
+        std::string label = std::string(specialistName(s)) + ":";
+        label.resize(17, ' ');
+        out << "  " << label << formatLatency(latency.bySpecialist[s][total]) << "\n";
+    }
+}
+
+/** @brief Lower-case specialist name used as a JSON/CSV key. */
+std::string specialistKey(int idx) {
+    std::string key = specialistName(idx);
+    for (char& ch : key) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    return key;
+}
+
+void writeLatencyJson(const LatencySummary& s, std::ofstream& out) {
+    out << "{\"count\": " << s.count << ", \"mean\": " << s.meanUs << ", \"p50\": " << s.p50Us << ", \"p90\": "
+        << s.p90Us << ", \"p99\": " << s.p99Us << ", \"max\": " << s.maxUs << "}";
+}
+
+void writeStagesJson(const std::array<LatencySummary, kLatencyStageCount>& stages, std::ofstream& out) {
+    out << "{";
+    for (int stage = 0; stage < kLatencyStageCount; ++stage) {
+        out << (stage > 0 ? ", " : "") << "\"" << latencyStageKey(static_cast<LatencyStage>(stage)) << "\": ";
+        writeLatencyJson(stages[stage], out);
+    }
+    out << "}";
+}
+
+template <typename T>
+void writeColumnJson(const char* name, const std::vector<T>& column, std::ofstream& out) {
+    out << ",\n    \"" << name << "\": [";
+    for (size_t i = 0; i < column.size(); ++i) {
+        out << (i > 0 ? ", " : "") << column[i];
+    }
+    out << "]";
+}
+
+void writeLatencyCsv(const std::string& key, const LatencySummary& s, std::ofstream& out) {
+    out << key << "count," << s.count << "\n" << key << "mean," << s.meanUs << "\n" << key << "p50," << s.p50Us
+        << "\n" << key << "p90," << s.p90Us << "\n" << key << "p99," << s.p99Us << "\n" << key << "max," << s.maxUs
+        << "\n";
+}
+
+void writeStagesCsv(const std::string& prefix, const std::array<LatencySummary, kLatencyStageCount>& stages,
+                    std::ofstream& out) {
+    for (int stage = 0; stage < kLatencyStageCount; ++stage) {
+        writeLatencyCsv(prefix + latencyStageKey(static_cast<LatencyStage>(stage)) + ".", stages[stage], out);
+    }
+}
+
+/**
+ * @brief One line per pool window. Busy time can exceed open time: a window that is parked still
+ * finishes the patient it holds.
+ */
+void writeRegistrationText(const SummaryPayload& payload, std::ofstream& out) {
+    out << "Registration windows (peak open " << payload.peakOpenRegistrationWindows << " of "
+        << payload.registrationWindows.size() << "):\n";
+    char buf[128];
+    for (size_t i = 0; i < payload.registrationWindows.size(); ++i) {
+        const RegistrationWindowSummary& w = payload.registrationWindows[i];
+        std::snprintf(buf, sizeof(buf), "  #%zu: opened %dx, open %.1f s, busy %.1f s, %lld patients", i,
+                      w.activations, static_cast<double>(w.openMs) / 1000.0, static_cast<double>(w.busyMs) / 1000.0,
+                      w.patients);
+        out << buf;
+        if (!payload.discreteEvent) out << ", pid " << w.pid;
+        out << "\n";
+    }
+}
+
+/** @brief Patients per second of a triage worker over the run. */
+double triageThroughput(const TriageWorkerSummary& worker, long long elapsedMs) {
+    return elapsedMs > 0 ? worker.patients() * 1000.0 / static_cast<double>(elapsedMs) : 0.0;
+}
+
+/** @brief One line per triage worker: decisions, throughput and busy time. */
+void writeTriageWorkersText(const SummaryPayload& payload, std::ofstream& out) {
+    out << "Triage workers:\n";
+    char buf[160];
+    for (size_t w = 0; w < payload.triageWorkers.size(); ++w) {
+        const TriageWorkerSummary& worker = payload.triageWorkers[w];
+        double busyShare = payload.elapsedMs > 0 ? static_cast<double>(worker.busyMs) / payload.elapsedMs : 0.0;
+        std::snprintf(buf, sizeof(buf), "  #%zu: %d patients (%.1f/s; R/Y/G %d/%d/%d, home %d), busy %.1f s (%.0f%%)",
+                      w, worker.patients(), triageThroughput(worker, payload.elapsedMs), worker.red, worker.yellow,
+                      worker.green, worker.sentHome, static_cast<double>(worker.busyMs) / 1000.0, busyShare * 100.0);
+        out << buf;
+        if (!payload.discreteEvent) out << ", pid " << worker.pid;
+        out << "\n";
+    }
+}
+
+/** @brief Fraction of the run the doctor spent examining. */
+double doctorUtilization(const DoctorSummary& doctor, long long elapsedMs) {
+    return elapsedMs > 0 ? static_cast<double>(doctor.busyMs) / static_cast<double>(elapsedMs) : 0.0;
+}
+
+/** @brief One line per doctor: exams, busy time and utilization, leaves. */
+void writeDoctorsText(const SummaryPayload& payload, std::ofstream& out) {
+    char buf[160];
+    std::snprintf(buf, sizeof(buf), "Specialist doctors (utilization = busy / %.1f s elapsed):\n",
+                  static_cast<double>(payload.elapsedMs) / 1000.0);
+    out << buf;
+    for (int s = 0; s < kSpecialistCount; ++s) {
+        for (size_t d = 0; d < payload.doctors[s].size(); ++d) {
+            const DoctorSummary& doc = payload.doctors[s][d];
+            std::snprintf(buf, sizeof(buf), "  %s #%zu: %lld exams, busy %.1f s (%.0f%%), %d leaves (%.1f s)",
+                          specialistName(s), d, doc.exams, static_cast<double>(doc.busyMs) / 1000.0,
+                          doctorUtilization(doc, payload.elapsedMs) * 100.0, doc.leaves,
+                          static_cast<double>(doc.leaveMs) / 1000.0);
+            out << buf;
+            if (!payload.discreteEvent) out << ", pid " << doc.pid;
+            out << "\n";
+        }
+    }
+}
+
+/** @brief Scheduling policy with exam throughput, queue wait and time in system per colour. */
+void writeSpecialistPolicyText(const SummaryPayload& payload, std::ofstream& out) {
+    const int total = static_cast<int>(LatencyStage::TimeInSystem);
+    const int redWait = static_cast<int>(QueueClass::SpecialistRed);
+    char buf[192];
+    std::snprintf(buf, sizeof(buf), "Specialist policy: %s (%lld exams, %.1f/s)\n", payload.specialistPolicy.c_str(),
+                  examsFinished(payload), examThroughput(payload));
+    out << buf;
+    for (int c = 0; c < kTriageColorCount; ++c) {
+        const LatencySummary& wait = payload.latency.queueWait[redWait + c];
+        const LatencySummary& inSystem = payload.latency.byColor[c][total];
+        std::snprintf(buf, sizeof(buf),
+                      "  %s%lld exams (%.1f/s), queue wait p50/p99 %s / %s ms, time in system p99 %s ms\n",
+                      kColorLabels[c], examsFinished(payload, c), examThroughput(payload, c),
+                      formatMs(wait.p50Us).c_str(), formatMs(wait.p99Us).c_str(), formatMs(inSystem.p99Us).c_str());
+        out << buf;
+    }
+}
+} // namespace
+
+long long examsFinished(const SummaryPayload& payload, int color) {
+    const int total = static_cast<int>(LatencyStage::TimeInSystem);
+    long long exams = 0;
+    for (int c = 0; c < kTriageColorCount; ++c) {
+        if (color < 0 || color == c) exams += static_cast<long long>(payload.latency.byColor[c][total].count);
+    }
+    return exams;
+}
+
+double examThroughput(const SummaryPayload& payload, int color) {
+    if (payload.elapsedMs <= 0) return 0.0;
+    return examsFinished(payload, color) * 1000.0 / static_cast<double>(payload.elapsedMs);
+}
+
+std::string formatDuration(long long seconds) {
+    long long days = seconds / 86400;
+    seconds %= 86400;
+    long long hours = seconds / 3600;
+    seconds %= 3600;
+    long long minutes = seconds / 60;
+    seconds %= 60;
+    std::ostringstream oss;
+    oss << days << "d " << hours << "h " << minutes << "m " << seconds << "s";
+    return oss.str();
+}
+
+const char* specialistName(int idx) {
+    switch (static_cast<SpecialistType>(idx)) {
+        case SpecialistType::Cardiologist: return "Cardiologist";
+        case SpecialistType::Neurologist: return "Neurologist";
+        case SpecialistType::Ophthalmologist: return "Ophthalmologist";
+        case SpecialistType::Laryngologist: return "Laryngologist";
+        case SpecialistType::Surgeon: return "Surgeon";
+        case SpecialistType::Paediatrician: return "Paediatrician";
+        default: return "Unknown";
+    }
+}
+
+bool writeSummaryText(const SummaryPayload& payload, std::ofstream& out) {
+    out << "SOR Simulation Summary\n";
+    out << "======================\n";
+    if (payload.discreteEvent) {
+        out << "Engine: discrete-event (virtual clock)\n";
+    }
+    out << "Total patients processed: " << payload.totalPatients << "\n";
+    out << "Waiting room capacity: " << payload.waitingRoomCapacity << "\n";
+    out << "Registered queue length at shutdown: " << payload.queueRegistrationLen << "\n";
+    out << "Triage outcomes:\n";
+    out << "  Red:    " << payload.triageRed << "\n";
+    out << "  Yellow: " << payload.triageYellow << "\n";
+    out << "  Green:  " << payload.triageGreen << "\n";
+    out << "  Sent home from triage: " << payload.triageSentHome << "\n";
+    out << "Final dispositions:\n";
+    out << "  Home:       " << payload.outcomeHome << "\n";
+    out << "  Ward:       " << payload.outcomeWard << "\n";
+    out << "  Other:      " << payload.outcomeOther << "\n";
+    out << "Time scale (ms per minute): " << payload.timeScaleMsPerSimMinute << "\n";
+    out << "Simulation duration (config minutes): " << payload.simulationDurationMinutes << "\n";
+    out << "Simulated elapsed time: " << formatDuration(payload.simulatedSeconds) << "\n";
+    writeLatencyText(payload.latency, out);
+    writeRegistrationText(payload, out);
+    writeTriageWorkersText(payload, out);
+    writeDoctorsText(payload, out);
+    writeSpecialistPolicyText(payload, out);
+    if (payload.discreteEvent) {
+        out << "Process IDs: n/a (single process)\n";
+        return static_cast<bool>(out);
+    }
+    out << "Process IDs:\n";
+    out << "  Director:      " << payload.directorPid << "\n";
+    out << "  Registration1: " << payload.registration1Pid << "\n";
+    out << "Log records dropped: " << payload.logRecordsDropped << "\n";
+    return static_cast<bool>(out);
+}
+
+bool writeSummary(const SummaryPayload& payload, const std::string& path) {
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out) {
+        logErrno("summary file open failed");
+        return false;
+    }
+    return writeSummaryText(payload, out);
+}
+
+std::string summarySiblingPath(const std::string& textPath, const std::string& suffix) {
+    const std::string ext = ".txt";
+    if (textPath.size() > ext.size() && textPath.compare(textPath.size() - ext.size(), ext.size(), ext) == 0) {
+        return textPath.substr(0, textPath.size() - ext.size()) + suffix;
+    }
+    return textPath + suffix;
+}
+
+// Hand-written JSON: every key is a fixed identifier and every value a number, so nothing needs escaping.
+bool writeSummaryJson(const SummaryPayload& payload, const std::string& path) {
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out) {
+        logErrno("summary json open failed");
+        return false;
+    }
+    out << "{\n";
+    out << "  \"engine\": \"" << (payload.discreteEvent ? "discrete-event" : "process") << "\",\n";
+    out << "  \"totalPatients\": " << payload.totalPatients << ",\n";
+    out << "  \"waitingRoomCapacity\": " << payload.waitingRoomCapacity << ",\n";
+    out << "  \"registrationQueueAtShutdown\": " << payload.queueRegistrationLen << ",\n";
+    out << "  \"triage\": {\"red\": " << payload.triageRed << ", \"yellow\": " << payload.triageYellow
+        << ", \"green\": " << payload.triageGreen << ", \"sentHome\": " << payload.triageSentHome << "},\n";
+    out << "  \"outcomes\": {\"home\": " << payload.outcomeHome << ", \"ward\": " << payload.outcomeWard
+        << ", \"other\": " << payload.outcomeOther << "},\n";
+    out << "  \"timeScaleMsPerSimMinute\": " << payload.timeScaleMsPerSimMinute << ",\n";
+    out << "  \"simulationDurationMinutes\": " << payload.simulationDurationMinutes << ",\n";
+    out << "  \"simulatedSeconds\": " << payload.simulatedSeconds << ",\n";
+    if (!payload.discreteEvent) {
+        out << "  \"logRecordsDropped\": " << payload.logRecordsDropped << ",\n";
+    }
+    out << "  \"registrationWindows\": {\"peakOpen\": " << payload.peakOpenRegistrationWindows << ", \"windows\": [";
+    for (size_t i = 0; i < payload.registrationWindows.size(); ++i) {
+        const RegistrationWindowSummary& w = payload.registrationWindows[i];
+        out << (i > 0 ? ", " : "") << "{\"pid\": " << w.pid << ", \"activations\": " << w.activations
+            << ", \"openMs\": " << w.openMs << ", \"patients\": " << w.patients << ", \"busyMs\": " << w.busyMs
+            << "}";
+    }
+    out << "]},\n";
+    out << "  \"elapsedMs\": " << payload.elapsedMs << ",\n";
+    out << "  \"triageWorkers\": [";
+    for (size_t w = 0; w < payload.triageWorkers.size(); ++w) {
+        const TriageWorkerSummary& worker = payload.triageWorkers[w];
+        out << (w > 0 ? ", " : "") << "{\"pid\": " << worker.pid << ", \"patients\": " << worker.patients()
+            << ", \"perSecond\": " << triageThroughput(worker, payload.elapsedMs) << ", \"red\": " << worker.red
+            << ", \"yellow\": " << worker.yellow << ", \"green\": " << worker.green << ", \"sentHome\": "
+            << worker.sentHome << ", \"busyMs\": " << worker.busyMs << "}";
+    }
+    out << "],\n";
+    out << "  \"doctors\": {";
+    for (int s = 0; s < kSpecialistCount; ++s) {
+        out << (s > 0 ? "," : "") << "\n    \"" << specialistKey(s) << "\": [";
+        for (size_t d = 0; d < payload.doctors[s].size(); ++d) {
+            const DoctorSummary& doc = payload.doctors[s][d];
+            out << (d > 0 ? ", " : "") << "{\"pid\": " << doc.pid << ", \"exams\": " << doc.exams
+                << ", \"busyMs\": " << doc.busyMs << ", \"utilization\": "
+                << doctorUtilization(doc, payload.elapsedMs) << ", \"leaves\": " << doc.leaves
+                << ", \"leaveMs\": " << doc.leaveMs << "}";
+        }
+        out << "]";
+    }
+    out << "\n  },\n";
+    out << "  \"specialistPolicy\": {\"name\": \"" << payload.specialistPolicy << "\", \"exams\": "
+        << examsFinished(payload) << ", \"perSecond\": " << examThroughput(payload) << ", \"byColor\": {";
+    for (int c = 0; c < kTriageColorCount; ++c) {
+        const LatencySummary& wait = payload.latency.queueWait[static_cast<int>(QueueClass::SpecialistRed) + c];
+        const LatencySummary& inSystem = payload.latency.byColor[c][static_cast<int>(LatencyStage::TimeInSystem)];
+        out << (c > 0 ? ", " : "") << "\"" << kColorKeys[c] << "\": {\"exams\": " << examsFinished(payload, c)
+            << ", \"perSecond\": " << examThroughput(payload, c) << ", \"queueWaitP50Us\": " << wait.p50Us
+            << ", \"queueWaitP99Us\": " << wait.p99Us << ", \"timeInSystemP99Us\": " << inSystem.p99Us << "}";
+    }
+    out << "}},\n";
+    out << "  \"latencyUs\": {\n    \"stages\": ";
+    writeStagesJson(payload.latency.stages, out);
+    out << ",\n    \"byColor\": {";
+    for (int c = 0; c < kTriageColorCount; ++c) {
+        out << (c > 0 ? "," : "") << "\n      \"" << kColorKeys[c] << "\": ";
+        writeStagesJson(payload.latency.byColor[c], out);
+    }
+    out << "\n    },\n    \"bySpecialist\": {";
+    for (int s = 0; s < kSpecialistCount; ++s) {
+        out << (s > 0 ? "," : "") << "\n      \"" << specialistKey(s) << "\": ";
+        writeStagesJson(payload.latency.bySpecialist[s], out);
+    }
+    out << "\n    },\n    \"queueWait\": {";
+    for (int c = 0; c < kQueueClassCount; ++c) {
+        out << (c > 0 ? "," : "") << "\n      \"" << queueClassKey(static_cast<QueueClass>(c)) << "\": ";
+        writeLatencyJson(payload.latency.queueWait[c], out);
+    }
+    out << "\n    }\n  },\n";
+    const QueueTimeSeries& series = payload.queueSeries;
+    out << "  \"queueSeries\": {\n    \"intervalMs\": " << series.intervalMs() << ",\n    \"samples\": " << series.size();
+    writeColumnJson("elapsedMs", series.elapsedMs(), out);
+    writeColumnJson("waitingRoom", series.waitingRoom(), out);
+    writeColumnJson("registrationQueue", series.registrationQueue(), out);
+    writeColumnJson("triageQueue", series.triageQueue(), out);
+    writeColumnJson("specialistQueues", series.specialistQueues(), out);
+    writeColumnJson("waitSem", series.waitSemaphore(), out);
+    writeColumnJson("finished", series.finished(), out);
+    out << "\n  }\n}\n";
+    return static_cast<bool>(out);
+}
+
+bool writeSummaryCsv(const SummaryPayload& payload, const std::string& path) {
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out) {
+        logErrno("summary csv open failed");
+        return false;
+    }
+    out << "key,value\n";
+    out << "engine," << (payload.discreteEvent ? "discrete-event" : "process") << "\n";
+    out << "totalPatients," << payload.totalPatients << "\n";
+    out << "waitingRoomCapacity," << payload.waitingRoomCapacity << "\n";
+    out << "registrationQueueAtShutdown," << payload.queueRegistrationLen << "\n";
+    out << "triage.red," << payload.triageRed << "\n";
+    out << "triage.yellow," << payload.triageYellow << "\n";
+    out << "triage.green," << payload.triageGreen << "\n";
+    out << "triage.sentHome," << payload.triageSentHome << "\n";
+    out << "outcomes.home," << payload.outcomeHome << "\n";
+    out << "outcomes.ward," << payload.outcomeWard << "\n";
+    out << "outcomes.other," << payload.outcomeOther << "\n";
+    out << "timeScaleMsPerSimMinute," << payload.timeScaleMsPerSimMinute << "\n";
+    out << "simulationDurationMinutes," << payload.simulationDurationMinutes << "\n";
+    out << "simulatedSeconds," << payload.simulatedSeconds << "\n";
+    if (!payload.discreteEvent) {
+        out << "logRecordsDropped," << payload.logRecordsDropped << "\n";
+    }
+    out << "registrationWindows.peakOpen," << payload.peakOpenRegistrationWindows << "\n";
+    for (size_t i = 0; i < payload.registrationWindows.size(); ++i) {
+        const RegistrationWindowSummary& w = payload.registrationWindows[i];
+        std::string key = "registrationWindows." + std::to_string(i) + ".";
+        out << key << "pid," << w.pid << "\n" << key << "activations," << w.activations << "\n" << key << "openMs,"
+            << w.openMs << "\n" << key << "patients," << w.patients << "\n" << key << "busyMs," << w.busyMs << "\n";
+    }
+    out << "elapsedMs," << payload.elapsedMs << "\n";
+    for (size_t w = 0; w < payload.triageWorkers.size(); ++w) {
+        const TriageWorkerSummary& worker = payload.triageWorkers[w];
+        std::string key = "triageWorkers." + std::to_string(w) + ".";
+        out << key << "pid," << worker.pid << "\n" << key << "patients," << worker.patients() << "\n" << key
+            << "perSecond," << triageThroughput(worker, payload.elapsedMs) << "\n" << key << "red," << worker.red
+            << "\n" << key << "yellow," << worker.yellow << "\n" << key << "green," << worker.green << "\n" << key
+            << "sentHome," << worker.sentHome << "\n" << key << "busyMs," << worker.busyMs << "\n";
+    }
+    for (int s = 0; s < kSpecialistCount; ++s) {
+        for (size_t d = 0; d < payload.doctors[s].size(); ++d) {
+            const DoctorSummary& doc = payload.doctors[s][d];
+            std::string key = "doctors." + specialistKey(s) + "." + std::to_string(d) + ".";
+            out << key << "pid," << doc.pid << "\n" << key << "exams," << doc.exams << "\n" << key << "busyMs,"
+                << doc.busyMs << "\n" << key << "utilization," << doctorUtilization(doc, payload.elapsedMs) << "\n"
+                << key << "leaves," << doc.leaves << "\n" << key << "leaveMs," << doc.leaveMs << "\n";
+        }
+    }
+    out << "specialistPolicy.name," << payload.specialistPolicy << "\n";
+    out << "specialistPolicy.exams," << examsFinished(payload) << "\n";
+    out << "specialistPolicy.perSecond," << examThroughput(payload) << "\n";
+    for (int c = 0; c < kTriageColorCount; ++c) {
+        const LatencySummary& wait = payload.latency.queueWait[static_cast<int>(QueueClass::SpecialistRed) + c];
+        const LatencySummary& inSystem = payload.latency.byColor[c][static_cast<int>(LatencyStage::TimeInSystem)];
+        std::string key = std::string("specialistPolicy.") + kColorKeys[c] + ".";
+        out << key << "exams," << examsFinished(payload, c) << "\n" << key << "perSecond,"
+            << examThroughput(payload, c) << "\n" << key << "queueWaitP50Us," << wait.p50Us << "\n" << key
+            << "queueWaitP99Us," << wait.p99Us << "\n" << key << "timeInSystemP99Us," << inSystem.p99Us << "\n";
+    }
+    writeStagesCsv("latencyUs.stages.", payload.latency.stages, out);
+    for (int c = 0; c < kTriageColorCount; ++c) {
+        writeStagesCsv(std::string("latencyUs.byColor.") + kColorKeys[c] + ".", payload.latency.byColor[c], out);
+    }
+    for (int s = 0; s < kSpecialistCount; ++s) {
+        writeStagesCsv("latencyUs.bySpecialist." + specialistKey(s) + ".", payload.latency.bySpecialist[s], out);
+    }
+    for (int c = 0; c < kQueueClassCount; ++c) {
+        writeLatencyCsv(std::string("latencyUs.queueWait.") + queueClassKey(static_cast<QueueClass>(c)) + ".",
+                        payload.latency.queueWait[c], out);
+    }
+    out << "queueSeries.intervalMs," << payload.queueSeries.intervalMs() << "\n";
+    out << "queueSeries.samples," << payload.queueSeries.size() << "\n";
+    return static_cast<bool>(out);
+}
+
+bool writeQueueSeriesCsv(const QueueTimeSeries& series, const std::string& path) {
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out) {
+        logErrno("queue series csv open failed");
+        return false;
+    }
+    out << "elapsedMs,waitingRoom,registrationQueue,triageQueue,specialistQueues,waitSem,finished\n";
+    for (size_t i = 0; i < series.size(); ++i) {
+        out << series.elapsedMs()[i] << "," << series.waitingRoom()[i] << "," << series.registrationQueue()[i] << ","
+            << series.triageQueue()[i] << "," << series.specialistQueues()[i] << "," << series.waitSemaphore()[i]
+            << "," << series.finished()[i] << "\n";
+    }
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,45 @@
+#include "report/time_series.hpp"
+
+namespace {
+/** @brief Keep elements 0, 2, 4, ... of a column. */
+template <typename T>
+void keepEven(std::vector<T>& column) {
+    size_t kept = 0;
+    for (size_t i = 0; i < column.size(); i += 2) {
+        column[kept++] = column[i];
+    }
+    column.resize(kept);
+}
+} // namespace
+
+QueueTimeSeries::QueueTimeSeries(int intervalMs, size_t capacity)
+    : baseIntervalMs_(intervalMs), capacity_(capacity < 2 ? 2 : capacity) {}
+
+void QueueTimeSeries::record(long long elapsedMs, const MetricsSnapshot& metrics, long long finished) {
+    if (baseIntervalMs_ <= 0) return;
+    if (ticks_++ % stride_ != 0) return;
+    if (size() == capacity_) {
+        thinOut();
+        // The tick is kept only if it also falls on the doubled interval.
+        if ((ticks_ - 1) % stride_ != 0) return;
+    }
+    elapsedMs_.push_back(elapsedMs);
+    waitingRoom_.push_back(metrics.waitingInside);
+    registrationQueue_.push_back(metrics.registrationQueueLen);
+    triageQueue_.push_back(metrics.triageQueueLen);
+    specialistQueues_.push_back(metrics.specialistsQueueLen);
+    waitSemaphore_.push_back(metrics.waitSemaphoreValue);
+    finished_.push_back(finished);
+}
+
+// Sample i was taken at tick i * stride_, so the even samples are exactly the ticks of the doubled stride.
+void QueueTimeSeries::thinOut() {
+    keepEven(elapsedMs_);
+    keepEven(waitingRoom_);
+    keepEven(registrationQueue_);
+    keepEven(triageQueue_);
+    keepEven(specialistQueues_);
+    keepEven(waitSemaphore_);
+    keepEven(finished_);
+    stride_ *= 2;
+}
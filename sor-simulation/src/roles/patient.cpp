@@ -1,16 +1,19 @@
 #include "roles/patient.hpp"
 
 #include "ipc/message_queue.hpp"
+#include "ipc/run_namespace.hpp"
 #include "ipc/semaphore.hpp"
 #include "ipc/shared_memory.hpp"
 #include "logging/logger.hpp"
 #include "model/events.hpp"
 #include "model/shared_state.hpp"
+#include "model/sim_rules.hpp"
 #include "model/types.hpp"
 #include "util/error.hpp"
 
 #include <atomic>
 #include <array>
+#include <cerrno>
 #include <csignal>
 #include <pthread.h>
 #include <cstring>
@@ -64,9 +67,12 @@ void* childThreadMain(void* arg) {
              "Child thread exiting for patient id=" + std::to_string(args->patientId));
     return nullptr;
 }
+
+/** @brief Slice for waiting-room waits so stop requests are noticed without a signal. */
+constexpr int kSeatWaitSliceMs = 200;
 } // namespace
 
-// Patient lifecycle entry (see header for details).
+// Patient process entry (see header for details).
 int Patient::run(const std::string& keyPath, int patientId, int age, bool isVip, bool hasGuardian, int personsCount) {
     // Ignore SIGINT so only SIGUSR2 controls shutdown.
     struct sigaction saIgnore {};
@@ -82,45 +88,61 @@ int Patient::run(const std::string& keyPath, int patientId, int age, bool isVip,
     sigaction(SIGUSR2, &sa, nullptr);
 
     MessageQueue regQueue;
+    MessageQueue triageQueue;
     MessageQueue logQueue;
     Semaphore waitSem;
-    Semaphore stateSem;
     SharedMemory shm;
 
-    key_t regKey = ftok(keyPath.c_str(), 'R');
-    key_t triKey = ftok(keyPath.c_str(), 'T');
-    key_t logKey = ftok(keyPath.c_str(), 'L');
-    key_t waitKey = ftok(keyPath.c_str(), 'W');
-    key_t stateKey = ftok(keyPath.c_str(), 'M');
-    key_t shmKey = ftok(keyPath.c_str(), 'H');
+    key_t regKey = ipcKey(keyPath, 'R');
+    key_t triKey = ipcKey(keyPath, 'T');
+    key_t logKey = ipcKey(keyPath, 'L');
+    key_t waitKey = ipcKey(keyPath, 'W');
+    key_t shmKey = ipcKey(keyPath, 'H');
 
     if (regKey == -1 || triKey == -1 || logKey == -1 ||
-        waitKey == -1 || stateKey == -1 || shmKey == -1) {
-        logErrno("Patient ftok failed");
+        waitKey == -1 || shmKey == -1) {
+        logErrno("Patient IPC key lookup failed");
         return 1;
     }
-    if (!regQueue.open(regKey) || !logQueue.open(logKey)) {
+    // Shared state first: it tells us which transport the director created the queues with.
+    if (!shm.open(shmKey)) {
         return 1;
     }
-    if (!waitSem.open(waitKey) || !stateSem.open(stateKey)) {
+    auto* statePtr = static_cast<SharedState*>(shm.attach());
+    if (!statePtr) {
         return 1;
     }
-    if (!shm.open(shmKey)) {
+    QueueTransport transport = statePtr->queueTransport != 0 ? QueueTransport::ShmRing : QueueTransport::SysV;
+    if (!regQueue.open(regKey, transport) || !logQueue.open(logKey)) {
+        shm.detach(statePtr);
         return 1;
     }
-    auto* statePtr = static_cast<SharedState*>(shm.attach());
-    if (!statePtr) {
+    attachLogRings(logKey);
+    if (!waitSem.open(waitKey)) {
+        shm.detach(statePtr);
         return 1;
     }
 
-    int triageQueueId = -1;
-    if (triKey != -1) {
-        triageQueueId = msgget(triKey, 0);
-    }
-    std::array<int, kSpecialistCount> specQueueIds;
-    specQueueIds.fill(-1);
-    setLogMetricsContext({statePtr, regQueue.id(), triageQueueId, specQueueIds,
-                          waitSem.id(), stateSem.id()});
+    // Triage handle is only used for log metrics; a failure just reports tQ=0.
+    triageQueue.open(triKey, transport);
+    std::array<const MessageQueue*, kSpecialistCount> specQueues{};
+    setLogMetricsContext({statePtr, &regQueue, &triageQueue, specQueues,
+                          waitSem.id()});
+
+    PatientContext ctx{&regQueue, logQueue.id(), &waitSem, statePtr, &stopFlag, true};
+    int rc = lifecycle(ctx, patientId, age, isVip, hasGuardian, personsCount);
+    shm.detach(statePtr);
+    return rc;
+}
+
+// Patient lifecycle on shared handles (see header for details).
+int Patient::lifecycle(const PatientContext& ctx, int patientId, int age, bool isVip, bool hasGuardian,
+                       int personsCount) {
+    MessageQueue& regQueue = *ctx.registrationQueue;
+    Semaphore& waitSem = *ctx.waitSemaphore;
+    SharedState* statePtr = ctx.sharedState;
+    const std::atomic<bool>& stopRequested = *ctx.stopFlag;
+    int logId = ctx.logQueueId;
 
     /**
      * @brief Returns waiting-room capacity and rolls back shared counters symmetrically.
@@ -129,17 +151,9 @@ int Patient::run(const std::string& keyPath, int patientId, int age, bool isVip,
         for (int i = 0; i < slots; ++i) {
             waitSem.post();
         }
-        stateSem.wait();
-        if (statePtr->currentInWaitingRoom >= slots) {
-            statePtr->currentInWaitingRoom -= slots;
-        }
-        if (statePtr->queueRegistrationLen > 0) {
-            statePtr->queueRegistrationLen -= 1;
-        }
-        if (statePtr->totalPatients > 0) {
-            statePtr->totalPatients -= 1;
-        }
-        stateSem.post();
+        subtractClamped(statePtr->waitingRoom.currentInWaitingRoom, slots);
+        subtractClamped(statePtr->waitingRoom.queueRegistrationLen, 1);
+        subtractClamped(statePtr->waitingRoom.totalPatients, 1);
     };
 
     // Spawn a lightweight thread to model the child presence (if any).
@@ -147,16 +161,29 @@ int Patient::run(const std::string& keyPath, int patientId, int age, bool isVip,
     ChildArgs* childArgs = nullptr;
     std::atomic<bool> childStop(false);
     bool childStarted = false;
+    bool childInline = false;
     // Ensure guardian helper thread is stopped and cleaned up.
     auto stopChildThread = [&]() {
         if (childStarted) {
             childStop.store(true);
             pthread_join(childThread, nullptr);
             delete childArgs;
+            childStarted = false;
+        }
+        if (childInline) {
+            childInline = false;
+            logEvent(logId, Role::Patient, currentSimMinutes(statePtr),
+                     "Child thread exiting for patient id=" + std::to_string(patientId));
         }
     };
-    if (hasGuardian && personsCount == 2) {
-        childArgs = new ChildArgs{logQueue.id(), patientId, &childStop, statePtr};
+    if (!ctx.spawnChildThread && hasGuardian && personsCount == 2) {
+        // Pooled patients model the child on the guardian's worker: same lifetime and log lines as the
+        // process-mode helper thread, without a thread per guardian.
+        childInline = true;
+        logEvent(logId, Role::Patient, currentSimMinutes(statePtr),
+                 "Child thread active for patient id=" + std::to_string(patientId));
+    } else if (hasGuardian && personsCount == 2) {
+        childArgs = new ChildArgs{logId, patientId, &childStop, statePtr};
         if (pthread_create(&childThread, nullptr, childThreadMain, childArgs) == 0) {
             childStarted = true;
         } else {
@@ -168,87 +195,95 @@ int Patient::run(const std::string& keyPath, int patientId, int age, bool isVip,
     }
 
     // Log that patient is queued outside waiting for a slot.
+    const long long doorNs = hopClockNs();
     int simTime = currentSimMinutes(statePtr);
-    logEvent(logQueue.id(), Role::Patient, simTime,
-             "Patient waiting to enter waiting room id=" + std::to_string(patientId) +
-             " persons=" + std::to_string(personsCount));
+    LogEventFields waiting;
+    waiting.kind = LogEventKind::PatientWaitingOutside;
+    waiting.subject = patientId;
+    waiting.persons = personsCount;
+    logEvent(logId, Role::Patient, simTime, waiting);
 
-    // Acquire waiting room slots
+    // Acquire waiting room slots in bounded slices so a stop request is seen even while blocked.
     //FIXME this would need changing, suspicious activity
     int acquired = 0;
-    for (int i = 0; i < personsCount; ++i) {
-        if (!waitSem.wait()) {
-            int simTime = currentSimMinutes(statePtr);
-            logEvent(logQueue.id(), Role::Patient, simTime,
-                     "ERROR waitSem wait failed id=" + std::to_string(patientId) +
-                     " persons=" + std::to_string(personsCount) +
-                     " acquired=" + std::to_string(acquired));
-            // Roll back already acquired slots to avoid leaking capacity.
+    while (acquired < personsCount) {
+        if (stopRequested.load()) {
             for (int j = 0; j < acquired; ++j) {
-                if (!waitSem.post()) {
-                }
+                waitSem.post();
             }
-            logEvent(logQueue.id(), Role::Patient, simTime,
-                     "ERROR PATIENT ROLLBACK released=" + std::to_string(acquired));
-            shm.detach(statePtr);
-            return 1;
+            stopChildThread();
+            return 0;
+        }
+        if (waitSem.waitFor(kSeatWaitSliceMs)) {
+            acquired += 1;
+            continue;
+        }
+        if (errno == EAGAIN || errno == EINTR) {
+            continue;
         }
-        acquired += 1;
+        simTime = currentSimMinutes(statePtr);
+        logEvent(logId, Role::Patient, simTime,
+                 "ERROR waitSem wait failed id=" + std::to_string(patientId) +
+                 " persons=" + std::to_string(personsCount) +
+                 " acquired=" + std::to_string(acquired));
+        // Roll back already acquired slots to avoid leaking capacity.
+        for (int j = 0; j < acquired; ++j) {
+            waitSem.post();
+        }
+        logEvent(logId, Role::Patient, simTime,
+                 "ERROR PATIENT ROLLBACK released=" + std::to_string(acquired));
+        stopChildThread();
+        return 1;
     }
 
     // If stop was requested after acquiring slots, roll back.
-    if (stopFlag.load()) {
+    if (stopRequested.load()) {
         for (int i = 0; i < personsCount; ++i) {
             waitSem.post();
         }
         stopChildThread();
-        shm.detach(statePtr);
         return 0;
     }
 
     // Update shared state: inside count and queue len
-    if (!stateSem.wait()) {
-        for (int i = 0; i < personsCount; ++i) {
-            waitSem.post();
-        }
-        stopChildThread();
-        shm.detach(statePtr);
-        return 1;
-    }
-    statePtr->currentInWaitingRoom += personsCount;
-    statePtr->queueRegistrationLen += 1;
-    statePtr->totalPatients += 1;
-    stateSem.post();
+    statePtr->waitingRoom.currentInWaitingRoom.fetch_add(personsCount, std::memory_order_relaxed);
+    statePtr->waitingRoom.queueRegistrationLen.fetch_add(1, std::memory_order_relaxed);
+    statePtr->waitingRoom.totalPatients.fetch_add(1, std::memory_order_relaxed);
+    const long long insideNs = hopClockNs();
+    statePtr->latency.recordHop(LatencyStage::DoorToWaitingRoom, doorNs, insideNs);
 
     simTime = currentSimMinutes(statePtr);
-    logEvent(logQueue.id(), Role::Patient, simTime,
-             "Patient arrived id=" + std::to_string(patientId) +
-             " age=" + std::to_string(age) +
-             " vip=" + std::string(isVip ? "1" : "0") +
-             " persons=" + std::to_string(personsCount) +
-             " guardian=" + std::string(hasGuardian ? "1" : "0"));
+    LogEventFields arrived;
+    arrived.kind = LogEventKind::PatientArrived;
+    arrived.subject = patientId;
+    arrived.age = age;
+    arrived.vip = isVip ? 1 : 0;
+    arrived.persons = personsCount;
+    arrived.guardian = hasGuardian ? 1 : 0;
+    logEvent(logId, Role::Patient, simTime, arrived);
 
     EventMessage ev{};
-    long baseType = static_cast<long>(EventType::PatientArrived);
     // VIPs use lower mtype to be dequeued first with negative msgtyp in msgrcv.
-    ev.mtype = isVip ? baseType : baseType + 1;
+    ev.mtype = arrivalMsgType(isVip);
     ev.patientId = patientId;
     ev.age = age;
     ev.isVip = isVip ? 1 : 0;
     ev.personsCount = personsCount;
+    ev.hops.doorNs = doorNs;
+    ev.hops.waitingRoomNs = insideNs;
     std::strncpy(ev.extra, hasGuardian ? "guardian" : "solo", sizeof(ev.extra) - 1);
 
     // Non-blocking send with retry (short sleep) to avoid blocking on a full queue.
-    size_t payloadSize = sizeof(EventMessage) - sizeof(long);
+    ev.queuedNs = hopClockNs();
     while (true) {
-        if (stopFlag.load()) {
+        if (stopRequested.load()) {
             // Release slots and exit quietly.
             releaseSlotsAndCounters(personsCount);
             stopChildThread();
-            shm.detach(statePtr);
             return 0;
         }
-        if (msgsnd(regQueue.id(), &ev, payloadSize, IPC_NOWAIT) == 0) {
+        if (regQueue.send(&ev, sizeof(EventMessage), ev.mtype, IPC_NOWAIT)) {
+            statePtr->aging.registration[isVip ? 0 : 1].noteEnqueue(ev.queuedNs);
             break;
         }
         if (errno == EAGAIN) {
@@ -259,16 +294,17 @@ int Patient::run(const std::string& keyPath, int patientId, int age, bool isVip,
         // Release slots and counters on failure to avoid leaking capacity.
         releaseSlotsAndCounters(personsCount);
         stopChildThread();
-        shm.detach(statePtr);
         return 1;
     }
 
-    // Patient process ends; waiting room slots will be released once registration forwards the patient.
+    // Patient ends; waiting room slots will be released once registration forwards the patient.
     simTime = currentSimMinutes(statePtr);
-    logEvent(logQueue.id(), Role::Patient, simTime, "Patient registered id=" + std::to_string(patientId));
+    LogEventFields registered;
+    registered.kind = LogEventKind::PatientRegistered;
+    registered.subject = patientId;
+    logEvent(logId, Role::Patient, simTime, registered);
 
     // Stop child thread if it was started.
     stopChildThread();
-    shm.detach(statePtr);
     return 0;
 }
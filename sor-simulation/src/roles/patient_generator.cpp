@@ -2,19 +2,26 @@
 
 #include "logging/logger.hpp"
 #include "ipc/message_queue.hpp"
+#include "ipc/run_namespace.hpp"
 #include "ipc/shared_memory.hpp"
 #include "ipc/semaphore.hpp"
 #include "model/config.hpp"
 #include "model/types.hpp"
 #include "model/shared_state.hpp"
+#include "model/sim_rules.hpp"
 #include "roles/patient.hpp"
 #include "util/error.hpp"
 #include "util/random.hpp"
 
 #include <array>
 #include <atomic>
+#include <condition_variable>
 #include <csignal>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <ctime>
 #include <sys/wait.h>
@@ -25,7 +32,6 @@
 namespace {
 std::atomic<bool> stopFlag(false);
 std::atomic<bool> sigusr2Seen(false);
-constexpr int kDefaultTimeScaleMsPerSimMinute = 20;
 
 void handleSigusr2(int) {
     stopFlag.store(true);
@@ -56,10 +62,99 @@ int currentRealMinutes(const SharedState* state) {
     if (delta < 0) delta = 0;
     return static_cast<int>(delta / 60000);
 }
+
+/** @brief Cap on queued + running in-process patients (the fork path keeps its 2000-child cap). */
+constexpr size_t kMaxInProcessPatients = 100000;
+
+struct PatientTask {
+    int patientId;
+    PatientTraits traits;
+};
+
+/**
+ * @brief Fixed pool of threads running Patient::lifecycle on the generator's IPC handles.
+ *
+ * Tasks wait in a FIFO until a worker picks them up; workers that block on the waiting-room
+ * semaphore play the role of patients queued outside. stop() drops pending tasks and joins.
+ */
+class PatientPool {
+public:
+    PatientPool(const PatientContext& ctx, int threads) : ctx_(ctx) {
+        // Workers never take SIGUSR2; the generator thread handles it and sets the shared stop flag.
+        sigset_t blockSet;
+        sigset_t oldSet;
+        sigemptyset(&blockSet);
+        sigaddset(&blockSet, SIGUSR2);
+        pthread_sigmask(SIG_BLOCK, &blockSet, &oldSet);
+        for (int i = 0; i < threads; ++i) {
+            workers_.emplace_back([this]() { workerLoop(); });
+        }
+        pthread_sigmask(SIG_SETMASK, &oldSet, nullptr);
+    }
+
+    ~PatientPool() { stop(); }
+
+    PatientPool(const PatientPool&) = delete;
+    PatientPool& operator=(const PatientPool&) = delete;
+
+    void submit(const PatientTask& task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_.push_back(task);
+        }
+        cv_.notify_one();
+    }
+
+    /** @brief Patients queued or currently running. */
+    size_t inFlight() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pending_.size() + running_;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            pending_.clear();
+        }
+        cv_.notify_all();
+        for (auto& worker : workers_) {
+            if (worker.joinable()) worker.join();
+        }
+        workers_.clear();
+    }
+
+private:
+    void workerLoop() {
+        while (true) {
+            PatientTask task{};
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this]() { return stopping_ || !pending_.empty(); });
+                if (stopping_) return;
+                task = pending_.front();
+                pending_.pop_front();
+                running_ += 1;
+            }
+            Patient::lifecycle(ctx_, task.patientId, task.traits.age, task.traits.isVip,
+                               task.traits.hasGuardian, task.traits.personsCount);
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ -= 1;
+        }
+    }
+
+    PatientContext ctx_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<PatientTask> pending_;
+    size_t running_{0};
+    bool stopping_{false};
+    std::vector<std::thread> workers_;
+};
 } // namespace
 
 // Patient generator loop (see header for details).
-int PatientGenerator::run(const std::string& keyPath, const Config& cfg) {
+int PatientGenerator::run(const std::string& exePath, const std::string& keyPath, const Config& cfg) {
     // Ignore SIGINT so director controls shutdown via SIGUSR2.
     struct sigaction saIgnore {};
     saIgnore.sa_handler = SIG_IGN;
@@ -77,40 +172,55 @@ int PatientGenerator::run(const std::string& keyPath, const Config& cfg) {
     int spawned = 0;
     // Log current mode for clarity during long runs.
     int logId = -1;
-    key_t logKey = ftok(keyPath.c_str(), 'L');
+    key_t logKey = ipcKey(keyPath, 'L');
     MessageQueue logQueue;
-    key_t regKey = ftok(keyPath.c_str(), 'R');
-    key_t triKey = ftok(keyPath.c_str(), 'T');
+    key_t regKey = ipcKey(keyPath, 'R');
+    key_t triKey = ipcKey(keyPath, 'T');
     if (logKey != -1 && logQueue.open(logKey)) {
         logId = logQueue.id();
+        // In-process patients log through the generator's attachment.
+        attachLogRings(logKey);
     }
 
     // Access shared state to read waiting room occupancy for backpressure.
     SharedMemory shm;
-    Semaphore stateSem;
+    Semaphore waitSem;
     SharedState* statePtr = nullptr;
-    key_t shmKey = ftok(keyPath.c_str(), 'H');
-    key_t semKey = ftok(keyPath.c_str(), 'M');
-    if (shmKey != -1 && semKey != -1 && shm.open(shmKey) && stateSem.open(semKey)) {
+    key_t shmKey = ipcKey(keyPath, 'H');
+    key_t waitKey = ipcKey(keyPath, 'W');
+    if (shmKey != -1 && shm.open(shmKey)) {
         statePtr = static_cast<SharedState*>(shm.attach());
     }
 
-    int regQueueId = -1;
-    int triQueueId = -1;
-    if (regKey != -1) {
-        regQueueId = msgget(regKey, 0);
-    }
+    // Queue handles feed log metrics (failures just report 0); in-process patients also send on regQueue.
+    QueueTransport transport = (statePtr && statePtr->queueTransport != 0) ? QueueTransport::ShmRing
+                                                                          : QueueTransport::SysV;
+    MessageQueue regQueue;
+    MessageQueue triQueue;
+    bool regQueueOpen = regKey != -1 && regQueue.open(regKey, transport);
     if (triKey != -1) {
-        triQueueId = msgget(triKey, 0);
+        triQueue.open(triKey, transport);
     }
-    std::array<int, kSpecialistCount> specQueueIds;
-    specQueueIds.fill(-1);
-    setLogMetricsContext({statePtr, regQueueId, triQueueId, specQueueIds,
-                          -1, stateSem.id()});
+    // In-process mode runs every patient on one shared set of handles instead of fork+execv.
+    std::unique_ptr<PatientPool> pool;
+    if (cfg.inProcessPatients != 0) {
+        if (!statePtr || logId == -1 || !regQueueOpen || waitKey == -1 || !waitSem.open(waitKey)) {
+            logErrno("PatientGenerator in-process mode needs shm, queues and semaphores");
+            if (statePtr) shm.detach(statePtr);
+            return 1;
+        }
+        PatientContext ctx{&regQueue, logId, &waitSem, statePtr, &stopFlag, false};
+        pool = std::make_unique<PatientPool>(ctx, cfg.patientThreadPoolSize);
+    }
+    std::array<const MessageQueue*, kSpecialistCount> specQueues{};
+    setLogMetricsContext({statePtr, &regQueue, &triQueue, specQueues,
+                          waitSem.id()});
     int simTime = currentSimMinutes(statePtr);
     if (logId != -1) {
         logEvent(logId, Role::PatientGenerator, simTime,
-                 "PatientGenerator running (until SIGUSR2)");
+                 pool ? "PatientGenerator running in-process (threads=" +
+                            std::to_string(cfg.patientThreadPoolSize) + ", until SIGUSR2)"
+                      : std::string("PatientGenerator running (until SIGUSR2)"));
     }
     std::vector<pid_t> children;
     bool childLimitLogged = false;
@@ -129,15 +239,8 @@ int PatientGenerator::run(const std::string& keyPath, const Config& cfg) {
         }
     };
     // Scale intervals with sim speed; clamp to at least 1 ms for positive inputs.
-    auto scaleInterval = [&](int baseMs) {
-        if (baseMs <= 0) return cfg.timeScaleMsPerSimMinute;
-        long long scaled = static_cast<long long>(baseMs) * cfg.timeScaleMsPerSimMinute /
-                           kDefaultTimeScaleMsPerSimMinute;
-        if (scaled <= 0) scaled = 1;
-        return static_cast<int>(scaled);
-    };
-    int genMinMs = scaleInterval(cfg.patientGenMinMs);
-    int genMaxMs = scaleInterval(cfg.patientGenMaxMs);
+    int genMinMs = scaleIntervalMs(cfg.patientGenMinMs, cfg.timeScaleMsPerSimMinute);
+    int genMaxMs = scaleIntervalMs(cfg.patientGenMaxMs, cfg.timeScaleMsPerSimMinute);
     if (genMaxMs < genMinMs) genMaxMs = genMinMs;
 
     while (!stopFlag.load()) {
@@ -149,30 +252,40 @@ int PatientGenerator::run(const std::string& keyPath, const Config& cfg) {
         }
 
         // Backpressure: avoid exceeding system process limits and waiting-room capacity.
-        const size_t maxChildren = 2000; // cap concurrent patient processes to avoid fork errors
-        while (!stopFlag.load() && children.size() >= maxChildren) {
+        const size_t maxChildren = pool ? kMaxInProcessPatients : 2000; // cap concurrent patients to avoid fork errors
+        auto inFlight = [&]() { return pool ? pool->inFlight() : children.size(); };
+        while (!stopFlag.load() && inFlight() >= maxChildren) {
             // Reap some children to free slots
             reapChildren(children);
-            if (children.size() >= maxChildren) {
+            if (inFlight() >= maxChildren) {
                 usleep(50 * 1000); // brief pause before retrying
                 if (!childLimitLogged && logId != -1) {
                     simTime = currentSimMinutes(statePtr);
                     logEvent(logId, Role::PatientGenerator, simTime,
-                             "PatientGenerator waiting for children slots (count=" + std::to_string(children.size()) + ")");
+                             "PatientGenerator waiting for children slots (count=" + std::to_string(inFlight()) + ")");
                 }
                 childLimitLogged = true;
             }
         }
         if (stopFlag.load()) break;
-        if (childLimitLogged && children.size() < maxChildren) {
+        if (childLimitLogged && inFlight() < maxChildren) {
             childLimitLogged = false;
         }
 
         // If waiting room is full, slow down generation.
-        int age = rng.uniformInt(1, 90);
-        bool hasGuardian = age < 18;
-        int personsCount = hasGuardian ? 2 : 1;
-        bool isVip = rng.uniformInt(0, 99) < 10; // ~10% VIP
+        PatientTraits traits = drawPatientTraits(rng);
+        int age = traits.age;
+        bool hasGuardian = traits.hasGuardian;
+        int personsCount = traits.personsCount;
+        bool isVip = traits.isVip;
+
+        if (pool) {
+            pool->submit(PatientTask{spawned + 1, traits});
+            spawned++;
+            int sleepMs = rng.uniformInt(genMinMs, genMaxMs);
+            usleep(static_cast<useconds_t>(sleepMs * 1000));
+            continue;
+        }
 
         pid_t pid = fork();
         if (pid == -1) {
@@ -194,7 +307,7 @@ int PatientGenerator::run(const std::string& keyPath, const Config& cfg) {
             std::string personsStr = std::to_string(personsCount);
 
             std::vector<char*> args;
-            args.push_back(const_cast<char*>(keyPath.c_str())); // executable path
+            args.push_back(const_cast<char*>(exePath.c_str())); // executable path
             args.push_back(const_cast<char*>("patient"));
             args.push_back(const_cast<char*>(keyPath.c_str()));
             args.push_back(const_cast<char*>(idStr.c_str()));
@@ -203,7 +316,7 @@ int PatientGenerator::run(const std::string& keyPath, const Config& cfg) {
             args.push_back(const_cast<char*>(guardianStr.c_str()));
             args.push_back(const_cast<char*>(personsStr.c_str()));
             args.push_back(nullptr);
-            execv(keyPath.c_str(), args.data());
+            execv(exePath.c_str(), args.data());
             logErrno("execv patient failed");
             _exit(1);
         }
@@ -217,7 +330,11 @@ int PatientGenerator::run(const std::string& keyPath, const Config& cfg) {
         reapChildren(children);
     }
 
-    // On shutdown or completion, signal remaining children and wait.
+    // On shutdown or completion, stop in-process patients, then signal remaining children and wait.
+    if (pool) {
+        stopFlag.store(true);
+        pool->stop();
+    }
     for (pid_t c : children) {
         if (c > 0) {
             kill(c, SIGUSR2);
@@ -1,16 +1,20 @@
 #include "roles/registration.hpp"
 
+#include "ipc/aging_receive.hpp"
 #include "ipc/message_queue.hpp"
+#include "ipc/run_namespace.hpp"
 #include "ipc/semaphore.hpp"
 #include "ipc/shared_memory.hpp"
 #include "logging/logger.hpp"
 #include "model/events.hpp"
 #include "model/shared_state.hpp"
+#include "model/sim_rules.hpp"
 #include "model/types.hpp"
 #include "util/error.hpp"
 
 #include <array>
 #include <atomic>
+#include <cerrno>
 #include <csignal>
 #include <cstring>
 #include <string>
@@ -29,6 +33,20 @@ void handleSigusr2(int) {
     sigusr2Seen.store(true);
 }
 
+/** @brief SIGUSR1 from the director on park; its only job is to interrupt the blocking receive. */
+void handleParkSignal(int) {}
+
+/** @brief Sleep the whole duration even if a park signal interrupts it (the patient in hand is still served). */
+void sleepServiceMs(int ms) {
+    struct timespec req {};
+    req.tv_sec = ms / 1000;
+    req.tv_nsec = static_cast<long>(ms % 1000) * 1000000L;
+    struct timespec rem {};
+    while (nanosleep(&req, &rem) == -1 && errno == EINTR && !stopFlag.load()) {
+        req = rem;
+    }
+}
+
 /** @brief Monotonic clock in milliseconds (best effort). */
 long long monotonicMs() {
     struct timespec ts {};
@@ -45,16 +63,6 @@ int currentSimMinutes(const SharedState* state) {
     return static_cast<int>(delta / state->timeScaleMsPerSimMinute);
 }
 
-/** @brief Safe queue length probe (0 on error). */
-int queueLen(int qid) {
-    if (qid < 0) return 0;
-    struct msqid_ds stats {};
-    if (msgctl(qid, IPC_STAT, &stats) == -1) {
-        return 0;
-    }
-    return static_cast<int>(stats.msg_qnum);
-}
-
 /** @brief Safe semaphore value probe (0 on error). */
 int semaphoreValue(int semId) {
     if (semId < 0) return 0;
@@ -65,7 +73,7 @@ int semaphoreValue(int semId) {
 } // namespace
 
 // Registration window entry point (see header for details).
-int Registration::run(const std::string& keyPath, bool isSecond) {
+int Registration::run(const std::string& keyPath, int window) {
     // Ignore SIGINT so only SIGUSR2 triggers shutdown.
     struct sigaction saIgnore {};
     saIgnore.sa_handler = SIG_IGN;
@@ -80,56 +88,69 @@ int Registration::run(const std::string& keyPath, bool isSecond) {
     sa.sa_flags = 0;
     sigaction(SIGUSR2, &sa, nullptr);
 
-    // Open existing IPC objects using same ftok keys as Director.
+    // Pool windows: the director sends SIGUSR1 on park. No SA_RESTART, so a blocked receive returns EINTR.
+    if (window > 0) {
+        struct sigaction saPark {};
+        saPark.sa_handler = handleParkSignal;
+        sigemptyset(&saPark.sa_mask);
+        saPark.sa_flags = 0;
+        sigaction(SIGUSR1, &saPark, nullptr);
+    }
+
+    // Open existing IPC objects using the run keys the Director created.
     MessageQueue regQueue;
     MessageQueue triageQueue;
     MessageQueue logQueue;
-    Semaphore stateSem;
     Semaphore waitSem;
+    Semaphore gate;
     SharedMemory shm;
 
-    key_t regKey = ftok(keyPath.c_str(), 'R');
-    key_t triKey = ftok(keyPath.c_str(), 'T');
-    key_t logKey = ftok(keyPath.c_str(), 'L');
-    key_t semStateKey = ftok(keyPath.c_str(), 'M');
-    key_t waitKey = ftok(keyPath.c_str(), 'W');
-    key_t shmKey = ftok(keyPath.c_str(), 'H');
+    key_t regKey = ipcKey(keyPath, 'R');
+    key_t triKey = ipcKey(keyPath, 'T');
+    key_t logKey = ipcKey(keyPath, 'L');
+    key_t waitKey = ipcKey(keyPath, 'W');
+    key_t shmKey = ipcKey(keyPath, 'H');
+    key_t gateKey = ipcKey(keyPath, 'G');
 
     if (regKey == -1 || triKey == -1 || logKey == -1 ||
-        semStateKey == -1 || waitKey == -1 || shmKey == -1) {
-        logErrno("Registration ftok failed");
+        waitKey == -1 || shmKey == -1 || gateKey == -1) {
+        logErrno("Registration IPC key lookup failed");
         return 1;
     }
-    if (!regQueue.open(regKey) || !triageQueue.open(triKey) || !logQueue.open(logKey)) {
+    if (!shm.open(shmKey)) {
         return 1;
     }
-    if (!stateSem.open(semStateKey) || !waitSem.open(waitKey)) {
+    auto* statePtr = static_cast<SharedState*>(shm.attach());
+    if (!statePtr) {
         return 1;
     }
-    if (!shm.open(shmKey)) {
+    QueueTransport transport = statePtr->queueTransport != 0 ? QueueTransport::ShmRing : QueueTransport::SysV;
+    if (!regQueue.open(regKey, transport) || !triageQueue.open(triKey, transport) || !logQueue.open(logKey)) {
+        shm.detach(statePtr);
         return 1;
     }
-    auto* statePtr = static_cast<SharedState*>(shm.attach());
-    if (!statePtr) {
+    attachLogRings(logKey);
+    if (!waitSem.open(waitKey) || (window > 0 && !gate.open(gateKey))) {
+        shm.detach(statePtr);
         return 1;
     }
+    if (window >= statePtr->registrationWindowCount) {
+        errno = EINVAL;
+        logErrno("Registration window outside the pool");
+        shm.detach(statePtr);
+        return 1;
+    }
+    RegistrationWindowSlot& slot = statePtr->registrationWindows[window];
     int serviceMs = statePtr->registrationServiceMs;
     if (serviceMs < 0) serviceMs = 0;
 
-    std::array<int, kSpecialistCount> specQueueIds;
-    specQueueIds.fill(-1);
-    setLogMetricsContext({statePtr, regQueue.id(), triageQueue.id(), specQueueIds,
-                          waitSem.id(), stateSem.id()});
+    std::array<const MessageQueue*, kSpecialistCount> specQueues{};
+    setLogMetricsContext({statePtr, &regQueue, &triageQueue, specQueues,
+                          waitSem.id()});
 
     // Helper to release waiting-room capacity and update shared counters symmetrically.
     auto releaseSlots = [&](int count, const char* errTag) {
-        stateSem.wait();
-        if (statePtr->currentInWaitingRoom >= count) {
-            statePtr->currentInWaitingRoom -= count;
-        } else {
-            statePtr->currentInWaitingRoom = 0;
-        }
-        stateSem.post();
+        subtractClamped(statePtr->waitingRoom.currentInWaitingRoom, count);
         for (int i = 0; i < count; ++i) {
             if (!waitSem.post()) {
                 logErrno(errTag);
@@ -137,52 +158,77 @@ int Registration::run(const std::string& keyPath, bool isSecond) {
         }
     };
 
-    Role myRole = isSecond ? Role::Registration2 : Role::Registration1;
+    Role myRole = window > 0 ? Role::Registration2 : Role::Registration1;
+    const std::string windowName = "Registration window " + std::to_string(window);
     // Log includes PID via logger; message text focuses on patient ids/flags.
     int simTime = currentSimMinutes(statePtr);
-    logEvent(logQueue.id(), myRole, simTime, isSecond ? "Registration2 started" : "Registration started");
+    logEvent(logQueue.id(), myRole, simTime, window > 0 ? windowName + " ready" : std::string("Registration started"));
 
     long long lastHeartbeat = 0;
+    bool taking = window == 0;
 
     while (!stopFlag.load()) {
+        // Pool windows wait on their gate semaphore while the director keeps them closed; the timeout
+        // only bounds how long a missed post could delay the next look at the slot.
+        if (window > 0 && slot.open.load(std::memory_order_acquire) == 0) {
+            if (taking) {
+                taking = false;
+                slot.taking.store(0, std::memory_order_release);
+                logEvent(logQueue.id(), myRole, currentSimMinutes(statePtr), windowName + " parked");
+            }
+            if (!gate.waitFor(500, window) && (errno == EIDRM || errno == EINVAL)) {
+                break;
+            }
+            continue;
+        }
+        if (!taking) {
+            taking = true;
+            slot.taking.store(1, std::memory_order_release);
+            logEvent(logQueue.id(), myRole, currentSimMinutes(statePtr), windowName + " opened");
+        }
+
         EventMessage ev{};
-        long baseType = static_cast<long>(EventType::PatientArrived);
-        // Use negative msgtyp to prioritize lower mtype (VIP first).
-        ssize_t res = msgrcv(regQueue.id(), &ev, sizeof(EventMessage) - sizeof(long),
-                             -(baseType + 1), 0); // accept both VIP (1) and normal (2)
-        if (res == -1) {
+        // VIP (arrivalMsgType(true)) before normal, unless aging lets a long-waiting normal patient through.
+        if (!receiveAged(regQueue, ev, arrivalMsgType(true), statePtr->aging.registration.data(), 2,
+                         statePtr->vipQueueAging)) {
             if ((errno == EINTR && stopFlag.load()) || errno == EIDRM || errno == EINVAL) {
                 break;
             }
+            if (errno == EINTR) {
+                continue;  // park signal: look at the slot again
+            }
             logErrno("Registration msgrcv failed");
             continue;
         }
 
-        stateSem.wait();
-        if (statePtr->queueRegistrationLen > 0) {
-            statePtr->queueRegistrationLen -= 1;
-        }
-        stateSem.post();
+        subtractClamped(statePtr->waitingRoom.queueRegistrationLen, 1);
+        ev.hops.registrationNs = hopClockNs();
+        statePtr->latency.recordQueueWait(ev.isVip ? QueueClass::RegistrationVip : QueueClass::RegistrationNormal,
+                                          ev.queuedNs, ev.hops.registrationNs);
+        statePtr->latency.recordHop(LatencyStage::WaitingRoomToRegistration, ev.hops.waitingRoomNs,
+                                    ev.hops.registrationNs);
 
         simTime = currentSimMinutes(statePtr);
-        logEvent(logQueue.id(), myRole, simTime,
-                 "Registering patient id=" + std::to_string(ev.patientId) +
-                 " vip=" + std::to_string(ev.isVip) +
-                 " persons=" + std::to_string(ev.personsCount));
+        LogEventFields fields;
+        fields.kind = LogEventKind::RegisteringPatient;
+        fields.subject = ev.patientId;
+        fields.vip = ev.isVip;
+        fields.persons = ev.personsCount;
+        logEvent(logQueue.id(), myRole, simTime, fields);
 
-        // Simulate service time to allow queue buildup (and potential reg2 activation).
+        // Simulate service time to allow queue buildup (and extra windows to open).
         if (serviceMs > 0) {
-            usleep(static_cast<useconds_t>(serviceMs * 1000));
+            sleepServiceMs(serviceMs);
         }
 
         // Forward to triage queue (VIP gets lower mtype for priority).
-        long baseRegType = static_cast<long>(EventType::PatientRegistered);
-        ev.mtype = ev.isVip ? baseRegType : baseRegType + 1;
+        ev.mtype = registeredMsgType(ev.isVip != 0);
+        ev.queuedNs = hopClockNs();
         // Non-blocking send with retry to avoid stalling when triage queue is full.
-        size_t payloadSize = sizeof(EventMessage) - sizeof(long);
         bool sent = false;
         while (!sent) {
-            if (msgsnd(triageQueue.id(), &ev, payloadSize, IPC_NOWAIT) == 0) {
+            if (triageQueue.send(&ev, sizeof(EventMessage), ev.mtype, IPC_NOWAIT)) {
+                statePtr->aging.triage[ev.isVip ? 0 : 1].noteEnqueue(ev.queuedNs);
                 sent = true;
                 break;
             }
@@ -195,10 +241,8 @@ int Registration::run(const std::string& keyPath, bool isSecond) {
         }
         if (sent) {
             simTime = currentSimMinutes(statePtr);
-            logEvent(logQueue.id(), myRole, simTime,
-                     "Forwarded patient id=" + std::to_string(ev.patientId) +
-                     " vip=" + std::to_string(ev.isVip) +
-                     " persons=" + std::to_string(ev.personsCount));
+            fields.kind = LogEventKind::RegistrationForwarded;
+            logEvent(logQueue.id(), myRole, simTime, fields);
 
             // Free waiting room capacity as patient leaves for triage.
             releaseSlots(ev.personsCount, "waitSem post failed (reg)");
@@ -206,21 +250,19 @@ int Registration::run(const std::string& keyPath, bool isSecond) {
             // If we failed to forward (queue gone or fatal error), free the slots so we don't leak capacity.
             releaseSlots(ev.personsCount, "waitSem post failed (reg drop)");
             simTime = currentSimMinutes(statePtr);
-            logEvent(logQueue.id(), myRole, simTime,
-                     "Dropped patient id=" + std::to_string(ev.patientId) +
-                     " due to triage send failure; released waiting room slots");
+            fields.kind = LogEventKind::RegistrationDropped;
+            logEvent(logQueue.id(), myRole, simTime, fields);
         }
+        slot.patients.fetch_add(1, std::memory_order_relaxed);
+        slot.busyNs.fetch_add(hopClockNs() - ev.hops.registrationNs, std::memory_order_relaxed);
 
         // Heartbeat every ~5s to surface stalls (queue length, waitSem, inside count).
         long long nowMs = monotonicMs();
         if (lastHeartbeat == 0 || nowMs - lastHeartbeat >= 5000) {
             lastHeartbeat = nowMs;
-            int qlen = queueLen(regQueue.id());
+            int qlen = regQueue.length();
             int wsemVal = semaphoreValue(waitSem.id());
-            int inside = 0;
-            stateSem.wait();
-            inside = statePtr->currentInWaitingRoom;
-            stateSem.post();
+            int inside = statePtr->waitingRoom.currentInWaitingRoom.load(std::memory_order_relaxed);
             simTime = currentSimMinutes(statePtr);
             logEvent(logQueue.id(), myRole, simTime,
                      "HEARTBEAT REG qLen=" + std::to_string(qlen) +
@@ -231,10 +273,13 @@ int Registration::run(const std::string& keyPath, bool isSecond) {
     }
 
     simTime = currentSimMinutes(statePtr);
-    if (sigusr2Seen.load()) {
-        logEvent(logQueue.id(), myRole, simTime, isSecond ? "Registration2 shutting down (SIGUSR2)" : "Registration shutting down (SIGUSR2)");
+    std::string reason = sigusr2Seen.load() ? " (SIGUSR2)" : "";
+    if (window == 0) {
+        logEvent(logQueue.id(), myRole, simTime, "Registration shutting down" + reason);
     } else {
-        logEvent(logQueue.id(), myRole, simTime, isSecond ? "Registration2 shutting down" : "Registration shutting down");
+        // "parked" closes the visualizer's open count; "stopped" is not a lifecycle message.
+        if (taking) logEvent(logQueue.id(), myRole, simTime, windowName + " parked");
+        logEvent(logQueue.id(), myRole, simTime, windowName + " stopped" + reason);
     }
     shm.detach(statePtr);
     return 0;
@@ -1,17 +1,22 @@
 #include "roles/specialist.hpp"
 
+#include "ipc/aging_receive.hpp"
 #include "ipc/message_queue.hpp"
+#include "ipc/run_namespace.hpp"
 #include "ipc/semaphore.hpp"
 #include "ipc/shared_memory.hpp"
 #include "logging/logger.hpp"
 #include "model/events.hpp"
 #include "model/shared_state.hpp"
+#include "model/sim_rules.hpp"
+#include "model/specialist_policy.hpp"
 #include "model/types.hpp"
 #include "util/error.hpp"
 #include "util/random.hpp"
 
 #include <array>
 #include <atomic>
+#include <cerrno>
 #include <csignal>
 #include <cstring>
 #include <string>
@@ -57,12 +62,6 @@ Role roleForType(SpecialistType t) {
     }
 }
 
-/** @brief Highest message type a specialist should accept (priority range). */
-long maxMsgTypeForSpec(SpecialistType t) {
-    // base + specialist*10 + maxPriority(3)
-    return static_cast<long>(EventType::PatientToSpecialist) + static_cast<int>(t) * 10 + 3;
-}
-
 /** @brief Monotonic clock in milliseconds (best effort). */
 long long monotonicMs() {
     struct timespec ts {};
@@ -81,7 +80,7 @@ int currentSimMinutes(const SharedState* state) {
 } // namespace
 
 // Specialist loop entry (see header for details).
-int Specialist::run(const std::string& keyPath, SpecialistType type) {
+int Specialist::run(const std::string& keyPath, SpecialistType type, int doctor) {
     // Ignore SIGINT so only SIGUSR2/SIGUSR1 manage lifecycle.
     struct sigaction saIgnore {};
     saIgnore.sa_handler = SIG_IGN;
@@ -103,36 +102,45 @@ int Specialist::run(const std::string& keyPath, SpecialistType type) {
 
     MessageQueue specQueue;
     MessageQueue logQueue;
-    Semaphore stateSem;
     Semaphore waitSem;
     SharedMemory shm;
 
-    key_t regKey = ftok(keyPath.c_str(), 'R');
-    key_t triKey = ftok(keyPath.c_str(), 'T');
-    key_t specKey = ftok(keyPath.c_str(), 'A' + static_cast<int>(type));
-    key_t logKey = ftok(keyPath.c_str(), 'L');
-    key_t semStateKey = ftok(keyPath.c_str(), 'M');
-    key_t waitKey = ftok(keyPath.c_str(), 'W');
-    key_t shmKey = ftok(keyPath.c_str(), 'H');
+    key_t regKey = ipcKey(keyPath, 'R');
+    key_t triKey = ipcKey(keyPath, 'T');
+    key_t specKey = ipcKey(keyPath, 'A' + static_cast<int>(type));
+    key_t logKey = ipcKey(keyPath, 'L');
+    key_t waitKey = ipcKey(keyPath, 'W');
+    key_t shmKey = ipcKey(keyPath, 'H');
 
     if (regKey == -1 || triKey == -1 || specKey == -1 || logKey == -1 ||
-        semStateKey == -1 || waitKey == -1 || shmKey == -1) {
-        logErrno("Specialist ftok failed");
+        waitKey == -1 || shmKey == -1) {
+        logErrno("Specialist IPC key lookup failed");
         return 1;
     }
-    if (!specQueue.open(specKey) || !logQueue.open(logKey)) {
+    if (!shm.open(shmKey)) {
         return 1;
     }
-    if (!stateSem.open(semStateKey) || !waitSem.open(waitKey)) {
+    auto* statePtr = static_cast<SharedState*>(shm.attach());
+    if (!statePtr) {
         return 1;
     }
-    if (!shm.open(shmKey)) {
+    QueueTransport transport = statePtr->queueTransport != 0 ? QueueTransport::ShmRing : QueueTransport::SysV;
+    if (!specQueue.open(specKey, transport) || !logQueue.open(logKey)) {
+        shm.detach(statePtr);
         return 1;
     }
-    auto* statePtr = static_cast<SharedState*>(shm.attach());
-    if (!statePtr) {
+    attachLogRings(logKey);
+    if (!waitSem.open(waitKey)) {
+        shm.detach(statePtr);
         return 1;
     }
+    if (doctor >= statePtr->doctorCount[static_cast<int>(type)]) {
+        errno = EINVAL;
+        logErrno("Specialist doctor outside the configured staff");
+        shm.detach(statePtr);
+        return 1;
+    }
+    DoctorCounters& counters = statePtr->doctors[static_cast<int>(type)][doctor];
     int examMinMs = statePtr->specialistExamMinMs;
     int examMaxMs = statePtr->specialistExamMaxMs;
     if (examMinMs <= 0 || examMaxMs <= 0 || examMaxMs < examMinMs) {
@@ -146,79 +154,91 @@ int Specialist::run(const std::string& keyPath, SpecialistType type) {
         leaveMaxMs = 500;
     }
 
-    int registrationQueueId = -1;
-    int triageQueueId = -1;
-    if (regKey != -1) {
-        registrationQueueId = msgget(regKey, 0);
-    }
-    if (triKey != -1) {
-        triageQueueId = msgget(triKey, 0);
-    }
-    std::array<int, kSpecialistCount> specQueueIds;
-    specQueueIds.fill(-1);
-    specQueueIds[static_cast<int>(type)] = specQueue.id();
-    setLogMetricsContext({statePtr, registrationQueueId, triageQueueId, specQueueIds,
-                          waitSem.id(), stateSem.id()});
+    // Registration/triage handles are only used for log metrics; failures just report 0.
+    MessageQueue registrationQueue;
+    MessageQueue triageQueue;
+    registrationQueue.open(regKey, transport);
+    triageQueue.open(triKey, transport);
+    std::array<const MessageQueue*, kSpecialistCount> specQueues{};
+    specQueues[static_cast<int>(type)] = &specQueue;
+    setLogMetricsContext({statePtr, &registrationQueue, &triageQueue, specQueues,
+                          waitSem.id()});
 
     Role asRole = roleForType(type);
     int simTime = currentSimMinutes(statePtr);
-    logEvent(logQueue.id(), asRole, simTime, "Specialist " + specToString(type) + " started");
-    RandomGenerator rng;
+    logEvent(logQueue.id(), asRole, simTime,
+             "Specialist " + specToString(type) + " doctor " + std::to_string(doctor) + " started");
+    RandomGenerator rng(doctorSeed(statePtr->randomSeed, type, doctor));
+    const SpecialistPolicy policy = statePtr->specialistPolicy;
+    SpecialistScheduler scheduler(policy, statePtr->colorQueueAging);
+    AgingLane* lanes = statePtr->aging.specialists[static_cast<int>(type)].data();
 
     while (!stopFlag.load()) {
         if (pausedFlag.load()) {
             int pauseMs = rng.uniformInt(leaveMinMs, leaveMaxMs);
+            const long long leaveStartNs = hopClockNs();
             usleep(static_cast<useconds_t>(pauseMs * 1000));
             pausedFlag.store(false);
+            counters.leaves.fetch_add(1, std::memory_order_relaxed);
+            counters.leaveNs.fetch_add(hopClockNs() - leaveStartNs, std::memory_order_relaxed);
             simTime = currentSimMinutes(statePtr);
             logEvent(logQueue.id(), asRole, simTime, "SIGUSR1: temporary leave finished");
         }
 
         EventMessage ev{};
-        long maxType = maxMsgTypeForSpec(type);
-        // Negative msgtyp picks the lowest mtype <= |msgtyp|, giving priority to red/yellow over green.
-        ssize_t res = msgrcv(specQueue.id(), &ev, sizeof(EventMessage) - sizeof(long),
-                             -maxType, 0);
-        if (res == -1) {
+        // The policy picks a colour from the lanes; with nothing to pick, block for whatever arrives first.
+        const long redType = specialistMsgType(type, TriageColor::Red);
+        long long queued[kTriageColorCount];
+        long long headAgeMs[kTriageColorCount];
+        const long long nowNs = hopClockNs();
+        for (int c = 0; c < kTriageColorCount; ++c) {
+            queued[c] = lanes[c].queued();
+            headAgeMs[c] = lanes[c].headAgeMs(nowNs);
+        }
+        if (!receiveClass(specQueue, ev, redType, lanes, kTriageColorCount, scheduler.pick(queued, headAgeMs))) {
             if ((errno == EINTR && stopFlag.load()) || errno == EIDRM || errno == EINVAL) {
                 break;
             }
             continue;
         }
+        scheduler.noteServed(static_cast<int>(ev.mtype - redType));
+        const long long examStartNs = hopClockNs();
+        statePtr->latency.recordQueueWait(
+            static_cast<QueueClass>(static_cast<int>(QueueClass::SpecialistRed) + (ev.mtype - redType)), ev.queuedNs,
+            examStartNs);
+        statePtr->latency.recordHop(LatencyStage::TriageToSpecialist, ev.hops.triageNs, examStartNs);
 
         simTime = currentSimMinutes(statePtr);
-        logEvent(logQueue.id(), asRole, simTime,
-                 "Received patient id=" + std::to_string(ev.patientId) +
-                 " color=" + std::to_string(ev.triageColor) +
-                 " persons=" + std::to_string(ev.personsCount));
-
-        // Simulate exam; slower to allow queues to build (registration2 logic to kick in later).
-        int examMs = rng.uniformInt(examMinMs, examMaxMs);
+        LogEventFields fields;
+        fields.kind = LogEventKind::SpecialistReceived;
+        fields.subject = ev.patientId;
+        fields.color = ev.triageColor;
+        fields.persons = ev.personsCount;
+        logEvent(logQueue.id(), asRole, simTime, fields);
+
+        // Simulate exam; slower to allow queues to build.
+        int examMs = colorExamMs(policy, static_cast<TriageColor>(ev.triageColor),
+                                 rng.uniformInt(examMinMs, examMaxMs));
         usleep(static_cast<useconds_t>(examMs * 1000));
 
-        int outcomeRand = rng.uniformInt(0, 999);
-        stateSem.wait();
-        if (outcomeRand < 850) {
-            statePtr->outcomeHome += 1;
-        } else if (outcomeRand < 995) {
-            statePtr->outcomeWard += 1;
-        } else {
-            statePtr->outcomeOther += 1;
+        const long long examEndNs = hopClockNs();
+        statePtr->latency.recordExam(ev.hops, examStartNs, examEndNs, ev.triageColor, ev.specialistIdx);
+        counters.exams.fetch_add(1, std::memory_order_relaxed);
+        counters.busyNs.fetch_add(examEndNs - examStartNs, std::memory_order_relaxed);
+
+        Outcome outcome = pickOutcome(rng);
+        OutcomeCounters& outcomes = statePtr->outcomes[static_cast<int>(type)];
+        switch (outcome) {
+            case Outcome::Home: outcomes.home.fetch_add(1, std::memory_order_relaxed); break;
+            case Outcome::Ward: outcomes.ward.fetch_add(1, std::memory_order_relaxed); break;
+            default: outcomes.other.fetch_add(1, std::memory_order_relaxed); break;
         }
-        stateSem.post();
-
-        std::string outcomeText;
-        if (outcomeRand < 850) outcomeText = "home";
-        else if (outcomeRand < 995) outcomeText = "ward";
-        else outcomeText = "otherFacility";
 
         simTime = currentSimMinutes(statePtr);
-        logEvent(logQueue.id(), asRole, simTime,
-                 "Handled patient id=" + std::to_string(ev.patientId) +
-                 " outcome=" + outcomeText +
-                 " persons=" + std::to_string(ev.personsCount) +
-                 " color=" + std::to_string(ev.triageColor) +
-                 " specIdx=" + std::to_string(ev.specialistIdx));
+        fields.kind = LogEventKind::SpecialistHandled;
+        fields.outcome = static_cast<int>(outcome);
+        fields.specialist = ev.specialistIdx;
+        logEvent(logQueue.id(), asRole, simTime, fields);
     }
 
     simTime = currentSimMinutes(statePtr);
@@ -1,17 +1,21 @@
 #include "roles/triage.hpp"
 
+#include "ipc/aging_receive.hpp"
 #include "ipc/message_queue.hpp"
+#include "ipc/run_namespace.hpp"
 #include "ipc/semaphore.hpp"
 #include "ipc/shared_memory.hpp"
 #include "logging/logger.hpp"
 #include "model/events.hpp"
 #include "model/shared_state.hpp"
+#include "model/sim_rules.hpp"
 #include "model/types.hpp"
 #include "util/error.hpp"
 #include "util/random.hpp"
 
 #include <array>
 #include <atomic>
+#include <cerrno>
 #include <csignal>
 #include <cstring>
 #include <string>
@@ -30,38 +34,6 @@ void handleSigusr2(int) {
     sigusr2Seen.store(true);
 }
 
-/** @brief Uniformly pick a specialist type. */
-SpecialistType pickSpecialist(RandomGenerator& rng) {
-    int r = rng.uniformInt(0, 5);
-    switch (r) {
-        case 0: return SpecialistType::Cardiologist;
-        case 1: return SpecialistType::Neurologist;
-        case 2: return SpecialistType::Ophthalmologist;
-        case 3: return SpecialistType::Laryngologist;
-        case 4: return SpecialistType::Surgeon;
-        case 5: return SpecialistType::Paediatrician;
-        default: return SpecialistType::None;
-    }
-}
-
-/** @brief Pick triage color with weighted probabilities. */
-TriageColor pickColor(RandomGenerator& rng) {
-    int r = rng.uniformInt(0, 99);
-    if (r < 10) return TriageColor::Red;
-    if (r < 45) return TriageColor::Yellow;
-    return TriageColor::Green;
-}
-
-/** @brief Priority ordering for colors (lower is higher priority). */
-int colorPriority(TriageColor c) {
-    switch (c) {
-        case TriageColor::Red: return 1;    // highest priority
-        case TriageColor::Yellow: return 2; // medium
-        case TriageColor::Green: return 3;  // lowest
-        default: return 3;
-    }
-}
-
 /** @brief Monotonic clock in milliseconds (best effort). */
 long long monotonicMs() {
     struct timespec ts {};
@@ -80,7 +52,7 @@ int currentSimMinutes(const SharedState* state) {
 } // namespace
 
 // Triage loop entry (see header for details).
-int Triage::run(const std::string& keyPath) {
+int Triage::run(const std::string& keyPath, int worker) {
     // Ignore SIGINT so only SIGUSR2 controls shutdown.
     struct sigaction saIgnore {};
     saIgnore.sa_handler = SIG_IGN;
@@ -97,120 +69,129 @@ int Triage::run(const std::string& keyPath) {
     MessageQueue triageQueue;
     std::array<MessageQueue, kSpecialistCount> specQueues;
     MessageQueue logQueue;
-    Semaphore stateSem;
     Semaphore waitSem;
     SharedMemory shm;
 
-    key_t regKey = ftok(keyPath.c_str(), 'R');
-    key_t triKey = ftok(keyPath.c_str(), 'T');
+    key_t regKey = ipcKey(keyPath, 'R');
+    key_t triKey = ipcKey(keyPath, 'T');
     std::array<key_t, kSpecialistCount> specKeys;
     for (int i = 0; i < kSpecialistCount; ++i) {
-        specKeys[i] = ftok(keyPath.c_str(), 'A' + i);
+        specKeys[i] = ipcKey(keyPath, 'A' + i);
     }
-    key_t logKey = ftok(keyPath.c_str(), 'L');
-    key_t semStateKey = ftok(keyPath.c_str(), 'M');
-    key_t waitKey = ftok(keyPath.c_str(), 'W');
-    key_t shmKey = ftok(keyPath.c_str(), 'H');
+    key_t logKey = ipcKey(keyPath, 'L');
+    key_t waitKey = ipcKey(keyPath, 'W');
+    key_t shmKey = ipcKey(keyPath, 'H');
 
     if (regKey == -1 || triKey == -1 || logKey == -1 ||
-        semStateKey == -1 || waitKey == -1 || shmKey == -1) {
-        logErrno("Triage ftok failed");
+        waitKey == -1 || shmKey == -1) {
+        logErrno("Triage IPC key lookup failed");
         return 1;
     }
     for (int i = 0; i < kSpecialistCount; ++i) {
         if (specKeys[i] == -1) {
-            logErrno("Triage ftok failed");
+            logErrno("Triage IPC key lookup failed");
             return 1;
         }
     }
-    if (!triageQueue.open(triKey) || !logQueue.open(logKey)) {
+    if (!shm.open(shmKey)) {
         return 1;
     }
-    std::array<int, kSpecialistCount> specQueueIds;
-    specQueueIds.fill(-1);
+    auto* statePtr = static_cast<SharedState*>(shm.attach());
+    if (!statePtr) {
+        return 1;
+    }
+    QueueTransport transport = statePtr->queueTransport != 0 ? QueueTransport::ShmRing : QueueTransport::SysV;
+    if (!triageQueue.open(triKey, transport) || !logQueue.open(logKey)) {
+        shm.detach(statePtr);
+        return 1;
+    }
+    attachLogRings(logKey);
+    std::array<const MessageQueue*, kSpecialistCount> specQueuePtrs{};
     for (int i = 0; i < kSpecialistCount; ++i) {
-        if (!specQueues[i].open(specKeys[i])) {
+        if (!specQueues[i].open(specKeys[i], transport)) {
             logErrno("Triage spec queue open failed");
+            shm.detach(statePtr);
             return 1;
         }
-        specQueueIds[i] = specQueues[i].id();
-    }
-    if (!stateSem.open(semStateKey) || !waitSem.open(waitKey)) {
-        return 1;
+        specQueuePtrs[i] = &specQueues[i];
     }
-    if (!shm.open(shmKey)) {
+    if (!waitSem.open(waitKey)) {
+        shm.detach(statePtr);
         return 1;
     }
-    auto* statePtr = static_cast<SharedState*>(shm.attach());
-    if (!statePtr) {
+    if (worker >= statePtr->triageWorkerCount) {
+        errno = EINVAL;
+        logErrno("Triage worker outside the configured pool");
+        shm.detach(statePtr);
         return 1;
     }
+    TriageCounters& counters = statePtr->triage[worker];
     int triageServiceMs = statePtr->triageServiceMs;
     if (triageServiceMs < 0) triageServiceMs = 0;
 
-    int registrationQueueId = -1;
-    if (regKey != -1) {
-        registrationQueueId = msgget(regKey, 0);
-    }
-    setLogMetricsContext({statePtr, registrationQueueId, triageQueue.id(), specQueueIds,
-                          waitSem.id(), stateSem.id()});
+    // Registration handle is only used for log metrics; a failure just reports rQ=0.
+    MessageQueue registrationQueue;
+    registrationQueue.open(regKey, transport);
+    setLogMetricsContext({statePtr, &registrationQueue, &triageQueue, specQueuePtrs,
+                          waitSem.id()});
 
     int simTime = currentSimMinutes(statePtr);
-    logEvent(logQueue.id(), Role::Triage, simTime, "Triage started");
-    RandomGenerator rng;
+    logEvent(logQueue.id(), Role::Triage, simTime, "Triage started (worker " + std::to_string(worker) + ")");
+    RandomGenerator rng(triageSeed(statePtr->randomSeed, worker));
 
     while (!stopFlag.load()) {
         EventMessage ev{};
-        long baseType = static_cast<long>(EventType::PatientRegistered);
-        // Negative msgtyp prioritizes lower mtype, so VIP (baseType) is dequeued before normal (baseType+1).
-        ssize_t res = msgrcv(triageQueue.id(), &ev, sizeof(EventMessage) - sizeof(long),
-                             -(baseType + 1), 0);
-        if (res == -1) {
+        // VIP (registeredMsgType(true)) before normal, unless aging lets a long-waiting normal patient through.
+        if (!receiveAged(triageQueue, ev, registeredMsgType(true), statePtr->aging.triage.data(), 2,
+                         statePtr->vipQueueAging)) {
             if ((errno == EINTR && stopFlag.load()) || errno == EIDRM || errno == EINVAL) {
                 break;
             }
             logErrno("Triage msgrcv failed");
             continue;
         }
+        ev.hops.triageNs = hopClockNs();
+        statePtr->latency.recordQueueWait(ev.isVip ? QueueClass::TriageVip : QueueClass::TriageNormal, ev.queuedNs,
+                                          ev.hops.triageNs);
+        statePtr->latency.recordHop(LatencyStage::RegistrationToTriage, ev.hops.registrationNs, ev.hops.triageNs);
 
         if (triageServiceMs > 0) {
             usleep(static_cast<useconds_t>(triageServiceMs * 1000));
         }
 
         // 5% send home directly
-        int rHome = rng.uniformInt(0, 99);
-        stateSem.wait();
-        if (rHome < 5) {
-            statePtr->triageSentHome += 1;
-            stateSem.post();
+        bool sendHome = rollSentHomeFromTriage(rng);
+        if (sendHome) {
+            counters.sentHome.fetch_add(1, std::memory_order_relaxed);
+            counters.busyNs.fetch_add(hopClockNs() - ev.hops.triageNs, std::memory_order_relaxed);
             simTime = currentSimMinutes(statePtr);
-            logEvent(logQueue.id(), Role::Triage, simTime,
-                     "Patient sent home from triage id=" + std::to_string(ev.patientId));
+            LogEventFields sentHome;
+            sentHome.kind = LogEventKind::TriageSentHome;
+            sentHome.subject = ev.patientId;
+            logEvent(logQueue.id(), Role::Triage, simTime, sentHome);
             continue;
         }
 
         TriageColor color = pickColor(rng);
         switch (color) {
-            case TriageColor::Red: statePtr->triageRed += 1; break;
-            case TriageColor::Yellow: statePtr->triageYellow += 1; break;
-            case TriageColor::Green: statePtr->triageGreen += 1; break;
+            case TriageColor::Red: counters.red.fetch_add(1, std::memory_order_relaxed); break;
+            case TriageColor::Yellow: counters.yellow.fetch_add(1, std::memory_order_relaxed); break;
+            case TriageColor::Green: counters.green.fetch_add(1, std::memory_order_relaxed); break;
             default: break;
         }
         SpecialistType spec = pickSpecialist(rng);
-        stateSem.post();
 
-        long routedType = static_cast<long>(EventType::PatientToSpecialist) +
-                          static_cast<int>(spec) * 10 + colorPriority(color);
-        ev.mtype = routedType;
+        ev.mtype = specialistMsgType(spec, color);
         ev.specialistIdx = static_cast<int>(spec);
         ev.triageColor = static_cast<int>(color);
 
         // Non-blocking send with retry to avoid stalling if specialist queue is momentarily full.
-        size_t payloadSize = sizeof(EventMessage) - sizeof(long);
+        ev.queuedNs = hopClockNs();
         bool sent = false;
         while (!sent) {
             MessageQueue& targetQueue = specQueues[static_cast<int>(spec)];
-            if (msgsnd(targetQueue.id(), &ev, payloadSize, IPC_NOWAIT) == 0) {
+            if (targetQueue.send(&ev, sizeof(EventMessage), ev.mtype, IPC_NOWAIT)) {
+                statePtr->aging.specialists[ev.specialistIdx][colorPriority(color) - 1].noteEnqueue(ev.queuedNs);
                 sent = true;
                 break;
             }
@@ -221,12 +202,15 @@ int Triage::run(const std::string& keyPath) {
             logErrno("Triage send to specialist failed");
             break;
         }
+        counters.busyNs.fetch_add(hopClockNs() - ev.hops.triageNs, std::memory_order_relaxed);
         if (sent) {
             simTime = currentSimMinutes(statePtr);
-            logEvent(logQueue.id(), Role::Triage, simTime,
-                     "Forwarded patient id=" + std::to_string(ev.patientId) +
-                     " to specialist=" + std::to_string(ev.specialistIdx) +
-                     " color=" + std::to_string(ev.triageColor));
+            LogEventFields forwarded;
+            forwarded.kind = LogEventKind::TriageForwarded;
+            forwarded.subject = ev.patientId;
+            forwarded.specialist = ev.specialistIdx;
+            forwarded.color = ev.triageColor;
+            logEvent(logQueue.id(), Role::Triage, simTime, forwarded);
         }
     }
 
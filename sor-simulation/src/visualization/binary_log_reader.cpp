@@ -0,0 +1,79 @@
+#include "visualization/binary_log_reader.hpp"
+
+#include "logging/binary_log.hpp"
+
+#include <cstring>
+
+namespace {
+LogRole logRoleFor(Role role) {
+    switch (role) {
+        case Role::Director: return LogRole::Director;
+        case Role::PatientGenerator: return LogRole::PatientGenerator;
+        case Role::Patient: return LogRole::Patient;
+        case Role::Registration1: return LogRole::Registration1;
+        case Role::Registration2: return LogRole::Registration2;
+        case Role::Triage: return LogRole::Triage;
+        case Role::SpecialistCardio:
+        case Role::SpecialistNeuro:
+        case Role::SpecialistOphthalmo:
+        case Role::SpecialistLaryng:
+        case Role::SpecialistSurgeon:
+        case Role::SpecialistPaediatric:
+            return LogRole::Specialist;
+        case Role::Logger: return LogRole::Logger;
+        default: return LogRole::Unknown;
+    }
+}
+} // namespace
+
+LogFormat detectLogFormat(std::string_view head, size_t& headerBytes) {
+    headerBytes = 0;
+    if (head.empty()) return LogFormat::Unknown;
+    if (head[0] != kBinaryLogMagic[0]) return LogFormat::Text;
+    if (head.size() < sizeof(BinaryLogHeader)) return LogFormat::Unknown;
+    BinaryLogHeader header;
+    std::memcpy(&header, head.data(), sizeof(header));
+    if (!binaryLogHeaderValid(header)) return LogFormat::Unsupported;
+    headerBytes = sizeof(header);
+    return LogFormat::Binary;
+}
+
+bool readBinaryLogRecord(std::string_view bytes, size_t& used, LogEntry& out) {
+    BinaryLogRecord rec;
+    if (bytes.size() < sizeof(rec)) return false;
+    std::memcpy(&rec, bytes.data(), sizeof(rec));
+    if (bytes.size() < sizeof(rec) + rec.textLen) return false;
+    used = sizeof(rec) + rec.textLen;
+
+    Role role = static_cast<Role>(rec.role);
+    out.simTime = rec.simTime;
+    out.pid = rec.pid;
+    out.hasMetrics = (rec.flags & kRecordHasMetrics) != 0;
+    out.waitingCurrent = rec.metrics[0];
+    out.waitingCapacity = rec.metrics[1];
+    out.regQueue = rec.metrics[2];
+    out.triageQueue = rec.metrics[3];
+    out.specialistsQueue = rec.metrics[4];
+    out.waitSem = rec.metrics[5];
+    out.stateSem = (rec.flags & kRecordStateSem) ? 1 : 0;
+    out.roleKind = logRoleFor(role);
+    out.role = roleLabel(role);
+
+    if (rec.textLen > 0) {
+        // Free-text event: classify it like a text line.
+        out.typed = false;
+        out.text = bytes.substr(sizeof(rec), rec.textLen);
+        out.kind = classifyMessage(out.roleKind, out.text);
+        out.patientId = -1;
+        if (isPatientFlowKind(out.kind)) {
+            extractInt(out.text, "id=", out.patientId);
+        }
+        return true;
+    }
+    out.typed = true;
+    out.fields = unpackLogFields(rec);
+    out.kind = out.fields.kind;
+    out.patientId = isPatientFlowKind(out.kind) ? rec.subject : -1;
+    out.text = std::string_view();  // derived only where it is displayed (formatEventText)
+    return true;
+}
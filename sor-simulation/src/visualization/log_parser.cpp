@@ -1,21 +1,156 @@
 #include "visualization/log_parser.hpp"
 
 #include <cctype>
-#include <sstream>
+#include <charconv>
 
-int toIntSafe(const std::string& s) {
-    try {
-        return std::stoi(s);
-    } catch (const std::exception&) {
-        return 0;
+namespace {
+constexpr size_t kNpos = std::string_view::npos;
+
+bool startsWith(std::string_view text, std::string_view prefix) {
+    return text.size() >= prefix.size() && text.compare(0, prefix.size(), prefix) == 0;
+}
+
+/** @brief First c in [p, end), or end. Columns are a few bytes long, so a plain loop beats memchr. */
+inline const char* scanTo(const char* p, const char* end, char c) {
+    while (p < end && *p != c) ++p;
+    return p;
+}
+
+/**
+ * @brief Read a decimal int at p with from_chars; returns the first unread byte. Like toIntSafe, a
+ * missing or out-of-range number reads as 0 (the digits of an overlong number are still skipped).
+ */
+inline const char* readInt(const char* p, const char* end, int& out) {
+    int value = 0;
+    auto res = std::from_chars(p, end, value);
+    out = res.ec == std::errc() ? value : 0;
+    return res.ptr;
+}
+
+bool endsWith(std::string_view text, std::string_view suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/** @brief Classification result: kind plus the length of the matched leading phrase. */
+struct Match {
+    MessageKind kind{MessageKind::Other};
+    size_t prefixLen{0};
+};
+
+inline Match matchPrefix(std::string_view text, std::string_view prefix, MessageKind kind) {
+    return startsWith(text, prefix) ? Match{kind, prefix.size()} : Match{};
+}
+
+Match classifyRegistration(std::string_view text) {
+    switch (text.empty() ? '\0' : text[0]) {
+        case 'R':
+            if (startsWith(text, "Registering patient")) return {MessageKind::RegisteringPatient, 19};
+            if (startsWith(text, "Registration")) {
+                if (text.find(" started") != kNpos || endsWith(text, " opened")) {
+                    return {MessageKind::RegistrationStarted, 12};
+                }
+                if (text.find(" shutting down") != kNpos || endsWith(text, " parked")) {
+                    return {MessageKind::RegistrationStopping, 12};
+                }
+            }
+            return {};
+        case 'F': return matchPrefix(text, "Forwarded patient", MessageKind::RegistrationForwarded);
+        case 'D': return matchPrefix(text, "Dropped patient", MessageKind::RegistrationDropped);
+        default: return {};
+    }
+}
+
+Match classifyTriage(std::string_view text) {
+    switch (text.empty() ? '\0' : text[0]) {
+        case 'T':
+            if (startsWith(text, "Triage started")) return {MessageKind::TriageStarted, 14};
+            return matchPrefix(text, "Triage shutting down", MessageKind::TriageStopping);
+        case 'F': return matchPrefix(text, "Forwarded patient", MessageKind::TriageForwarded);
+        case 'P': return matchPrefix(text, "Patient sent home from triage", MessageKind::TriageSentHome);
+        default: return {};
+    }
+}
+
+Match classifySpecialist(std::string_view text) {
+    switch (text.empty() ? '\0' : text[0]) {
+        case 'R': return matchPrefix(text, "Received patient", MessageKind::SpecialistReceived);
+        case 'H': return matchPrefix(text, "Handled patient", MessageKind::SpecialistHandled);
+        case 'S':
+            if (startsWith(text, "Specialist shutting down")) return {MessageKind::SpecialistStopping, 24};
+            if (startsWith(text, "SIGUSR1: temporary leave finished")) return {MessageKind::SpecialistLeaveFinished, 33};
+            if (startsWith(text, "Specialist ") && endsWith(text, "started")) return {MessageKind::SpecialistStarted, 11};
+            return {};
+        default: return {};
+    }
+}
+
+Match classifyPatient(std::string_view text) {
+    if (!startsWith(text, "Patient ")) return {};
+    switch (text.size() > 8 ? text[8] : '\0') {
+        case 'w':
+            return matchPrefix(text, "Patient waiting to enter waiting room", MessageKind::PatientWaitingOutside);
+        case 'a': return matchPrefix(text, "Patient arrived", MessageKind::PatientArrived);
+        case 'r': return matchPrefix(text, "Patient registered", MessageKind::PatientRegistered);
+        default: return {};
+    }
+}
+
+Match classify(LogRole role, std::string_view text) {
+    switch (role) {
+        case LogRole::Patient: return classifyPatient(text);
+        case LogRole::Registration1:
+        case LogRole::Registration2: return classifyRegistration(text);
+        case LogRole::Triage: return classifyTriage(text);
+        case LogRole::Specialist: return classifySpecialist(text);
+        case LogRole::Director: return matchPrefix(text, "Director sent SIGUSR1", MessageKind::DirectorSentLeave);
+        default: return {};
+    }
+}
+
+/** @brief Patient-flow messages all read "<phrase> id=<n> ..."; pick the id up right after the phrase. */
+int patientIdAfter(std::string_view text, size_t prefixLen) {
+    const char* p = text.data() + prefixLen;
+    const char* end = text.data() + text.size();
+    if (end - p > 4 && p[0] == ' ' && p[1] == 'i' && p[2] == 'd' && p[3] == '=' &&
+        static_cast<unsigned>(p[4] - '0') < 10u) {
+        int id = -1;
+        readInt(p + 4, end, id);
+        return id;
+    }
+    int id = -1;
+    return extractInt(text, "id=", id) ? id : -1;
+}
+} // namespace
+
+int toIntSafe(std::string_view s) {
+    int value = 0;
+    auto res = std::from_chars(s.data(), s.data() + s.size(), value);
+    return res.ec == std::errc() ? value : 0;
+}
+
+bool isPatientFlowKind(MessageKind kind) {
+    switch (kind) {
+        case MessageKind::PatientWaitingOutside:
+        case MessageKind::PatientArrived:
+        case MessageKind::PatientRegistered:
+        case MessageKind::RegisteringPatient:
+        case MessageKind::RegistrationForwarded:
+        case MessageKind::RegistrationDropped:
+        case MessageKind::TriageForwarded:
+        case MessageKind::TriageSentHome:
+        case MessageKind::SpecialistReceived:
+        case MessageKind::SpecialistHandled:
+            return true;
+        default:
+            return false;
     }
 }
 
-bool extractInt(const std::string& text, const std::string& key, int& out) {
+bool extractInt(std::string_view text, std::string_view key, int& out) {
     size_t pos = 0;
     while (true) {
         pos = text.find(key, pos);
-        if (pos == std::string::npos) return false;
+        if (pos == kNpos) return false;
         // Ensure we're not matching a substring inside another token (e.g. "pid=").
         if (pos > 0 && std::isalnum(static_cast<unsigned char>(text[pos - 1]))) {
             pos += key.size();
@@ -25,30 +160,20 @@ bool extractInt(const std::string& text, const std::string& key, int& out) {
         while (pos < text.size() && text[pos] == ' ') {
             ++pos;
         }
-        long val = 0;
-        bool found = false;
-        while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos]))) {
-            val = val * 10 + (text[pos] - '0');
-            found = true;
-            ++pos;
+        size_t digitsEnd = pos;
+        while (digitsEnd < text.size() && std::isdigit(static_cast<unsigned char>(text[digitsEnd]))) {
+            ++digitsEnd;
         }
-        if (found) {
-            out = static_cast<int>(val);
+        if (digitsEnd == pos) {
+            return false;
         }
-        return found;
+        int value = 0;
+        std::from_chars(text.data() + pos, text.data() + digitsEnd, value);
+        out = value;
+        return true;
     }
 }
 
-std::vector<std::string> split(const std::string& line, char delim) {
-    std::vector<std::string> parts;
-    std::stringstream ss(line);
-    std::string item;
-    while (std::getline(ss, item, delim)) {
-        parts.push_back(item);
-    }
-    return parts;
-}
-
 TriageColor colorFromInt(int value) {
     switch (value) {
         case 0: return TriageColor::Red;
@@ -97,52 +222,97 @@ std::string specialistNameColored(SpecialistType t) {
     return std::string(color) + specialistName(t) + reset;
 }
 
-SpecialistType specialistFromLabel(const std::string& text) {
-    if (text.find("Cardiologist") != std::string::npos) return SpecialistType::Cardiologist;
-    if (text.find("Neurologist") != std::string::npos) return SpecialistType::Neurologist;
-    if (text.find("Ophthalmologist") != std::string::npos) return SpecialistType::Ophthalmologist;
-    if (text.find("Laryngologist") != std::string::npos) return SpecialistType::Laryngologist;
-    if (text.find("Surgeon") != std::string::npos) return SpecialistType::Surgeon;
-    if (text.find("Paediatrician") != std::string::npos) return SpecialistType::Paediatrician;
+SpecialistType specialistFromLabel(std::string_view text) {
+    if (text.find("Cardiologist") != kNpos) return SpecialistType::Cardiologist;
+    if (text.find("Neurologist") != kNpos) return SpecialistType::Neurologist;
+    if (text.find("Ophthalmologist") != kNpos) return SpecialistType::Ophthalmologist;
+    if (text.find("Laryngologist") != kNpos) return SpecialistType::Laryngologist;
+    if (text.find("Surgeon") != kNpos) return SpecialistType::Surgeon;
+    if (text.find("Paediatrician") != kNpos) return SpecialistType::Paediatrician;
     return SpecialistType::None;
 }
 
-bool parseLogLine(const std::string& line, LogEntry& out) {
-    auto parts = split(line, ';');
-    if (parts.size() < 3) {
-        return false;
+// Perfect hash on (length, one distinguishing byte) over the fixed role names the logger writes.
+LogRole classifyRole(std::string_view role) {
+    switch (role.size()) {
+        case 4:
+            if (role[0] != 'r') return LogRole::Unknown;
+            return role[3] == '1' ? LogRole::Registration1 : role[3] == '2' ? LogRole::Registration2 : LogRole::Unknown;
+        case 6: return role[0] == 't' ? LogRole::Triage : role[0] == 'l' ? LogRole::Logger : LogRole::Unknown;
+        case 7: return role[0] == 'p' ? LogRole::Patient : LogRole::Unknown;
+        case 8: return role[0] == 'd' ? LogRole::Director : LogRole::Unknown;
+        case 10: return role[0] == 's' ? LogRole::Specialist : LogRole::Unknown;
+        case 11: return role[0] == 'p' ? LogRole::PatientGenerator : LogRole::Unknown;
+        default: return LogRole::Unknown;
     }
-    out.simTime = toIntSafe(parts[0]);
-    out.pid = toIntSafe(parts[1]);
-
-    if (parts.size() >= 9 && parts[2].rfind("wR=", 0) == 0) {
-        out.hasMetrics = true;
-        // wR is x/y
-        auto slashPos = parts[2].find('/');
-        if (slashPos != std::string::npos) {
-            out.waitingCurrent = toIntSafe(parts[2].substr(3, slashPos - 3));
-            out.waitingCapacity = toIntSafe(parts[2].substr(slashPos + 1));
+}
+
+MessageKind classifyMessage(LogRole role, std::string_view text) {
+    return classify(role, text).kind;
+}
+
+// Layout: simTime;pid;[wR=x/y;rQ=;tQ=;sQ=;wSem=;sSem=;]role;text (text may itself contain ';').
+// Single forward pass: numbers are read in place with from_chars, fields are never copied.
+bool parseLogLine(std::string_view line, LogEntry& out) {
+    const char* cur = line.data();
+    const char* end = cur + line.size();
+
+    const char* simEnd = scanTo(cur, end, ';');
+    if (simEnd == end) return false;
+    const char* pidBegin = simEnd + 1;
+    const char* pidEnd = scanTo(pidBegin, end, ';');
+    if (pidEnd == end) return false;
+    const char* third = pidEnd + 1;
+    if (third == end) return false;
+
+    readInt(cur, simEnd, out.simTime);
+    readInt(pidBegin, pidEnd, out.pid);
+    out.hasMetrics = false;
+
+    const char* roleBegin = third;
+    if (end - third > 3 && third[0] == 'w' && third[1] == 'R' && third[2] == '=') {
+        // wR=cur/cap then five key=value fields; fall back to the plain layout if any is missing.
+        int values[7] = {0, 0, 0, 0, 0, 0, 0};
+        const char* p = readInt(third + 3, end, values[0]);
+        if (p < end && *p == '/') {
+            p = readInt(p + 1, end, values[1]);
         }
-        out.regQueue = toIntSafe(parts[3].substr(parts[3].find('=') + 1));
-        out.triageQueue = toIntSafe(parts[4].substr(parts[4].find('=') + 1));
-        out.specialistsQueue = toIntSafe(parts[5].substr(parts[5].find('=') + 1));
-        out.waitSem = toIntSafe(parts[6].substr(parts[6].find('=') + 1));
-        out.stateSem = toIntSafe(parts[7].substr(parts[7].find('=') + 1));
-        out.role = parts[8];
-        std::string remaining;
-        for (size_t i = 9; i < parts.size(); ++i) {
-            if (i > 9) remaining.push_back(';');
-            remaining += parts[i];
+        p = scanTo(p, end, ';');
+        bool complete = p != end;
+        for (int i = 2; complete && i < 7; ++i) {
+            const char* eq = scanTo(p + 1, end, '=');
+            const char* semi = scanTo(p + 1, eq, ';');
+            if (semi == eq) {
+                // '=' found inside this field: read the value up to the next ';'.
+                semi = scanTo(eq, end, ';');
+                readInt(eq + 1, semi, values[i]);
+            }
+            complete = semi != end;
+            p = semi;
         }
-        out.text = remaining;
-    } else {
-        out.role = parts[2];
-        std::string remaining;
-        for (size_t i = 3; i < parts.size(); ++i) {
-            if (i > 3) remaining.push_back(';');
-            remaining += parts[i];
+        if (complete) {
+            out.hasMetrics = true;
+            out.waitingCurrent = values[0];
+            out.waitingCapacity = values[1];
+            out.regQueue = values[2];
+            out.triageQueue = values[3];
+            out.specialistsQueue = values[4];
+            out.waitSem = values[5];
+            out.stateSem = values[6];
+            roleBegin = p + 1;
         }
-        out.text = remaining.empty() ? parts[2] : remaining;
     }
+    const char* roleEnd = scanTo(roleBegin, end, ';');
+    out.role = std::string_view(roleBegin, static_cast<size_t>(roleEnd - roleBegin));
+    if (roleEnd != end) {
+        out.text = std::string_view(roleEnd + 1, static_cast<size_t>(end - roleEnd - 1));
+    } else {
+        // Plain lines without a text column show the role field as text (old behaviour); metric lines stay empty.
+        out.text = out.hasMetrics ? std::string_view() : out.role;
+    }
+    out.roleKind = classifyRole(out.role);
+    Match match = classify(out.roleKind, out.text);
+    out.kind = match.kind;
+    out.patientId = isPatientFlowKind(match.kind) ? patientIdAfter(out.text, match.prefixLen) : -1;
     return true;
 }
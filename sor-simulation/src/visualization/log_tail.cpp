@@ -0,0 +1,139 @@
+#include "visualization/log_tail.hpp"
+
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <chrono>
+
+LogTail::~LogTail() {
+    close();
+}
+
+bool LogTail::open(const std::string& path) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ == -1) {
+        return false;
+    }
+    inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd_ != -1) {
+        watchId_ = inotify_add_watch(inotifyFd_, path.c_str(), IN_MODIFY | IN_CLOSE_WRITE);
+        if (watchId_ == -1) {
+            ::close(inotifyFd_);
+            inotifyFd_ = -1;
+        }
+    }
+    offset_ = 0;
+    return true;
+}
+
+void LogTail::unmapWindow() {
+    if (window_) {
+        munmap(window_, windowLen_);
+        window_ = nullptr;
+        windowLen_ = 0;
+    }
+    lines_.clear();
+}
+
+// Map [page-aligned offset, min(size, offset + window)); the view starts at the first unread byte.
+std::string_view LogTail::mapUnread() {
+    unmapWindow();
+    if (fd_ == -1) {
+        return {};
+    }
+    struct stat st {};
+    if (fstat(fd_, &st) == -1) {
+        return {};
+    }
+    if (st.st_size < offset_) {
+        offset_ = 0;  // truncated or replaced in place: start over
+    }
+    if (st.st_size == offset_) {
+        return {};
+    }
+
+    static const off_t pageSize = static_cast<off_t>(sysconf(_SC_PAGESIZE));
+    off_t mapStart = offset_ - (offset_ % pageSize);
+    size_t lead = static_cast<size_t>(offset_ - mapStart);
+    size_t available = static_cast<size_t>(st.st_size - offset_);
+    size_t take = std::min(available, kMaxWindowBytes);
+    void* addr = mmap(nullptr, lead + take, PROT_READ, MAP_SHARED, fd_, mapStart);
+    if (addr == MAP_FAILED) {
+        return {};
+    }
+    window_ = addr;
+    windowLen_ = lead + take;
+    return std::string_view(static_cast<const char*>(addr) + lead, take);
+}
+
+// Cut the unread window at its last newline.
+const std::vector<std::string_view>& LogTail::nextLines() {
+    std::string_view bytes = mapUnread();
+    const char* begin = bytes.data();
+    const char* end = begin + bytes.size();
+    const char* cursor = begin;
+    while (cursor < end) {
+        const char* nl = static_cast<const char*>(std::memchr(cursor, '\n', static_cast<size_t>(end - cursor)));
+        if (!nl) {
+            break;
+        }
+        lines_.emplace_back(cursor, static_cast<size_t>(nl - cursor));
+        cursor = nl + 1;
+    }
+    if (cursor == begin && bytes.size() == kMaxWindowBytes) {
+        // A single line longer than the window: hand it over whole rather than stalling.
+        lines_.emplace_back(begin, bytes.size());
+        cursor = end;
+    }
+    offset_ += static_cast<off_t>(cursor - begin);
+    return lines_;
+}
+
+std::string_view LogTail::nextBytes() {
+    return mapUnread();
+}
+
+void LogTail::consume(size_t bytes) {
+    offset_ += static_cast<off_t>(bytes);
+}
+
+bool LogTail::waitForChange(int timeoutMs) {
+    if (inotifyFd_ == -1) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::max(0, timeoutMs)));
+        return true;
+    }
+    struct pollfd pfd {};
+    pfd.fd = inotifyFd_;
+    pfd.events = POLLIN;
+    int rc = poll(&pfd, 1, std::max(0, timeoutMs));
+    if (rc <= 0) {
+        return false;  // timeout or EINTR (caller re-checks its stop flag)
+    }
+    // Drain queued events; their content does not matter, only that the file changed.
+    alignas(struct inotify_event) char buf[4096];
+    while (read(inotifyFd_, buf, sizeof(buf)) > 0) {
+    }
+    return true;
+}
+
+void LogTail::close() {
+    unmapWindow();
+    if (inotifyFd_ != -1) {
+        ::close(inotifyFd_);
+        inotifyFd_ = -1;
+        watchId_ = -1;
+    }
+    if (fd_ != -1) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    offset_ = 0;
+}
@@ -0,0 +1,248 @@
+#include "visualization/patient_store.hpp"
+
+namespace {
+constexpr size_t kInitialIndexSize = 1024;
+} // namespace
+
+PatientStore::PatientStore() : index_(kInitialIndexSize) {}
+
+size_t PatientStore::bucketFor(int id) const {
+    // Patient ids are sequential; mix them so neighbours do not form long probe runs.
+    uint32_t x = static_cast<uint32_t>(id);
+    x ^= x >> 16;
+    x *= 0x45d9f3bu;
+    x ^= x >> 16;
+    return x & (index_.size() - 1);
+}
+
+PatientStore::IndexEntry* PatientStore::lookup(int id) {
+    return const_cast<IndexEntry*>(static_cast<const PatientStore*>(this)->lookup(id));
+}
+
+const PatientStore::IndexEntry* PatientStore::lookup(int id) const {
+    size_t mask = index_.size() - 1;
+    for (size_t i = bucketFor(id);; i = (i + 1) & mask) {
+        if (index_[i].id == id) return &index_[i];
+        if (index_[i].id == kEmptyId) return nullptr;
+    }
+}
+
+void PatientStore::insertIndex(int id, int32_t slot) {
+    if ((indexUsed_ + 1) * 2 > index_.size()) {
+        growIndex();
+    }
+    size_t mask = index_.size() - 1;
+    size_t i = bucketFor(id);
+    while (index_[i].id != kEmptyId) {
+        i = (i + 1) & mask;
+    }
+    index_[i].id = id;
+    index_[i].slot = slot;
+    ++indexUsed_;
+}
+
+// Linear probing with backward-shift deletion, so no tombstones accumulate in the index.
+void PatientStore::eraseIndex(int id) {
+    size_t mask = index_.size() - 1;
+    size_t hole = bucketFor(id);
+    while (index_[hole].id != id) {
+        if (index_[hole].id == kEmptyId) return;
+        hole = (hole + 1) & mask;
+    }
+    for (size_t j = (hole + 1) & mask; index_[j].id != kEmptyId; j = (j + 1) & mask) {
+        size_t home = bucketFor(index_[j].id);
+        bool reachable = hole <= j ? (hole < home && home <= j) : (hole < home || home <= j);
+        if (!reachable) {
+            index_[hole] = index_[j];
+            hole = j;
+        }
+    }
+    index_[hole] = IndexEntry{};
+    --indexUsed_;
+}
+
+void PatientStore::growIndex() {
+    std::vector<IndexEntry> old;
+    old.swap(index_);
+    index_.assign(old.size() * 2, IndexEntry{});
+    indexUsed_ = 0;
+    for (const IndexEntry& e : old) {
+        if (e.id != kEmptyId) insertIndex(e.id, e.slot);
+    }
+}
+
+PatientView* PatientStore::find(int id) {
+    IndexEntry* e = lookup(id);
+    return e && e->slot != kFinishedSlot ? &slab_[static_cast<size_t>(e->slot)] : nullptr;
+}
+
+const PatientView* PatientStore::find(int id) const {
+    const IndexEntry* e = lookup(id);
+    return e && e->slot != kFinishedSlot ? &slab_[static_cast<size_t>(e->slot)] : nullptr;
+}
+
+PatientView* PatientStore::ensure(int id) {
+    if (IndexEntry* e = lookup(id)) {
+        return e->slot == kFinishedSlot ? nullptr : &slab_[static_cast<size_t>(e->slot)];
+    }
+    if (liveCount_ >= kMaxLivePatients) {
+        evictStalest();
+    }
+    int32_t slot;
+    if (!freeSlots_.empty()) {
+        slot = freeSlots_.back();
+        freeSlots_.pop_back();
+    } else {
+        slot = static_cast<int32_t>(slab_.size());
+        slab_.emplace_back();
+        slotLive_.push_back(0);
+        links_.emplace_back();
+    }
+    PatientView& pv = slab_[static_cast<size_t>(slot)];
+    pv = PatientView{};
+    pv.id = id;
+    slotLive_[static_cast<size_t>(slot)] = 1;
+    ++liveCount_;
+    links_[static_cast<size_t>(slot)] = Links{};
+    linkStage(slot);
+    insertIndex(id, slot);
+    return &pv;
+}
+
+int PatientStore::specialistList(SpecialistType type, Stage stage) {
+    int idx = static_cast<int>(type);
+    if (idx < 0 || idx >= kSpecialistCount) return -1;
+    if (stage == Stage::SpecialistQueue) return idx * 2;
+    if (stage == Stage::SpecialistActive) return idx * 2 + 1;
+    return -1;
+}
+
+// Stage lists append at the tail: a patient that (re)enters a stage queues behind everyone there.
+void PatientStore::linkStage(int32_t slot) {
+    Links& l = links_[static_cast<size_t>(slot)];
+    const PatientView& pv = slab_[static_cast<size_t>(slot)];
+    ListHead& list = stageLists_[static_cast<size_t>(pv.stage)];
+    l.stage = pv.stage;
+    l.persons = pv.persons > 0 ? pv.persons : 1;
+    l.prev = list.tail;
+    l.next = -1;
+    if (list.tail >= 0) {
+        links_[static_cast<size_t>(list.tail)].next = slot;
+    } else {
+        list.head = slot;
+    }
+    list.tail = slot;
+    ++list.size;
+    stagePersons_[static_cast<size_t>(l.stage)] += l.persons;
+}
+
+void PatientStore::unlinkStage(int32_t slot) {
+    Links& l = links_[static_cast<size_t>(slot)];
+    ListHead& list = stageLists_[static_cast<size_t>(l.stage)];
+    if (l.prev >= 0) links_[static_cast<size_t>(l.prev)].next = l.next;
+    else list.head = l.next;
+    if (l.next >= 0) links_[static_cast<size_t>(l.next)].prev = l.prev;
+    else list.tail = l.prev;
+    l.prev = l.next = -1;
+    --list.size;
+    stagePersons_[static_cast<size_t>(l.stage)] -= l.persons;
+}
+
+// Specialist lists are kept by ascending id; ids arrive almost in order, so the walk from the tail is short.
+void PatientStore::linkSpecialist(int32_t slot, int listIdx) {
+    Links& l = links_[static_cast<size_t>(slot)];
+    ListHead& list = specialistLists_[static_cast<size_t>(listIdx)];
+    int id = slab_[static_cast<size_t>(slot)].id;
+    int32_t after = list.tail;
+    while (after >= 0 && slab_[static_cast<size_t>(after)].id > id) {
+        after = links_[static_cast<size_t>(after)].specPrev;
+    }
+    int32_t before = after >= 0 ? links_[static_cast<size_t>(after)].specNext : list.head;
+    l.specPrev = after;
+    l.specNext = before;
+    if (after >= 0) links_[static_cast<size_t>(after)].specNext = slot;
+    else list.head = slot;
+    if (before >= 0) links_[static_cast<size_t>(before)].specPrev = slot;
+    else list.tail = slot;
+    l.specList = listIdx;
+    ++list.size;
+}
+
+void PatientStore::unlinkSpecialist(int32_t slot) {
+    Links& l = links_[static_cast<size_t>(slot)];
+    if (l.specList < 0) return;
+    ListHead& list = specialistLists_[static_cast<size_t>(l.specList)];
+    if (l.specPrev >= 0) links_[static_cast<size_t>(l.specPrev)].specNext = l.specNext;
+    else list.head = l.specNext;
+    if (l.specNext >= 0) links_[static_cast<size_t>(l.specNext)].specPrev = l.specPrev;
+    else list.tail = l.specPrev;
+    l.specPrev = l.specNext = -1;
+    l.specList = -1;
+    --list.size;
+}
+
+void PatientStore::reindex(const PatientView& pv) {
+    int32_t slot = static_cast<int32_t>(&pv - slab_.data());
+    Links& l = links_[static_cast<size_t>(slot)];
+    int persons = pv.persons > 0 ? pv.persons : 1;
+    if (l.stage != pv.stage) {
+        unlinkStage(slot);
+        linkStage(slot);
+    } else if (l.persons != persons) {
+        stagePersons_[static_cast<size_t>(l.stage)] += persons - l.persons;
+        l.persons = persons;
+    }
+    int specList = specialistList(pv.specialist, pv.stage);
+    if (specList != l.specList) {
+        unlinkSpecialist(slot);
+        if (specList >= 0) linkSpecialist(slot, specList);
+    }
+}
+
+void PatientStore::releaseSlot(int32_t slot) {
+    unlinkStage(slot);
+    unlinkSpecialist(slot);
+    slotLive_[static_cast<size_t>(slot)] = 0;
+    freeSlots_.push_back(slot);
+    --liveCount_;
+}
+
+void PatientStore::finish(int id) {
+    IndexEntry* e = lookup(id);
+    if (!e || e->slot == kFinishedSlot) {
+        return;
+    }
+    int32_t slot = e->slot;
+    e->slot = kFinishedSlot;
+    releaseSlot(slot);
+    ++finishedCount_;
+    rememberFinished(id);
+}
+
+// Bounded memory of finished ids: the oldest one leaves the index when the ring wraps.
+void PatientStore::rememberFinished(int id) {
+    if (finishedFill_ == kFinishedMemory) {
+        eraseIndex(finishedRing_[finishedHead_]);
+    } else {
+        ++finishedFill_;
+    }
+    finishedRing_[finishedHead_] = id;
+    finishedHead_ = (finishedHead_ + 1) % kFinishedMemory;
+}
+
+// Only reached when kMaxLivePatients are live at once (e.g. a missed stream of "finished" lines).
+void PatientStore::evictStalest() {
+    int32_t victim = -1;
+    for (size_t i = 0; i < slab_.size(); ++i) {
+        if (!slotLive_[i]) continue;
+        if (victim < 0 || slab_[i].lastSimTime < slab_[static_cast<size_t>(victim)].lastSimTime) {
+            victim = static_cast<int32_t>(i);
+        }
+    }
+    if (victim < 0) {
+        return;
+    }
+    eraseIndex(slab_[static_cast<size_t>(victim)].id);
+    releaseSlot(victim);
+    ++evictedCount_;
+}
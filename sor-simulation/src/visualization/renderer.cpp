@@ -5,46 +5,95 @@
 
 #include <array>
 #include <algorithm>
-#include <iostream>
+#include <ostream>
 #include <sstream>
 
+namespace {
+/** @brief Narrowest label ("id=1") plus its separating space, in terminal cells. */
+constexpr size_t kMinLabelCells = 5;
+/** @brief Waiting-room rows drawn before any metrics line has reported the capacity. */
+constexpr size_t kUnknownCapacityRows = 13;
+/** @brief Queue rows shown per specialist; longer queues end with an ellipsis. */
+constexpr size_t kSpecialistQueueRows = 4;
+
+/** @brief Upper bound of labels that can fill maxLines lines of the given width (+1 to detect overflow). */
+size_t labelBudget(size_t width, size_t maxLines) {
+    return maxLines * ((width + 1) / kMinLabelCells) + 1;
+}
+
+/** @brief Cut wrapped lines to maxLines and mark hidden patients with a trailing "...". */
+void capLines(std::vector<std::string>& lines, size_t maxLines, bool more) {
+    if (lines.size() > maxLines) {
+        lines.resize(maxLines);
+        more = true;
+    }
+    if (more && !lines.empty()) {
+        lines.back() = "...";
+    }
+}
+
+/** @brief Wrapped labels of a stage in arrival order, reading only as many patients as can be shown. */
+std::vector<std::string> stageLines(const VisualizationState& state, Stage stage, size_t width, size_t maxLines) {
+    auto list = collectPatientsByStage(state, stage, labelBudget(width, maxLines));
+    std::vector<std::string> tokens;
+    tokens.reserve(list.size());
+    for (auto* p : list) tokens.push_back(formatPatientLabel(*p, stage));
+    auto lines = wrapTokens(tokens, width);
+    capLines(lines, maxLines, list.size() < state.patients.stageCount(stage));
+    return lines;
+}
+
+/** @brief Up to limit patients queued at / inside a specialist room, by ascending id. */
+std::vector<const PatientView*> collectAtSpecialist(const VisualizationState& state, int idx, bool active,
+                                                    size_t limit) {
+    std::vector<const PatientView*> list;
+    state.patients.forEachAtSpecialist(static_cast<SpecialistType>(idx), active, [&](const PatientView& p) {
+        if (list.size() >= limit) return false;
+        list.push_back(&p);
+        return true;
+    });
+    return list;
+}
+} // namespace
 
 // Render waiting room/triage/entrance overview with live stats (see header).
-void renderTopSection(const VisualizationState& state) {
+void renderTopSection(const VisualizationState& state, std::ostream& out) {
     const int totalWidth = 118;
     const int colWaiting = 60;
     const int colTriage = 24;
     const int colEntrance = 30;
     std::string border(totalWidth, '=');
-    std::cout << border << "\n";
+    out << border << "\n";
 
     // One-line stats above everything
     std::stringstream statsLine;
     statsLine << "Elapsed " << state.latestSimTime << "m | "
-              << "Triage R/Y/G " << state.triageRed << "/" << state.triageYellow << "/" << state.triageGreen
+              << "Triage x" << state.triageWorkersActive << " R/Y/G " << state.triageRed << "/" << state.triageYellow << "/" << state.triageGreen
               << " home " << state.triageSentHome << " | "
-              << "Disp H/W/O " << state.outcomeHome << "/" << state.outcomeWard << "/" << state.outcomeOther;
+              << "Disp H/W/O " << state.outcomeHome << "/" << state.outcomeWard << "/" << state.outcomeOther
+              << " | Inside " << state.patients.size() << " left " << state.patients.finishedCount();
     std::string statsPadded = padded(statsLine.str(), totalWidth - 2);
-    std::cout << "|" << statsPadded << "|\n";
-    std::cout << border << "\n";
+    out << "|" << statsPadded << "|\n";
+    out << border << "\n";
 
-    std::string reg2Status = state.reg2Active ? "REG2 ON" : "REG2 off";
+    std::string reg2Status =
+        state.poolWindowsOpen > 0 ? "REG +" + std::to_string(state.poolWindowsOpen) + " ON" : "REG +0 off";
 
     std::stringstream headWait;
     std::stringstream headReg;
-    // counts based on current staged patients to avoid stale metrics
-    auto waitingList = collectPatientsByStage(state, Stage::WaitingRoom);
-    auto regList = collectPatientsByStage(state, Stage::RegistrationQueue);
-    auto triageList = collectPatientsByStage(state, Stage::TriageQueue);
-    size_t triageCount = triageList.size();
+    // counts come from the per-stage lists, so they track the staged patients without a scan
+    const PatientStore& patients = state.patients;
+    size_t waitingCount = patients.stageCount(Stage::WaitingRoom);
+    size_t regCount = patients.stageCount(Stage::RegistrationQueue);
+    size_t triageCount = patients.stageCount(Stage::TriageQueue);
+    size_t entranceCount = patients.stageCount(Stage::OutsideQueue);
 
     auto personCount = [](const PatientView* p) {
         return p->persons > 0 ? p->persons : 1;
     };
-    int personsWaiting = 0;
-    for (auto* p : waitingList) personsWaiting += personCount(p);
-    for (auto* p : regList) personsWaiting += personCount(p);
-    int patientsWaiting = static_cast<int>(waitingList.size() + regList.size());
+    int personsWaiting =
+        static_cast<int>(patients.stagePersons(Stage::WaitingRoom) + patients.stagePersons(Stage::RegistrationQueue));
+    int patientsWaiting = static_cast<int>(waitingCount + regCount);
 
     int capacityPersons = state.waitingCapacity > 0 ? state.waitingCapacity : 0;
     int usedPersons = personsWaiting;
@@ -62,78 +111,57 @@ void renderTopSection(const VisualizationState& state) {
     }
     headWait << " (patients " << patientsWaiting << ")";
     headReg << "TRIAGE QUEUE tQ=" << triageCount;
-    auto entranceList = collectPatientsByStage(state, Stage::OutsideQueue);
     std::stringstream headEnt;
-    headEnt << "ENTRANCE outQ=" << entranceList.size() << " " << reg2Status;
+    headEnt << "ENTRANCE outQ=" << entranceCount << " " << reg2Status;
 
-    std::cout << "|" << padded(headWait.str(), colWaiting)
+    out << "|" << padded(headWait.str(), colWaiting)
               << "|" << padded(headReg.str(), colTriage)
               << "|" << padded(headEnt.str(), colEntrance) << "|\n";
 
+    // Registration queue first, then the waiting room, each in arrival order. With a known
+    // person capacity the walk stops at the first patient that no longer fits; without one it
+    // stops once the rows of an unknown-capacity frame are filled.
     std::vector<const PatientView*> waitingCombined;
-    waitingCombined.insert(waitingCombined.end(), waitingList.begin(), waitingList.end());
-    waitingCombined.insert(waitingCombined.end(), regList.begin(), regList.end());
-
-    std::sort(waitingCombined.begin(), waitingCombined.end(), [](const PatientView* a, const PatientView* b) {
-        int stagePriA = (a->stage == Stage::RegistrationQueue) ? 0 : 1;
-        int stagePriB = (b->stage == Stage::RegistrationQueue) ? 0 : 1;
-        if (stagePriA != stagePriB) return stagePriA < stagePriB;
-        int orderA = (a->stage == Stage::RegistrationQueue) ? a->regOrder : a->waitOrder;
-        int orderB = (b->stage == Stage::RegistrationQueue) ? b->regOrder : b->waitOrder;
-        if (orderA < 0) orderA = a->lastSimTime;
-        if (orderB < 0) orderB = b->lastSimTime;
-        return orderA < orderB;
-    });
-
-    // Trim by person capacity if known to avoid displaying more than can fit.
-    if (capacityPersons > 0) {
-        std::vector<const PatientView*> trimmed;
-        int remaining = capacityPersons;
-        for (auto* p : waitingCombined) {
-            int need = personCount(p);
-            if (need <= remaining) {
-                trimmed.push_back(p);
-                remaining -= need;
-            } else {
-                break;
+    const size_t waitingLimit =
+        capacityPersons > 0 ? static_cast<size_t>(capacityPersons)
+                            : labelBudget(static_cast<size_t>(colWaiting - 2), kUnknownCapacityRows);
+    int remaining = capacityPersons;
+    bool full = false;
+    auto takeWaiting = [&](const PatientView& p) {
+        if (waitingCombined.size() >= waitingLimit) {
+            full = true;
+            return false;
+        }
+        if (capacityPersons > 0) {
+            int need = personCount(&p);
+            if (need > remaining) {
+                full = true;
+                return false;
             }
+            remaining -= need;
         }
-        waitingCombined.swap(trimmed);
+        waitingCombined.push_back(&p);
+        return true;
+    };
+    patients.forEachInStage(Stage::RegistrationQueue, takeWaiting);
+    if (!full) {
+        patients.forEachInStage(Stage::WaitingRoom, takeWaiting);
     }
 
-    std::vector<const PatientView*> triageOrdered = triageList;
-    std::sort(triageOrdered.begin(), triageOrdered.end(), [](const PatientView* a, const PatientView* b) {
-        int oa = a->triageOrder < 0 ? a->lastSimTime : a->triageOrder;
-        int ob = b->triageOrder < 0 ? b->lastSimTime : b->triageOrder;
-        return oa < ob;
-    });
-
     std::vector<std::string> waitingTokens;
     for (auto* p : waitingCombined) {
         Stage renderStage = p->registrationInProgress ? Stage::RegistrationQueue : Stage::WaitingRoom;
         waitingTokens.push_back(formatPatientLabel(*p, renderStage));
     }
-
-    std::vector<std::string> triageTokens;
-    for (auto* p : triageOrdered) triageTokens.push_back(formatPatientLabel(*p, Stage::TriageQueue));
-
-    std::vector<std::string> entranceTokens;
-    for (auto* p : entranceList) entranceTokens.push_back(formatPatientLabel(*p, Stage::OutsideQueue));
-
     auto waitingLines = wrapTokens(waitingTokens, static_cast<size_t>(colWaiting - 2));
-    auto regLines = wrapTokens(triageTokens, static_cast<size_t>(colTriage - 2));
-    auto entranceLines = wrapTokens(entranceTokens, static_cast<size_t>(colEntrance - 2));
 
     size_t minRows = static_cast<size_t>((state.waitingCapacity + 3) / 4); // assume roughly 4 items per line
     size_t waitingHeight = waitingLines.size();
     if (waitingHeight < minRows) waitingHeight = minRows;
 
-    // Cap entrance height to waiting-height; show overflow with ellipsis.
-    size_t entranceCap = waitingHeight > 0 ? waitingHeight : entranceLines.size();
-    if (entranceCap > 0 && entranceLines.size() > entranceCap) {
-        entranceLines.resize(entranceCap);
-        entranceLines.back() = "...";
-    }
+    // Triage and entrance columns are capped to the waiting-room height; overflow shows an ellipsis.
+    auto regLines = stageLines(state, Stage::TriageQueue, static_cast<size_t>(colTriage - 2), waitingHeight);
+    auto entranceLines = stageLines(state, Stage::OutsideQueue, static_cast<size_t>(colEntrance - 2), waitingHeight);
 
     size_t rows = std::max({waitingHeight, regLines.size(), entranceLines.size()});
     if (rows < minRows) rows = minRows;
@@ -141,38 +169,44 @@ void renderTopSection(const VisualizationState& state) {
         std::string w = i < waitingLines.size() ? waitingLines[i] : "";
         std::string r = i < regLines.size() ? regLines[i] : "";
         std::string e = i < entranceLines.size() ? entranceLines[i] : "";
-        std::cout << "|" << padded(w, colWaiting)
+        out << "|" << padded(w, colWaiting)
                   << "|" << padded(r, colTriage)
                   << "|" << padded(e, colEntrance) << "|\n";
     }
 }
 
 // Render the trailing set of recent log actions (see header).
-void renderActions(const VisualizationState& state) {
+void renderActions(const VisualizationState& state, std::ostream& out) {
     const int totalWidth = 118;
     const int rightWidth = 30;
     const int leftWidth = totalWidth - rightWidth - 3;
     std::string separator(totalWidth, '-');
-    std::cout << separator << "\n";
-    std::cout << "|" << padded(" LAST ACTIONS", leftWidth) << "|" << padded("", rightWidth) << "|\n";
+    out << separator << "\n";
+    out << "|" << padded(" LAST ACTIONS", leftWidth) << "|" << padded("", rightWidth) << "|\n";
     size_t actionsToShow = std::min<size_t>(state.lastActions.size(), 10);
     for (size_t i = 0; i < actionsToShow; ++i) {
         const std::string& act = state.lastActions[state.lastActions.size() - actionsToShow + i];
-        std::cout << "|" << padded(act, leftWidth) << "|" << padded("", rightWidth) << "|\n";
+        out << "|" << padded(act, leftWidth) << "|" << padded("", rightWidth) << "|\n";
     }
     std::string border(totalWidth, '=');
-    std::cout << border << "\n";
+    out << border << "\n";
 }
 
 // Render specialist queues/active patients and per-specialist stats (see header).
-void renderSpecialists(const VisualizationState& state) {
+void renderSpecialists(const VisualizationState& state, std::ostream& out) {
     const int totalWidth = 118;
     const int colWidth = totalWidth / 3 - 1;
+    const size_t colText = static_cast<size_t>(colWidth - 2);
     std::array<std::vector<const PatientView*>, 6> queues{};
     std::array<std::vector<const PatientView*>, 6> active{};
+    auto leaveCount = [&](int idx) {
+        return static_cast<int>(std::count_if(state.doctors[idx].begin(), state.doctors[idx].end(),
+                                              [](const DoctorView& d) { return d.onLeave; }));
+    };
+    // Red background only when every doctor of the specialty is away.
     auto specialistLabel = [&](int idx) {
         SpecialistType type = static_cast<SpecialistType>(idx);
-        if (state.specialistOnLeave[idx]) {
+        if (!state.doctors[idx].empty() && leaveCount(idx) == static_cast<int>(state.doctors[idx].size())) {
             const char* reset = "\033[0m";
             const char* bg = "\033[41m";
             const char* fg = "\033[97m";
@@ -181,35 +215,24 @@ void renderSpecialists(const VisualizationState& state) {
         return specialistNameColored(type);
     };
 
-    for (const auto& kv : state.patients) {
-        const auto& p = kv.second;
-        if (p.specialist == SpecialistType::None) continue;
-        int idx = static_cast<int>(p.specialist);
-        if (idx < 0 || idx >= 6) continue;
-        if (p.stage == Stage::SpecialistQueue) queues[idx].push_back(&p);
-        else if (p.stage == Stage::SpecialistActive) active[idx].push_back(&p);
-    }
     for (int i = 0; i < 6; ++i) {
-        std::sort(queues[i].begin(), queues[i].end(), [](const PatientView* a, const PatientView* b) {
-            return a->id < b->id;
-        });
-        std::sort(active[i].begin(), active[i].end(), [](const PatientView* a, const PatientView* b) {
-            return a->id < b->id;
-        });
+        queues[i] = collectAtSpecialist(state, i, false, labelBudget(colText, kSpecialistQueueRows));
+        active[i] = collectAtSpecialist(state, i, true, labelBudget(colText, 1));
     }
 
-    std::cout << "|" << padded(" SPECIALISTS", totalWidth - 2) << "|\n";
+    out << "|" << padded(" SPECIALISTS", totalWidth - 2) << "|\n";
     for (int row = 0; row < 2; ++row) {
         std::array<std::string, 3> headers{};
         for (int col = 0; col < 3; ++col) {
             int idx = row * 3 + col;
             if (idx >= 6) continue;
             std::stringstream ss;
-            ss << specialistLabel(idx) << " pid=" << state.specialistPids[idx] << " q="
-               << queues[idx].size() << " act=" << active[idx].size();
+            SpecialistType type = static_cast<SpecialistType>(idx);
+            ss << specialistLabel(idx) << " dr=" << state.doctors[idx].size() << " away=" << leaveCount(idx) << " q="
+               << state.patients.specialistCount(type, false) << " act=" << state.patients.specialistCount(type, true);
             headers[col] = padded(ss.str(), colWidth);
         }
-        std::cout << "|" << headers[0] << "|" << headers[1] << "|" << headers[2] << "|\n";
+        out << "|" << headers[0] << "|" << headers[1] << "|" << headers[2] << "|\n";
 
         // stats line per specialist directly under header
         std::array<std::string, 3> statVals{};
@@ -224,7 +247,22 @@ void renderSpecialists(const VisualizationState& state) {
             ss << "Handled=" << handled << " H/W/O " << h << "/" << w << "/" << o;
             statVals[col] = padded(ss.str(), colWidth);
         }
-        std::cout << "|" << statVals[0] << "|" << statVals[1] << "|" << statVals[2] << "|\n";
+        out << "|" << statVals[0] << "|" << statVals[1] << "|" << statVals[2] << "|\n";
+
+        // utilization per doctor in doctor-index order; "L" marks a doctor on leave
+        std::array<std::string, 3> utilVals{};
+        for (int col = 0; col < 3; ++col) {
+            int idx = row * 3 + col;
+            if (idx >= 6) continue;
+            std::stringstream ss;
+            ss << "Util%";
+            for (const DoctorView& doctor : state.doctors[idx]) {
+                ss << " " << static_cast<int>(doctor.utilization(state.latestSimTime) * 100.0 + 0.5)
+                   << (doctor.onLeave ? "L" : "");
+            }
+            utilVals[col] = padded(ss.str(), colWidth);
+        }
+        out << "|" << utilVals[0] << "|" << utilVals[1] << "|" << utilVals[2] << "|\n";
 
         // queue header line
         std::array<std::string, 3> queueHdr{};
@@ -233,7 +271,7 @@ void renderSpecialists(const VisualizationState& state) {
             if (idx >= 6) continue;
             queueHdr[col] = padded("Queue", colWidth);
         }
-        std::cout << "|" << queueHdr[0] << "|" << queueHdr[1] << "|" << queueHdr[2] << "|\n";
+        out << "|" << queueHdr[0] << "|" << queueHdr[1] << "|" << queueHdr[2] << "|\n";
 
         // queue lines
         std::array<std::vector<std::string>, 3> queueLines{};
@@ -243,7 +281,9 @@ void renderSpecialists(const VisualizationState& state) {
             if (idx >= 6) continue;
             std::vector<std::string> tokens;
             for (auto* p : queues[idx]) tokens.push_back(formatPatientLabel(*p, Stage::SpecialistQueue));
-            queueLines[col] = wrapTokens(tokens, static_cast<size_t>(colWidth - 2));
+            queueLines[col] = wrapTokens(tokens, colText);
+            capLines(queueLines[col], kSpecialistQueueRows,
+                     queues[idx].size() < state.patients.specialistCount(static_cast<SpecialistType>(idx), false));
             queueHeights[col] = queueLines[col].size();
         }
         size_t maxQueueRows = std::max({queueHeights[0], queueHeights[1], queueHeights[2]});
@@ -253,7 +293,7 @@ void renderSpecialists(const VisualizationState& state) {
                 rowVals[col] = r < queueLines[col].size() ? queueLines[col][r] : "";
                 rowVals[col] = padded(rowVals[col], colWidth);
             }
-            std::cout << "|" << rowVals[0] << "|" << rowVals[1] << "|" << rowVals[2] << "|\n";
+            out << "|" << rowVals[0] << "|" << rowVals[1] << "|" << rowVals[2] << "|\n";
         }
 
         // active line
@@ -274,23 +314,20 @@ void renderSpecialists(const VisualizationState& state) {
             }
             actVals[col] = padded(combined, colWidth);
         }
-        std::cout << "|" << actHdr[0] << "|" << actHdr[1] << "|" << actHdr[2] << "|\n";
-        std::cout << "|" << actVals[0] << "|" << actVals[1] << "|" << actVals[2] << "|\n";
+        out << "|" << actHdr[0] << "|" << actHdr[1] << "|" << actHdr[2] << "|\n";
+        out << "|" << actVals[0] << "|" << actVals[1] << "|" << actVals[2] << "|\n";
 
         // separator between specialist rows for readability
         std::string sep(colWidth, '-');
-        std::cout << "|" << padded(sep, colWidth) << "|" << padded(sep, colWidth) << "|" << padded(sep, colWidth) << "|\n";
+        out << "|" << padded(sep, colWidth) << "|" << padded(sep, colWidth) << "|" << padded(sep, colWidth) << "|\n";
     }
     std::string border(totalWidth, '=');
-    std::cout << border << "\n";
+    out << border << "\n";
 }
 
-// Full frame render: clears screen then draws all sections (see header).
-void render(const VisualizationState& state) {
-    // Clear screen (including scrollback) and move cursor home so each frame replaces the previous one.
-    std::cout << "\033[H\033[2J\033[3J";
-    renderTopSection(state);
-    renderActions(state);
-    renderSpecialists(state);
-    std::cout.flush();
+// Full frame text: all sections, top to bottom (see header).
+void renderFrame(const VisualizationState& state, std::ostream& out) {
+    renderTopSection(state, out);
+    renderActions(state, out);
+    renderSpecialists(state, out);
 }
@@ -1,62 +1,113 @@
 #include "visualization/state.hpp"
 
+#include "logging/binary_log.hpp"
+#include "model/sim_rules.hpp"
+
 #include <algorithm>
+#include <charconv>
+#include <string_view>
 
-PatientView& ensurePatient(VisualizationState& state, int patientId) {
-    auto it = state.patients.find(patientId);
-    if (it == state.patients.end()) {
-        PatientView pv;
-        pv.id = patientId;
-        auto res = state.patients.emplace(patientId, pv);
-        return res.first->second;
-    }
-    return it->second;
+double DoctorView::utilization(int nowSim) const {
+    long long busy = busyMinutes + (busySince >= 0 ? std::max(0, nowSim - busySince) : 0);
+    int span = nowSim - startSim;
+    return span > 0 ? std::min(1.0, static_cast<double>(busy) / span) : 0.0;
+}
+
+PatientView* ensurePatient(VisualizationState& state, int patientId) {
+    return state.patients.ensure(patientId);
 }
 
 namespace {
 void trackRegistrationLifecycle(const LogEntry& entry, VisualizationState& state) {
-    if (entry.role == "reg1") {
-        if (entry.text.find("started") != std::string::npos) state.reg1Active = true;
-        if (entry.text.find("shutting down") != std::string::npos) state.reg1Active = false;
+    switch (entry.kind) {
+        case MessageKind::RegistrationStarted:
+        case MessageKind::RegistrationStopping: {
+            bool active = entry.kind == MessageKind::RegistrationStarted;
+            if (entry.roleKind == LogRole::Registration1) state.reg1Active = active;
+            if (entry.roleKind == LogRole::Registration2) {
+                state.poolWindowsOpen = active ? state.poolWindowsOpen + 1 : std::max(0, state.poolWindowsOpen - 1);
+            }
+            break;
+        }
+        case MessageKind::TriageStarted: state.triageWorkersActive++; break;
+        case MessageKind::TriageStopping: state.triageWorkersActive = std::max(0, state.triageWorkersActive - 1); break;
+        default: break;
     }
-    if (entry.role == "reg2") {
-        if (entry.text.find("Registration2 started") != std::string::npos) state.reg2Active = true;
-        if (entry.text.find("Registration2 shutting down") != std::string::npos) state.reg2Active = false;
+}
+
+DoctorView* doctorByPid(VisualizationState& state, int pid) {
+    if (pid <= 0) return nullptr;
+    for (auto& doctors : state.doctors) {
+        for (DoctorView& doctor : doctors) {
+            if (doctor.pid == pid) return &doctor;
+        }
     }
-    if (entry.role == "triage") {
-        if (entry.text.find("Triage started") != std::string::npos) state.triageActive = true;
-        if (entry.text.find("Triage shutting down") != std::string::npos) state.triageActive = false;
+    return nullptr;
+}
+
+/** @brief Register (or restart) the doctor named by a "Specialist <Name> doctor N started" line. */
+void trackDoctorStart(const LogEntry& entry, VisualizationState& state) {
+    SpecialistType t = specialistFromLabel(entry.text);
+    if (t == SpecialistType::None) return;
+    int index = 0;
+    extractInt(entry.text, "doctor ", index);
+    std::vector<DoctorView>& doctors = state.doctors[static_cast<int>(t)];
+    auto it = std::find_if(doctors.begin(), doctors.end(), [&](const DoctorView& d) { return d.index == index; });
+    if (it == doctors.end()) {
+        it = doctors.insert(std::find_if(doctors.begin(), doctors.end(),
+                                         [&](const DoctorView& d) { return d.index > index; }),
+                            DoctorView{});
     }
+    *it = DoctorView{};
+    it->pid = entry.pid;
+    it->index = index;
+    it->startSim = entry.simTime;
+}
+
+/** @brief Append decimal value without going through std::to_string. */
+void appendInt(std::string& out, int value) {
+    char buf[16];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, static_cast<size_t>(res.ptr - buf));
 }
 
-int specialistIndexByPid(const VisualizationState& state, int pid) {
-    if (pid <= 0) return -1;
-    for (int i = 0; i < kSpecialistCount; ++i) {
-        if (state.specialistPids[i] == pid) return i;
+/** @brief Typed field of a binary record (absent when -1), or the "key=" value of a text line. */
+bool readField(const LogEntry& entry, std::string_view key, int typedValue, int& out) {
+    if (entry.typed) {
+        if (typedValue < 0) return false;
+        out = typedValue;
+        return true;
+    }
+    return extractInt(entry.text, key, out);
+}
+
+void readColorAndSpecialist(const LogEntry& entry, std::string_view specKey, PatientView& pv) {
+    int colorVal = 3;
+    if (readField(entry, "color=", entry.fields.color, colorVal)) {
+        pv.color = colorFromInt(colorVal);
+    }
+    int specVal = -1;
+    if (readField(entry, specKey, entry.fields.specialist, specVal)) {
+        pv.specialist = specialistFromInt(specVal);
     }
-    return -1;
 }
 } // namespace
 
 void applyPatientUpdate(const LogEntry& entry, VisualizationState& state) {
-    auto isPatientFlowRole = [](const std::string& role) {
-        return role == "patient" ||
-               role == "triage" ||
-               role == "specialist" ||
-               role == "reg1" ||
-               role == "reg2";
-    };
-    if (!isPatientFlowRole(entry.role)) {
+    if (!isPatientFlowKind(entry.kind)) {
         return;
     }
 
-    int patientId = -1;
-    if (!extractInt(entry.text, "id=", patientId)) {
+    if (entry.patientId < 0) {
         return;
     }
-    PatientView& pv = ensurePatient(state, patientId);
+    PatientView* found = ensurePatient(state, entry.patientId);
+    if (!found) {
+        return;  // late line for a patient that already left the SOR
+    }
+    PatientView& pv = *found;
     pv.pid = entry.pid;
-    if (entry.role == "patient" && entry.pid > 0 && pv.patientPid == 0) {
+    if (entry.roleKind == LogRole::Patient && entry.pid > 0 && pv.patientPid == 0) {
         pv.patientPid = entry.pid;
     }
     pv.lastSimTime = entry.simTime;
@@ -85,139 +136,131 @@ void applyPatientUpdate(const LogEntry& entry, VisualizationState& state) {
         }
     };
 
-    if (entry.text.find("waiting to enter waiting room") != std::string::npos) {
-        extractInt(entry.text, "persons=", pv.persons);
-        setStage(Stage::OutsideQueue);
-        return;
-    }
+    switch (entry.kind) {
+        case MessageKind::PatientWaitingOutside:
+            readField(entry, "persons=", entry.fields.persons, pv.persons);
+            setStage(Stage::OutsideQueue);
+            break;
 
-    if (entry.text.find("Patient arrived") != std::string::npos) {
-        extractInt(entry.text, "persons=", pv.persons);
-        int vipVal = 0;
-        if (extractInt(entry.text, "vip=", vipVal)) {
-            pv.isVip = vipVal != 0;
-        }
-        int guardianVal = 0;
-        if (extractInt(entry.text, "guardian=", guardianVal)) {
-            pv.hasGuardian = guardianVal != 0;
+        case MessageKind::PatientArrived: {
+            readField(entry, "persons=", entry.fields.persons, pv.persons);
+            int vipVal = 0;
+            if (readField(entry, "vip=", entry.fields.vip, vipVal)) {
+                pv.isVip = vipVal != 0;
+            }
+            int guardianVal = 0;
+            if (readField(entry, "guardian=", entry.fields.guardian, guardianVal)) {
+                pv.hasGuardian = guardianVal != 0;
+            }
+            setStage(Stage::WaitingRoom);
+            pv.color = TriageColor::None;
+            break;
         }
-        setStage(Stage::WaitingRoom);
-        pv.color = TriageColor::None;
-        return;
-    }
 
-    if (entry.text.find("Patient registered") != std::string::npos) {
-        setStage(Stage::RegistrationQueue);
-        return;
-    }
+        case MessageKind::PatientRegistered:
+            setStage(Stage::RegistrationQueue);
+            break;
 
-    if ((entry.role == "reg1" || entry.role == "reg2") &&
-        entry.text.find("Registering patient") != std::string::npos) {
-        setStage(Stage::RegistrationQueue);
-        pv.registrationInProgress = true;
-        pv.registrationWindow = entry.role;
-        return;
-    }
+        case MessageKind::RegisteringPatient:
+            setStage(Stage::RegistrationQueue);
+            pv.registrationInProgress = true;
+            pv.registrationWindow = entry.role;
+            break;
 
-    if ((entry.role == "reg1" || entry.role == "reg2") &&
-        entry.text.find("Forwarded patient") != std::string::npos) {
-        setStage(Stage::TriageQueue);
-        pv.registrationInProgress = false;
-        pv.registrationWindow.clear();
-        extractInt(entry.text, "persons=", pv.persons);
-        int vipVal = 0;
-        if (extractInt(entry.text, "vip=", vipVal)) {
-            pv.isVip = vipVal != 0;
+        case MessageKind::RegistrationForwarded: {
+            setStage(Stage::TriageQueue);
+            pv.registrationInProgress = false;
+            pv.registrationWindow.clear();
+            readField(entry, "persons=", entry.fields.persons, pv.persons);
+            int vipVal = 0;
+            if (readField(entry, "vip=", entry.fields.vip, vipVal)) {
+                pv.isVip = vipVal != 0;
+            }
+            break;
         }
-        return;
-    }
 
-    if ((entry.role == "reg1" || entry.role == "reg2") &&
-        entry.text.find("Dropped patient") != std::string::npos) {
-        pv.registrationInProgress = false;
-        pv.registrationWindow.clear();
-        return;
-    }
+        case MessageKind::RegistrationDropped:
+            pv.registrationInProgress = false;
+            pv.registrationWindow.clear();
+            break;
 
-    if (entry.role == "triage" &&
-        entry.text.find("Forwarded patient") != std::string::npos) {
-        pv.stage = Stage::SpecialistQueue;
-        int colorVal = 3;
-        if (extractInt(entry.text, "color=", colorVal)) {
-            pv.color = colorFromInt(colorVal);
-        }
-        int specVal = -1;
-        if (extractInt(entry.text, "specialist=", specVal)) {
-            pv.specialist = specialistFromInt(specVal);
-            switch (pv.color) {
-                case TriageColor::Red: state.triageRed++; break;
-                case TriageColor::Yellow: state.triageYellow++; break;
-                case TriageColor::Green: state.triageGreen++; break;
-                default: break;
+        case MessageKind::TriageForwarded: {
+            pv.stage = Stage::SpecialistQueue;
+            int colorVal = 3;
+            if (readField(entry, "color=", entry.fields.color, colorVal)) {
+                pv.color = colorFromInt(colorVal);
+            }
+            int specVal = -1;
+            if (readField(entry, "specialist=", entry.fields.specialist, specVal)) {
+                pv.specialist = specialistFromInt(specVal);
+                switch (pv.color) {
+                    case TriageColor::Red: state.triageRed++; break;
+                    case TriageColor::Yellow: state.triageYellow++; break;
+                    case TriageColor::Green: state.triageGreen++; break;
+                    default: break;
+                }
             }
+            readField(entry, "persons=", entry.fields.persons, pv.persons);
+            break;
         }
-        extractInt(entry.text, "persons=", pv.persons);
-        return;
-    }
 
-    if (entry.text.find("Patient sent home from triage") != std::string::npos) {
-        setStage(Stage::SentHome);
-        pv.specialist = SpecialistType::None;
-        pv.color = TriageColor::None;
-        state.triageSentHome++;
-        return;
-    }
+        case MessageKind::TriageSentHome:
+            setStage(Stage::SentHome);
+            pv.specialist = SpecialistType::None;
+            pv.color = TriageColor::None;
+            state.triageSentHome++;
+            break;
 
-    if (entry.role == "specialist" &&
-        entry.text.find("Received patient") != std::string::npos) {
-        setStage(Stage::SpecialistActive);
-        int colorVal = 3;
-        if (extractInt(entry.text, "color=", colorVal)) {
-            pv.color = colorFromInt(colorVal);
-        }
-        int specVal = -1;
-        if (extractInt(entry.text, "specIdx=", specVal)) {
-            pv.specialist = specialistFromInt(specVal);
-        }
-        extractInt(entry.text, "persons=", pv.persons);
-        return;
-    }
+        case MessageKind::SpecialistReceived:
+            setStage(Stage::SpecialistActive);
+            readColorAndSpecialist(entry, "specIdx=", pv);
+            readField(entry, "persons=", entry.fields.persons, pv.persons);
+            if (DoctorView* doctor = doctorByPid(state, entry.pid)) doctor->busySince = entry.simTime;
+            break;
 
-    if (entry.role == "specialist" &&
-        entry.text.find("Handled patient") != std::string::npos) {
-        setStage(Stage::Done);
-        int colorVal = 3;
-        if (extractInt(entry.text, "color=", colorVal)) {
-            pv.color = colorFromInt(colorVal);
-        }
-        int specVal = -1;
-        if (extractInt(entry.text, "specIdx=", specVal)) {
-            pv.specialist = specialistFromInt(specVal);
-        }
-        extractInt(entry.text, "persons=", pv.persons);
-        size_t pos = entry.text.find("outcome=");
-        if (pos != std::string::npos) {
-            pv.outcome = entry.text.substr(pos + 8);
-            auto space = pv.outcome.find(' ');
-            if (space != std::string::npos) {
-                pv.outcome = pv.outcome.substr(0, space);
+        case MessageKind::SpecialistHandled: {
+            setStage(Stage::Done);
+            readColorAndSpecialist(entry, "specIdx=", pv);
+            readField(entry, "persons=", entry.fields.persons, pv.persons);
+            size_t pos = entry.typed ? std::string_view::npos : entry.text.find("outcome=");
+            if (entry.typed && entry.fields.outcome >= 0) {
+                pv.outcome.assign(outcomeLabel(static_cast<Outcome>(entry.fields.outcome)));
+            } else if (pos != std::string_view::npos) {
+                std::string_view outcome = entry.text.substr(pos + 8);
+                pv.outcome.assign(outcome.substr(0, outcome.find(' ')));
             }
-        }
-        SpecialistType specType = pv.specialist;
-        if (specType != SpecialistType::None) {
-            int idx = static_cast<int>(specType);
-            state.specialistHandled[idx]++;
-            if (pv.outcome == "home") {
-                state.specialistHome[idx]++;
-                state.outcomeHome++;
-            } else if (pv.outcome == "ward") {
-                state.specialistWard[idx]++;
-                state.outcomeWard++;
-            } else {
-                state.specialistOther[idx]++;
-                state.outcomeOther++;
+            if (DoctorView* doctor = doctorByPid(state, entry.pid)) {
+                if (doctor->busySince >= 0) doctor->busyMinutes += std::max(0, entry.simTime - doctor->busySince);
+                doctor->busySince = -1;
+                doctor->handled++;
+            }
+            SpecialistType specType = pv.specialist;
+            if (specType != SpecialistType::None) {
+                int idx = static_cast<int>(specType);
+                state.specialistHandled[idx]++;
+                if (pv.outcome == "home") {
+                    state.specialistHome[idx]++;
+                    state.outcomeHome++;
+                } else if (pv.outcome == "ward") {
+                    state.specialistWard[idx]++;
+                    state.outcomeWard++;
+                } else {
+                    state.specialistOther[idx]++;
+                    state.outcomeOther++;
+                }
             }
+            break;
         }
+
+        default:
+            break;
+    }
+
+    // Outcomes are already counted above; keep only patients that are still inside.
+    if (pv.stage == Stage::Done || pv.stage == Stage::SentHome) {
+        state.patients.finish(pv.id);
+    } else {
+        state.patients.reindex(pv);
     }
 }
 
@@ -234,49 +277,54 @@ void applyLogEntry(const LogEntry& entry, VisualizationState& state) {
     }
 
     auto markLeave = [&](int pid, bool onLeave) {
-        int idx = specialistIndexByPid(state, pid);
-        if (idx >= 0) {
-            state.specialistOnLeave[idx] = onLeave;
+        if (DoctorView* doctor = doctorByPid(state, pid)) {
+            doctor->onLeave = onLeave;
         }
     };
 
-    if (entry.role == "specialist" && entry.text.find("started") != std::string::npos) {
-        SpecialistType t = specialistFromLabel(entry.text);
-        if (t != SpecialistType::None) {
-            state.specialistPids[static_cast<int>(t)] = entry.pid;
-            state.specialistOnLeave[static_cast<int>(t)] = false;
-        }
-    }
-
-    if (entry.role == "director" && entry.text.find("SIGUSR1") != std::string::npos) {
-        int pid = -1;
-        if (extractInt(entry.text, "pid=", pid)) {
-            markLeave(pid, true);
+    switch (entry.kind) {
+        case MessageKind::SpecialistStarted:
+            trackDoctorStart(entry, state);
+            break;
+        case MessageKind::DirectorSentLeave: {
+            int pid = -1;
+            if (readField(entry, "pid=", entry.fields.subject, pid)) {
+                markLeave(pid, true);
+            }
+            break;
         }
+        case MessageKind::SpecialistLeaveFinished:
+            markLeave(entry.pid, false);
+            break;
+        default:
+            break;
     }
 
-    if (entry.role == "specialist" &&
-        entry.text.find("SIGUSR1: temporary leave finished") != std::string::npos) {
-        markLeave(entry.pid, false);
-    }
-
-    std::string action = "[" + std::to_string(entry.simTime) + "] " + entry.role + ": " + entry.text;
-    state.lastActions.push_back(action);
-    const size_t maxActions = 14;
-    while (state.lastActions.size() > maxActions) {
-        state.lastActions.pop_front();
+    // "[simTime] role: text" written into a reused slot.
+    std::string& action = state.lastActions.pushSlot();
+    action.push_back('[');
+    appendInt(action, entry.simTime);
+    action.append("] ");
+    action.append(entry.role);
+    action.append(": ");
+    if (entry.typed) {
+        char text[160];
+        action.append(text, formatEventText(entry.fields, text, sizeof(text)));
+    } else {
+        action.append(entry.text);
     }
 
     trackRegistrationLifecycle(entry, state);
     applyPatientUpdate(entry, state);
 }
 
-std::vector<const PatientView*> collectPatientsByStage(const VisualizationState& state, Stage stage) {
+std::vector<const PatientView*> collectPatientsByStage(const VisualizationState& state, Stage stage, size_t limit) {
     std::vector<const PatientView*> list;
-    for (const auto& kv : state.patients) {
-        if (kv.second.stage == stage) {
-            list.push_back(&kv.second);
-        }
-    }
+    list.reserve(std::min(limit, state.patients.stageCount(stage)));
+    state.patients.forEachInStage(stage, [&](const PatientView& pv) {
+        if (list.size() >= limit) return false;
+        list.push_back(&pv);
+        return true;
+    });
     return list;
 }
@@ -0,0 +1,195 @@
+#include "visualization/terminal_canvas.hpp"
+
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+constexpr const char* kClearScreen = "\033[H\033[2J\033[3J";
+constexpr const char* kHideCursor = "\033[?25l";
+constexpr const char* kShowCursor = "\033[?25h";
+constexpr const char* kResetStyle = "\033[0m";
+/** @brief Unchanged cells between two changed spans that are cheaper to rewrite than to skip with a cursor move. */
+constexpr size_t kMaxRewriteGap = 6;
+/**
+ * @brief Every this many frames the canvas redraws fully, repairing anything other processes
+ * printed onto the same terminal.
+ */
+constexpr uint64_t kFullRedrawEveryFrames = 256;
+} // namespace
+
+bool TerminalCanvas::Cell::operator==(const Cell& other) const {
+    return len == other.len && style == other.style && std::memcmp(glyph, other.glyph, len) == 0;
+}
+
+TerminalCanvas::TerminalCanvas(int fd) : fd_(fd) {}
+
+TerminalCanvas::~TerminalCanvas() {
+    if (frames_ > 0) {
+        out_.assign(kResetStyle);
+        out_ += kShowCursor;
+        writeAll();
+    }
+}
+
+uint16_t TerminalCanvas::internStyle(const std::string& sgr) {
+    auto it = styleIds_.find(sgr);
+    if (it != styleIds_.end()) {
+        return it->second;
+    }
+    uint16_t id = static_cast<uint16_t>(styles_.size());
+    styles_.push_back(sgr);
+    styleIds_.emplace(sgr, id);
+    return id;
+}
+
+// Split the frame into rows of cells. SGR sequences accumulate into the current style until a reset
+// ("\033[0m" / "\033[m"); other escape sequences and control bytes are dropped.
+void TerminalCanvas::parse(std::string_view frame, std::vector<Row>& rows) {
+    size_t rowCount = static_cast<size_t>(std::count(frame.begin(), frame.end(), '\n'));
+    if (!frame.empty() && frame.back() != '\n') ++rowCount;
+    rows.resize(rowCount);
+    for (Row& row : rows) row.clear();
+
+    std::string sgr;
+    uint16_t style = 0;
+    size_t r = 0;
+    for (size_t i = 0; i < frame.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(frame[i]);
+        if (c == '\n') {
+            ++r;
+            continue;
+        }
+        if (c == '\033') {
+            if (i + 1 < frame.size() && frame[i + 1] == '[') {
+                size_t end = i + 2;
+                while (end < frame.size() && !(frame[end] >= 0x40 && frame[end] <= 0x7e)) ++end;
+                if (end < frame.size() && frame[end] == 'm') {
+                    std::string_view params = frame.substr(i + 2, end - i - 2);
+                    if (params.empty() || params == "0") {
+                        sgr.clear();
+                    } else {
+                        sgr.append(frame.substr(i, end - i + 1));
+                    }
+                    style = internStyle(sgr);
+                }
+                i = end;
+            } else {
+                ++i;
+            }
+            continue;
+        }
+        if (c < 0x20 || c == 0x7f) {
+            continue;
+        }
+        Row& row = rows[r];
+        if ((c & 0xc0) == 0x80 && !row.empty() && row.back().len < 4) {
+            Cell& last = row.back();
+            last.glyph[last.len++] = static_cast<char>(c);  // UTF-8 continuation byte
+            continue;
+        }
+        Cell cell;
+        cell.glyph[0] = static_cast<char>(c);
+        cell.style = style;
+        row.push_back(cell);
+    }
+}
+
+void TerminalCanvas::emitStyle(uint16_t style) {
+    if (style == outStyle_) return;
+    out_ += kResetStyle;
+    out_ += styles_[style];
+    outStyle_ = style;
+}
+
+void TerminalCanvas::emitCursor(size_t row, size_t col) {
+    char buf[32];
+    int n = std::snprintf(buf, sizeof(buf), "\033[%zu;%zuH", row + 1, col + 1);
+    out_.append(buf, static_cast<size_t>(n));
+}
+
+bool TerminalCanvas::writeAll() {
+    const char* p = out_.data();
+    size_t left = out_.size();
+    while (left > 0) {
+        ssize_t n = ::write(fd_, p, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        left -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+TerminalCanvas::FrameStats TerminalCanvas::present(std::string_view frame) {
+    FrameStats stats;
+    stats.fullBytes = std::strlen(kClearScreen) + frame.size();
+    parse(frame, back_);
+    out_.clear();
+    if (frames_ % kFullRedrawEveryFrames == 0) {
+        valid_ = false;
+    }
+
+    if (!valid_) {
+        out_ += kHideCursor;
+        out_ += kClearScreen;
+        outStyle_ = 0;
+        for (size_t r = 0; r < back_.size(); ++r) {
+            for (const Cell& cell : back_[r]) {
+                emitStyle(cell.style);
+                out_.append(cell.glyph, cell.len);
+            }
+            stats.changedCells += back_[r].size();
+            emitStyle(0);
+            out_ += "\r\n";
+        }
+    } else {
+        const Row empty;
+        size_t rowCount = std::max(back_.size(), front_.size());
+        for (size_t r = 0; r < rowCount; ++r) {
+            const Row& now = r < back_.size() ? back_[r] : empty;
+            const Row& before = r < front_.size() ? front_[r] : empty;
+            size_t col = 0;
+            while (col < now.size()) {
+                if (col < before.size() && now[col] == before[col]) {
+                    ++col;
+                    continue;
+                }
+                // Extend the span over later changes separated by short unchanged gaps.
+                size_t last = col;
+                for (size_t j = col + 1; j < now.size() && j - last <= kMaxRewriteGap; ++j) {
+                    if (j >= before.size() || now[j] != before[j]) last = j;
+                }
+                emitCursor(r, col);
+                for (size_t j = col; j <= last; ++j) {
+                    if (j >= before.size() || now[j] != before[j]) ++stats.changedCells;
+                    emitStyle(now[j].style);
+                    out_.append(now[j].glyph, now[j].len);
+                }
+                col = last + 1;
+            }
+            if (before.size() > now.size()) {
+                // Old row was longer: erase its tail.
+                emitCursor(r, now.size());
+                emitStyle(0);
+                out_ += "\033[K";
+                stats.changedCells += before.size() - now.size();
+            }
+        }
+        emitStyle(0);
+        emitCursor(back_.size(), 0);
+    }
+
+    bool written = writeAll();
+    valid_ = written;  // after a failed or partial write the screen state is unknown
+    std::swap(front_, back_);
+    stats.bytes = out_.size();
+    ++frames_;
+    totalBytes_ += stats.bytes;
+    totalFullBytes_ += stats.fullBytes;
+    return stats;
+}
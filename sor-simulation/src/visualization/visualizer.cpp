@@ -1,25 +1,48 @@
 #include "visualization/visualizer.hpp"
 
+#include "visualization/binary_log_reader.hpp"
 #include "visualization/log_parser.hpp"
+#include "visualization/log_tail.hpp"
 #include "visualization/renderer.hpp"
 #include "visualization/state.hpp"
+#include "visualization/terminal_canvas.hpp"
+#include "visualization/triple_buffer.hpp"
 
+#include <unistd.h>
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <csignal>
-#include <fstream>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <thread>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 namespace {
 std::atomic<bool> g_stop(false);
+std::atomic<bool> g_resized(false);
 constexpr int kDefaultRenderIntervalMs = 200;
+/** @brief Ingest re-checks the stop flag at least this often while the log is idle. */
+constexpr int kIngestIdleWaitMs = 100;
+/** @brief Lines applied between checks whether the render thread is waiting for a snapshot. */
+constexpr uint64_t kSnapshotCheckLines = 256;
 
 void handleSigint(int) {
     g_stop.store(true);
 }
 
+void handleSigwinch(int) {
+    g_resized.store(true);
+}
+
+/**
+ * @brief Two-stage visualizer: the ingest thread owns the log tail and the live state, the render
+ * thread (the caller of run()) draws published snapshots at the configured interval.
+ */
 class VisualizerApp {
 public:
     VisualizerApp(std::string logPath, int renderIntervalMs)
@@ -30,72 +53,213 @@ public:
 
 private:
     bool waitForLog();
-    bool pumpLines();
-    void maybeRender(bool advanced);
+    void ingestLoop();
+    bool detectFormat();
+    void pumpLog();
+    void pumpLines();
+    void pumpRecords();
+    void entryApplied();
+    void publishSnapshot();
+    void renderLoop();
+    void renderNow(const VisualizationState& snapshot);
+    void reportOutput() const;
 
     std::string logPath_;
-    std::ifstream in_;
-    VisualizationState state_;
     int renderIntervalMs_;
-    std::chrono::steady_clock::time_point lastRender_{std::chrono::steady_clock::now()};
+
+    // Ingest thread only.
+    LogTail tail_;
+    LogFormat format_{LogFormat::Unknown};
+    VisualizationState state_;
+    bool dirty_{false};
+    uint64_t linesApplied_{0};
+
+    // Handoff between the threads.
+    TripleBuffer<VisualizationState> snapshots_;
+    std::atomic<bool> snapshotWanted_{true};
+    std::atomic<bool> ingestBehind_{false};
+
+    // Render thread only.
+    TerminalCanvas canvas_{STDOUT_FILENO};
+    std::ostringstream frame_;
+    TerminalCanvas::FrameStats lastFrame_;
+    uint64_t droppedFrames_{0};
+    uint64_t lateFrames_{0};
 };
 
 bool VisualizerApp::waitForLog() {
     while (!g_stop.load()) {
-        in_.open(logPath_);
-        if (in_) break;
+        if (tail_.open(logPath_)) return true;
         std::this_thread::sleep_for(std::chrono::milliseconds(200));
     }
-    if (!in_) {
-        std::cerr << "Cannot open log file: " << logPath_ << std::endl;
-        return false;
+    std::cerr << "Cannot open log file: " << logPath_ << std::endl;
+    return false;
+}
+
+void VisualizerApp::publishSnapshot() {
+    snapshotWanted_.store(false, std::memory_order_relaxed);
+    snapshots_.writeBuffer() = state_;
+    snapshots_.publish();
+    dirty_ = false;
+}
+
+// The format is known once the first bytes are in: a digit starts a text line, the magic a binary log.
+bool VisualizerApp::detectFormat() {
+    size_t headerBytes = 0;
+    format_ = detectLogFormat(tail_.nextBytes(), headerBytes);
+    if (format_ == LogFormat::Binary) {
+        tail_.consume(headerBytes);
+    } else if (format_ == LogFormat::Unsupported) {
+        std::cerr << "Unsupported binary log version: " << logPath_ << std::endl;
+        g_stop.store(true);
+    }
+    return format_ == LogFormat::Text || format_ == LogFormat::Binary;
+}
+
+// Call after every applied line/record. During a backlog a snapshot is published as soon as the
+// render thread asks for one; once caught up (end of pumpLog) the latest state is always published.
+void VisualizerApp::entryApplied() {
+    if (++linesApplied_ % kSnapshotCheckLines == 0 && snapshotWanted_.load(std::memory_order_relaxed)) {
+        publishSnapshot();
+    }
+}
+
+void VisualizerApp::pumpLog() {
+    if (format_ == LogFormat::Unknown && !detectFormat()) {
+        return;
+    }
+    if (format_ == LogFormat::Binary) {
+        pumpRecords();
+    } else {
+        pumpLines();
+    }
+    ingestBehind_.store(false, std::memory_order_relaxed);
+    if (dirty_) {
+        publishSnapshot();
+    }
+}
+
+// Consume every complete line appended since the last call, parsing views straight from the mapping.
+void VisualizerApp::pumpLines() {
+    for (;;) {
+        const std::vector<std::string_view>& lines = tail_.nextLines();
+        if (lines.empty()) break;
+        ingestBehind_.store(true, std::memory_order_relaxed);
+        for (std::string_view line : lines) {
+            if (line.empty()) continue;
+            LogEntry entry;
+            if (parseLogLine(line, entry)) {
+                applyLogEntry(entry, state_);
+                dirty_ = true;
+            }
+            entryApplied();
+        }
     }
-    return true;
 }
 
-bool VisualizerApp::pumpLines() {
-    bool advanced = false;
-    std::string line;
-    while (std::getline(in_, line)) {
-        advanced = true;
-        if (line.empty()) continue;
+// Consume every complete binary record; a record cut off at the end of the window waits for the next call.
+void VisualizerApp::pumpRecords() {
+    for (;;) {
+        std::string_view bytes = tail_.nextBytes();
+        if (bytes.empty()) break;
+        ingestBehind_.store(true, std::memory_order_relaxed);
+        size_t consumed = 0;
+        size_t used = 0;
         LogEntry entry;
-        if (parseLogLine(line, entry)) {
+        while (readBinaryLogRecord(bytes.substr(consumed), used, entry)) {
             applyLogEntry(entry, state_);
+            dirty_ = true;
+            consumed += used;
+            entryApplied();
         }
+        tail_.consume(consumed);
+        if (consumed == 0) break;
+    }
+}
+
+void VisualizerApp::ingestLoop() {
+    while (!g_stop.load()) {
+        pumpLog();
+        if (g_stop.load()) break;
+        // Sleep until the logger appends (inotify); the timeout only bounds the stop-flag latency.
+        tail_.waitForChange(kIngestIdleWaitMs);
     }
-    if (in_.eof()) {
-        in_.clear();
+}
+
+// Build the frame text, append the output meter, and let the canvas write only what changed.
+void VisualizerApp::renderNow(const VisualizationState& snapshot) {
+    frame_.str(std::string());
+    renderFrame(snapshot, frame_);
+    uint64_t frames = canvas_.frames();
+    frame_ << " frame " << frames + 1 << " | last " << lastFrame_.bytes << " B (" << lastFrame_.changedCells
+           << " cells, full redraw " << lastFrame_.fullBytes << " B) | avg "
+           << (frames > 0 ? canvas_.totalBytes() / frames : 0) << " B/frame | dropped " << droppedFrames_
+           << " late " << lateFrames_ << "\n";
+    if (g_resized.exchange(false)) {
+        canvas_.invalidate();
     }
-    return advanced;
+    lastFrame_ = canvas_.present(frame_.str());
 }
 
-void VisualizerApp::maybeRender(bool advanced) {
-    auto now = std::chrono::steady_clock::now();
-    if (advanced || std::chrono::duration_cast<std::chrono::milliseconds>(now - lastRender_).count() > renderIntervalMs_) {
-        render(state_);
-        lastRender_ = now;
+// Fixed-rate frames. A tick without a new snapshot redraws nothing; if ingest is still working
+// through a backlog at that moment the frame counts as dropped. Ticks missed because a render
+// overran are counted as late and skipped rather than rendered in a burst.
+void VisualizerApp::renderLoop() {
+    using Clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::milliseconds(renderIntervalMs_);
+    auto nextTick = Clock::now();
+    bool drawn = false;
+    while (!g_stop.load()) {
+        bool fresh = snapshots_.acquire();
+        if (fresh) {
+            snapshotWanted_.store(true, std::memory_order_relaxed);
+        }
+        if (fresh || !drawn || g_resized.load()) {
+            renderNow(snapshots_.readBuffer());
+            drawn = true;
+        } else if (ingestBehind_.load(std::memory_order_relaxed)) {
+            ++droppedFrames_;
+        }
+
+        nextTick += interval;
+        auto now = Clock::now();
+        if (now > nextTick) {
+            auto missed = (now - nextTick) / interval + 1;
+            lateFrames_ += static_cast<uint64_t>(missed);
+            nextTick += interval * missed;
+        }
+        std::this_thread::sleep_until(nextTick);
     }
 }
 
+void VisualizerApp::reportOutput() const {
+    uint64_t frames = canvas_.frames();
+    if (frames == 0) return;
+    std::cerr << "Visualizer output: frames=" << frames << " bytes=" << canvas_.totalBytes()
+              << " avg=" << canvas_.totalBytes() / frames << " B/frame (full redraw avg "
+              << canvas_.totalFullBytes() / frames << " B/frame) dropped=" << droppedFrames_
+              << " late=" << lateFrames_ << " lines=" << linesApplied_ << std::endl;
+}
+
 int VisualizerApp::run() {
     if (!waitForLog()) return 1;
 
-    render(state_);
-    lastRender_ = std::chrono::steady_clock::now();
-
-    while (!g_stop.load()) {
-        bool advanced = pumpLines();
-        maybeRender(advanced);
-        if (g_stop.load()) break;
-        std::this_thread::sleep_for(std::chrono::milliseconds(renderIntervalMs_));
+    std::thread ingest([this]() { ingestLoop(); });
+    renderLoop();
+    ingest.join();
+    // Show the final state even if the last snapshot arrived after the last tick.
+    if (snapshots_.acquire()) {
+        renderNow(snapshots_.readBuffer());
     }
+    reportOutput();
     return 0;
 }
 } // namespace
 
 int runVisualizer(const std::string& logPath, int renderIntervalMs) {
     std::signal(SIGINT, handleSigint);
-    VisualizerApp app(logPath, renderIntervalMs);
-    return app.run();
+    std::signal(SIGWINCH, handleSigwinch);
+    // Three state snapshots plus the live state are too large for a comfortable stack frame.
+    auto app = std::make_unique<VisualizerApp>(logPath, renderIntervalMs);
+    return app->run();
 }